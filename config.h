@@ -34,6 +34,8 @@
 // History:
 //
 // 20240721 Copied from BresserWeatherSensorLW project
+// 20261017 Added ABP credentials
+//          debug(): replaced endless loop by wake guard forced sleep
 //
 // ToDo:
 // - 
@@ -46,6 +48,7 @@
 #include <stdint.h>
 #include <RadioLib.h>
 #include "secrets.h"
+#include "src/WakeGuard.h"
 
 // How often to send an uplink - consider legal & FUP constraints - see notes
 const uint32_t uplinkIntervalSeconds = 5UL * 60UL;    // minutes x seconds
@@ -171,6 +174,13 @@ uint64_t devEUI  =   RADIOLIB_LORAWAN_DEV_EUI;
 uint8_t appKey[] = { RADIOLIB_LORAWAN_APP_KEY };
 uint8_t nwkKey[] = { RADIOLIB_LORAWAN_NWK_KEY };
 
+// ABP credentials
+uint32_t devAddr =        RADIOLIB_LORAWAN_DEV_ADDR;
+uint8_t fNwkSIntKey[] = { RADIOLIB_LORAWAN_FNWKSINT_KEY };
+uint8_t sNwkSIntKey[] = { RADIOLIB_LORAWAN_SNWKSINT_KEY };
+uint8_t nwkSEncKey[] =  { RADIOLIB_LORAWAN_NWKSENC_KEY };
+uint8_t appSKey[] =     { RADIOLIB_LORAWAN_APPS_KEY };
+
 // Create the LoRaWAN node
 LoRaWANNode node(&radio, &Region, subBand);
 
@@ -240,11 +250,18 @@ String stateDecode(const int16_t result) {
   return "See TypeDef.h";
 }
 
+// Wake-cycle guard (declared in growatt2lorawan-v2.ino)
+extern WakeGuard wakeGuard;
+
 // Helper function to display any issues
+// Fatal errors (Freeze) do not block - the incident is recorded and
+// the node goes to sleep until the next wake-up cycle
 void debug(bool isFail, const char* message, int state, bool Freeze) {
   if (isFail) {
     log_w("%s - %s (%d)", message, stateDecode(state).c_str(), state);
-    while (Freeze);
+    if (Freeze) {
+      wakeGuard.fail();
+    }
   }
 }
 
@@ -0,0 +1,537 @@
+///////////////////////////////////////////////////////////////////////////////
+// microbench.cpp
+//
+// Host microbenchmarks of the node's decode, encode and command hot paths
+//
+// The benchmarks run the firmware code shared via the Arduino-independent
+// headers in src/ (GrowattDecode.h, UplinkSchema.h, SecretsParser.h,
+// SleepSchedule.h, ...) with the Google Benchmark API. By default, the minimal
+// harness in extras/host/MicroBench.h is used; define USE_GOOGLE_BENCHMARK to
+// build against the Google Benchmark library instead.
+//
+// Build:
+//   g++ -std=c++11 -O2 -DNDEBUG -Wall -I../.. -I../../src -o microbench microbench.cpp
+// or with Google Benchmark:
+//   g++ -std=c++11 -O2 -DNDEBUG -DUSE_GOOGLE_BENCHMARK -I../.. -I../../src -o microbench microbench.cpp -lbenchmark -lpthread
+// If ArduinoJson is found in the include path (-I<ArduinoJson>/src), the
+// complete parsing of 'secrets.json' is benchmarked as well.
+//
+// Usage:
+//   microbench [--benchmark_filter=<substring>] [--benchmark_min_time=<s>]
+//              [--benchmark_format=console|json] [--benchmark_out=<file>]
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//          Use PAYLOAD_SIZE_MAX from growatt2lorawan_cfg.h
+//          Use frame encoders of ports 1, 2, 4 and 5 from UplinkSchema.h
+//          Added downlink dispatch benchmark
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if defined(USE_GOOGLE_BENCHMARK)
+#include <benchmark/benchmark.h>
+#else
+#include "../host/MicroBench.h"
+#endif
+#include <math.h>
+#include <string>
+#include "growatt2lorawan_cfg.h"
+#include "ModbusRtu.h"
+#include "GrowattDecode.h"
+#include "../host/LoraEncoderHost.h"
+#include "UplinkSchema.h"
+#include "SwingingDoor.h"
+#include "DualPredictor.h"
+#include "FrameParity.h"
+#include "FragCodec.h"
+#include "SecretsParser.h"
+#include "SleepSchedule.h"
+#include "DownlinkDispatch.h"
+#if defined(__has_include)
+#if __has_include(<ArduinoJson.h>)
+#include <ArduinoJson.h>
+#define HAVE_ARDUINOJSON
+#endif
+#endif
+
+//
+// Test data
+//
+
+// Input register image of an inverter at ~1.2 kW
+static uint16_t inputRegs[128];
+
+// Holding register blocks 0 and 1
+static uint16_t holdingRegs[2][64];
+
+static void initRegisters(void)
+{
+    for (int i = 0; i < 128; i++)
+    {
+        inputRegs[i] = static_cast<uint16_t>(i * 0x9E37u);
+    }
+    inputRegs[0] = 1;     // status: normal
+    inputRegs[1] = 0;     // solarpower [0.1 W]
+    inputRegs[2] = 12500;
+    inputRegs[3] = 3215;  // pv1voltage [0.1 V]
+    inputRegs[4] = 21;    // pv1current [0.1 A]
+    inputRegs[37] = 5001; // gridfrequency [0.01 Hz]
+    inputRegs[38] = 2334; // gridvoltage [0.1 V]
+    inputRegs[93] = 412;  // tempinverter [0.1 degC]
+
+    for (int b = 0; b < 2; b++)
+    {
+        for (int i = 0; i < 64; i++)
+        {
+            holdingRegs[b][i] = static_cast<uint16_t>((64 * b + i) * 0x7F4Au);
+        }
+    }
+}
+
+// Transport returning a fixed response frame (read input registers, 64 registers)
+class LoopbackTransport : public ModbusTransport
+{
+public:
+    uint8_t frame[MB_FRAME_MAX];
+    size_t size = 0;
+
+    void begin(uint8_t slave, const uint16_t *regs)
+    {
+        frame[0] = slave;
+        frame[1] = 0x04;
+        frame[2] = 128;
+        for (int i = 0; i < 64; i++)
+        {
+            frame[3 + 2 * i] = regs[i] >> 8;
+            frame[4 + 2 * i] = regs[i] & 0xFF;
+        }
+        uint16_t crc = modbusCrc16(frame, 131);
+        frame[131] = crc & 0xFF;
+        frame[132] = crc >> 8;
+        size = 133;
+    }
+
+    int transact(const uint8_t *req, size_t reqLen, uint8_t *resp, size_t expected, uint32_t timeoutMs) override
+    {
+        (void)req;
+        (void)reqLen;
+        (void)expected;
+        (void)timeoutMs;
+        memcpy(resp, frame, size);
+        return static_cast<int>(size);
+    }
+};
+
+//
+// Modbus (growattIF::ReadInputRegisters() / ReadHoldingRegisters())
+//
+
+static void BM_ModbusCrc16(benchmark::State &state)
+{
+    uint8_t frame[131];
+    for (size_t i = 0; i < sizeof(frame); i++)
+    {
+        frame[i] = static_cast<uint8_t>(i * 31);
+    }
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(modbusCrc16(frame, sizeof(frame)));
+    }
+    state.SetBytesProcessed(state.iterations() * sizeof(frame));
+}
+BENCHMARK(BM_ModbusCrc16);
+
+// Request/response handling and register extraction of both blocks (without I/O)
+static void BM_ReadInputRegisters_Frame(benchmark::State &state)
+{
+    LoopbackTransport transport;
+    ModbusRtuMaster master;
+    uint16_t regs[128];
+
+    transport.begin(1, inputRegs);
+    master.begin(1, transport);
+    for (auto _ : state)
+    {
+        for (int block = 0; block < 2; block++)
+        {
+            if (master.readInputRegisters(block * 64, 64) != ModbusRtuMaster::ku8MBSuccess)
+            {
+                state.SkipWithError("Modbus error");
+                break;
+            }
+            for (int i = 0; i < 64; i++)
+            {
+                regs[block * 64 + i] = master.getResponseBuffer(i);
+            }
+        }
+        benchmark::DoNotOptimize(regs);
+    }
+}
+BENCHMARK(BM_ReadInputRegisters_Frame);
+
+static void BM_ReadInputRegisters_Decode(benchmark::State &state)
+{
+    growatt_input_registers d;
+    for (auto _ : state)
+    {
+        growattDecodeInputRegisters(inputRegs, d);
+        benchmark::DoNotOptimize(d);
+    }
+}
+BENCHMARK(BM_ReadInputRegisters_Decode);
+
+static void BM_ReadHoldingRegisters_Decode(benchmark::State &state)
+{
+    growatt_holding_registers s;
+    for (auto _ : state)
+    {
+        growattDecodeHoldingRegisters(0, holdingRegs[0], s);
+        growattDecodeHoldingRegisters(1, holdingRegs[1], s);
+        benchmark::DoNotOptimize(s);
+    }
+}
+BENCHMARK(BM_ReadHoldingRegisters_Decode);
+
+//
+// Payload encoding (AppLayer::getPayloadStage2())
+//
+
+static void BM_Payload_Port1(benchmark::State &state)
+{
+    growatt_input_registers d;
+    uint8_t buf[PAYLOAD_SIZE_MAX];
+    uint16_t seq = 0;
+
+    growattDecodeInputRegisters(inputRegs, d);
+    for (auto _ : state)
+    {
+        LoraEncoder encoder(buf);
+        encodeStatusUplink(encoder, d, seq++);
+        benchmark::DoNotOptimize(buf);
+    }
+}
+BENCHMARK(BM_Payload_Port1);
+
+static void BM_Payload_Port2(benchmark::State &state)
+{
+    growatt_input_registers d;
+    uint8_t buf[PAYLOAD_SIZE_MAX];
+
+    growattDecodeInputRegisters(inputRegs, d);
+    for (auto _ : state)
+    {
+        LoraEncoder encoder(buf);
+        encodePv1Uplink(encoder, d, 0);
+        benchmark::DoNotOptimize(buf);
+    }
+}
+BENCHMARK(BM_Payload_Port2);
+
+// Swinging door compression of a full sample buffer (64 samples, 2 series)
+static void BM_Payload_Port4(benchmark::State &state)
+{
+    const int n = 64;
+    uint16_t dt[n];
+    uint16_t output[n];
+    uint16_t solar[n];
+    uint8_t buf[PAYLOAD_SIZE_MAX];
+
+    for (int i = 0; i < n; i++)
+    {
+        dt[i] = static_cast<uint16_t>(i * 60);
+        float p = 1500.0f * sinf(3.14159f * i / n) + 50.0f * sinf(1.7f * i);
+        output[i] = static_cast<uint16_t>((p > 0) ? p : 0);
+        solar[i] = static_cast<uint16_t>(output[i] * 1.04f);
+    }
+    for (auto _ : state)
+    {
+        LoraEncoder encoder(buf);
+        benchmark::DoNotOptimize(encodePowerCurveUplink(encoder, 1760000000UL, dt, output, solar, n,
+                                                        PAYLOAD_SIZE_MAX, SDT_MAX_ERROR));
+        benchmark::DoNotOptimize(buf);
+    }
+}
+BENCHMARK(BM_Payload_Port4);
+
+// Dual prediction: prediction, trend update and report
+static void BM_Payload_Port5(benchmark::State &state)
+{
+    DpState s = {1760000000UL, 1200, 35, 4500000UL};
+    uint8_t buf[PAYLOAD_SIZE_MAX];
+    uint32_t t = s.t0 + 45 * 60;
+
+    for (auto _ : state)
+    {
+        DpState next;
+        uint16_t power;
+        uint32_t energy;
+        dpPredict(s, t, power, energy);
+        next.t0 = t;
+        next.power = power + 100;
+        next.trend = dpTrend(s, t, next.power);
+        next.energy = energy;
+        LoraEncoder encoder(buf);
+        encodePredictionUplink(encoder, 0x01 /* DP_REASON_POWER */, next, 0);
+        benchmark::DoNotOptimize(buf);
+    }
+}
+BENCHMARK(BM_Payload_Port5);
+
+// Parity group of 4 frames (port 1 payloads) and parity frame encoding
+static void BM_Payload_Port6(benchmark::State &state)
+{
+    growatt_input_registers d;
+    uint8_t frame[PAYLOAD_SIZE_MAX];
+    uint8_t out[3 + 2 * FEC_GROUP_MAX + FEC_FRAME_MAX];
+    FecGroup g;
+
+    growattDecodeInputRegisters(inputRegs, d);
+    LoraEncoder encoder(frame);
+    encodeStatusUplink(encoder, d, 0);
+    uint8_t len = encoder.getLength();
+
+    for (auto _ : state)
+    {
+        fecReset(g, 0, 4);
+        for (uint16_t seq = 0; seq < 4; seq++)
+        {
+            fecAdd(g, seq, 1, frame, len);
+        }
+        benchmark::DoNotOptimize(fecEncode(g, out));
+        benchmark::DoNotOptimize(out);
+    }
+}
+BENCHMARK(BM_Payload_Port6);
+
+// All fragments of a 256 byte blob (input register image) with 50% redundancy
+static void BM_Payload_Port7(benchmark::State &state)
+{
+    const uint8_t fragSize = PAYLOAD_SIZE_MAX - FRAG_HDR_SIZE;
+    uint8_t blob[256];
+    uint8_t out[FRAG_HDR_SIZE + fragSize];
+
+    for (int i = 0; i < 128; i++)
+    {
+        blob[2 * i] = inputRegs[i] & 0xFF;
+        blob[2 * i + 1] = inputRegs[i] >> 8;
+    }
+    uint8_t n = fragCount(sizeof(blob), fragSize);
+    for (auto _ : state)
+    {
+        for (uint8_t idx = 0; idx < n + n / 2; idx++)
+        {
+            fragEncode(blob, sizeof(blob), 1, 0x01, idx, fragSize, out);
+            benchmark::DoNotOptimize(out);
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * sizeof(blob));
+}
+BENCHMARK(BM_Payload_Port7);
+
+// Inverter summary and two energy meters
+static void BM_Payload_Port9(benchmark::State &state)
+{
+    growatt_input_registers d;
+    float meter[2][DEV_NUM_VALUES] = {{-850.5f, 10234.2f, 8123.9f}, {120.0f, 345.6f, 0.0f}};
+    uint8_t buf[PAYLOAD_SIZE_MAX];
+
+    growattDecodeInputRegisters(inputRegs, d);
+    for (auto _ : state)
+    {
+        LoraEncoder encoder(buf);
+        encodeInverterSummary(encoder, 0, d);
+        encoder.writeUint8(2);
+        for (int i = 0; i < 2; i++)
+        {
+            encodeMeter(encoder, 0, meter[i]);
+        }
+        benchmark::DoNotOptimize(buf);
+    }
+}
+BENCHMARK(BM_Payload_Port9);
+
+//
+// Configuration uplinks (sendCfgUplink())
+//
+
+static void BM_CfgUplink_DateTime(benchmark::State &state)
+{
+    uint8_t buf[PAYLOAD_SIZE_MAX];
+    uint32_t t = 1760000000UL;
+
+    for (auto _ : state)
+    {
+        LoraEncoder encoder(buf);
+        encodeDateTime(encoder, t++, 1);
+        benchmark::DoNotOptimize(buf);
+    }
+}
+BENCHMARK(BM_CfgUplink_DateTime);
+
+static void BM_CfgUplink_LwConfig(benchmark::State &state)
+{
+    uint8_t buf[PAYLOAD_SIZE_MAX];
+
+    for (auto _ : state)
+    {
+        LoraEncoder encoder(buf);
+        encodeLwConfig(encoder, 360, 900, 60);
+        benchmark::DoNotOptimize(buf);
+    }
+}
+BENCHMARK(BM_CfgUplink_LwConfig);
+
+//
+// Downlink dispatch (decodeDownlink())
+//
+
+static void BM_DecodeDownlink_GetRequest(benchmark::State &state)
+{
+    static const uint8_t ports[] = {CMD_GET_DATETIME, CMD_SET_DATETIME, CMD_GET_LW_CONFIG, CMD_GET_LW_STATUS,
+                                    CMD_GET_STATUS_INTERVAL, CMD_GET_SENSORS_STAT, CMD_GET_SAMPLES, 0x7F};
+    const size_t n = sizeof(ports) / sizeof(ports[0]);
+    const uint8_t payload[1] = {0x00};
+    size_t i = 0;
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(getCmdRequest(ports[i], payload, sizeof(payload)));
+        i = (i + 1 < n) ? i + 1 : 0;
+    }
+}
+BENCHMARK(BM_DecodeDownlink_GetRequest);
+
+//
+// Secrets (loadSecrets())
+//
+
+static const char *joinEuiStr = "0x0000000000000000";
+static const char *devEuiStr = "0x70B3D57ED0060A2B";
+static const char *appKeyStr[16] = {
+    "0x2B", "0x7E", "0x15", "0x16", "0x28", "0xAE", "0xD2", "0xA6",
+    "0xAB", "0xF7", "0x15", "0x88", "0x09", "0xCF", "0x4F", "0x3C"};
+
+static void BM_LoadSecrets_ParseEui(benchmark::State &state)
+{
+    uint64_t joinEUI;
+    uint64_t devEUI;
+
+    for (auto _ : state)
+    {
+        parseEui(joinEuiStr, joinEUI);
+        parseEui(devEuiStr, devEUI);
+        benchmark::DoNotOptimize(joinEUI);
+        benchmark::DoNotOptimize(devEUI);
+    }
+}
+BENCHMARK(BM_LoadSecrets_ParseEui);
+
+static void BM_LoadSecrets_ParseKey(benchmark::State &state)
+{
+    uint8_t key[16];
+
+    for (auto _ : state)
+    {
+        parseKey(appKeyStr, key);
+        benchmark::DoNotOptimize(key);
+    }
+}
+BENCHMARK(BM_LoadSecrets_ParseKey);
+
+#if defined(HAVE_ARDUINOJSON)
+// Complete parsing of 'secrets.json' (OTAA) - without file access
+static void BM_LoadSecrets_Json(benchmark::State &state)
+{
+    std::string json = std::string("{\"joinEUI\":\"") + joinEuiStr + "\",\"devEUI\":\"" + devEuiStr + "\"";
+    for (const char *name : {"nwkKey", "appKey"})
+    {
+        json += std::string(",\"") + name + "\":[";
+        for (int i = 0; i < 16; i++)
+        {
+            json += std::string(i ? "," : "") + "\"" + appKeyStr[i] + "\"";
+        }
+        json += "]";
+    }
+    json += "}";
+
+    uint64_t joinEUI;
+    uint64_t devEUI;
+    uint8_t nwkKey[16];
+    uint8_t appKey[16];
+    for (auto _ : state)
+    {
+        JsonDocument doc;
+        if (deserializeJson(doc, json.c_str()) ||
+            !parseEui(doc["joinEUI"], joinEUI) || !parseEui(doc["devEUI"], devEUI) ||
+            !parseKey(doc["nwkKey"], nwkKey) || !parseKey(doc["appKey"], appKey))
+        {
+            state.SkipWithError("Parse error");
+            break;
+        }
+        benchmark::DoNotOptimize(appKey);
+    }
+}
+BENCHMARK(BM_LoadSecrets_Json);
+#endif
+
+//
+// Sleep duration (sleepDuration())
+//
+
+static void BM_SleepDuration(benchmark::State &state)
+{
+    time_t t = 1760000000L;
+
+    for (auto _ : state)
+    {
+        struct tm timeinfo;
+        localtime_r(&t, &timeinfo);
+        uint32_t interval = alignSleepInterval(360, timeinfo);
+        interval = (interval > SLEEP_INTERVAL_MIN) ? interval : SLEEP_INTERVAL_MIN;
+        benchmark::DoNotOptimize(interval);
+        t += 7;
+    }
+}
+BENCHMARK(BM_SleepDuration);
+
+int main(int argc, char **argv)
+{
+    initRegisters();
+#if defined(USE_GOOGLE_BENCHMARK)
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+#else
+    return benchmark::internal::main(argc, argv);
+#endif
+}
@@ -0,0 +1,154 @@
+///////////////////////////////////////////////////////////////////////////////
+// blob_reassemble.cpp
+//
+// Host tool for bulk data (blob) transfer - reassembles blobs from the
+// fragments received on BLOB_PORT, using the same codec as the node
+// (src/FragCodec.h)
+//
+// Input (stdin): one fragment per line as hex string (uplink payload on
+//   BLOB_PORT, e.g. copied from the network server's console; spaces are
+//   ignored). Lines starting with '#' are ignored.
+//
+// Output: each complete blob is written to blob_s<session>_t<type>.bin;
+//   progress is reported on stderr.
+//   Blob types: 0x01 - input registers 0...127 (16 bit, LE)
+//               0x02 - sample records (see CMD_GET_SAMPLES)
+//               0x03 - diagnostic burst (see src/BurstCapture.h)
+//               0x80 | port - oversized uplink payload of <port>
+//
+// Build:
+//   g++ -std=c++11 -O2 -Wall -I../../src -o blob_reassemble blob_reassemble.cpp
+//
+// Usage:
+//   ./blob_reassemble < fragments.txt
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cctype>
+#include "FragCodec.h"
+
+// Parse hex string; returns number of bytes or -1 on error
+static int parseHex(const char *str, uint8_t *buf, size_t size)
+{
+    size_t n = 0;
+    int nibble = -1;
+    for (; *str; str++)
+    {
+        if (isspace(static_cast<unsigned char>(*str)))
+        {
+            continue;
+        }
+        if (!isxdigit(static_cast<unsigned char>(*str)))
+        {
+            return -1;
+        }
+        int v = isdigit(static_cast<unsigned char>(*str)) ? *str - '0' : (tolower(*str) - 'a' + 10);
+        if (nibble < 0)
+        {
+            nibble = v;
+        }
+        else
+        {
+            if (n >= size)
+            {
+                return -1;
+            }
+            buf[n++] = static_cast<uint8_t>((nibble << 4) | v);
+            nibble = -1;
+        }
+    }
+    return (nibble < 0) ? static_cast<int>(n) : -1;
+}
+
+int main(void)
+{
+    static FragReassembler reassembler;
+    static uint8_t blob[FRAG_DATA_MAX * FRAG_SIZE_MAX];
+    char line[1024];
+    unsigned lineNo = 0;
+    bool done = false;
+
+    while (fgets(line, sizeof(line), stdin))
+    {
+        lineNo++;
+        if (line[0] == '#')
+        {
+            continue;
+        }
+        uint8_t frame[FRAG_HDR_SIZE + FRAG_SIZE_MAX];
+        int len = parseHex(line, frame, sizeof(frame));
+        if (len == 0)
+        {
+            continue;
+        }
+        if ((len < 0) || !reassembler.add(frame, len))
+        {
+            fprintf(stderr, "Line %u: invalid fragment\n", lineNo);
+            continue;
+        }
+        if (done && (reassembler.session() == frame[0]))
+        {
+            // Surplus fragment of a completed blob
+            continue;
+        }
+        done = false;
+        fprintf(stderr, "Session %u: fragment %u, %u data fragments missing\n",
+                reassembler.session(), frame[2], reassembler.missing());
+
+        if (reassembler.complete())
+        {
+            char fname[32];
+            size_t size = reassembler.read(blob);
+            snprintf(fname, sizeof(fname), "blob_s%u_t%02x.bin", reassembler.session(), reassembler.type());
+            FILE *f = fopen(fname, "wb");
+            if (!f || (fwrite(blob, 1, size, f) != size))
+            {
+                fprintf(stderr, "Writing %s failed\n", fname);
+                return 1;
+            }
+            fclose(f);
+            fprintf(stderr, "Session %u: %u bytes written to %s\n", reassembler.session(), static_cast<unsigned>(size), fname);
+            done = true;
+        }
+    }
+    if (!done && reassembler.missing())
+    {
+        fprintf(stderr, "Session %u incomplete: %u data fragments missing\n", reassembler.session(), reassembler.missing());
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,366 @@
+///////////////////////////////////////////////////////////////////////////////
+// LwCrypto.h
+//
+// LoRaWAN cryptography with pluggable AES-128 backend - payload encryption
+// (AES-CTR), MIC (AES-CMAC, RFC 4493) and session key derivation
+//
+// The software backend (LwSoftAes) is the reference implementation; other
+// backends only have to provide the primitives of LwCryptoBackend.
+//
+// This file is used by the host-side tools only (lw_crypto_check.cpp and
+// extras/lns/lns_stub.cpp) - RadioLib 6.6 uses its own, fixed software AES
+// instance for the LoRaWAN stack, so the firmware cannot use it.
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//          Moved from src/ (not used by the firmware)
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_LWCRYPTO_H)
+#define _LWCRYPTO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define LW_AES_BLOCK 16
+
+/// Frame direction (LoRaWAN A_i / B_0 blocks)
+#define LW_DIR_UPLINK 0
+#define LW_DIR_DOWNLINK 1
+
+/*!
+ * \brief AES-128 backend interface
+ *
+ * Only encryption is required by LoRaWAN. Multi-block operations are part of
+ * the interface, so a hardware backend can process a complete frame with a
+ * single access to the accelerator.
+ */
+class LwCryptoBackend
+{
+public:
+    virtual ~LwCryptoBackend() {}
+
+    /*!
+     * \brief Set key
+     */
+    virtual void setKey(const uint8_t *key) = 0;
+
+    /*!
+     * \brief Encrypt single block (ECB)
+     */
+    virtual void encryptBlock(const uint8_t *in, uint8_t *out) = 0;
+
+    /*!
+     * \brief CBC-MAC over complete blocks
+     *
+     * \param in      input data
+     * \param nBlocks number of blocks
+     * \param x       chaining value (in: IV / out: last cipher block)
+     */
+    virtual void cbcMac(const uint8_t *in, size_t nBlocks, uint8_t *x)
+    {
+        for (size_t i = 0; i < nBlocks; i++)
+        {
+            for (int j = 0; j < LW_AES_BLOCK; j++)
+            {
+                x[j] ^= in[i * LW_AES_BLOCK + j];
+            }
+            encryptBlock(x, x);
+        }
+    }
+
+    /*!
+     * \brief CTR mode encryption / decryption
+     *
+     * \param counter initial counter block (big endian increment; modified)
+     * \param in      input data
+     * \param out     output data (may be identical to in)
+     * \param len     length in bytes
+     */
+    virtual void ctr(uint8_t *counter, const uint8_t *in, uint8_t *out, size_t len)
+    {
+        uint8_t s[LW_AES_BLOCK];
+        for (size_t pos = 0; pos < len; pos += LW_AES_BLOCK)
+        {
+            encryptBlock(counter, s);
+            for (size_t j = 0; (j < LW_AES_BLOCK) && (pos + j < len); j++)
+            {
+                out[pos + j] = in[pos + j] ^ s[j];
+            }
+            for (int j = LW_AES_BLOCK - 1; j >= 0; j--)
+            {
+                if (++counter[j] != 0)
+                {
+                    break;
+                }
+            }
+        }
+    }
+};
+
+/*!
+ * \brief Software AES-128 (encryption only; reference implementation)
+ */
+class LwSoftAes : public LwCryptoBackend
+{
+public:
+    void setKey(const uint8_t *key) override
+    {
+        static const uint8_t rcon[10] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1B, 0x36};
+
+        memcpy(_rk, key, 16);
+        for (int i = 16, r = 0; i < 176; i += 4)
+        {
+            uint8_t t[4] = {_rk[i - 4], _rk[i - 3], _rk[i - 2], _rk[i - 1]};
+            if (i % 16 == 0)
+            {
+                uint8_t t0 = t[0];
+                t[0] = sbox(t[1]) ^ rcon[r++];
+                t[1] = sbox(t[2]);
+                t[2] = sbox(t[3]);
+                t[3] = sbox(t0);
+            }
+            for (int j = 0; j < 4; j++)
+            {
+                _rk[i + j] = _rk[i + j - 16] ^ t[j];
+            }
+        }
+    }
+
+    void encryptBlock(const uint8_t *in, uint8_t *out) override
+    {
+        uint8_t s[16];
+
+        for (int i = 0; i < 16; i++)
+        {
+            s[i] = in[i] ^ _rk[i];
+        }
+        for (int round = 1; round <= 10; round++)
+        {
+            // SubBytes and ShiftRows (state is column major)
+            uint8_t t[16];
+            for (int c = 0; c < 4; c++)
+            {
+                for (int r = 0; r < 4; r++)
+                {
+                    t[4 * c + r] = sbox(s[4 * ((c + r) % 4) + r]);
+                }
+            }
+            // MixColumns (not in last round)
+            if (round < 10)
+            {
+                for (int c = 0; c < 4; c++)
+                {
+                    uint8_t *col = &t[4 * c];
+                    uint8_t a = col[0] ^ col[1] ^ col[2] ^ col[3];
+                    uint8_t c0 = col[0];
+                    col[0] ^= a ^ xtime(col[0] ^ col[1]);
+                    col[1] ^= a ^ xtime(col[1] ^ col[2]);
+                    col[2] ^= a ^ xtime(col[2] ^ col[3]);
+                    col[3] ^= a ^ xtime(col[3] ^ c0);
+                }
+            }
+            // AddRoundKey
+            for (int i = 0; i < 16; i++)
+            {
+                s[i] = t[i] ^ _rk[16 * round + i];
+            }
+        }
+        memcpy(out, s, 16);
+    }
+
+private:
+    uint8_t _rk[176]; //!< expanded key
+
+    static uint8_t xtime(uint8_t x)
+    {
+        return static_cast<uint8_t>((x << 1) ^ ((x & 0x80) ? 0x1B : 0x00));
+    }
+
+    static uint8_t sbox(uint8_t x)
+    {
+        static const uint8_t tab[256] = {
+            0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+            0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+            0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+            0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+            0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+            0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+            0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+            0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+            0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+            0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+            0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+            0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+            0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+            0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+            0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+            0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16};
+        return tab[x];
+    }
+};
+
+/*!
+ * \brief AES-CMAC (RFC 4493)
+ *
+ * \param aes backend (key already set)
+ * \param msg message
+ * \param len message length
+ * \param mac 16 byte MAC
+ */
+static inline void lwCmac(LwCryptoBackend &aes, const uint8_t *msg, size_t len, uint8_t *mac)
+{
+    uint8_t k[LW_AES_BLOCK] = {0};
+    uint8_t last[LW_AES_BLOCK];
+
+    // Subkey generation: K1 = L << 1, K2 = K1 << 1 (with conditional XOR of 0x87)
+    aes.encryptBlock(k, k);
+    int nSub = ((len == 0) || (len % LW_AES_BLOCK)) ? 2 : 1;
+    for (int n = 0; n < nSub; n++)
+    {
+        uint8_t msb = k[0] & 0x80;
+        for (int i = 0; i < LW_AES_BLOCK - 1; i++)
+        {
+            k[i] = static_cast<uint8_t>((k[i] << 1) | (k[i + 1] >> 7));
+        }
+        k[LW_AES_BLOCK - 1] = static_cast<uint8_t>((k[LW_AES_BLOCK - 1] << 1) ^ (msb ? 0x87 : 0x00));
+    }
+
+    size_t nBlocks = (len + LW_AES_BLOCK - 1) / LW_AES_BLOCK;
+    if (nBlocks == 0)
+    {
+        nBlocks = 1;
+    }
+    size_t lastLen = len - (nBlocks - 1) * LW_AES_BLOCK;
+
+    // Last block - complete: XOR K1 / incomplete: pad with 10...0, XOR K2
+    memset(last, 0, LW_AES_BLOCK);
+    memcpy(last, &msg[(nBlocks - 1) * LW_AES_BLOCK], lastLen);
+    if (lastLen < LW_AES_BLOCK)
+    {
+        last[lastLen] = 0x80;
+    }
+    for (int i = 0; i < LW_AES_BLOCK; i++)
+    {
+        last[i] ^= k[i];
+    }
+
+    memset(mac, 0, LW_AES_BLOCK);
+    aes.cbcMac(msg, nBlocks - 1, mac);
+    aes.cbcMac(last, 1, mac);
+}
+
+/*!
+ * \brief Encrypt / decrypt FRMPayload (LoRaWAN 1.0.x/1.1, 4.3.3)
+ *
+ * The A_i blocks only differ in the last byte (i = 1...), so the key stream
+ * is AES-CTR with A_1 as initial counter block.
+ *
+ * \param aes     backend (AppSKey / NwkSEncKey already set)
+ * \param devAddr device address
+ * \param fCnt    frame counter
+ * \param dir     LW_DIR_UPLINK / LW_DIR_DOWNLINK
+ * \param in      input data
+ * \param out     output data (may be identical to in)
+ * \param len     length in bytes
+ */
+static inline void lwPayloadCrypt(LwCryptoBackend &aes, uint32_t devAddr, uint32_t fCnt, uint8_t dir,
+                                  const uint8_t *in, uint8_t *out, size_t len)
+{
+    uint8_t a[LW_AES_BLOCK] = {0x01, 0, 0, 0, 0, dir,
+                               static_cast<uint8_t>(devAddr), static_cast<uint8_t>(devAddr >> 8),
+                               static_cast<uint8_t>(devAddr >> 16), static_cast<uint8_t>(devAddr >> 24),
+                               static_cast<uint8_t>(fCnt), static_cast<uint8_t>(fCnt >> 8),
+                               static_cast<uint8_t>(fCnt >> 16), static_cast<uint8_t>(fCnt >> 24),
+                               0, 1};
+    aes.ctr(a, in, out, len);
+}
+
+/*!
+ * \brief Compute MIC of data frame (LoRaWAN 1.0.x, 4.4)
+ *
+ * \param aes     backend (NwkSKey already set)
+ * \param devAddr device address
+ * \param fCnt    frame counter
+ * \param dir     LW_DIR_UPLINK / LW_DIR_DOWNLINK
+ * \param msg     MHDR | FHDR | FPort | FRMPayload
+ * \param len     message length (max. 255)
+ *
+ * \returns MIC (first 4 bytes of CMAC, little endian)
+ */
+static inline uint32_t lwMic(LwCryptoBackend &aes, uint32_t devAddr, uint32_t fCnt, uint8_t dir,
+                             const uint8_t *msg, size_t len)
+{
+    uint8_t buf[LW_AES_BLOCK + 256];
+    uint8_t mac[LW_AES_BLOCK];
+
+    if (len > 255)
+    {
+        return 0;
+    }
+    const uint8_t b0[LW_AES_BLOCK] = {0x49, 0, 0, 0, 0, dir,
+                                      static_cast<uint8_t>(devAddr), static_cast<uint8_t>(devAddr >> 8),
+                                      static_cast<uint8_t>(devAddr >> 16), static_cast<uint8_t>(devAddr >> 24),
+                                      static_cast<uint8_t>(fCnt), static_cast<uint8_t>(fCnt >> 8),
+                                      static_cast<uint8_t>(fCnt >> 16), static_cast<uint8_t>(fCnt >> 24),
+                                      0, static_cast<uint8_t>(len)};
+    memcpy(buf, b0, LW_AES_BLOCK);
+    memcpy(&buf[LW_AES_BLOCK], msg, len);
+    lwCmac(aes, buf, LW_AES_BLOCK + len, mac);
+    return mac[0] | (mac[1] << 8) | (mac[2] << 16) | (static_cast<uint32_t>(mac[3]) << 24);
+}
+
+/*!
+ * \brief Derive session key (LoRaWAN 1.0.x, 6.2.5)
+ *
+ * \param aes      backend (AppKey already set)
+ * \param type     0x01 - NwkSKey / 0x02 - AppSKey
+ * \param appNonce AppNonce (3 bytes, as in JoinAccept)
+ * \param netId    NetID (3 bytes, as in JoinAccept)
+ * \param devNonce DevNonce
+ * \param key      derived key (16 bytes)
+ */
+static inline void lwDeriveKey(LwCryptoBackend &aes, uint8_t type, const uint8_t *appNonce, const uint8_t *netId,
+                               uint16_t devNonce, uint8_t *key)
+{
+    uint8_t blk[LW_AES_BLOCK] = {0};
+    blk[0] = type;
+    memcpy(&blk[1], appNonce, 3);
+    memcpy(&blk[4], netId, 3);
+    blk[7] = static_cast<uint8_t>(devNonce);
+    blk[8] = static_cast<uint8_t>(devNonce >> 8);
+    aes.encryptBlock(blk, key);
+}
+#endif // _LWCRYPTO_H
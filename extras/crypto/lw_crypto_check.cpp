@@ -0,0 +1,278 @@
+///////////////////////////////////////////////////////////////////////////////
+// lw_crypto_check.cpp
+//
+// Host tool for the LoRaWAN crypto backends (LwCrypto.h) -
+// conformance check of the software reference implementation against
+// published test vectors (FIPS-197, RFC 4493, SP 800-38A), cross-check
+// against a second backend and benchmark
+//
+// If built with -DWITH_OPENSSL, OpenSSL's (usually AES-NI accelerated)
+// AES-128 is used as second backend.
+//
+// Build:
+//   g++ -std=c++11 -O2 -Wall -o lw_crypto_check lw_crypto_check.cpp
+//   g++ -std=c++11 -O2 -Wall -DWITH_OPENSSL -o lw_crypto_check lw_crypto_check.cpp -lcrypto
+//
+// Usage:
+//   ./lw_crypto_check
+//
+// Exit code: 0 - all checks passed / 1 - failure
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//          LwCrypto.h moved to extras/crypto
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include "LwCrypto.h"
+
+#if defined(WITH_OPENSSL)
+#include <openssl/evp.h>
+
+/*!
+ * \brief AES-128 backend using OpenSSL
+ */
+class LwOpenSslAes : public LwCryptoBackend
+{
+public:
+    LwOpenSslAes() : _ctx(EVP_CIPHER_CTX_new()) {}
+    ~LwOpenSslAes() { EVP_CIPHER_CTX_free(_ctx); }
+
+    void setKey(const uint8_t *key) override
+    {
+        memcpy(_key, key, 16);
+    }
+
+    void encryptBlock(const uint8_t *in, uint8_t *out) override
+    {
+        int len;
+        EVP_EncryptInit_ex(_ctx, EVP_aes_128_ecb(), nullptr, _key, nullptr);
+        EVP_CIPHER_CTX_set_padding(_ctx, 0);
+        EVP_EncryptUpdate(_ctx, out, &len, in, 16);
+    }
+
+    void cbcMac(const uint8_t *in, size_t nBlocks, uint8_t *x) override
+    {
+        uint8_t buf[16];
+        int len;
+        if (nBlocks == 0)
+        {
+            return;
+        }
+        EVP_EncryptInit_ex(_ctx, EVP_aes_128_cbc(), nullptr, _key, x);
+        EVP_CIPHER_CTX_set_padding(_ctx, 0);
+        for (size_t i = 0; i < nBlocks; i++)
+        {
+            EVP_EncryptUpdate(_ctx, buf, &len, &in[16 * i], 16);
+        }
+        memcpy(x, buf, 16);
+    }
+
+    void ctr(uint8_t *counter, const uint8_t *in, uint8_t *out, size_t len) override
+    {
+        int outLen;
+        EVP_EncryptInit_ex(_ctx, EVP_aes_128_ctr(), nullptr, _key, counter);
+        EVP_EncryptUpdate(_ctx, out, &outLen, in, static_cast<int>(len));
+        // Advance counter as the reference implementation does
+        for (size_t n = 0; n < (len + 15) / 16; n++)
+        {
+            for (int j = 15; j >= 0; j--)
+            {
+                if (++counter[j] != 0)
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+private:
+    EVP_CIPHER_CTX *_ctx;
+    uint8_t _key[16];
+};
+#endif
+
+static int failures = 0;
+
+// Parse hex string into buffer; returns number of bytes
+static size_t hex(const char *str, uint8_t *buf)
+{
+    size_t n = 0;
+    for (; str[0] && str[1]; str += 2)
+    {
+        unsigned v;
+        sscanf(str, "%2x", &v);
+        buf[n++] = static_cast<uint8_t>(v);
+    }
+    return n;
+}
+
+static void check(const char *name, const uint8_t *res, const char *expected)
+{
+    uint8_t exp[256];
+    size_t n = hex(expected, exp);
+    bool ok = memcmp(res, exp, n) == 0;
+    printf("%-28s %s\n", name, ok ? "passed" : "FAILED");
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+// Conformance check against published test vectors
+static void conformance(LwCryptoBackend &aes, const char *backend)
+{
+    uint8_t key[16];
+    uint8_t msg[64];
+    uint8_t res[64];
+    char name[64];
+
+    printf("--- %s ---\n", backend);
+
+    // FIPS-197, Appendix C.1
+    hex("000102030405060708090a0b0c0d0e0f", key);
+    hex("00112233445566778899aabbccddeeff", msg);
+    aes.setKey(key);
+    aes.encryptBlock(msg, res);
+    check("FIPS-197 C.1", res, "69c4e0d86a7b0430d8cdb78070b4c55a");
+
+    // RFC 4493, section 4
+    static const char *cmacExp[4] = {
+        "bb1d6929e95937287fa37d129b756746",
+        "070a16b46b4d4144f79bdd9dd04a287c",
+        "dfa66747de9ae63030ca32611497c827",
+        "51f0bebf7e3b9d92fc49741779363cfe"};
+    static const size_t cmacLen[4] = {0, 16, 40, 64};
+    hex("2b7e151628aed2a6abf7158809cf4f3c", key);
+    hex("6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+        "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710",
+        msg);
+    aes.setKey(key);
+    for (int i = 0; i < 4; i++)
+    {
+        lwCmac(aes, msg, cmacLen[i], res);
+        snprintf(name, sizeof(name), "RFC 4493 CMAC len=%zu", cmacLen[i]);
+        check(name, res, cmacExp[i]);
+    }
+
+    // SP 800-38A, F.5.1 (CTR-AES128.Encrypt)
+    uint8_t counter[16];
+    hex("f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff", counter);
+    aes.ctr(counter, msg, res, 64);
+    check("SP 800-38A F.5.1 CTR", res,
+          "874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff"
+          "5ae4df3edbd5d35e5b4f09020db03eab1e031dda2fbe03d1792170a0f3009cee");
+}
+
+#if defined(WITH_OPENSSL)
+// Cross-check of LoRaWAN operations with random keys / frames
+static void crossCheck(LwCryptoBackend &a, LwCryptoBackend &b, int n)
+{
+    int errors = 0;
+    srand(1);
+    for (int i = 0; i < n; i++)
+    {
+        uint8_t key[16];
+        uint8_t frame[255];
+        uint8_t encA[255];
+        uint8_t encB[255];
+        size_t len = rand() % 256;
+        uint32_t devAddr = static_cast<uint32_t>(rand());
+        uint32_t fCnt = static_cast<uint32_t>(rand());
+        for (int j = 0; j < 16; j++)
+        {
+            key[j] = static_cast<uint8_t>(rand());
+        }
+        for (size_t j = 0; j < len; j++)
+        {
+            frame[j] = static_cast<uint8_t>(rand());
+        }
+        a.setKey(key);
+        b.setKey(key);
+        lwPayloadCrypt(a, devAddr, fCnt, LW_DIR_UPLINK, frame, encA, len);
+        lwPayloadCrypt(b, devAddr, fCnt, LW_DIR_UPLINK, frame, encB, len);
+        if ((memcmp(encA, encB, len) != 0) ||
+            (lwMic(a, devAddr, fCnt, LW_DIR_DOWNLINK, frame, len) != lwMic(b, devAddr, fCnt, LW_DIR_DOWNLINK, frame, len)))
+        {
+            errors++;
+        }
+    }
+    printf("%-28s %s (%d frames)\n", "Cross-check", errors ? "FAILED" : "passed", n);
+    failures += errors ? 1 : 0;
+}
+#endif
+
+// Benchmark: payload encryption and MIC of one frame
+static void benchmark(LwCryptoBackend &aes, const char *backend, size_t len)
+{
+    const int n = 20000;
+    uint8_t key[16] = {0};
+    uint8_t frame[255] = {0};
+    uint32_t mic = 0;
+
+    aes.setKey(key);
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++)
+    {
+        lwPayloadCrypt(aes, 0x26011234, i, LW_DIR_UPLINK, frame, frame, len);
+        mic ^= lwMic(aes, 0x26011234, i, LW_DIR_UPLINK, frame, len);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    double us = std::chrono::duration<double, std::micro>(t1 - t0).count() / n;
+    printf("%-12s %3zu bytes: %8.3f us/frame (%08x)\n", backend, len, us, mic);
+}
+
+int main(void)
+{
+    LwSoftAes soft;
+    conformance(soft, "software");
+#if defined(WITH_OPENSSL)
+    LwOpenSslAes openssl;
+    conformance(openssl, "openssl");
+    crossCheck(soft, openssl, 10000);
+#endif
+
+    printf("--- benchmark ---\n");
+    static const size_t sizes[] = {13, 51, 222};
+    for (size_t len : sizes)
+    {
+        benchmark(soft, "software", len);
+#if defined(WITH_OPENSSL)
+        benchmark(openssl, "openssl", len);
+#endif
+    }
+    return failures ? 1 : 0;
+}
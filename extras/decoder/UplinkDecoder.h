@@ -0,0 +1,820 @@
+///////////////////////////////////////////////////////////////////////////////
+// UplinkDecoder.h
+//
+// Host-side uplink decoder library
+//
+// Decodes uplinks of growatt2lorawan in bulk - inverter status (port 1),
+// PV1 data (port 2) and the responses to CMD_GET_DATETIME / CMD_GET_LW_CONFIG.
+// The payload layout is shared with the firmware via src/UplinkSchema.h.
+//
+// - uplinkParseLine(): extracts metadata and payload from a JSON line
+//   (The Things Stack storage integration export, ChirpStack event)
+// - uplinkDecode(): decodes payload as scripts/uplink_formatter.js
+// - uplinkFormatCsv() / uplinkFormatJson(): output formatting without
+//   heap allocations; numbers are formatted as by the JavaScript decoders
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_UPLINKDECODER_H)
+#define _UPLINKDECODER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "UplinkSchema.h"
+
+// Command codes (response port = command) - see src/growatt2lorawan_cmd.h
+#define UD_CMD_GET_DATETIME 0x20
+#define UD_CMD_GET_LW_CONFIG 0x36
+
+/// Maximum LoRaWAN application payload size
+#define UD_PAYLOAD_MAX 242
+
+/// Maximum length of metadata strings (received_at, device_id)
+#define UD_META_MAX 128
+
+/*!
+ * \brief Uplink types with a columnar output table
+ */
+enum UplinkType
+{
+    UD_STATUS,   //!< port 1 - inverter status
+    UD_PV1,      //!< port 2 - PV1 data
+    UD_DATETIME, //!< response to CMD_GET_DATETIME
+    UD_LWCONFIG, //!< response to CMD_GET_LW_CONFIG
+    UD_NUM_TYPES,
+    UD_OTHER = UD_NUM_TYPES //!< not handled
+};
+
+/*!
+ * \brief Uplink frame as read from the input
+ *
+ * The metadata strings point into the input line (not terminated).
+ */
+struct UplinkFrame
+{
+    const char *receivedAt;       //!< reception time (ISO 8601)
+    size_t receivedAtLen;         //!< length of receivedAt
+    const char *deviceId;         //!< device ID
+    size_t deviceIdLen;           //!< length of deviceId
+    int64_t fCnt;                 //!< frame counter, -1 if not available
+    uint8_t port;                 //!< FPort
+    size_t len;                   //!< payload size
+    uint8_t payload[UD_PAYLOAD_MAX]; //!< payload
+};
+
+/*!
+ * \brief Decoded uplink
+ */
+struct UplinkRecord
+{
+    UplinkType type;     //!< uplink type
+    bool resultOnly;     //!< only Modbus result available (readout failed)
+    uint8_t result;      //!< Modbus result (ports 1 / 2)
+    int32_t seq;         //!< sample sequence number, -1 if not available
+    UplinkStatus status; //!< port 1
+    UplinkPv1 pv1;       //!< port 2
+    uint32_t unixtime;   //!< CMD_GET_DATETIME
+    uint8_t rtcSource;   //!< CMD_GET_DATETIME
+    uint16_t sleepInterval;     //!< CMD_GET_LW_CONFIG
+    uint16_t sleepIntervalLong; //!< CMD_GET_LW_CONFIG
+    uint8_t lwStatInterval;     //!< CMD_GET_LW_CONFIG
+};
+
+/*!
+ * \brief Get uplink type from port
+ */
+static inline UplinkType uplinkType(uint8_t port)
+{
+    switch (port)
+    {
+    case 1:
+        return UD_STATUS;
+    case 2:
+        return UD_PV1;
+    case UD_CMD_GET_DATETIME:
+        return UD_DATETIME;
+    case UD_CMD_GET_LW_CONFIG:
+        return UD_LWCONFIG;
+    default:
+        return UD_OTHER;
+    }
+}
+
+/*!
+ * \brief Decode uplink payload
+ *
+ * Follows the structure of scripts/uplink_formatter.js: a single byte payload
+ * is a Modbus result only; ports 1 and 2 start with the Modbus result and
+ * may be followed by the sample sequence number.
+ *
+ * \param port FPort
+ * \param buf  payload
+ * \param len  payload size
+ * \param rec  decoded uplink
+ *
+ * \returns true if decoded, false if type not handled or payload too short
+ */
+static inline bool uplinkDecode(uint8_t port, const uint8_t *buf, size_t len, UplinkRecord &rec)
+{
+    rec.type = uplinkType(port);
+    rec.resultOnly = false;
+    rec.seq = -1;
+    if ((rec.type == UD_OTHER) || (len == 0))
+    {
+        return false;
+    }
+    if (len == 1)
+    {
+        rec.resultOnly = true;
+        rec.result = buf[0];
+        return true;
+    }
+
+    switch (rec.type)
+    {
+    case UD_STATUS:
+        rec.result = buf[0];
+        if (!decodeInverterStatus(&buf[1], len - 1, rec.status))
+        {
+            return false;
+        }
+        if (len >= 1 + UPLINK_STATUS_SIZE + 2)
+        {
+            rec.seq = buf[1 + UPLINK_STATUS_SIZE] | (buf[2 + UPLINK_STATUS_SIZE] << 8);
+        }
+        return true;
+    case UD_PV1:
+        rec.result = buf[0];
+        if (!decodeInverterPv1(&buf[1], len - 1, rec.pv1))
+        {
+            return false;
+        }
+        if (len >= 1 + UPLINK_PV1_SIZE + 2)
+        {
+            rec.seq = buf[1 + UPLINK_PV1_SIZE] | (buf[2 + UPLINK_PV1_SIZE] << 8);
+        }
+        return true;
+    case UD_DATETIME:
+        return decodeDateTime(buf, len, rec.unixtime, rec.rtcSource);
+    case UD_LWCONFIG:
+        return decodeLwConfig(buf, len, rec.sleepInterval, rec.sleepIntervalLong, rec.lwStatInterval);
+    default:
+        return false;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Input: JSON lines
+// -----------------------------------------------------------------------------
+
+/*!
+ * \brief Decode base64
+ *
+ * \param in     input
+ * \param inLen  input length
+ * \param out    output
+ * \param maxLen capacity of out
+ *
+ * \returns number of bytes decoded, or -1 on invalid input
+ */
+static inline int uplinkBase64Decode(const char *in, size_t inLen, uint8_t *out, size_t maxLen)
+{
+    // 0x40: invalid, 0x80: padding
+    static uint8_t tab[256];
+    static bool init = false;
+    if (!init)
+    {
+        static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        memset(tab, 0x40, sizeof(tab));
+        for (int i = 0; i < 64; i++)
+        {
+            tab[static_cast<uint8_t>(alphabet[i])] = static_cast<uint8_t>(i);
+        }
+        tab[static_cast<uint8_t>('=')] = 0x80;
+        init = true;
+    }
+
+    while ((inLen > 0) && (tab[static_cast<uint8_t>(in[inLen - 1])] == 0x80))
+    {
+        inLen--;
+    }
+    if ((inLen % 4 == 1) || (inLen / 4 * 3 + (inLen % 4 ? inLen % 4 - 1 : 0) > maxLen))
+    {
+        return -1;
+    }
+
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(in);
+    size_t n = 0;
+    size_t i = 0;
+    for (; i + 4 <= inLen; i += 4)
+    {
+        uint32_t a = tab[p[i]], b = tab[p[i + 1]], c = tab[p[i + 2]], d = tab[p[i + 3]];
+        if ((a | b | c | d) & 0xC0)
+        {
+            return -1;
+        }
+        uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+        out[n++] = static_cast<uint8_t>(v >> 16);
+        out[n++] = static_cast<uint8_t>(v >> 8);
+        out[n++] = static_cast<uint8_t>(v);
+    }
+    if (i < inLen)
+    {
+        uint32_t v = 0;
+        size_t rem = inLen - i;
+        for (size_t j = 0; j < rem; j++)
+        {
+            uint8_t d = tab[p[i + j]];
+            if (d & 0xC0)
+            {
+                return -1;
+            }
+            v |= static_cast<uint32_t>(d) << (18 - 6 * j);
+        }
+        out[n++] = static_cast<uint8_t>(v >> 16);
+        if (rem == 3)
+        {
+            out[n++] = static_cast<uint8_t>(v >> 8);
+        }
+    }
+    return static_cast<int>(n);
+}
+
+/*!
+ * \brief Find value of JSON member
+ *
+ * The first occurrence of the member name at any nesting level is used;
+ * this is sufficient for the export formats handled by uplinkParseLine().
+ *
+ * \param p   JSON text
+ * \param end end of JSON text
+ * \param key member name including quotes, e.g. "\"f_port\""
+ * \param len length of key
+ *
+ * \returns pointer to first character of value, or nullptr if not found
+ */
+static inline const char *uplinkJsonFind(const char *p, const char *end, const char *key, size_t len)
+{
+    const char *start = p;
+    while (p < end)
+    {
+        const char *q = static_cast<const char *>(memchr(p, key[1], end - p));
+        if (!q || (q + len - 1 > end))
+        {
+            return nullptr;
+        }
+        if ((q > start) && (q[-1] == '"') && (memcmp(q - 1, key, len) == 0))
+        {
+            const char *v = q - 1 + len;
+            while ((v < end) && ((*v == ' ') || (*v == '\t') || (*v == ':')))
+            {
+                v++;
+            }
+            return v;
+        }
+        p = q + 1;
+    }
+    return nullptr;
+}
+
+// Get JSON string member (without escape sequences)
+static inline bool uplinkJsonString(const char *p, const char *end, const char *key, size_t keyLen,
+                                    const char *&val, size_t &len)
+{
+    const char *v = uplinkJsonFind(p, end, key, keyLen);
+    if (!v || (*v != '"'))
+    {
+        return false;
+    }
+    const char *e = static_cast<const char *>(memchr(v + 1, '"', end - v - 1));
+    if (!e)
+    {
+        return false;
+    }
+    val = v + 1;
+    len = e - val;
+    return true;
+}
+
+// Get JSON integer member (also accepts numeric strings)
+static inline bool uplinkJsonInt(const char *p, const char *end, const char *key, size_t keyLen, int64_t &val)
+{
+    const char *v = uplinkJsonFind(p, end, key, keyLen);
+    if (!v)
+    {
+        return false;
+    }
+    if ((v < end) && (*v == '"'))
+    {
+        v++;
+    }
+    int64_t n = 0;
+    const char *s = v;
+    while ((v < end) && (*v >= '0') && (*v <= '9'))
+    {
+        n = n * 10 + (*v++ - '0');
+    }
+    val = n;
+    return v != s;
+}
+
+#define UD_KEY(k) k, sizeof(k) - 1
+
+/*!
+ * \brief Parse JSON line
+ *
+ * Supported formats:
+ * - The Things Stack storage integration / MQTT / webhook uplink message
+ *   ("device_id", "received_at", "f_port", "f_cnt", "frm_payload" (base64))
+ * - ChirpStack uplink event ("deviceName", "time", "fPort", "fCnt", "data" (base64))
+ *
+ * \param line JSON line
+ * \param end  end of line
+ * \param f    uplink frame
+ *
+ * \returns true if an uplink with application payload was found
+ */
+static inline bool uplinkParseLine(const char *line, const char *end, UplinkFrame &f)
+{
+    int64_t port;
+    const char *payload;
+    size_t payloadLen;
+
+    if (uplinkJsonInt(line, end, UD_KEY("\"f_port\""), port))
+    {
+        if (!uplinkJsonString(line, end, UD_KEY("\"frm_payload\""), payload, payloadLen))
+        {
+            return false;
+        }
+        if (!uplinkJsonString(line, end, UD_KEY("\"device_id\""), f.deviceId, f.deviceIdLen))
+        {
+            f.deviceIdLen = 0;
+        }
+        if (!uplinkJsonString(line, end, UD_KEY("\"received_at\""), f.receivedAt, f.receivedAtLen))
+        {
+            f.receivedAtLen = 0;
+        }
+        if (!uplinkJsonInt(line, end, UD_KEY("\"f_cnt\""), f.fCnt))
+        {
+            // Omitted by The Things Stack if zero
+            f.fCnt = 0;
+        }
+    }
+    else if (uplinkJsonInt(line, end, UD_KEY("\"fPort\""), port))
+    {
+        if (!uplinkJsonString(line, end, UD_KEY("\"data\""), payload, payloadLen))
+        {
+            return false;
+        }
+        if (!uplinkJsonString(line, end, UD_KEY("\"deviceName\""), f.deviceId, f.deviceIdLen))
+        {
+            f.deviceIdLen = 0;
+        }
+        if (!uplinkJsonString(line, end, UD_KEY("\"time\""), f.receivedAt, f.receivedAtLen))
+        {
+            f.receivedAtLen = 0;
+        }
+        if (!uplinkJsonInt(line, end, UD_KEY("\"fCnt\""), f.fCnt))
+        {
+            f.fCnt = -1;
+        }
+    }
+    else
+    {
+        return false;
+    }
+    if ((port < 1) || (port > 255) || (f.deviceIdLen > UD_META_MAX) || (f.receivedAtLen > UD_META_MAX))
+    {
+        return false;
+    }
+    int n = uplinkBase64Decode(payload, payloadLen, f.payload, sizeof(f.payload));
+    if (n < 0)
+    {
+        return false;
+    }
+    f.port = static_cast<uint8_t>(port);
+    f.len = static_cast<size_t>(n);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Output
+// -----------------------------------------------------------------------------
+
+// Append string
+static inline char *uplinkFmtStr(char *p, const char *s, size_t len)
+{
+    memcpy(p, s, len);
+    return p + len;
+}
+
+// Write unsigned integer
+static inline char *uplinkFmtUint(char *p, uint64_t v)
+{
+    char tmp[20];
+    int n = 0;
+    do
+    {
+        tmp[n++] = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (n)
+    {
+        *p++ = tmp[--n];
+    }
+    return p;
+}
+
+// Write signed integer
+static inline char *uplinkFmtInt(char *p, int64_t v)
+{
+    if (v < 0)
+    {
+        *p++ = '-';
+        return uplinkFmtUint(p, static_cast<uint64_t>(-v));
+    }
+    return uplinkFmtUint(p, static_cast<uint64_t>(v));
+}
+
+/*!
+ * \brief Write number with one decimal, as JavaScript's Number.toFixed(1)
+ *
+ * The value is rounded half up based on its exact binary value. With an
+ * 80 bit (or wider) long double, v * 10 + 0.5 is computed without rounding
+ * error for all floats and for temperature / 100. Values of 1e18 and above
+ * are written with printf(), from 1e21 in the shortest exponential notation
+ * as by JavaScript. NaN and infinity are written as "NaN" and "Infinity"
+ * (rawfloat() in the JavaScript decoders maps exponent 255 to a finite value
+ * instead).
+ *
+ * \param p output
+ * \param v value
+ *
+ * \returns end of output
+ */
+static inline char *uplinkFmtFixed1(char *p, double v)
+{
+    if (v != v)
+    {
+        memcpy(p, "NaN", 3);
+        return p + 3;
+    }
+    if (v < 0)
+    {
+        *p++ = '-';
+        v = -v;
+    }
+    if (v > 1.7976931348623157e308)
+    {
+        memcpy(p, "Infinity", 8);
+        return p + 8;
+    }
+    if (v >= 1e21)
+    {
+        // Shortest representation which reads back as v
+        char tmp[32];
+        for (int prec = 0; prec < 17; prec++)
+        {
+            snprintf(tmp, sizeof(tmp), "%.*e", prec, v);
+            if (strtod(tmp, nullptr) == v)
+            {
+                break;
+            }
+        }
+        char *e = strchr(tmp, 'e');
+        p = uplinkFmtStr(p, tmp, e - tmp);
+        *p++ = 'e';
+        *p++ = '+';
+        return uplinkFmtUint(p, static_cast<uint64_t>(atoi(e + 2)));
+    }
+    long double x = static_cast<long double>(v) * 10 + 0.5L;
+    if (x >= 1e18L)
+    {
+        return p + sprintf(p, "%.1f", v);
+    }
+    uint64_t n = static_cast<uint64_t>(x);
+    p = uplinkFmtUint(p, n / 10);
+    *p++ = '.';
+    *p++ = static_cast<char>('0' + n % 10);
+    return p;
+}
+
+/*!
+ * \brief Modbus result text as in the JavaScript decoders
+ *
+ * \returns text, or nullptr if unknown
+ */
+static inline const char *uplinkModbusText(uint8_t code)
+{
+    switch (code)
+    {
+    case 0x00:
+        return "Success";
+    case 0x01:
+        return "IllegalFunction";
+    case 0x02:
+        return "IllegalDataAddress";
+    case 0x03:
+        return "IllegalDataValue";
+    case 0x04:
+        return "SlaveDeviceFailure";
+    case 0xE0:
+        return "InvalidSlaveID";
+    case 0xE1:
+        return "InvalidFunction";
+    case 0xE2:
+        return "ResponseTimedOut";
+    case 0xE3:
+        return "InvalidCRC";
+    default:
+        return nullptr;
+    }
+}
+
+/*!
+ * \brief RTC source text as in scripts/uplink_formatter.js
+ *
+ * \returns text, or nullptr if unknown
+ */
+static inline const char *uplinkRtcSourceText(uint8_t source)
+{
+    static const char *const text[] = {"GPS", "RTC", "LORA", "unsynched", "set (source unknown)"};
+    return (source < 5) ? text[source] : nullptr;
+}
+
+/// Maximum length of one output line
+#define UD_LINE_MAX 1024
+
+/*!
+ * \brief Get CSV header line of uplink type
+ */
+static inline const char *uplinkCsvHeader(UplinkType type)
+{
+    switch (type)
+    {
+    case UD_STATUS:
+        return "received_at,device_id,f_cnt,modbus,status,faultcode,energytoday,energytotal,totalworktime,"
+               "outputpower,gridvoltage,gridfrequency,seq\n";
+    case UD_PV1:
+        return "received_at,device_id,f_cnt,modbus,pv1voltage,pv1current,pv1power,tempinverter,tempipm,"
+               "pv1energytoday,pv1energytotal,seq\n";
+    case UD_DATETIME:
+        return "received_at,device_id,f_cnt,modbus,unixtime,rtc_source\n";
+    case UD_LWCONFIG:
+        return "received_at,device_id,f_cnt,modbus,sleep_interval,sleep_interval_long,lw_status_interval\n";
+    default:
+        return "";
+    }
+}
+
+/*!
+ * \brief Format decoded uplink as CSV line (columns see uplinkCsvHeader())
+ *
+ * Fields which are not available are left empty. Numbers with decimals are
+ * formatted as by the JavaScript decoders. The metadata is written without
+ * quoting (device IDs of The Things Stack only contain [a-z0-9-]).
+ *
+ * \param p   output (at least UD_LINE_MAX characters)
+ * \param f   uplink frame
+ * \param rec decoded uplink
+ *
+ * \returns end of output
+ */
+static inline char *uplinkFormatCsv(char *p, const UplinkFrame &f, const UplinkRecord &rec)
+{
+    p = uplinkFmtStr(p, f.receivedAt, f.receivedAtLen);
+    *p++ = ',';
+    p = uplinkFmtStr(p, f.deviceId, f.deviceIdLen);
+    *p++ = ',';
+    if (f.fCnt >= 0)
+    {
+        p = uplinkFmtInt(p, f.fCnt);
+    }
+    *p++ = ',';
+    if (rec.resultOnly || (rec.type == UD_STATUS) || (rec.type == UD_PV1))
+    {
+        p = uplinkFmtUint(p, rec.result);
+    }
+    if (rec.resultOnly)
+    {
+        static const char *const empty[] = {",,,,,,,,,\n", ",,,,,,,,\n", ",,\n", ",,,\n"};
+        const char *e = empty[rec.type];
+        return uplinkFmtStr(p, e, strlen(e));
+    }
+
+    switch (rec.type)
+    {
+    case UD_STATUS:
+        *p++ = ',';
+        p = uplinkFmtUint(p, rec.status.status);
+        *p++ = ',';
+        p = uplinkFmtUint(p, rec.status.faultcode);
+        *p++ = ',';
+        p = uplinkFmtFixed1(p, rec.status.energytoday);
+        *p++ = ',';
+        p = uplinkFmtFixed1(p, rec.status.energytotal);
+        *p++ = ',';
+        p = uplinkFmtFixed1(p, rec.status.totalworktime);
+        *p++ = ',';
+        p = uplinkFmtFixed1(p, rec.status.outputpower);
+        *p++ = ',';
+        p = uplinkFmtFixed1(p, rec.status.gridvoltage);
+        *p++ = ',';
+        p = uplinkFmtFixed1(p, rec.status.gridfrequency);
+        *p++ = ',';
+        break;
+    case UD_PV1:
+        *p++ = ',';
+        p = uplinkFmtFixed1(p, rec.pv1.pv1voltage);
+        *p++ = ',';
+        p = uplinkFmtFixed1(p, rec.pv1.pv1current);
+        *p++ = ',';
+        p = uplinkFmtFixed1(p, rec.pv1.pv1power);
+        *p++ = ',';
+        p = uplinkFmtFixed1(p, rec.pv1.tempinverter / 100.0);
+        *p++ = ',';
+        p = uplinkFmtFixed1(p, rec.pv1.tempipm / 100.0);
+        *p++ = ',';
+        p = uplinkFmtFixed1(p, rec.pv1.pv1energytoday);
+        *p++ = ',';
+        p = uplinkFmtFixed1(p, rec.pv1.pv1energytotal);
+        *p++ = ',';
+        break;
+    case UD_DATETIME:
+        *p++ = ',';
+        p = uplinkFmtUint(p, rec.unixtime);
+        *p++ = ',';
+        p = uplinkFmtUint(p, rec.rtcSource);
+        break;
+    case UD_LWCONFIG:
+        *p++ = ',';
+        p = uplinkFmtUint(p, rec.sleepInterval);
+        *p++ = ',';
+        p = uplinkFmtUint(p, rec.sleepIntervalLong);
+        *p++ = ',';
+        p = uplinkFmtUint(p, rec.lwStatInterval);
+        break;
+    default:
+        break;
+    }
+    if ((rec.seq >= 0) && ((rec.type == UD_STATUS) || (rec.type == UD_PV1)))
+    {
+        p = uplinkFmtUint(p, static_cast<uint32_t>(rec.seq));
+    }
+    *p++ = '\n';
+    return p;
+}
+
+// Append JSON member name
+static inline char *uplinkFmtKey(char *p, const char *key, bool &first)
+{
+    if (!first)
+    {
+        *p++ = ',';
+    }
+    first = false;
+    *p++ = '"';
+    p = uplinkFmtStr(p, key, strlen(key));
+    *p++ = '"';
+    *p++ = ':';
+    return p;
+}
+
+// Append JSON member with number formatted as string by toFixed(1)
+static inline char *uplinkFmtJsonFixed1(char *p, const char *key, double v, bool &first)
+{
+    p = uplinkFmtKey(p, key, first);
+    *p++ = '"';
+    p = uplinkFmtFixed1(p, v);
+    *p++ = '"';
+    return p;
+}
+
+// Append JSON member with unsigned integer
+static inline char *uplinkFmtJsonUint(char *p, const char *key, uint32_t v, bool &first)
+{
+    p = uplinkFmtKey(p, key, first);
+    return uplinkFmtUint(p, v);
+}
+
+/*!
+ * \brief Format decoded uplink as JSON object
+ *
+ * Member names, order and value types are identical to the output of
+ * decoder() in scripts/uplink_formatter.js, so both can be compared directly.
+ *
+ * \param p   output (at least UD_LINE_MAX characters)
+ * \param rec decoded uplink
+ *
+ * \returns end of output
+ */
+static inline char *uplinkFormatJson(char *p, const UplinkRecord &rec)
+{
+    bool first = true;
+    *p++ = '{';
+    if (rec.resultOnly || (rec.type == UD_STATUS) || (rec.type == UD_PV1))
+    {
+        const char *text = uplinkModbusText(rec.result);
+        p = uplinkFmtKey(p, "modbus", first);
+        p = uplinkFmtStr(p, "{\"code\":", 8);
+        p = uplinkFmtUint(p, rec.result);
+        if (text)
+        {
+            p = uplinkFmtStr(p, ",\"text\":\"", 9);
+            p = uplinkFmtStr(p, text, strlen(text));
+            *p++ = '"';
+        }
+        *p++ = '}';
+    }
+    if (rec.resultOnly)
+    {
+        *p++ = '}';
+        return p;
+    }
+
+    switch (rec.type)
+    {
+    case UD_STATUS:
+        p = uplinkFmtJsonUint(p, "status", rec.status.status, first);
+        p = uplinkFmtJsonUint(p, "faultcode", rec.status.faultcode, first);
+        p = uplinkFmtJsonFixed1(p, "energytoday", rec.status.energytoday, first);
+        p = uplinkFmtJsonFixed1(p, "energytotal", rec.status.energytotal, first);
+        p = uplinkFmtJsonFixed1(p, "totalworktime", rec.status.totalworktime, first);
+        p = uplinkFmtJsonFixed1(p, "outputpower", rec.status.outputpower, first);
+        p = uplinkFmtJsonFixed1(p, "gridvoltage", rec.status.gridvoltage, first);
+        p = uplinkFmtJsonFixed1(p, "gridfrequency", rec.status.gridfrequency, first);
+        break;
+    case UD_PV1:
+        p = uplinkFmtJsonFixed1(p, "pv1voltage", rec.pv1.pv1voltage, first);
+        p = uplinkFmtJsonFixed1(p, "pv1current", rec.pv1.pv1current, first);
+        p = uplinkFmtJsonFixed1(p, "pv1power", rec.pv1.pv1power, first);
+        p = uplinkFmtJsonFixed1(p, "tempinverter", rec.pv1.tempinverter / 100.0, first);
+        p = uplinkFmtJsonFixed1(p, "tempipm", rec.pv1.tempipm / 100.0, first);
+        p = uplinkFmtJsonFixed1(p, "pv1energytoday", rec.pv1.pv1energytoday, first);
+        p = uplinkFmtJsonFixed1(p, "pv1energytotal", rec.pv1.pv1energytotal, first);
+        break;
+    case UD_DATETIME:
+    {
+        const char *text = uplinkRtcSourceText(rec.rtcSource);
+        p = uplinkFmtJsonUint(p, "unixtime", rec.unixtime, first);
+        if (text)
+        {
+            p = uplinkFmtKey(p, "rtc_source", first);
+            *p++ = '"';
+            p = uplinkFmtStr(p, text, strlen(text));
+            *p++ = '"';
+        }
+        break;
+    }
+    case UD_LWCONFIG:
+        p = uplinkFmtJsonUint(p, "sleep_interval", rec.sleepInterval, first);
+        p = uplinkFmtJsonUint(p, "sleep_interval_long", rec.sleepIntervalLong, first);
+        p = uplinkFmtJsonUint(p, "lw_status_interval", rec.lwStatInterval, first);
+        break;
+    default:
+        break;
+    }
+    if ((rec.seq >= 0) && ((rec.type == UD_STATUS) || (rec.type == UD_PV1)))
+    {
+        p = uplinkFmtJsonUint(p, "seq", static_cast<uint32_t>(rec.seq), first);
+    }
+    *p++ = '}';
+    return p;
+}
+#endif // _UPLINKDECODER_H
@@ -0,0 +1,131 @@
+///////////////////////////////////////////////////////////////////////////////
+// crosscheck.js
+//
+// Cross-check of the C++ uplink decoder against the JavaScript decoders
+//
+// Decodes every frame of the JSON lines written by "uplink_decode -f jsonl"
+// with scripts/uplink_formatter.js and scripts/datacake_decoder.js and
+// compares the results. Frames rejected by the C++ decoder must make the
+// JavaScript decoder throw.
+//
+// Usage: uplink_decode -f jsonl <input> | node crosscheck.js
+//        node crosscheck.js <decoded.jsonl>
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+'use strict';
+
+const fs = require('fs');
+const path = require('path');
+const readline = require('readline');
+const vm = require('vm');
+
+// Load decoder function from script (the scripts do not export it)
+function load(file, name) {
+    const ctx = {};
+    const src = fs.readFileSync(path.join(__dirname, '..', '..', 'scripts', file), 'utf8');
+    vm.runInNewContext(src + '; this.decoder = ' + name + ';', ctx);
+    return ctx.decoder;
+}
+
+const uplinkFormatter = load('uplink_formatter.js', 'decoder');
+const datacakeDecoder = load('datacake_decoder.js', 'Decoder');
+
+function hexToBytes(hex) {
+    const bytes = [];
+    for (let i = 0; i < hex.length; i += 2) {
+        bytes.push(parseInt(hex.substr(i, 2), 16));
+    }
+    return bytes;
+}
+
+// Run decoder, returns JSON string or null if the decoder throws
+function run(decoder, bytes, port) {
+    try {
+        return JSON.stringify(decoder(bytes, port));
+    } catch (e) {
+        return null;
+    }
+}
+
+let frames = 0;
+let mismatches = 0;
+let datacakeFrames = 0;
+
+function mismatch(what, frame, expected, actual) {
+    mismatches++;
+    if (mismatches <= 20) {
+        console.error(what + ' mismatch: port ' + frame.port + ', bytes ' + frame.bytes);
+        console.error('  JavaScript: ' + expected);
+        console.error('  C++:        ' + actual);
+    }
+}
+
+const rl = readline.createInterface({
+    input: process.argv[2] ? fs.createReadStream(process.argv[2]) : process.stdin,
+    crlfDelay: Infinity
+});
+
+rl.on('line', function (line) {
+    if (!line) {
+        return;
+    }
+    const frame = JSON.parse(line);
+    const bytes = hexToBytes(frame.bytes);
+    const actual = frame.error ? null : JSON.stringify(frame.decoded);
+    frames++;
+
+    const expected = run(uplinkFormatter, bytes, frame.port);
+    if (expected !== actual) {
+        mismatch('uplink_formatter.js', frame, expected, actual);
+    }
+
+    // datacake_decoder.js: ports 1 and 2 without sequence number
+    if (!frame.error && ((bytes.length === 1) || (frame.port === 1) || (frame.port === 2))) {
+        const decoded = Object.assign({}, frame.decoded);
+        delete decoded.seq;
+        const dc = run(datacakeDecoder, bytes, frame.port);
+        datacakeFrames++;
+        if (dc !== JSON.stringify(decoded)) {
+            mismatch('datacake_decoder.js', frame, dc, JSON.stringify(decoded));
+        }
+    }
+});
+
+rl.on('close', function () {
+    console.log('frames: ' + frames + ' (datacake: ' + datacakeFrames + '), mismatches: ' + mismatches);
+    process.exit(mismatches ? 1 : 0);
+});
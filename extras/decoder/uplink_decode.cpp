@@ -0,0 +1,590 @@
+///////////////////////////////////////////////////////////////////////////////
+// uplink_decode.cpp
+//
+// High-throughput decoder for uplink history (see UplinkDecoder.h)
+//
+// Streams JSON lines (e.g. The Things Stack storage integration export) and
+// writes one CSV file per uplink type (columnar, for import into pandas,
+// DuckDB, Arrow/Parquet converters etc.):
+//   <prefix>port1.csv, <prefix>port2.csv, <prefix>datetime.csv, <prefix>lwconfig.csv
+//
+// -f jsonl writes the decoded frames as JSON lines to stdout instead
+// (input for the cross-check against the JavaScript decoders, crosscheck.js).
+// -b <iterations> decodes the input from memory without writing (benchmark).
+// -g <frames> generates test data in The Things Stack format to stdout.
+//
+// Build: g++ -std=c++11 -O2 -Wall -I../../src -o uplink_decode uplink_decode.cpp
+//
+// Usage: uplink_decode [-f csv|jsonl] [-o <prefix>] [-b <iterations>] [<input>]
+//        uplink_decode -g <frames> [-s <seed>]
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "UplinkDecoder.h"
+#include "../host/LoraEncoderHost.h"
+
+// Input chunk size
+#define CHUNK_SIZE (4 * 1024 * 1024)
+
+// Output buffer size (per file)
+#define OUT_BUF_SIZE (1024 * 1024)
+
+// Time source reported in generated date/time responses (E_TIME_SOURCE::E_LORA)
+#define TIME_SOURCE_LORA 2
+
+/*!
+ * \brief Buffered output file
+ */
+struct OutFile
+{
+    FILE *f = nullptr;
+    char *buf = nullptr;
+    size_t n = 0;
+
+    // Make room for one more line
+    char *reserve(void)
+    {
+        if (n > OUT_BUF_SIZE - UD_LINE_MAX)
+        {
+            flush();
+        }
+        return &buf[n];
+    }
+
+    void commit(const char *end)
+    {
+        n = end - buf;
+    }
+
+    void flush(void)
+    {
+        if (f && n)
+        {
+            fwrite(buf, 1, n, f);
+        }
+        n = 0;
+    }
+};
+
+/*!
+ * \brief Decoder statistics
+ */
+struct Stats
+{
+    uint64_t lines = 0;                //!< input lines
+    uint64_t bytes = 0;                //!< input bytes
+    uint64_t frames[UD_NUM_TYPES] = {}; //!< decoded frames per type
+    uint64_t resultOnly = 0;           //!< frames with Modbus result only
+    uint64_t skipped = 0;              //!< ports not handled
+    uint64_t invalid = 0;              //!< no uplink / invalid payload
+    uint64_t errors = 0;               //!< payload too short
+
+    uint64_t decoded(void) const
+    {
+        uint64_t n = 0;
+        for (int i = 0; i < UD_NUM_TYPES; i++)
+        {
+            n += frames[i];
+        }
+        return n;
+    }
+};
+
+enum OutFormat
+{
+    FMT_CSV,   //!< one CSV file per uplink type
+    FMT_JSONL, //!< JSON line per frame (for crosscheck.js)
+    FMT_NONE   //!< no output (benchmark)
+};
+
+static const char *const csvNames[UD_NUM_TYPES] = {"port1.csv", "port2.csv", "datetime.csv", "lwconfig.csv"};
+
+// Write hex string
+static char *fmtHex(char *p, const uint8_t *buf, size_t len)
+{
+    static const char hex[] = "0123456789abcdef";
+    for (size_t i = 0; i < len; i++)
+    {
+        *p++ = hex[buf[i] >> 4];
+        *p++ = hex[buf[i] & 0xF];
+    }
+    return p;
+}
+
+/*!
+ * \brief Process one line
+ */
+static void processLine(const char *line, const char *end, OutFormat fmt, OutFile *out, Stats &stats)
+{
+    UplinkFrame f;
+    UplinkRecord rec = UplinkRecord();
+
+    stats.lines++;
+    if (!uplinkParseLine(line, end, f))
+    {
+        stats.invalid++;
+        return;
+    }
+    bool ok = uplinkDecode(f.port, f.payload, f.len, rec);
+    if (rec.type == UD_OTHER)
+    {
+        stats.skipped++;
+        return;
+    }
+    if (ok)
+    {
+        stats.frames[rec.type]++;
+        stats.resultOnly += rec.resultOnly ? 1 : 0;
+    }
+    else
+    {
+        stats.errors++;
+    }
+
+    if (fmt == FMT_CSV)
+    {
+        if (ok)
+        {
+            OutFile &o = out[rec.type];
+            o.commit(uplinkFormatCsv(o.reserve(), f, rec));
+        }
+    }
+    else if (fmt == FMT_JSONL)
+    {
+        char *p = out[0].reserve();
+        p += sprintf(p, "{\"f_cnt\":%lld,\"port\":%u,\"bytes\":\"", static_cast<long long>(f.fCnt), f.port);
+        p = fmtHex(p, f.payload, f.len);
+        if (ok)
+        {
+            p = uplinkFmtStr(p, "\",\"decoded\":", 12);
+            p = uplinkFormatJson(p, rec);
+        }
+        else
+        {
+            p = uplinkFmtStr(p, "\",\"error\":true", 14);
+        }
+        *p++ = '}';
+        *p++ = '\n';
+        out[0].commit(p);
+    }
+}
+
+/*!
+ * \brief Process buffer with complete lines
+ *
+ * \returns number of bytes processed (up to the last line feed)
+ */
+static size_t processBuffer(const char *buf, size_t len, OutFormat fmt, OutFile *out, Stats &stats)
+{
+    const char *p = buf;
+    const char *end = buf + len;
+    while (p < end)
+    {
+        const char *nl = static_cast<const char *>(memchr(p, '\n', end - p));
+        if (!nl)
+        {
+            break;
+        }
+        if (nl > p)
+        {
+            processLine(p, nl, fmt, out, stats);
+        }
+        p = nl + 1;
+    }
+    stats.bytes += p - buf;
+    return p - buf;
+}
+
+// -----------------------------------------------------------------------------
+// Test data generator
+// -----------------------------------------------------------------------------
+
+// Encode base64
+static char *fmtBase64(char *p, const uint8_t *buf, size_t len)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t i = 0;
+    for (; i + 3 <= len; i += 3)
+    {
+        uint32_t v = (buf[i] << 16) | (buf[i + 1] << 8) | buf[i + 2];
+        *p++ = alphabet[v >> 18];
+        *p++ = alphabet[(v >> 12) & 0x3F];
+        *p++ = alphabet[(v >> 6) & 0x3F];
+        *p++ = alphabet[v & 0x3F];
+    }
+    if (i < len)
+    {
+        uint32_t v = buf[i] << 16;
+        if (i + 1 < len)
+        {
+            v |= buf[i + 1] << 8;
+        }
+        *p++ = alphabet[v >> 18];
+        *p++ = alphabet[(v >> 12) & 0x3F];
+        *p++ = (i + 1 < len) ? alphabet[(v >> 6) & 0x3F] : '=';
+        *p++ = '=';
+    }
+    return p;
+}
+
+// Random value in [0, max) with 0.1 resolution (as register * 0.1) or arbitrary
+static float rnd(float max)
+{
+    if (rand() % 4)
+    {
+        return static_cast<float>(rand() % static_cast<int>(max * 10)) * 0.1f;
+    }
+    return static_cast<float>(rand()) / RAND_MAX * max;
+}
+
+/*!
+ * \brief Generate uplinks in the format of The Things Stack storage integration
+ *
+ * A few devices send ports 1 and 2 in turns (with and without sequence number),
+ * with occasional Modbus errors, command responses, other ports and truncated
+ * payloads.
+ */
+static void generate(unsigned long n, uint32_t seed)
+{
+    static const uint8_t errors[] = {0xE0, 0xE2, 0xE3, 0x02, 0x05};
+    const unsigned nDevices = 4;
+    uint32_t fCnt[nDevices] = {};
+    uint16_t seq[nDevices] = {};
+    time_t t = 1717200000; // 2024-06-01
+    char line[2048];
+
+    srand(seed);
+    for (unsigned long i = 0; i < n; i++)
+    {
+        unsigned dev = i % nDevices;
+        uint8_t payload[64];
+        LoraEncoder encoder(payload);
+        uint8_t port = ((i / nDevices) % 2) ? 2 : 1;
+        int r = rand() % 100;
+
+        if (r < 3)
+        {
+            encoder.writeUint8(errors[rand() % sizeof(errors)]);
+        }
+        else if (r < 5)
+        {
+            port = UD_CMD_GET_DATETIME;
+            encodeDateTime(encoder, static_cast<uint32_t>(t), (rand() % 4) ? TIME_SOURCE_LORA : rand() % 6);
+        }
+        else if (r < 7)
+        {
+            port = UD_CMD_GET_LW_CONFIG;
+            encodeLwConfig(encoder, static_cast<uint16_t>(rand() % 65536), static_cast<uint16_t>(rand() % 65536),
+                           static_cast<uint8_t>(rand() % 256));
+        }
+        else if (r < 9)
+        {
+            // PV analytics - not handled
+            port = 3;
+            for (int j = 0; j < 11; j++)
+            {
+                encoder.writeUint8(static_cast<uint8_t>(rand()));
+            }
+        }
+        else
+        {
+            growatt_input_registers d;
+            memset(&d, 0, sizeof(d));
+            d.status = rand() % 4;
+            d.faultcode = (rand() % 20) ? 0 : rand() % 256;
+            d.energytoday = rnd(40);
+            d.energytotal = rnd(60000);
+            d.totalworktime = rnd(100000);
+            d.outputpower = rnd(6000);
+            d.gridvoltage = 200 + rnd(60);
+            d.gridfrequency = 49.5f + rnd(1);
+            d.pv1voltage = rnd(500);
+            d.pv1current = rnd(15);
+            d.pv1power = rnd(6000);
+            d.tempinverter = rnd(100) - 20;
+            d.tempipm = rnd(100) - 20;
+            d.pv1energytoday = rnd(40);
+            d.pv1energytotal = rnd(60000);
+            encoder.writeUint8((rand() % 50) ? 0 : errors[rand() % sizeof(errors)]);
+            if (port == 1)
+            {
+                encodeInverterStatus(encoder, d);
+            }
+            else
+            {
+                encodeInverterPv1(encoder, d);
+            }
+            // Older firmware without sequence number on device 3
+            if (dev != 3)
+            {
+                encoder.writeUint16(seq[dev]++);
+            }
+        }
+
+        // Truncated payload
+        size_t payloadLen = encoder.getLength();
+        if ((rand() % 200 == 0) && (payloadLen > 2))
+        {
+            payloadLen = 2 + rand() % (payloadLen - 2);
+        }
+
+        char received[40];
+        struct tm tm;
+        gmtime_r(&t, &tm);
+        size_t len = strftime(received, sizeof(received), "%Y-%m-%dT%H:%M:%S", &tm);
+        sprintf(&received[len], ".%09uZ", static_cast<unsigned>(rand() % 1000000000));
+
+        char *p = line;
+        p += sprintf(p, "{\"end_device_ids\":{\"device_id\":\"growatt-%02u\",\"application_ids\":"
+                        "{\"application_id\":\"growatt2lorawan\"},\"dev_eui\":\"70B3D57ED00000%02X\"},"
+                        "\"received_at\":\"%s\",\"uplink_message\":{\"f_port\":%u,\"f_cnt\":%u,\"frm_payload\":\"",
+                     dev + 1, dev + 1, received, port, fCnt[dev]++);
+        p = fmtBase64(p, payload, payloadLen);
+        p += sprintf(p, "\",\"rx_metadata\":[{\"gateway_ids\":{\"gateway_id\":\"gw-01\"},\"rssi\":%d,\"snr\":%.1f}],"
+                        "\"received_at\":\"%s\"}}\n",
+                     -60 - rand() % 60, (rand() % 200 - 100) / 10.0, received);
+        fwrite(line, 1, p - line, stdout);
+
+        if (dev == nDevices - 1)
+        {
+            t += 150;
+        }
+    }
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: uplink_decode [-f csv|jsonl] [-o <prefix>] [-b <iterations>] [<input>]\n"
+                    "       uplink_decode -g <frames> [-s <seed>]\n");
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    OutFormat fmt = FMT_CSV;
+    const char *prefix = "";
+    unsigned long iterations = 0;
+    unsigned long genFrames = 0;
+    uint32_t seed = 1;
+    int arg = 1;
+
+    for (; arg + 1 < argc; arg += 2)
+    {
+        const char *val = argv[arg + 1];
+        if (strcmp(argv[arg], "-f") == 0)
+        {
+            if (strcmp(val, "csv") == 0)
+                fmt = FMT_CSV;
+            else if (strcmp(val, "jsonl") == 0)
+                fmt = FMT_JSONL;
+            else
+                usage();
+        }
+        else if (strcmp(argv[arg], "-o") == 0)
+            prefix = val;
+        else if (strcmp(argv[arg], "-b") == 0)
+            iterations = strtoul(val, nullptr, 10);
+        else if (strcmp(argv[arg], "-g") == 0)
+            genFrames = strtoul(val, nullptr, 10);
+        else if (strcmp(argv[arg], "-s") == 0)
+            seed = static_cast<uint32_t>(strtoul(val, nullptr, 10));
+        else
+            break;
+    }
+    if (genFrames)
+    {
+        if (arg != argc)
+        {
+            usage();
+        }
+        generate(genFrames, seed);
+        return 0;
+    }
+    if (arg < argc - 1)
+    {
+        usage();
+    }
+
+    FILE *in = stdin;
+    if ((arg == argc - 1) && (strcmp(argv[arg], "-") != 0))
+    {
+        in = fopen(argv[arg], "rb");
+        if (!in)
+        {
+            fprintf(stderr, "Cannot open %s\n", argv[arg]);
+            return 1;
+        }
+    }
+
+    Stats stats;
+    std::chrono::duration<double> elapsed(0);
+
+    if (iterations)
+    {
+        // Benchmark: parse, decode and format from memory, without writing
+        std::vector<char> data;
+        std::vector<char> chunk(CHUNK_SIZE);
+        size_t n;
+        while ((n = fread(chunk.data(), 1, chunk.size(), in)) > 0)
+        {
+            data.insert(data.end(), chunk.begin(), chunk.begin() + n);
+        }
+        if (data.empty() || (data.back() != '\n'))
+        {
+            data.push_back('\n');
+        }
+
+        OutFile out[UD_NUM_TYPES];
+        std::vector<char> bufs(UD_NUM_TYPES * OUT_BUF_SIZE);
+        for (int i = 0; i < UD_NUM_TYPES; i++)
+        {
+            out[i].buf = &bufs[i * OUT_BUF_SIZE];
+        }
+        OutFormat benchFmt = (fmt == FMT_JSONL) ? FMT_JSONL : FMT_CSV;
+
+        for (unsigned long i = 0; i < iterations; i++)
+        {
+            Stats s;
+            auto t0 = std::chrono::steady_clock::now();
+            processBuffer(data.data(), data.size(), benchFmt, out, s);
+            elapsed += std::chrono::steady_clock::now() - t0;
+            stats = s;
+        }
+        elapsed /= static_cast<double>(iterations);
+    }
+    else
+    {
+        OutFile out[UD_NUM_TYPES];
+        std::vector<char> bufs(UD_NUM_TYPES * OUT_BUF_SIZE);
+        int nOut = (fmt == FMT_JSONL) ? 1 : UD_NUM_TYPES;
+        for (int i = 0; i < nOut; i++)
+        {
+            out[i].buf = &bufs[i * OUT_BUF_SIZE];
+            if (fmt == FMT_JSONL)
+            {
+                out[i].f = stdout;
+                continue;
+            }
+            std::string name = std::string(prefix) + csvNames[i];
+            out[i].f = fopen(name.c_str(), "wb");
+            if (!out[i].f)
+            {
+                fprintf(stderr, "Cannot create %s\n", name.c_str());
+                return 1;
+            }
+            fputs(uplinkCsvHeader(static_cast<UplinkType>(i)), out[i].f);
+        }
+
+        // Stream input in chunks; an incomplete line is carried over to the next chunk
+        std::vector<char> buf(CHUNK_SIZE);
+        size_t fill = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (;;)
+        {
+            size_t n = fread(&buf[fill], 1, buf.size() - fill, in);
+            fill += n;
+            if (n == 0)
+            {
+                if (fill)
+                {
+                    // Last line without line feed
+                    buf.resize(fill + 1);
+                    buf[fill++] = '\n';
+                    processBuffer(buf.data(), fill, fmt, out, stats);
+                }
+                break;
+            }
+            size_t done = processBuffer(buf.data(), fill, fmt, out, stats);
+            if ((done == 0) && (fill == buf.size()))
+            {
+                // Line longer than a chunk: skip it
+                char *nl;
+                do
+                {
+                    n = fread(buf.data(), 1, buf.size(), in);
+                    nl = static_cast<char *>(memchr(buf.data(), '\n', n));
+                } while (n && !nl);
+                fill = 0;
+                if (nl)
+                {
+                    fill = (buf.data() + n) - (nl + 1);
+                    memmove(buf.data(), nl + 1, fill);
+                }
+                stats.lines++;
+                stats.invalid++;
+                continue;
+            }
+            memmove(buf.data(), &buf[done], fill - done);
+            fill -= done;
+        }
+        for (int i = 0; i < nOut; i++)
+        {
+            out[i].flush();
+            if (out[i].f != stdout)
+            {
+                fclose(out[i].f);
+            }
+        }
+        elapsed = std::chrono::steady_clock::now() - t0;
+    }
+    if (in != stdin)
+    {
+        fclose(in);
+    }
+
+    double s = elapsed.count();
+    fprintf(stderr, "lines: %llu, status: %llu, pv1: %llu, datetime: %llu, lwconfig: %llu (result only: %llu)\n",
+            static_cast<unsigned long long>(stats.lines), static_cast<unsigned long long>(stats.frames[UD_STATUS]),
+            static_cast<unsigned long long>(stats.frames[UD_PV1]),
+            static_cast<unsigned long long>(stats.frames[UD_DATETIME]),
+            static_cast<unsigned long long>(stats.frames[UD_LWCONFIG]),
+            static_cast<unsigned long long>(stats.resultOnly));
+    fprintf(stderr, "skipped: %llu, invalid: %llu, errors: %llu\n", static_cast<unsigned long long>(stats.skipped),
+            static_cast<unsigned long long>(stats.invalid), static_cast<unsigned long long>(stats.errors));
+    if (s > 0)
+    {
+        fprintf(stderr, "%s%.3f s, %.2f Mframes/s, %.1f MB/s\n", iterations ? "per iteration: " : "", s,
+                stats.lines / s / 1e6, stats.bytes / s / 1e6);
+    }
+    return 0;
+}
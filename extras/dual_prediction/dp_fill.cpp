@@ -0,0 +1,128 @@
+///////////////////////////////////////////////////////////////////////////////
+// dp_fill.cpp
+//
+// Host tool for dual-prediction reporting - reconstructs the complete
+// time series from the reports received on port 5, using the same
+// predictor as the node (src/DualPredictor.h)
+//
+// Input (stdin): one report per line, as decoded by uplink_formatter.js
+//   <dp_t0> <outputpower> <dp_trend> <dp_energy>
+// Lines starting with '#' are ignored. Reports must be sorted by time.
+//
+// Output (stdout): CSV
+//   time,outputpower,energytotal,source
+//   (outputpower in W, energytotal in kWh, source: report/prediction)
+//
+// Build:
+//   g++ -std=c++11 -O2 -Wall -I../../src -o dp_fill dp_fill.cpp
+//
+// Usage:
+//   ./dp_fill [interval_in_seconds] < reports.txt > series.csv
+//   (default interval: 360 s, i.e. SLEEP_INTERVAL)
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "DualPredictor.h"
+
+static void printRow(uint32_t t, uint16_t power, uint32_t energy, const char *source)
+{
+    printf("%u,%u,%.3f,%s\n", t, power, energy / 1000.0, source);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t interval = (argc > 1) ? strtoul(argv[1], NULL, 0) : 360;
+    if (interval == 0)
+    {
+        fprintf(stderr, "Invalid interval\n");
+        return 1;
+    }
+
+    char line[256];
+    DpState prev = {0, 0, 0, 0};
+    bool valid = false;
+    unsigned lineNo = 0;
+
+    printf("time,outputpower,energytotal,source\n");
+    while (fgets(line, sizeof(line), stdin))
+    {
+        lineNo++;
+        if ((line[0] == '#') || (strspn(line, " \t\r\n") == strlen(line)))
+        {
+            continue;
+        }
+
+        unsigned long t0, power, energy;
+        long trend;
+        if (sscanf(line, "%lu %lu %ld %lu", &t0, &power, &trend, &energy) != 4)
+        {
+            fprintf(stderr, "Line %u: invalid format\n", lineNo);
+            continue;
+        }
+        DpState cur;
+        cur.t0 = static_cast<uint32_t>(t0);
+        cur.power = static_cast<uint16_t>(power);
+        cur.trend = static_cast<int16_t>(trend);
+        cur.energy = static_cast<uint32_t>(energy);
+
+        if (cur.t0 == 0)
+        {
+            // Clock not synchronized on the node - value is not usable for prediction
+            fprintf(stderr, "Line %u: report without timestamp skipped\n", lineNo);
+            valid = false;
+            continue;
+        }
+
+        // Fill the gap since the previous report with predicted values
+        if (valid && (cur.t0 > prev.t0))
+        {
+            for (uint32_t t = prev.t0 + interval; t + interval / 2 < cur.t0; t += interval)
+            {
+                uint16_t p;
+                uint32_t e;
+                dpPredict(prev, t, p, e);
+                printRow(t, p, e, "prediction");
+            }
+        }
+        printRow(cur.t0, cur.power, cur.energy, "report");
+        prev = cur;
+        valid = true;
+    }
+    return 0;
+}
@@ -0,0 +1,106 @@
+///////////////////////////////////////////////////////////////////////////////
+// LoraEncoderHost.h
+//
+// Host replacement for the subset of the lora-serialization library's
+// LoraEncoder used by the uplink payload layout (src/UplinkSchema.h)
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_LORAENCODERHOST_H)
+#define _LORAENCODERHOST_H
+
+#include <stdint.h>
+#include <string.h>
+
+/*!
+ * \brief Host implementation of the LoraEncoder subset used by the node
+ *
+ * Byte order and scaling are identical to the lora-serialization library:
+ * integers and raw floats little endian, temperatures as signed 16 bit
+ * value of temperature * 100 (truncated) in big endian.
+ */
+class LoraEncoder
+{
+public:
+    LoraEncoder(uint8_t *buffer) : _buffer(buffer), _start(buffer) {}
+
+    void writeUint8(uint8_t i)
+    {
+        *_buffer++ = i;
+    }
+
+    void writeUint16(uint16_t i)
+    {
+        writeInt(i, 2);
+    }
+
+    void writeUint32(uint32_t i)
+    {
+        writeInt(i, 4);
+    }
+
+    void writeRawFloat(float value)
+    {
+        uint32_t raw;
+        memcpy(&raw, &value, sizeof(raw));
+        writeInt(raw, 4);
+    }
+
+    void writeTemperature(float temperature)
+    {
+        int16_t t = static_cast<int16_t>(temperature * 100);
+        *_buffer++ = static_cast<uint16_t>(t) >> 8;
+        *_buffer++ = static_cast<uint16_t>(t) & 0xFF;
+    }
+
+    uint8_t getLength(void)
+    {
+        return static_cast<uint8_t>(_buffer - _start);
+    }
+
+private:
+    uint8_t *_buffer;
+    uint8_t *_start;
+
+    void writeInt(uint32_t i, int bytes)
+    {
+        for (int b = 0; b < bytes; b++)
+        {
+            *_buffer++ = (i >> (8 * b)) & 0xFF;
+        }
+    }
+};
+#endif // _LORAENCODERHOST_H
@@ -0,0 +1,427 @@
+///////////////////////////////////////////////////////////////////////////////
+// MicroBench.h
+//
+// Minimal microbenchmark harness for host tools
+//
+// Implements the subset of the Google Benchmark API used by
+// extras/bench/microbench.cpp (benchmark::State with range-for loop,
+// DoNotOptimize(), ClobberMemory(), BENCHMARK(), BENCHMARK_MAIN()) and writes
+// results in the Google Benchmark JSON format, so results can be compared
+// with the Google Benchmark tools (e.g. compare.py).
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_MICROBENCH_H)
+#define _MICROBENCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace benchmark
+{
+
+    /*!
+     * \brief Benchmark state
+     *
+     * Usage (as with Google Benchmark):
+     *
+     *   static void BM_Foo(benchmark::State &state)
+     *   {
+     *       for (auto _ : state)
+     *       {
+     *           benchmark::DoNotOptimize(foo());
+     *       }
+     *   }
+     *   BENCHMARK(BM_Foo);
+     */
+    class State
+    {
+    public:
+        explicit State(int64_t iterations) : _maxIterations(iterations) {}
+
+        // Loop variable - non-trivial to avoid unused variable warnings
+        struct Value
+        {
+            Value() {}
+            ~Value() {}
+        };
+
+        class Iterator
+        {
+        public:
+            Iterator(State *state, int64_t remaining) : _state(state), _remaining(remaining) {}
+            Value operator*() const { return Value(); }
+            Iterator &operator++()
+            {
+                _remaining--;
+                return *this;
+            }
+            bool operator!=(const Iterator &) const
+            {
+                if (_remaining > 0)
+                {
+                    return true;
+                }
+                _state->stopTimer();
+                return false;
+            }
+
+        private:
+            State *_state;
+            int64_t _remaining;
+        };
+
+        Iterator begin()
+        {
+            startTimer();
+            return Iterator(this, _maxIterations);
+        }
+
+        Iterator end()
+        {
+            return Iterator(this, 0);
+        }
+
+        int64_t iterations() const { return _maxIterations; }
+        void SetBytesProcessed(int64_t bytes) { _bytes = bytes; }
+        void SetItemsProcessed(int64_t items) { _items = items; }
+        void SetLabel(const std::string &label) { _label = label; }
+        void SkipWithError(const char *msg) { _error = msg; }
+
+        double realTime = 0; //!< [s]
+        double cpuTime = 0;  //!< [s]
+        int64_t _bytes = 0;
+        int64_t _items = 0;
+        std::string _label;
+        std::string _error;
+
+    private:
+        int64_t _maxIterations;
+        std::chrono::steady_clock::time_point _t0;
+        clock_t _c0 = 0;
+
+        void startTimer()
+        {
+            _c0 = clock();
+            _t0 = std::chrono::steady_clock::now();
+        }
+
+        void stopTimer()
+        {
+            realTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - _t0).count();
+            cpuTime = static_cast<double>(clock() - _c0) / CLOCKS_PER_SEC;
+        }
+    };
+
+    /// Prevent the compiler from optimizing away a value
+    template <class T>
+    inline void DoNotOptimize(T const &value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    /// Prevent the compiler from optimizing away memory writes
+    inline void ClobberMemory()
+    {
+        asm volatile("" : : : "memory");
+    }
+
+    namespace internal
+    {
+        typedef void (*Function)(State &);
+
+        struct Benchmark
+        {
+            const char *name;
+            Function fn;
+        };
+
+        inline std::vector<Benchmark> &registry()
+        {
+            static std::vector<Benchmark> benchmarks;
+            return benchmarks;
+        }
+
+        inline int registerBenchmark(const char *name, Function fn)
+        {
+            registry().push_back({name, fn});
+            return 0;
+        }
+
+        struct Result
+        {
+            std::string name;
+            int64_t iterations;
+            double realTime; //!< per iteration [ns]
+            double cpuTime;  //!< per iteration [ns]
+            double bytesPerSecond;
+            double itemsPerSecond;
+            std::string label;
+            std::string error;
+        };
+
+        // Run benchmark with increasing number of iterations until minTime is reached
+        inline Result run(const Benchmark &b, double minTime)
+        {
+            int64_t n = 1;
+            for (;;)
+            {
+                State state(n);
+                b.fn(state);
+                bool done = (state.realTime >= minTime) || (n >= 1000000000) || !state._error.empty();
+                if (done)
+                {
+                    Result r;
+                    r.name = b.name;
+                    r.iterations = n;
+                    r.realTime = 1e9 * state.realTime / n;
+                    r.cpuTime = 1e9 * state.cpuTime / n;
+                    r.bytesPerSecond = (state._bytes && state.realTime > 0) ? state._bytes / state.realTime : 0;
+                    r.itemsPerSecond = (state._items && state.realTime > 0) ? state._items / state.realTime : 0;
+                    r.label = state._label;
+                    r.error = state._error;
+                    return r;
+                }
+                // Estimate required iterations (like Google Benchmark: at most 10x per step)
+                double mult = (state.realTime > 0) ? 1.4 * minTime / state.realTime : 10;
+                mult = (mult > 10) ? 10 : ((mult < 2) ? 2 : mult);
+                n = static_cast<int64_t>(n * mult);
+            }
+        }
+
+        inline std::string jsonEscape(const std::string &s)
+        {
+            std::string out;
+            for (char c : s)
+            {
+                if ((c == '"') || (c == '\\'))
+                {
+                    out += '\\';
+                }
+                out += c;
+            }
+            return out;
+        }
+
+        // Write results in the JSON format of Google Benchmark (--benchmark_format=json)
+        inline void writeJson(FILE *f, const char *executable, const std::vector<Result> &results)
+        {
+            char date[32];
+            char host[64] = "";
+            time_t now = time(nullptr);
+            strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", localtime(&now));
+            gethostname(host, sizeof(host) - 1);
+
+            fprintf(f, "{\n  \"context\": {\n");
+            fprintf(f, "    \"date\": \"%s\",\n", date);
+            fprintf(f, "    \"host_name\": \"%s\",\n", jsonEscape(host).c_str());
+            fprintf(f, "    \"executable\": \"%s\",\n", jsonEscape(executable).c_str());
+            fprintf(f, "    \"num_cpus\": %ld,\n", sysconf(_SC_NPROCESSORS_ONLN));
+#if defined(NDEBUG)
+            fprintf(f, "    \"library_build_type\": \"release\"\n");
+#else
+            fprintf(f, "    \"library_build_type\": \"debug\"\n");
+#endif
+            fprintf(f, "  },\n  \"benchmarks\": [\n");
+            for (size_t i = 0; i < results.size(); i++)
+            {
+                const Result &r = results[i];
+                fprintf(f, "    {\n");
+                fprintf(f, "      \"name\": \"%s\",\n", jsonEscape(r.name).c_str());
+                fprintf(f, "      \"run_name\": \"%s\",\n", jsonEscape(r.name).c_str());
+                fprintf(f, "      \"run_type\": \"iteration\",\n");
+                fprintf(f, "      \"repetitions\": 1,\n");
+                fprintf(f, "      \"repetition_index\": 0,\n");
+                fprintf(f, "      \"threads\": 1,\n");
+                if (!r.error.empty())
+                {
+                    fprintf(f, "      \"error_occurred\": true,\n");
+                    fprintf(f, "      \"error_message\": \"%s\",\n", jsonEscape(r.error).c_str());
+                }
+                fprintf(f, "      \"iterations\": %lld,\n", static_cast<long long>(r.iterations));
+                fprintf(f, "      \"real_time\": %.4e,\n", r.realTime);
+                fprintf(f, "      \"cpu_time\": %.4e,\n", r.cpuTime);
+                if (r.bytesPerSecond > 0)
+                {
+                    fprintf(f, "      \"bytes_per_second\": %.4e,\n", r.bytesPerSecond);
+                }
+                if (r.itemsPerSecond > 0)
+                {
+                    fprintf(f, "      \"items_per_second\": %.4e,\n", r.itemsPerSecond);
+                }
+                if (!r.label.empty())
+                {
+                    fprintf(f, "      \"label\": \"%s\",\n", jsonEscape(r.label).c_str());
+                }
+                fprintf(f, "      \"time_unit\": \"ns\"\n");
+                fprintf(f, "    }%s\n", (i + 1 < results.size()) ? "," : "");
+            }
+            fprintf(f, "  ]\n}\n");
+        }
+
+        /*!
+         * \brief Run all registered benchmarks
+         *
+         * Options (subset of Google Benchmark):
+         *   --benchmark_filter=<substring>
+         *   --benchmark_min_time=<seconds>
+         *   --benchmark_format=console|json
+         *   --benchmark_out=<file> (JSON)
+         *   --benchmark_list_tests
+         */
+        inline int main(int argc, char **argv)
+        {
+            std::string filter;
+            double minTime = 0.5;
+            bool json = false;
+            bool list = false;
+            const char *outFile = nullptr;
+
+            for (int i = 1; i < argc; i++)
+            {
+                const char *a = argv[i];
+                if (strncmp(a, "--benchmark_filter=", 19) == 0)
+                {
+                    filter = a + 19;
+                }
+                else if (strncmp(a, "--benchmark_min_time=", 21) == 0)
+                {
+                    minTime = atof(a + 21);
+                }
+                else if (strcmp(a, "--benchmark_format=json") == 0)
+                {
+                    json = true;
+                }
+                else if (strcmp(a, "--benchmark_format=console") == 0)
+                {
+                    json = false;
+                }
+                else if (strncmp(a, "--benchmark_out=", 16) == 0)
+                {
+                    outFile = a + 16;
+                }
+                else if (strcmp(a, "--benchmark_list_tests") == 0)
+                {
+                    list = true;
+                }
+                else
+                {
+                    fprintf(stderr, "Unknown option: %s\n", a);
+                    return 1;
+                }
+            }
+
+            std::vector<Result> results;
+            if (!json && !list)
+            {
+                printf("%-40s %14s %14s %12s\n", "Benchmark", "Time [ns]", "CPU [ns]", "Iterations");
+            }
+            for (const Benchmark &b : registry())
+            {
+                if (!filter.empty() && (strstr(b.name, filter.c_str()) == nullptr))
+                {
+                    continue;
+                }
+                if (list)
+                {
+                    printf("%s\n", b.name);
+                    continue;
+                }
+                Result r = run(b, minTime);
+                results.push_back(r);
+                if (!json)
+                {
+                    if (!r.error.empty())
+                    {
+                        printf("%-40s ERROR: %s\n", r.name.c_str(), r.error.c_str());
+                        continue;
+                    }
+                    printf("%-40s %14.1f %14.1f %12lld", r.name.c_str(), r.realTime, r.cpuTime,
+                           static_cast<long long>(r.iterations));
+                    if (r.bytesPerSecond > 0)
+                    {
+                        printf(" %.1f MB/s", r.bytesPerSecond / 1e6);
+                    }
+                    if (r.itemsPerSecond > 0)
+                    {
+                        printf(" %.3g items/s", r.itemsPerSecond);
+                    }
+                    if (!r.label.empty())
+                    {
+                        printf(" %s", r.label.c_str());
+                    }
+                    printf("\n");
+                }
+            }
+            if (json)
+            {
+                writeJson(stdout, argv[0], results);
+            }
+            if (outFile)
+            {
+                FILE *f = fopen(outFile, "w");
+                if (!f)
+                {
+                    perror(outFile);
+                    return 1;
+                }
+                writeJson(f, argv[0], results);
+                fclose(f);
+            }
+            return 0;
+        }
+    } // namespace internal
+} // namespace benchmark
+
+#define MICROBENCH_CONCAT2(a, b) a##b
+#define MICROBENCH_CONCAT(a, b) MICROBENCH_CONCAT2(a, b)
+
+/// Register benchmark function
+#define BENCHMARK(fn) \
+    static int MICROBENCH_CONCAT(_microbench_, __LINE__) = benchmark::internal::registerBenchmark(#fn, fn)
+
+/// Benchmark main function
+#define BENCHMARK_MAIN() \
+    int main(int argc, char **argv) { return benchmark::internal::main(argc, argv); }
+
+#endif // _MICROBENCH_H
@@ -0,0 +1,579 @@
+///////////////////////////////////////////////////////////////////////////////
+// Gwmp.h
+//
+// Semtech UDP packet forwarder protocol (GWMP, protocol version 2) -
+// packet framing, rxpk/txpk JSON and base64 helpers, LoRa time on air
+// and scripted packet loss
+//
+// Shared by the local network server stub (lns_stub.cpp) and the virtual
+// radio (VirtualRadio.h); the same protocol is spoken by ChirpStack's
+// gateway bridge and the Semtech packet forwarder.
+//
+// See https://github.com/Lora-net/packet_forwarder/blob/master/PROTOCOL.TXT
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_GWMP_H)
+#define _GWMP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/// Protocol version
+#define GWMP_VERSION 2
+
+// Packet types
+#define GWMP_PUSH_DATA 0x00 //!< gateway -> server: rxpk / stat
+#define GWMP_PUSH_ACK 0x01  //!< server -> gateway
+#define GWMP_PULL_DATA 0x02 //!< gateway -> server: keep-alive, opens downlink path
+#define GWMP_PULL_RESP 0x03 //!< server -> gateway: txpk
+#define GWMP_PULL_ACK 0x04  //!< server -> gateway
+#define GWMP_TX_ACK 0x05    //!< gateway -> server: txpk_ack
+
+/// Header size: version, token (2), type
+#define GWMP_HDR_SIZE 4
+
+/// Header size incl. gateway EUI (PUSH_DATA, PULL_DATA, TX_ACK)
+#define GWMP_HDR_EUI_SIZE 12
+
+/// Maximum UDP datagram size
+#define GWMP_BUF_SIZE 2048
+
+/// Default server port
+#define GWMP_PORT 1700
+
+/// Maximum LoRa PHY payload size
+#define GWMP_PHY_MAX 255
+
+/*!
+ * \brief Radio packet (rxpk / txpk)
+ */
+struct GwmpPacket
+{
+    uint32_t tmst;                  //!< concentrator time [us]; uplink: end of reception, downlink: start of transmission
+    bool imme;                      //!< downlink: transmit immediately
+    float freq;                     //!< frequency [MHz]
+    uint8_t sf;                     //!< spreading factor
+    uint16_t bw;                    //!< bandwidth [kHz]
+    bool ipol;                      //!< inverted polarity (downlink)
+    float rssi;                     //!< RSSI [dBm] (uplink)
+    float lsnr;                     //!< SNR [dB] (uplink)
+    size_t size;                    //!< PHY payload size
+    uint8_t data[GWMP_PHY_MAX];     //!< PHY payload
+};
+
+/*!
+ * \brief Encode base64
+ *
+ * \param in  input data
+ * \param len input length
+ * \param out output string (4 * ((len + 2) / 3) + 1 characters)
+ *
+ * \returns length of output string
+ */
+static inline size_t gwmpBase64Encode(const uint8_t *in, size_t len, char *out)
+{
+    static const char tab[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t n = 0;
+
+    for (size_t i = 0; i < len; i += 3)
+    {
+        uint32_t v = static_cast<uint32_t>(in[i]) << 16;
+        if (i + 1 < len)
+        {
+            v |= static_cast<uint32_t>(in[i + 1]) << 8;
+        }
+        if (i + 2 < len)
+        {
+            v |= in[i + 2];
+        }
+        out[n++] = tab[(v >> 18) & 0x3F];
+        out[n++] = tab[(v >> 12) & 0x3F];
+        out[n++] = (i + 1 < len) ? tab[(v >> 6) & 0x3F] : '=';
+        out[n++] = (i + 2 < len) ? tab[v & 0x3F] : '=';
+    }
+    out[n] = '\0';
+    return n;
+}
+
+/*!
+ * \brief Decode base64
+ *
+ * Decoding stops at the first character which is neither part of the
+ * alphabet nor padding.
+ *
+ * \param in     input string
+ * \param out    output data
+ * \param maxLen capacity of out
+ *
+ * \returns number of bytes decoded, or -1 if out is too small
+ */
+static inline int gwmpBase64Decode(const char *in, uint8_t *out, size_t maxLen)
+{
+    uint32_t v = 0;
+    int bits = 0;
+    size_t n = 0;
+
+    for (; *in; in++)
+    {
+        char c = *in;
+        int d;
+        if ((c >= 'A') && (c <= 'Z'))
+            d = c - 'A';
+        else if ((c >= 'a') && (c <= 'z'))
+            d = c - 'a' + 26;
+        else if ((c >= '0') && (c <= '9'))
+            d = c - '0' + 52;
+        else if (c == '+')
+            d = 62;
+        else if (c == '/')
+            d = 63;
+        else
+            break;
+
+        v = (v << 6) | static_cast<uint32_t>(d);
+        bits += 6;
+        if (bits >= 8)
+        {
+            bits -= 8;
+            if (n >= maxLen)
+            {
+                return -1;
+            }
+            out[n++] = static_cast<uint8_t>(v >> bits);
+        }
+    }
+    return static_cast<int>(n);
+}
+
+/*!
+ * \brief Find value of JSON member
+ *
+ * Minimal lookup for the flat objects used by the packet forwarder protocol -
+ * the first occurrence of "key" followed by a colon is used.
+ *
+ * \param json JSON text
+ * \param end  end of JSON text
+ * \param key  member name
+ *
+ * \returns pointer to first character of value, or nullptr if not found
+ */
+static inline const char *gwmpJsonFind(const char *json, const char *end, const char *key)
+{
+    size_t keyLen = strlen(key);
+
+    for (const char *p = json; p + keyLen + 2 < end; p++)
+    {
+        if ((p[0] != '"') || (strncmp(p + 1, key, keyLen) != 0) || (p[keyLen + 1] != '"'))
+        {
+            continue;
+        }
+        const char *v = p + keyLen + 2;
+        while ((v < end) && ((*v == ' ') || (*v == '\t')))
+        {
+            v++;
+        }
+        if ((v < end) && (*v == ':'))
+        {
+            v++;
+            while ((v < end) && ((*v == ' ') || (*v == '\t')))
+            {
+                v++;
+            }
+            return v;
+        }
+    }
+    return nullptr;
+}
+
+/*!
+ * \brief Get numeric JSON member
+ *
+ * \param json JSON text
+ * \param end  end of JSON text
+ * \param key  member name
+ * \param val  value
+ *
+ * \returns true if found
+ */
+static inline bool gwmpJsonNumber(const char *json, const char *end, const char *key, double &val)
+{
+    const char *v = gwmpJsonFind(json, end, key);
+    if (!v)
+    {
+        return false;
+    }
+    char *e;
+    val = strtod(v, &e);
+    return e != v;
+}
+
+/*!
+ * \brief Get boolean JSON member
+ *
+ * \param json JSON text
+ * \param end  end of JSON text
+ * \param key  member name
+ *
+ * \returns true if found and true
+ */
+static inline bool gwmpJsonTrue(const char *json, const char *end, const char *key)
+{
+    const char *v = gwmpJsonFind(json, end, key);
+    return v && (end - v >= 4) && (strncmp(v, "true", 4) == 0);
+}
+
+/*!
+ * \brief Get string JSON member (without escape sequences)
+ *
+ * \param json   JSON text
+ * \param end    end of JSON text
+ * \param key    member name
+ * \param buf    value
+ * \param bufLen capacity of buf
+ *
+ * \returns true if found and fits into buf
+ */
+static inline bool gwmpJsonString(const char *json, const char *end, const char *key, char *buf, size_t bufLen)
+{
+    const char *v = gwmpJsonFind(json, end, key);
+    if (!v || (*v != '"'))
+    {
+        return false;
+    }
+    v++;
+    size_t n = 0;
+    while ((v < end) && (*v != '"'))
+    {
+        if (n + 1 >= bufLen)
+        {
+            return false;
+        }
+        buf[n++] = *v++;
+    }
+    buf[n] = '\0';
+    return v < end;
+}
+
+/*!
+ * \brief Parse LoRa data rate identifier, e.g. "SF7BW125"
+ *
+ * \param datr data rate string
+ * \param sf   spreading factor
+ * \param bw   bandwidth [kHz]
+ *
+ * \returns true if valid
+ */
+static inline bool gwmpParseDatr(const char *datr, uint8_t &sf, uint16_t &bw)
+{
+    unsigned s;
+    unsigned b;
+    if (sscanf(datr, "SF%uBW%u", &s, &b) != 2)
+    {
+        return false;
+    }
+    sf = static_cast<uint8_t>(s);
+    bw = static_cast<uint16_t>(b);
+    return (sf >= 5) && (sf <= 12);
+}
+
+/*!
+ * \brief Parse radio packet object (rxpk array element or txpk)
+ *
+ * \param json JSON object text
+ * \param end  end of JSON object text
+ * \param pkt  radio packet
+ *
+ * \returns true if valid LoRa packet
+ */
+static inline bool gwmpParsePacket(const char *json, const char *end, GwmpPacket &pkt)
+{
+    double v;
+    char buf[4 * ((GWMP_PHY_MAX + 2) / 3) + 1];
+
+    memset(&pkt, 0, sizeof(pkt));
+    pkt.imme = gwmpJsonTrue(json, end, "imme");
+    pkt.ipol = gwmpJsonTrue(json, end, "ipol");
+    if (gwmpJsonNumber(json, end, "tmst", v))
+    {
+        pkt.tmst = static_cast<uint32_t>(v);
+    }
+    else if (!pkt.imme)
+    {
+        return false;
+    }
+    if (!gwmpJsonNumber(json, end, "freq", v))
+    {
+        return false;
+    }
+    pkt.freq = static_cast<float>(v);
+    if (gwmpJsonNumber(json, end, "rssi", v))
+    {
+        pkt.rssi = static_cast<float>(v);
+    }
+    if (gwmpJsonNumber(json, end, "lsnr", v))
+    {
+        pkt.lsnr = static_cast<float>(v);
+    }
+    if (!gwmpJsonString(json, end, "datr", buf, sizeof(buf)) || !gwmpParseDatr(buf, pkt.sf, pkt.bw))
+    {
+        return false;
+    }
+    if (!gwmpJsonString(json, end, "data", buf, sizeof(buf)))
+    {
+        return false;
+    }
+    int n = gwmpBase64Decode(buf, pkt.data, sizeof(pkt.data));
+    if (n < 0)
+    {
+        return false;
+    }
+    pkt.size = static_cast<size_t>(n);
+    return true;
+}
+
+/*!
+ * \brief Iterate over objects in JSON array
+ *
+ * \param p   current position (start of array contents or end of previous object)
+ * \param end end of JSON text
+ * \param obj start of next object
+ *
+ * \returns end of next object (after closing brace), or nullptr at end of array
+ */
+static inline const char *gwmpJsonNextObject(const char *p, const char *end, const char *&obj)
+{
+    while ((p < end) && (*p != '{'))
+    {
+        if (*p == ']')
+        {
+            return nullptr;
+        }
+        p++;
+    }
+    if (p >= end)
+    {
+        return nullptr;
+    }
+    obj = p;
+    int depth = 0;
+    bool str = false;
+    for (; p < end; p++)
+    {
+        if (str)
+        {
+            if (*p == '\\')
+                p++;
+            else if (*p == '"')
+                str = false;
+        }
+        else if (*p == '"')
+            str = true;
+        else if (*p == '{')
+            depth++;
+        else if ((*p == '}') && (--depth == 0))
+            return p + 1;
+    }
+    return nullptr;
+}
+
+/*!
+ * \brief Write GWMP header
+ *
+ * \param buf   datagram buffer
+ * \param token random token
+ * \param type  packet type
+ * \param eui   gateway EUI (PUSH_DATA, PULL_DATA, TX_ACK) or nullptr
+ *
+ * \returns header size
+ */
+static inline size_t gwmpHeader(uint8_t *buf, uint16_t token, uint8_t type, const uint8_t *eui)
+{
+    buf[0] = GWMP_VERSION;
+    buf[1] = static_cast<uint8_t>(token >> 8);
+    buf[2] = static_cast<uint8_t>(token);
+    buf[3] = type;
+    if (!eui)
+    {
+        return GWMP_HDR_SIZE;
+    }
+    memcpy(&buf[GWMP_HDR_SIZE], eui, 8);
+    return GWMP_HDR_EUI_SIZE;
+}
+
+/*!
+ * \brief Format radio packet as rxpk (uplink) or txpk (downlink) object
+ *
+ * \param pkt    radio packet
+ * \param uplink true: rxpk / false: txpk
+ * \param out    output buffer
+ * \param outLen capacity of out
+ *
+ * \returns length of JSON text, or 0 if out is too small
+ */
+static inline size_t gwmpFormatPacket(const GwmpPacket &pkt, bool uplink, char *out, size_t outLen)
+{
+    char b64[4 * ((GWMP_PHY_MAX + 2) / 3) + 1];
+    int n;
+
+    gwmpBase64Encode(pkt.data, pkt.size, b64);
+    if (uplink)
+    {
+        n = snprintf(out, outLen,
+                     "{\"rxpk\":[{\"tmst\":%u,\"chan\":0,\"rfch\":0,\"freq\":%.6f,\"stat\":1,\"modu\":\"LORA\","
+                     "\"datr\":\"SF%uBW%u\",\"codr\":\"4/5\",\"rssi\":%.0f,\"lsnr\":%.1f,\"size\":%u,\"data\":\"%s\"}]}",
+                     pkt.tmst, pkt.freq, pkt.sf, pkt.bw, pkt.rssi, pkt.lsnr, static_cast<unsigned>(pkt.size), b64);
+    }
+    else
+    {
+        n = snprintf(out, outLen,
+                     "{\"txpk\":{\"imme\":%s,\"tmst\":%u,\"freq\":%.6f,\"rfch\":0,\"powe\":14,\"modu\":\"LORA\","
+                     "\"datr\":\"SF%uBW%u\",\"codr\":\"4/5\",\"ipol\":%s,\"size\":%u,\"ncrc\":true,\"data\":\"%s\"}}",
+                     pkt.imme ? "true" : "false", pkt.tmst, pkt.freq, pkt.sf, pkt.bw, pkt.ipol ? "true" : "false",
+                     static_cast<unsigned>(pkt.size), b64);
+    }
+    return ((n > 0) && (static_cast<size_t>(n) < outLen)) ? static_cast<size_t>(n) : 0;
+}
+
+/*!
+ * \brief LoRa time on air (Semtech AN1200.13), coding rate 4/5, explicit header
+ *
+ * \param sf  spreading factor
+ * \param bw  bandwidth [kHz]
+ * \param len PHY payload size
+ * \param crc payload CRC enabled (uplink) / disabled (downlink)
+ *
+ * \returns time on air [us]
+ */
+static inline uint32_t gwmpTimeOnAir(uint8_t sf, uint16_t bw, size_t len, bool crc)
+{
+    double tSym = static_cast<double>(1UL << sf) * 1000.0 / bw;
+    int de = (tSym > 16000.0) ? 1 : 0;
+    double num = 8.0 * len - 4.0 * sf + 28 + (crc ? 16 : 0);
+    double nPayload = 8 + fmax(ceil(num / (4.0 * (sf - 2 * de))) * 5, 0.0);
+    return static_cast<uint32_t>((8 + 4.25 + nPayload) * tSym);
+}
+
+/*!
+ * \brief Scripted packet loss
+ *
+ * A packet is dropped if its sequence number (counted from 1) is in the drop
+ * list, or randomly with the given probability. The pseudo-random sequence
+ * only depends on the seed, so a run can be reproduced exactly.
+ */
+class GwmpLoss
+{
+public:
+    GwmpLoss() : _percent(0), _state(1), _nDrop(0), _count(0) {}
+
+    /*!
+     * \brief Set random loss
+     *
+     * \param percent loss probability [%]
+     * \param seed    pseudo-random generator seed
+     */
+    void setRandom(unsigned percent, uint32_t seed)
+    {
+        _percent = percent;
+        _state = seed ? seed : 1;
+    }
+
+    /*!
+     * \brief Set drop list
+     *
+     * \param list comma separated sequence numbers, e.g. "1,2,5"
+     *
+     * \returns true if valid
+     */
+    bool setList(const char *list)
+    {
+        _nDrop = 0;
+        while (*list)
+        {
+            char *e;
+            unsigned long n = strtoul(list, &e, 10);
+            if ((e == list) || (_nDrop >= sizeof(_drop) / sizeof(_drop[0])))
+            {
+                return false;
+            }
+            _drop[_nDrop++] = static_cast<uint32_t>(n);
+            list = (*e == ',') ? e + 1 : e;
+        }
+        return true;
+    }
+
+    /*!
+     * \brief Decide on next packet
+     *
+     * \returns true if packet shall be dropped
+     */
+    bool drop(void)
+    {
+        _count++;
+        for (size_t i = 0; i < _nDrop; i++)
+        {
+            if (_drop[i] == _count)
+            {
+                return true;
+            }
+        }
+        // xorshift32
+        _state ^= _state << 13;
+        _state ^= _state >> 17;
+        _state ^= _state << 5;
+        return (_percent > 0) && ((_state % 100) < _percent);
+    }
+
+    /*!
+     * \brief Get number of packets seen
+     */
+    uint32_t count(void) const
+    {
+        return _count;
+    }
+
+private:
+    unsigned _percent;   //!< random loss probability [%]
+    uint32_t _state;     //!< pseudo-random generator state
+    uint32_t _drop[32];  //!< drop list
+    size_t _nDrop;       //!< number of entries in drop list
+    uint32_t _count;     //!< number of packets seen
+};
+#endif // _GWMP_H
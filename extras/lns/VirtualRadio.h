@@ -0,0 +1,708 @@
+///////////////////////////////////////////////////////////////////////////////
+// VirtualRadio.h
+//
+// Virtual LoRa radio for end-to-end tests of the LoRaWAN stack on the host -
+// RadioLib PhysicalLayer and HAL implementation which forwards up- and
+// downlinks to a network server via the Semtech UDP packet forwarder
+// protocol (Gwmp.h)
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//          Ported to the RadioLib 6.6 interface (version pinned in package.json)
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_VIRTUALRADIO_H)
+#define _VIRTUALRADIO_H
+
+#include <RadioLib.h>
+
+// The PhysicalLayer and HAL interfaces changed incompatibly in RadioLib 7
+// (const transmit buffers, RadioLibTime_t, generic IRQ flags)
+#if !defined(RADIOLIB_VERSION_MAJOR) || (RADIOLIB_VERSION_MAJOR != 6) || (RADIOLIB_VERSION_MINOR < 6)
+#error "VirtualRadio.h requires RadioLib 6.6.x (see package.json)"
+#endif
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "Gwmp.h"
+
+// Interrupt flags of the virtual radio
+#define VR_IRQ_TX_DONE 0x01
+#define VR_IRQ_RX_DONE 0x02
+#define VR_IRQ_PREAMBLE 0x04
+#define VR_IRQ_TIMEOUT 0x08
+
+/// PULL_DATA keep-alive interval [ms]
+#define VR_KEEPALIVE_MS 5000
+
+/// Maximum deviation of downlink frequency [MHz]
+#define VR_FREQ_TOLERANCE 0.001f
+
+class VirtualRadio;
+
+/*!
+ * \brief RadioLib HAL for the host
+ *
+ * Timing is based on the monotonic system clock. All delays poll the
+ * virtual radio, so downlinks are received while the LoRaWAN stack waits
+ * for its receive windows - no threads are required.
+ */
+class VirtualHal : public RadioLibHal
+{
+public:
+    VirtualHal() : RadioLibHal(0, 1, 0, 1, 1, 2), _radio(nullptr), _t0(std::chrono::steady_clock::now()) {}
+
+    void attach(VirtualRadio *radio)
+    {
+        _radio = radio;
+    }
+
+    void pinMode(uint32_t, uint32_t) override {}
+    void digitalWrite(uint32_t, uint32_t) override {}
+    uint32_t digitalRead(uint32_t) override
+    {
+        return 0;
+    }
+    void attachInterrupt(uint32_t, void (*)(void), uint32_t) override {}
+    void detachInterrupt(uint32_t) override {}
+
+    void delay(unsigned long ms) override
+    {
+        delayMicroseconds(ms * 1000);
+    }
+
+    void delayMicroseconds(unsigned long us) override;
+
+    unsigned long millis() override
+    {
+        return static_cast<unsigned long>(micros() / 1000);
+    }
+
+    unsigned long micros() override
+    {
+        return static_cast<unsigned long>(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _t0).count());
+    }
+
+    long pulseIn(uint32_t, uint32_t, unsigned long) override
+    {
+        return 0;
+    }
+
+    void spiBegin() override {}
+    void spiBeginTransaction() override {}
+    void spiTransfer(uint8_t *, size_t, uint8_t *) override {}
+    void spiEndTransaction() override {}
+    void spiEnd() override {}
+
+    void yield() override;
+
+private:
+    VirtualRadio *_radio;
+    std::chrono::steady_clock::time_point _t0;
+};
+
+/*!
+ * \brief Virtual LoRa radio
+ *
+ * Implements RadioLib's PhysicalLayer on the host and acts as a single
+ * channel gateway at the same time: uplinks are forwarded as rxpk to a
+ * network server via the Semtech UDP packet forwarder protocol (lns_stub or
+ * e.g. ChirpStack's gateway bridge), downlinks (txpk) are buffered and
+ * delivered if a matching receive window (frequency, data rate, IQ
+ * inversion) is open at the scheduled transmission time.
+ *
+ * The concentrator time stamp (tmst) is the HAL's micros() counter, so the
+ * network server's RX1/RX2 scheduling directly refers to the end of the
+ * uplink transmission as seen by the LoRaWAN stack.
+ *
+ * Transmission blocks for the LoRa time on air.
+ *
+ * Written against the RadioLib 6.6 PhysicalLayer interface, the version used
+ * by the firmware (the receive windows are configured with
+ * irqRxDoneRxTimeout() / startReceive(), a timeout is checked with
+ * isRxTimeout()). The methods are deliberately not marked override, so
+ * minor signature changes between patch releases only disable the affected
+ * method instead of breaking the build.
+ */
+class VirtualRadio : public PhysicalLayer
+{
+public:
+    /*!
+     * \brief Constructor
+     *
+     * \param hal    host HAL
+     * \param server network server address
+     * \param port   network server UDP port
+     */
+    VirtualRadio(VirtualHal *hal, const char *server = "127.0.0.1", uint16_t port = GWMP_PORT)
+        : PhysicalLayer(61.03515625f, GWMP_PHY_MAX), _hal(hal), _mod(hal, RADIOLIB_NC, RADIOLIB_NC, RADIOLIB_NC)
+    {
+        hal->attach(this);
+        memset(&_server, 0, sizeof(_server));
+        _server.sin_family = AF_INET;
+        _server.sin_port = htons(port);
+        inet_pton(AF_INET, server, &_server.sin_addr);
+    }
+
+    ~VirtualRadio()
+    {
+        if (_sock >= 0)
+        {
+            close(_sock);
+        }
+    }
+
+    /*!
+     * \brief Open UDP socket and connect to network server
+     *
+     * \param gatewayEui gateway EUI (as registered at the network server)
+     *
+     * \returns RADIOLIB_ERR_NONE on success
+     */
+    int16_t begin(uint64_t gatewayEui = 0x0000000000000001ULL)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            _eui[i] = static_cast<uint8_t>(gatewayEui >> (56 - 8 * i));
+        }
+        _sock = socket(AF_INET, SOCK_DGRAM, 0);
+        if (_sock < 0)
+        {
+            return RADIOLIB_ERR_UNKNOWN;
+        }
+        fcntl(_sock, F_SETFL, O_NONBLOCK);
+        sendPullData();
+        return RADIOLIB_ERR_NONE;
+    }
+
+    /*!
+     * \brief Set scripted packet loss
+     */
+    GwmpLoss &uplinkLoss(void)
+    {
+        return _upLoss;
+    }
+
+    GwmpLoss &downlinkLoss(void)
+    {
+        return _downLoss;
+    }
+
+    /*!
+     * \brief Set link quality reported for up- and downlinks
+     *
+     * \param rssi RSSI [dBm]
+     * \param snr  SNR [dB]
+     */
+    void setLinkQuality(float rssi, float snr)
+    {
+        _rssi = rssi;
+        _snr = snr;
+    }
+
+    /*!
+     * \brief Get number of downlinks which did not hit an open receive window
+     */
+    unsigned getMissedDownlinks(void) const
+    {
+        return _missed;
+    }
+
+    /*!
+     * \brief Process network traffic and radio events
+     *
+     * Called by the HAL while waiting.
+     */
+    void poll(void)
+    {
+        uint64_t now = _hal->micros();
+
+        if ((_sock >= 0) && (now - _lastPull >= VR_KEEPALIVE_MS * 1000ULL))
+        {
+            sendPullData();
+        }
+        receiveDatagrams(now);
+
+        // Non-blocking transmission
+        if (_txActive && (now >= _txEnd))
+        {
+            _txActive = false;
+            _irq |= VR_IRQ_TX_DONE;
+            if (_txCb)
+            {
+                _txCb();
+            }
+        }
+
+        if (!_rxActive)
+        {
+            return;
+        }
+        for (size_t i = 0; i < _pending.size(); i++)
+        {
+            const Pending &p = _pending[i];
+            bool match = (fabsf(p.pkt.freq - _freq) < VR_FREQ_TOLERANCE) && (p.pkt.sf == _sf) &&
+                         (p.pkt.bw == _bw) && (p.pkt.ipol == _iqInverted);
+            if (!match || (p.start + 1000 < _rxOpen) || (_rxTimeout && (p.start > _rxEnd)) || (now < p.start))
+            {
+                continue;
+            }
+            if (p.lost)
+            {
+                // Preamble never arrives
+                continue;
+            }
+            _irq |= VR_IRQ_PREAMBLE;
+            if (now < p.end)
+            {
+                continue;
+            }
+            memcpy(_rxBuf, p.pkt.data, p.pkt.size);
+            _rxLen = p.pkt.size;
+            _pending.erase(_pending.begin() + i);
+            _rxActive = false;
+            _irq |= VR_IRQ_RX_DONE;
+            if (_rxCb)
+            {
+                _rxCb();
+            }
+            return;
+        }
+        if (_rxTimeout && !(_irq & VR_IRQ_PREAMBLE) && (now > _rxEnd))
+        {
+            _rxActive = false;
+            _irq |= VR_IRQ_TIMEOUT;
+        }
+    }
+
+    // --- PhysicalLayer ---
+
+    int16_t transmit(uint8_t *data, size_t len, uint8_t addr = 0)
+    {
+        int16_t state = startTransmit(data, len, addr);
+        if (state != RADIOLIB_ERR_NONE)
+        {
+            return state;
+        }
+        while (_txActive)
+        {
+            _hal->yield();
+        }
+        return finishTransmit();
+    }
+
+    int16_t startTransmit(uint8_t *data, size_t len, uint8_t addr = 0)
+    {
+        (void)addr;
+        if (len > GWMP_PHY_MAX)
+        {
+            return RADIOLIB_ERR_PACKET_TOO_LONG;
+        }
+        standby();
+        _irq = 0;
+        _txActive = true;
+        _txEnd = _hal->micros() + getTimeOnAir(len);
+
+        if (_iqInverted)
+        {
+            // Not receivable by a gateway
+            return RADIOLIB_ERR_NONE;
+        }
+        if (_upLoss.drop())
+        {
+            return RADIOLIB_ERR_NONE;
+        }
+        GwmpPacket pkt;
+        memset(&pkt, 0, sizeof(pkt));
+        pkt.tmst = static_cast<uint32_t>(_txEnd);
+        pkt.freq = _freq;
+        pkt.sf = _sf;
+        pkt.bw = _bw;
+        pkt.rssi = _rssi;
+        pkt.lsnr = _snr;
+        pkt.size = len;
+        memcpy(pkt.data, data, len);
+        _uplinks.push_back(pkt);
+        return RADIOLIB_ERR_NONE;
+    }
+
+    int16_t finishTransmit()
+    {
+        // The gateway forwards the uplink after reception is complete
+        for (const GwmpPacket &pkt : _uplinks)
+        {
+            uint8_t buf[GWMP_BUF_SIZE];
+            size_t n = gwmpHeader(buf, static_cast<uint16_t>(rand()), GWMP_PUSH_DATA, _eui);
+            size_t j = gwmpFormatPacket(pkt, true, reinterpret_cast<char *>(&buf[n]), sizeof(buf) - n);
+            send(buf, n + j);
+        }
+        _uplinks.clear();
+        _txActive = false;
+        return RADIOLIB_ERR_NONE;
+    }
+
+    int16_t receive(uint8_t *data, size_t len)
+    {
+        int16_t state = startReceive();
+        while ((state == RADIOLIB_ERR_NONE) && _rxActive)
+        {
+            _hal->yield();
+        }
+        return readData(data, len);
+    }
+
+    int16_t startReceive()
+    {
+        return startReceive(0, 0, 0, 0);
+    }
+
+    int16_t startReceive(uint32_t timeout, uint16_t irqFlags, uint16_t irqMask, size_t len)
+    {
+        (void)irqFlags;
+        (void)irqMask;
+        (void)len;
+        _irq = 0;
+        _rxActive = true;
+        _rxTimeout = timeout;
+        _rxOpen = _hal->micros();
+        _rxEnd = _rxOpen + timeout;
+        return RADIOLIB_ERR_NONE;
+    }
+
+    int16_t readData(uint8_t *data, size_t len)
+    {
+        size_t n = (len && (len < _rxLen)) ? len : _rxLen;
+        memcpy(data, _rxBuf, n);
+        _irq &= ~VR_IRQ_RX_DONE;
+        return (n > 0) ? RADIOLIB_ERR_NONE : RADIOLIB_ERR_RX_TIMEOUT;
+    }
+
+    int16_t standby()
+    {
+        _rxActive = false;
+        return RADIOLIB_ERR_NONE;
+    }
+
+    int16_t standby(uint8_t mode)
+    {
+        (void)mode;
+        return standby();
+    }
+
+    int16_t sleep()
+    {
+        return standby();
+    }
+
+    int16_t setFrequency(float freq)
+    {
+        _freq = freq;
+        return RADIOLIB_ERR_NONE;
+    }
+
+    int16_t setDataRate(DataRate_t dr)
+    {
+        int16_t state = checkDataRate(dr);
+        if (state == RADIOLIB_ERR_NONE)
+        {
+            _sf = dr.lora.spreadingFactor;
+            _bw = static_cast<uint16_t>(dr.lora.bandwidth + 0.5f);
+        }
+        return state;
+    }
+
+    int16_t checkDataRate(DataRate_t dr)
+    {
+        if ((dr.lora.spreadingFactor < 5) || (dr.lora.spreadingFactor > 12))
+        {
+            return RADIOLIB_ERR_INVALID_SPREADING_FACTOR;
+        }
+        return RADIOLIB_ERR_NONE;
+    }
+
+    int16_t setOutputPower(int8_t power)
+    {
+        (void)power;
+        return RADIOLIB_ERR_NONE;
+    }
+
+    int16_t checkOutputPower(int8_t power, int8_t *clipped)
+    {
+        if (clipped)
+        {
+            *clipped = power;
+        }
+        return RADIOLIB_ERR_NONE;
+    }
+
+    int16_t invertIQ(bool enable)
+    {
+        _iqInverted = enable;
+        return RADIOLIB_ERR_NONE;
+    }
+
+    int16_t setSyncWord(uint8_t *sync, size_t len)
+    {
+        (void)sync;
+        (void)len;
+        return RADIOLIB_ERR_NONE;
+    }
+
+    int16_t setPreambleLength(size_t len)
+    {
+        (void)len;
+        return RADIOLIB_ERR_NONE;
+    }
+
+    size_t getPacketLength(bool update = true)
+    {
+        (void)update;
+        return _rxLen;
+    }
+
+    float getRSSI()
+    {
+        return _rssi;
+    }
+
+    float getSNR()
+    {
+        return _snr;
+    }
+
+    uint32_t getTimeOnAir(size_t len)
+    {
+        // Uplinks with payload CRC, downlinks without
+        return gwmpTimeOnAir(_sf, _bw, len, !_iqInverted);
+    }
+
+    uint32_t calculateRxTimeout(uint32_t timeoutUs)
+    {
+        // startReceive() takes the timeout in microseconds
+        return timeoutUs;
+    }
+
+    int16_t irqRxDoneRxTimeout(uint16_t &irqFlags, uint16_t &irqMask)
+    {
+        irqFlags = VR_IRQ_RX_DONE | VR_IRQ_TIMEOUT;
+        irqMask = VR_IRQ_RX_DONE | VR_IRQ_TIMEOUT;
+        return RADIOLIB_ERR_NONE;
+    }
+
+    bool isRxTimeout()
+    {
+        return (_irq & VR_IRQ_TIMEOUT) != 0;
+    }
+
+    uint8_t randomByte()
+    {
+        return static_cast<uint8_t>(rand());
+    }
+
+    void setPacketReceivedAction(void (*func)(void))
+    {
+        _rxCb = func;
+    }
+
+    void clearPacketReceivedAction()
+    {
+        _rxCb = nullptr;
+    }
+
+    void setPacketSentAction(void (*func)(void))
+    {
+        _txCb = func;
+    }
+
+    void clearPacketSentAction()
+    {
+        _txCb = nullptr;
+    }
+
+    Module *getMod()
+    {
+        return &_mod;
+    }
+
+private:
+    /*!
+     * \brief Downlink scheduled by the network server
+     */
+    struct Pending
+    {
+        GwmpPacket pkt;  //!< txpk
+        uint64_t start;  //!< start of transmission (local time) [us]
+        uint64_t end;    //!< end of transmission (local time) [us]
+        bool lost;       //!< dropped by loss script
+    };
+
+    VirtualHal *_hal;
+    Module _mod;
+    int _sock = -1;
+    struct sockaddr_in _server;
+    uint8_t _eui[8];
+    uint64_t _lastPull = 0;
+
+    float _freq = 868.1f;
+    uint8_t _sf = 7;
+    uint16_t _bw = 125;
+    bool _iqInverted = false;
+    float _rssi = -60;
+    float _snr = 7;
+
+    uint16_t _irq = 0;
+    bool _txActive = false;
+    uint64_t _txEnd = 0;
+    std::vector<GwmpPacket> _uplinks;
+
+    bool _rxActive = false;
+    uint32_t _rxTimeout = 0;
+    uint64_t _rxOpen = 0;
+    uint64_t _rxEnd = 0;
+    uint8_t _rxBuf[GWMP_PHY_MAX];
+    size_t _rxLen = 0;
+    std::vector<Pending> _pending;
+    unsigned _missed = 0;
+
+    void (*_rxCb)(void) = nullptr;
+    void (*_txCb)(void) = nullptr;
+
+    GwmpLoss _upLoss;
+    GwmpLoss _downLoss;
+
+    void send(const uint8_t *buf, size_t len)
+    {
+        sendto(_sock, buf, len, 0, reinterpret_cast<const struct sockaddr *>(&_server), sizeof(_server));
+    }
+
+    void sendPullData(void)
+    {
+        uint8_t buf[GWMP_HDR_EUI_SIZE];
+        gwmpHeader(buf, static_cast<uint16_t>(rand()), GWMP_PULL_DATA, _eui);
+        send(buf, sizeof(buf));
+        _lastPull = _hal->micros();
+    }
+
+    void receiveDatagrams(uint64_t now)
+    {
+        uint8_t buf[GWMP_BUF_SIZE];
+        ssize_t n;
+
+        while ((_sock >= 0) && ((n = recv(_sock, buf, sizeof(buf), 0)) > 0))
+        {
+            if ((n <= GWMP_HDR_SIZE) || (buf[0] != GWMP_VERSION) || (buf[3] != GWMP_PULL_RESP))
+            {
+                continue;
+            }
+            const char *json = reinterpret_cast<const char *>(&buf[GWMP_HDR_SIZE]);
+            const char *end = reinterpret_cast<const char *>(&buf[n]);
+            const char *txpk = gwmpJsonFind(json, end, "txpk");
+            Pending p;
+            const char *err = "NONE";
+            if (!txpk || !gwmpParsePacket(txpk, end, p.pkt))
+            {
+                continue;
+            }
+
+            // Concentrator time stamp -> local time
+            p.start = p.pkt.imme ? now : now + static_cast<int32_t>(p.pkt.tmst - static_cast<uint32_t>(now));
+            p.end = p.start + gwmpTimeOnAir(p.pkt.sf, p.pkt.bw, p.pkt.size, false);
+            p.lost = _downLoss.drop();
+            if (p.start + 1000 < now)
+            {
+                err = "TOO_LATE";
+            }
+            else
+            {
+                _pending.push_back(p);
+            }
+
+            // TX_ACK with the token of the PULL_RESP
+            uint8_t ack[GWMP_HDR_EUI_SIZE + 48];
+            size_t len = gwmpHeader(ack, static_cast<uint16_t>((buf[1] << 8) | buf[2]), GWMP_TX_ACK, _eui);
+            len += snprintf(reinterpret_cast<char *>(&ack[len]), sizeof(ack) - len,
+                            "{\"txpk_ack\":{\"error\":\"%s\"}}", err);
+            send(ack, len);
+        }
+
+        // Downlinks which have not been received in any window
+        for (size_t i = 0; i < _pending.size();)
+        {
+            if (now > _pending[i].end + 100000)
+            {
+                _missed++;
+                _pending.erase(_pending.begin() + i);
+            }
+            else
+            {
+                i++;
+            }
+        }
+    }
+};
+
+inline void VirtualHal::delayMicroseconds(unsigned long us)
+{
+    unsigned long end = micros() + us;
+    for (unsigned long now = micros(); now < end; now = micros())
+    {
+        if (_radio)
+        {
+            _radio->poll();
+        }
+        unsigned long slice = end - now;
+        std::this_thread::sleep_for(std::chrono::microseconds((slice > 500) ? 500 : slice));
+    }
+    if (_radio)
+    {
+        _radio->poll();
+    }
+}
+
+inline void VirtualHal::yield()
+{
+    if (_radio)
+    {
+        _radio->poll();
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+}
+#endif // _VIRTUALRADIO_H
@@ -0,0 +1,961 @@
+///////////////////////////////////////////////////////////////////////////////
+// lns_stub.cpp
+//
+// Minimal LoRaWAN network server for end-to-end tests on the host
+//
+// Speaks the Semtech UDP packet forwarder protocol (Gwmp.h), so it can be used
+// with the virtual radio (VirtualRadio.h) as well as with a real gateway.
+// Implements a LoRaWAN 1.0.x (EU868) network server for a single root key:
+// - OTAA join (JoinAccept in RX1 / RX2, OptNeg = 0)
+// - uplink MIC check, 32 bit frame counter tracking, payload decryption
+// - ACK of confirmed uplinks
+// - LinkCheckReq / DeviceTimeReq (FOpts or port 0)
+// - queued application downlinks, e.g. commands (-q)
+// - scripted uplink / downlink loss
+// - join latency and command round trip statistics
+//
+// Build:
+//   g++ -std=c++11 -O2 -Wall -I../../src -o lns_stub lns_stub.cpp
+//
+// Usage:
+//   ./lns_stub -k <NwkKey> [-p <port>] [-n <NetID>] [-a <DevAddr>] [-r <1|2>]
+//              [-q <port>:<hex>]... [-u <loss %>] [-U <list>] [-d <loss %>] [-D <list>]
+//              [-s <seed>] [-t <seconds>]
+//
+//   -k  root key (NwkKey / LoRaWAN 1.0.x AppKey), 32 hex digits
+//   -p  UDP port (default: 1700)
+//   -n  NetID (hex, default: 000000)
+//   -a  DevAddr (hex, default: random)
+//   -r  receive window for downlinks (default: 1)
+//   -q  queue downlink, e.g. -q 32:00 (CMD_GET_DATETIME)
+//   -u  random uplink loss [%]
+//   -U  drop uplinks with given sequence numbers, e.g. 1,2
+//   -d  random downlink loss [%]
+//   -D  drop downlinks with given sequence numbers
+//   -s  seed for random loss
+//   -t  run time [s] (default: until SIGINT)
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "../crypto/LwCrypto.h"
+#include "Gwmp.h"
+
+// LoRaWAN message types (MHDR[7:5])
+#define MTYPE_JOIN_REQUEST 0x00
+#define MTYPE_JOIN_ACCEPT 0x20
+#define MTYPE_UNCONF_UP 0x40
+#define MTYPE_UNCONF_DOWN 0x60
+#define MTYPE_CONF_UP 0x80
+#define MTYPE_CONF_DOWN 0xA0
+
+// MAC commands (CID)
+#define MAC_LINK_CHECK 0x02
+#define MAC_DEVICE_TIME 0x0D
+
+// FCtrl bits (downlink)
+#define FCTRL_ACK 0x20
+#define FCTRL_FPENDING 0x10
+
+// EU868 receive windows
+#define JOIN_ACCEPT_DELAY1 5000000UL //!< [us]
+#define RECEIVE_DELAY1 1000000UL     //!< [us]
+#define RX2_FREQ 869.525f            //!< [MHz]
+#define RX2_SF 12
+
+// GPS epoch (1980-01-06) as Unix time, leap seconds since then
+#define GPS_EPOCH_UNIX 315964800UL
+#define GPS_LEAP_SECONDS 18
+
+/*!
+ * \brief AES-128 block decryption (FIPS-197, 5.3)
+ *
+ * Only required by the network server - the JoinAccept is "encrypted" with
+ * the AES decrypt operation, so that the device only needs AES encrypt.
+ */
+class AesDecrypt
+{
+public:
+    AesDecrypt()
+    {
+        // S-box: multiplicative inverse in GF(2^8) followed by affine transformation
+        for (int i = 0; i < 256; i++)
+        {
+            uint8_t x = 0;
+            for (int y = 1; (i != 0) && (y < 256); y++)
+            {
+                if (gmul(static_cast<uint8_t>(i), static_cast<uint8_t>(y)) == 1)
+                {
+                    x = static_cast<uint8_t>(y);
+                    break;
+                }
+            }
+            uint8_t s = x ^ rotl(x, 1) ^ rotl(x, 2) ^ rotl(x, 3) ^ rotl(x, 4) ^ 0x63;
+            _sbox[i] = s;
+            _inv[s] = static_cast<uint8_t>(i);
+        }
+    }
+
+    void setKey(const uint8_t *key)
+    {
+        uint8_t rcon = 1;
+        memcpy(_rk, key, 16);
+        for (int i = 16; i < 176; i += 4)
+        {
+            uint8_t t[4] = {_rk[i - 4], _rk[i - 3], _rk[i - 2], _rk[i - 1]};
+            if (i % 16 == 0)
+            {
+                uint8_t u = t[0];
+                t[0] = _sbox[t[1]] ^ rcon;
+                t[1] = _sbox[t[2]];
+                t[2] = _sbox[t[3]];
+                t[3] = _sbox[u];
+                rcon = gmul(rcon, 2);
+            }
+            for (int j = 0; j < 4; j++)
+            {
+                _rk[i + j] = _rk[i - 16 + j] ^ t[j];
+            }
+        }
+    }
+
+    void decryptBlock(const uint8_t *in, uint8_t *out)
+    {
+        uint8_t s[16];
+        uint8_t t[16];
+
+        for (int i = 0; i < 16; i++)
+        {
+            s[i] = in[i] ^ _rk[160 + i];
+        }
+        for (int round = 9; round >= 0; round--)
+        {
+            // InvShiftRows (state is column-major) and InvSubBytes
+            for (int c = 0; c < 4; c++)
+            {
+                for (int r = 0; r < 4; r++)
+                {
+                    t[r + 4 * ((c + r) % 4)] = s[r + 4 * c];
+                }
+            }
+            for (int i = 0; i < 16; i++)
+            {
+                s[i] = _inv[t[i]] ^ _rk[16 * round + i];
+            }
+            if (round == 0)
+            {
+                break;
+            }
+            // InvMixColumns
+            for (int c = 0; c < 4; c++)
+            {
+                uint8_t a0 = s[4 * c], a1 = s[4 * c + 1], a2 = s[4 * c + 2], a3 = s[4 * c + 3];
+                s[4 * c + 0] = gmul(a0, 14) ^ gmul(a1, 11) ^ gmul(a2, 13) ^ gmul(a3, 9);
+                s[4 * c + 1] = gmul(a0, 9) ^ gmul(a1, 14) ^ gmul(a2, 11) ^ gmul(a3, 13);
+                s[4 * c + 2] = gmul(a0, 13) ^ gmul(a1, 9) ^ gmul(a2, 14) ^ gmul(a3, 11);
+                s[4 * c + 3] = gmul(a0, 11) ^ gmul(a1, 13) ^ gmul(a2, 9) ^ gmul(a3, 14);
+            }
+        }
+        memcpy(out, s, 16);
+    }
+
+private:
+    uint8_t _sbox[256];
+    uint8_t _inv[256];
+    uint8_t _rk[176];
+
+    static uint8_t gmul(uint8_t a, uint8_t b)
+    {
+        uint8_t p = 0;
+        while (b)
+        {
+            if (b & 1)
+            {
+                p ^= a;
+            }
+            a = static_cast<uint8_t>((a << 1) ^ ((a & 0x80) ? 0x1B : 0x00));
+            b >>= 1;
+        }
+        return p;
+    }
+
+    static uint8_t rotl(uint8_t x, int n)
+    {
+        return static_cast<uint8_t>((x << n) | (x >> (8 - n)));
+    }
+};
+
+/*!
+ * \brief Latency statistics
+ */
+struct Latency
+{
+    unsigned n = 0;
+    double sum = 0;
+    double min = 0;
+    double max = 0;
+
+    void add(double ms)
+    {
+        min = (n == 0 || ms < min) ? ms : min;
+        max = (n == 0 || ms > max) ? ms : max;
+        sum += ms;
+        n++;
+    }
+
+    void print(const char *name) const
+    {
+        if (n == 0)
+        {
+            printf("%-24s -\n", name);
+            return;
+        }
+        printf("%-24s n=%u min=%.0f ms avg=%.0f ms max=%.0f ms\n", name, n, min, sum / n, max);
+    }
+};
+
+/*!
+ * \brief Device state (LoRaWAN 1.0.x session)
+ */
+struct Device
+{
+    uint8_t devEui[8];          //!< DevEUI (as transmitted, LE)
+    int devNonce = -1;          //!< last DevNonce
+    bool joined = false;        //!< session established
+    bool confirmed = false;     //!< first data uplink of session received
+    uint32_t devAddr = 0;       //!< device address
+    uint8_t nwkSKey[16];        //!< network session key
+    uint8_t appSKey[16];        //!< application session key
+    uint32_t fCntUp = 0;        //!< next expected uplink frame counter
+    uint32_t fCntDown = 0;      //!< next downlink frame counter
+    double joinStart = -1;      //!< time of first JoinRequest of current join procedure [ms]
+    unsigned joinAttempts = 0;  //!< JoinRequests of current join procedure
+    int cmdPort = -1;           //!< port of last command downlink (awaiting response)
+    double cmdTime = 0;         //!< transmission time of last command downlink [ms]
+};
+
+/*!
+ * \brief Queued application downlink
+ */
+struct Downlink
+{
+    uint8_t port;
+    std::vector<uint8_t> payload;
+};
+
+// Configuration
+static uint8_t nwkKey[16];
+static uint32_t netId = 0;
+static uint32_t fixedDevAddr = 0;
+static int rxWindow = 1;
+
+// State
+static int sock = -1;
+static struct sockaddr_in gwAddr;
+static bool gwKnown = false;
+static std::vector<Device> devices;
+static std::vector<Downlink> queue;
+static uint32_t joinNonce = 0;
+static GwmpLoss upLoss;
+static GwmpLoss downLoss;
+static volatile sig_atomic_t stop = 0;
+static std::chrono::steady_clock::time_point t0;
+
+// Statistics
+static unsigned nUplinks = 0;
+static unsigned nUplinksDropped = 0;
+static unsigned nMicErrors = 0;
+static unsigned nFCntGaps = 0;
+static unsigned nJoinRequests = 0;
+static unsigned nJoinAccepts = 0;
+static unsigned nDownlinks = 0;
+static unsigned nDownlinksDropped = 0;
+static unsigned nTxErrors = 0;
+static unsigned nLinkCheck = 0;
+static unsigned nDeviceTime = 0;
+static unsigned nAcks = 0;
+static Latency joinLatency;
+static Latency cmdLatency;
+
+static double nowMs(void)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static void onSignal(int)
+{
+    stop = 1;
+}
+
+static bool parseHex(const char *s, uint8_t *out, size_t len)
+{
+    if (strlen(s) != 2 * len)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++)
+    {
+        unsigned v;
+        if (sscanf(&s[2 * i], "%2x", &v) != 1)
+        {
+            return false;
+        }
+        out[i] = static_cast<uint8_t>(v);
+    }
+    return true;
+}
+
+static void printHex(const uint8_t *buf, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        printf("%02X", buf[i]);
+    }
+}
+
+static uint32_t getLe32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static void putLe32(uint8_t *p, uint32_t v)
+{
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+    p[2] = static_cast<uint8_t>(v >> 16);
+    p[3] = static_cast<uint8_t>(v >> 24);
+}
+
+/*!
+ * \brief Send txpk to gateway (PULL_RESP)
+ *
+ * \param rx      uplink the downlink responds to
+ * \param delayUs receive delay (RX1) [us]
+ * \param phy     PHY payload
+ * \param len     PHY payload size
+ */
+static void sendDownlink(const GwmpPacket &rx, uint32_t delayUs, const uint8_t *phy, size_t len)
+{
+    GwmpPacket tx;
+    uint8_t buf[GWMP_BUF_SIZE];
+
+    memset(&tx, 0, sizeof(tx));
+    tx.ipol = true;
+    tx.bw = 125;
+    if (rxWindow == 2)
+    {
+        tx.tmst = rx.tmst + delayUs + 1000000UL;
+        tx.freq = RX2_FREQ;
+        tx.sf = RX2_SF;
+    }
+    else
+    {
+        tx.tmst = rx.tmst + delayUs;
+        tx.freq = rx.freq;
+        tx.sf = rx.sf;
+        tx.bw = rx.bw;
+    }
+    tx.size = len;
+    memcpy(tx.data, phy, len);
+
+    if (!gwKnown)
+    {
+        printf("             no PULL_DATA received yet - downlink discarded\n");
+        return;
+    }
+    if (downLoss.drop())
+    {
+        printf("             downlink dropped (scripted)\n");
+        nDownlinksDropped++;
+        return;
+    }
+    size_t n = gwmpHeader(buf, static_cast<uint16_t>(rand()), GWMP_PULL_RESP, nullptr);
+    size_t j = gwmpFormatPacket(tx, false, reinterpret_cast<char *>(&buf[n]), sizeof(buf) - n);
+    sendto(sock, buf, n + j, 0, reinterpret_cast<struct sockaddr *>(&gwAddr), sizeof(gwAddr));
+    nDownlinks++;
+}
+
+/*!
+ * \brief Handle JoinRequest - send JoinAccept
+ */
+static void handleJoinRequest(const GwmpPacket &rx)
+{
+    LwSoftAes aes;
+    uint8_t mic[LW_AES_BLOCK];
+
+    nJoinRequests++;
+    if (rx.size != 23)
+    {
+        printf("             invalid JoinRequest size %u\n", static_cast<unsigned>(rx.size));
+        return;
+    }
+    aes.setKey(nwkKey);
+    lwCmac(aes, rx.data, 19, mic);
+    if (memcmp(mic, &rx.data[19], 4) != 0)
+    {
+        printf("             JoinRequest MIC error\n");
+        nMicErrors++;
+        return;
+    }
+
+    const uint8_t *devEui = &rx.data[9];
+    uint16_t devNonce = rx.data[17] | (rx.data[18] << 8);
+    Device *d = nullptr;
+    for (Device &dev : devices)
+    {
+        if (memcmp(dev.devEui, devEui, 8) == 0)
+        {
+            d = &dev;
+        }
+    }
+    if (!d)
+    {
+        devices.push_back(Device());
+        d = &devices.back();
+        memcpy(d->devEui, devEui, 8);
+    }
+
+    printf("JoinRequest DevEUI ");
+    for (int i = 7; i >= 0; i--)
+    {
+        printf("%02X", devEui[i]);
+    }
+    printf(" DevNonce %u\n", devNonce);
+    if (static_cast<int>(devNonce) <= d->devNonce)
+    {
+        // A real network server rejects this (LoRaWAN 1.0.4) - accepted here,
+        // because the host test node does not necessarily persist its nonces
+        printf("             DevNonce not incremented (last: %d)\n", d->devNonce);
+    }
+    d->devNonce = devNonce;
+    if (d->joinStart < 0)
+    {
+        d->joinStart = nowMs();
+        d->joinAttempts = 0;
+    }
+    d->joinAttempts++;
+
+    // JoinAccept: MHDR | JoinNonce | NetID | DevAddr | DLSettings | RxDelay | MIC
+    uint8_t ja[17];
+    joinNonce++;
+    ja[0] = MTYPE_JOIN_ACCEPT;
+    ja[1] = static_cast<uint8_t>(joinNonce);
+    ja[2] = static_cast<uint8_t>(joinNonce >> 8);
+    ja[3] = static_cast<uint8_t>(joinNonce >> 16);
+    ja[4] = static_cast<uint8_t>(netId);
+    ja[5] = static_cast<uint8_t>(netId >> 8);
+    ja[6] = static_cast<uint8_t>(netId >> 16);
+    d->devAddr = fixedDevAddr ? fixedDevAddr : ((netId & 0x7F) << 25) | (static_cast<uint32_t>(rand()) & 0x01FFFFFF);
+    putLe32(&ja[7], d->devAddr);
+    ja[11] = 0x00; // OptNeg = 0 (LoRaWAN 1.0.x), RX1DROffset = 0, RX2DR = DR0
+    ja[12] = RECEIVE_DELAY1 / 1000000UL;
+    lwCmac(aes, ja, 13, mic);
+    memcpy(&ja[13], mic, 4);
+
+    lwDeriveKey(aes, 0x01, &ja[1], &ja[4], devNonce, d->nwkSKey);
+    lwDeriveKey(aes, 0x02, &ja[1], &ja[4], devNonce, d->appSKey);
+    d->joined = true;
+    d->confirmed = false;
+    d->fCntUp = 0;
+    d->fCntDown = 0;
+    d->cmdPort = -1;
+
+    AesDecrypt dec;
+    dec.setKey(nwkKey);
+    dec.decryptBlock(&ja[1], &ja[1]);
+
+    printf("             -> JoinAccept DevAddr %08X (RX%d)\n", d->devAddr, rxWindow);
+    nJoinAccepts++;
+    sendDownlink(rx, JOIN_ACCEPT_DELAY1, ja, sizeof(ja));
+}
+
+/*!
+ * \brief Process MAC commands of uplink
+ *
+ * \param rx      uplink
+ * \param cmd     MAC commands
+ * \param len     length of MAC commands
+ * \param ans     MAC command answers
+ * \param ansLen  length of MAC command answers
+ */
+static void handleMacCommands(const GwmpPacket &rx, const uint8_t *cmd, size_t len, uint8_t *ans, size_t &ansLen)
+{
+    // Payload sizes of uplink MAC commands (LoRaWAN 1.0.4 / 1.1), -1: unknown
+    static const int8_t size[] = {-1, 1, 0, 1, 0, 1, 2, 1, 0, 0, 1, 1, -1, 0};
+
+    for (size_t i = 0; i < len;)
+    {
+        uint8_t cid = cmd[i++];
+        if ((cid >= sizeof(size)) || (size[cid] < 0))
+        {
+            printf(" [unknown CID 0x%02X]", cid);
+            return;
+        }
+        if (cid == MAC_LINK_CHECK)
+        {
+            // Margin above the demodulation floor of the spreading factor
+            float floorSnr = -7.5f - 2.5f * (rx.sf - 7);
+            int margin = static_cast<int>(rx.lsnr - floorSnr + 0.5f);
+            margin = (margin < 0) ? 0 : ((margin > 254) ? 254 : margin);
+            ans[ansLen++] = MAC_LINK_CHECK;
+            ans[ansLen++] = static_cast<uint8_t>(margin);
+            ans[ansLen++] = 1;
+            printf(" LinkCheckReq");
+            nLinkCheck++;
+        }
+        else if (cid == MAC_DEVICE_TIME)
+        {
+            // Time at end of uplink transmission, i.e. now
+            auto t = std::chrono::system_clock::now().time_since_epoch();
+            uint64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(t).count();
+            uint32_t gps = static_cast<uint32_t>(ms / 1000 - GPS_EPOCH_UNIX + GPS_LEAP_SECONDS);
+            ans[ansLen++] = MAC_DEVICE_TIME;
+            putLe32(&ans[ansLen], gps);
+            ansLen += 4;
+            ans[ansLen++] = static_cast<uint8_t>((ms % 1000) * 256 / 1000);
+            printf(" DeviceTimeReq");
+            nDeviceTime++;
+        }
+        else
+        {
+            printf(" CID 0x%02X", cid);
+        }
+        i += size[cid];
+    }
+}
+
+/*!
+ * \brief Handle data uplink - send downlink if required
+ */
+static void handleDataUplink(const GwmpPacket &rx)
+{
+    LwSoftAes aes;
+    uint8_t plain[GWMP_PHY_MAX];
+
+    if (rx.size < 12)
+    {
+        printf("Data uplink too short\n");
+        return;
+    }
+    uint32_t devAddr = getLe32(&rx.data[1]);
+    Device *d = nullptr;
+    for (Device &dev : devices)
+    {
+        if (dev.joined && (dev.devAddr == devAddr))
+        {
+            d = &dev;
+        }
+    }
+    if (!d)
+    {
+        printf("Uplink from unknown DevAddr %08X\n", devAddr);
+        return;
+    }
+
+    uint8_t fCtrl = rx.data[5];
+    uint16_t fCnt16 = rx.data[6] | (rx.data[7] << 8);
+    size_t fOptsLen = fCtrl & 0x0F;
+    size_t micPos = rx.size - 4;
+    if (8 + fOptsLen > micPos)
+    {
+        printf("Invalid FOptsLen\n");
+        return;
+    }
+
+    // Reconstruct 32 bit frame counter
+    uint32_t fCnt = (d->fCntUp & 0xFFFF0000UL) | fCnt16;
+    if (fCnt < d->fCntUp)
+    {
+        fCnt += 0x10000UL;
+    }
+    aes.setKey(d->nwkSKey);
+    if (lwMic(aes, devAddr, fCnt, LW_DIR_UPLINK, rx.data, micPos) != getLe32(&rx.data[micPos]))
+    {
+        printf("Uplink DevAddr %08X FCnt %u: MIC error\n", devAddr, fCnt);
+        nMicErrors++;
+        return;
+    }
+    if (fCnt > d->fCntUp)
+    {
+        nFCntGaps += fCnt - d->fCntUp;
+    }
+    d->fCntUp = fCnt + 1;
+
+    bool confirmed = (rx.data[0] & 0xE0) == MTYPE_CONF_UP;
+    int port = -1;
+    size_t len = 0;
+    if (8 + fOptsLen < micPos)
+    {
+        port = rx.data[8 + fOptsLen];
+        len = micPos - 9 - fOptsLen;
+        aes.setKey((port == 0) ? d->nwkSKey : d->appSKey);
+        lwPayloadCrypt(aes, devAddr, fCnt, LW_DIR_UPLINK, &rx.data[9 + fOptsLen], plain, len);
+    }
+
+    printf("Uplink DevAddr %08X FCnt %u %s SF%u %.3f MHz SNR %.1f", devAddr, fCnt,
+           confirmed ? "conf" : "unconf", rx.sf, rx.freq, rx.lsnr);
+    if (port >= 0)
+    {
+        printf(" port %d: ", port);
+        printHex(plain, len);
+    }
+    printf("\n");
+
+    if (!d->confirmed)
+    {
+        // First data uplink proves that the device accepted the session
+        d->confirmed = true;
+        if (d->joinStart >= 0)
+        {
+            double ms = nowMs() - d->joinStart;
+            printf("             session confirmed - join took %.0f ms, %u JoinRequest(s)\n", ms, d->joinAttempts);
+            joinLatency.add(ms);
+            d->joinStart = -1;
+        }
+    }
+    if ((d->cmdPort >= 0) && (port == d->cmdPort))
+    {
+        double ms = nowMs() - d->cmdTime;
+        printf("             response to command on port %d after %.0f ms\n", port, ms);
+        cmdLatency.add(ms);
+        d->cmdPort = -1;
+    }
+
+    // MAC commands in FOpts or FRMPayload (port 0)
+    uint8_t ans[16];
+    size_t ansLen = 0;
+    printf("             MAC:");
+    handleMacCommands(rx, &rx.data[8], fOptsLen, ans, ansLen);
+    if (port == 0)
+    {
+        handleMacCommands(rx, plain, len, ans, ansLen);
+    }
+    printf("\n");
+
+    // Downlink: MHDR | DevAddr | FCtrl | FCnt | FOpts | [FPort | FRMPayload] | MIC
+    bool appData = !queue.empty();
+    if (!confirmed && (ansLen == 0) && !appData)
+    {
+        return;
+    }
+    uint8_t dl[GWMP_PHY_MAX];
+    size_t n = 0;
+    dl[n++] = MTYPE_UNCONF_DOWN;
+    putLe32(&dl[n], devAddr);
+    n += 4;
+    dl[n++] = static_cast<uint8_t>((confirmed ? FCTRL_ACK : 0) | ((queue.size() > 1) ? FCTRL_FPENDING : 0) | ansLen);
+    dl[n++] = static_cast<uint8_t>(d->fCntDown);
+    dl[n++] = static_cast<uint8_t>(d->fCntDown >> 8);
+    memcpy(&dl[n], ans, ansLen);
+    n += ansLen;
+    printf("             -> Downlink FCnt %u%s", d->fCntDown, confirmed ? " ACK" : "");
+    if (ansLen)
+    {
+        printf(" FOpts ");
+        printHex(ans, ansLen);
+    }
+    if (appData)
+    {
+        Downlink &q = queue.front();
+        dl[n++] = q.port;
+        aes.setKey(d->appSKey);
+        lwPayloadCrypt(aes, devAddr, d->fCntDown, LW_DIR_DOWNLINK, q.payload.data(), &dl[n], q.payload.size());
+        n += q.payload.size();
+        printf(" port %u: ", q.port);
+        printHex(q.payload.data(), q.payload.size());
+        d->cmdPort = q.port;
+        d->cmdTime = nowMs() + RECEIVE_DELAY1 / 1000 + ((rxWindow == 2) ? 1000 : 0);
+        queue.erase(queue.begin());
+    }
+    printf(" (RX%d)\n", rxWindow);
+    aes.setKey(d->nwkSKey);
+    putLe32(&dl[n], lwMic(aes, devAddr, d->fCntDown, LW_DIR_DOWNLINK, dl, n));
+    n += 4;
+    d->fCntDown++;
+    nAcks += confirmed ? 1 : 0;
+    sendDownlink(rx, RECEIVE_DELAY1, dl, n);
+}
+
+/*!
+ * \brief Handle received datagram
+ */
+static void handleDatagram(const uint8_t *buf, size_t len, const struct sockaddr_in &from)
+{
+    uint8_t ack[GWMP_HDR_SIZE];
+
+    if ((len < GWMP_HDR_SIZE) || (buf[0] != GWMP_VERSION))
+    {
+        return;
+    }
+    uint16_t token = (buf[1] << 8) | buf[2];
+    uint8_t type = buf[3];
+
+    if (type == GWMP_PULL_DATA)
+    {
+        if (!gwKnown)
+        {
+            printf("Gateway connected (%s:%u)\n", inet_ntoa(from.sin_addr), ntohs(from.sin_port));
+        }
+        gwAddr = from;
+        gwKnown = true;
+        gwmpHeader(ack, token, GWMP_PULL_ACK, nullptr);
+        sendto(sock, ack, sizeof(ack), 0, reinterpret_cast<const struct sockaddr *>(&from), sizeof(from));
+        return;
+    }
+    if (type == GWMP_TX_ACK)
+    {
+        char err[32];
+        const char *json = reinterpret_cast<const char *>(&buf[GWMP_HDR_EUI_SIZE]);
+        const char *end = reinterpret_cast<const char *>(&buf[len]);
+        if ((len > GWMP_HDR_EUI_SIZE) && gwmpJsonString(json, end, "error", err, sizeof(err)) &&
+            (strcmp(err, "NONE") != 0))
+        {
+            printf("             TX_ACK error: %s\n", err);
+            nTxErrors++;
+        }
+        return;
+    }
+    if ((type != GWMP_PUSH_DATA) || (len < GWMP_HDR_EUI_SIZE))
+    {
+        return;
+    }
+    gwmpHeader(ack, token, GWMP_PUSH_ACK, nullptr);
+    sendto(sock, ack, sizeof(ack), 0, reinterpret_cast<const struct sockaddr *>(&from), sizeof(from));
+
+    const char *json = reinterpret_cast<const char *>(&buf[GWMP_HDR_EUI_SIZE]);
+    const char *end = reinterpret_cast<const char *>(&buf[len]);
+    const char *p = gwmpJsonFind(json, end, "rxpk");
+    const char *obj;
+    while (p && (p = gwmpJsonNextObject(p, end, obj)))
+    {
+        GwmpPacket rx;
+        if (!gwmpParsePacket(obj, p, rx) || (rx.size == 0))
+        {
+            continue;
+        }
+        nUplinks++;
+        printf("[%10.3f] ", nowMs() / 1000);
+        if (upLoss.drop())
+        {
+            printf("Uplink dropped (scripted)\n");
+            nUplinksDropped++;
+            continue;
+        }
+        uint8_t mtype = rx.data[0] & 0xE0;
+        if (mtype == MTYPE_JOIN_REQUEST)
+        {
+            handleJoinRequest(rx);
+        }
+        else if ((mtype == MTYPE_UNCONF_UP) || (mtype == MTYPE_CONF_UP))
+        {
+            handleDataUplink(rx);
+        }
+        else
+        {
+            printf("Ignoring MHDR 0x%02X\n", rx.data[0]);
+        }
+        fflush(stdout);
+    }
+}
+
+static void printSummary(void)
+{
+    printf("\n--- Summary ---\n");
+    printf("Uplinks                  %u (%u dropped, %u MIC errors, %u lost (FCnt gaps))\n",
+           nUplinks, nUplinksDropped, nMicErrors, nFCntGaps);
+    printf("JoinRequests / Accepts   %u / %u\n", nJoinRequests, nJoinAccepts);
+    printf("Downlinks                %u (%u dropped, %u TX errors)\n", nDownlinks, nDownlinksDropped, nTxErrors);
+    printf("ACK / LinkCheck / DevTime %u / %u / %u\n", nAcks, nLinkCheck, nDeviceTime);
+    joinLatency.print("Join latency");
+    cmdLatency.print("Command round trip");
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: lns_stub -k <NwkKey> [-p <port>] [-n <NetID>] [-a <DevAddr>] [-r <1|2>]\n"
+                    "                [-q <port>:<hex>]... [-u <loss %%>] [-U <list>] [-d <loss %%>] [-D <list>]\n"
+                    "                [-s <seed>] [-t <seconds>]\n");
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    int port = GWMP_PORT;
+    bool keySet = false;
+    unsigned upPercent = 0;
+    unsigned downPercent = 0;
+    uint32_t seed = 1;
+    double runTime = 0;
+    int arg = 1;
+
+    for (; arg + 1 < argc; arg += 2)
+    {
+        const char *val = argv[arg + 1];
+        if (strcmp(argv[arg], "-k") == 0)
+        {
+            keySet = parseHex(val, nwkKey, sizeof(nwkKey));
+            if (!keySet)
+            {
+                usage();
+            }
+        }
+        else if (strcmp(argv[arg], "-p") == 0)
+        {
+            port = atoi(val);
+        }
+        else if (strcmp(argv[arg], "-n") == 0)
+        {
+            netId = static_cast<uint32_t>(strtoul(val, nullptr, 16)) & 0xFFFFFF;
+        }
+        else if (strcmp(argv[arg], "-a") == 0)
+        {
+            fixedDevAddr = static_cast<uint32_t>(strtoul(val, nullptr, 16));
+        }
+        else if (strcmp(argv[arg], "-r") == 0)
+        {
+            rxWindow = (atoi(val) == 2) ? 2 : 1;
+        }
+        else if (strcmp(argv[arg], "-q") == 0)
+        {
+            Downlink q;
+            const char *hex = strchr(val, ':');
+            int p = atoi(val);
+            if (!hex || (p < 1) || (p > 223) || (strlen(hex + 1) % 2) || (strlen(hex + 1) > 2 * 51))
+            {
+                usage();
+            }
+            q.port = static_cast<uint8_t>(p);
+            q.payload.resize(strlen(hex + 1) / 2);
+            if (!parseHex(hex + 1, q.payload.data(), q.payload.size()))
+            {
+                usage();
+            }
+            queue.push_back(q);
+        }
+        else if (strcmp(argv[arg], "-u") == 0)
+        {
+            upPercent = static_cast<unsigned>(atoi(val));
+        }
+        else if (strcmp(argv[arg], "-U") == 0)
+        {
+            if (!upLoss.setList(val))
+            {
+                usage();
+            }
+        }
+        else if (strcmp(argv[arg], "-d") == 0)
+        {
+            downPercent = static_cast<unsigned>(atoi(val));
+        }
+        else if (strcmp(argv[arg], "-D") == 0)
+        {
+            if (!downLoss.setList(val))
+            {
+                usage();
+            }
+        }
+        else if (strcmp(argv[arg], "-s") == 0)
+        {
+            seed = static_cast<uint32_t>(strtoul(val, nullptr, 10));
+        }
+        else if (strcmp(argv[arg], "-t") == 0)
+        {
+            runTime = atof(val);
+        }
+        else
+        {
+            break;
+        }
+    }
+    if ((arg != argc) || !keySet)
+    {
+        usage();
+    }
+    upLoss.setRandom(upPercent, seed);
+    downLoss.setRandom(downPercent, seed * 2654435761UL);
+    srand(seed);
+
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if ((sock < 0) || (bind(sock, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0))
+    {
+        perror("bind");
+        return 1;
+    }
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    t0 = std::chrono::steady_clock::now();
+    printf("LoRaWAN network server stub listening on UDP port %d\n", port);
+    fflush(stdout);
+
+    while (!stop && ((runTime <= 0) || (nowMs() < runTime * 1000)))
+    {
+        fd_set fds;
+        struct timeval tv = {0, 100000};
+        FD_ZERO(&fds);
+        FD_SET(sock, &fds);
+        if (select(sock + 1, &fds, nullptr, nullptr, &tv) <= 0)
+        {
+            continue;
+        }
+        uint8_t buf[GWMP_BUF_SIZE];
+        struct sockaddr_in from;
+        socklen_t fromLen = sizeof(from);
+        ssize_t n = recvfrom(sock, buf, sizeof(buf) - 1, 0, reinterpret_cast<struct sockaddr *>(&from), &fromLen);
+        if (n > 0)
+        {
+            handleDatagram(buf, static_cast<size_t>(n), from);
+        }
+    }
+    close(sock);
+    printSummary();
+    return 0;
+}
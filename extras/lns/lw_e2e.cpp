@@ -0,0 +1,381 @@
+///////////////////////////////////////////////////////////////////////////////
+// lw_e2e.cpp
+//
+// End-to-end test of the node's LoRaWAN flows on the host
+//
+// Runs RadioLib's LoRaWANNode on the virtual radio (VirtualRadio.h) against a
+// network server - the stub (lns_stub.cpp) or e.g. ChirpStack with its
+// gateway bridge listening for the packet forwarder protocol:
+// - OTAA join as in lwActivate() (join time and attempts)
+// - uplinks with DeviceTimeReq / LinkCheckReq and confirmed uplinks as in loop()
+// - command downlinks CMD_GET_DATETIME / CMD_GET_LW_CONFIG answered as by
+//   sendCfgUplink() (command -> response latency)
+// - optional scripted loss on the radio path
+//
+// Build (RadioLib 6.6 sources as used by the firmware, non-Arduino build):
+//   g++ -std=c++11 -O2 -Wall -I<RadioLib>/src -I../../src -o lw_e2e lw_e2e.cpp $(find <RadioLib>/src -name '*.cpp')
+//
+// Usage:
+//   ./lns_stub -k <key> -q 32:00 &
+//   ./lw_e2e -k <key> [-e <DevEUI>] [-j <JoinEUI>] [-h <server>] [-p <port>]
+//            [-n <uplinks>] [-i <interval [s]>] [-c <confirm every n>]
+//            [-T <DeviceTime every n>] [-L <LinkCheck every n>]
+//            [-u <loss %>] [-U <list>] [-d <loss %>] [-D <list>] [-s <seed>]
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//          Ported to RadioLib 6.6 (version pinned in package.json)
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <chrono>
+#include <RadioLib.h>
+#include "VirtualRadio.h"
+#include "../host/LoraEncoderHost.h"
+#include "UplinkSchema.h"
+
+// Command codes - see src/growatt2lorawan_cmd.h
+#define CMD_GET_DATETIME 0x20
+#define CMD_GET_LW_CONFIG 0x36
+
+// Time source reported in the date/time response (E_TIME_SOURCE::E_LORA)
+#define TIME_SOURCE_LORA 2
+
+// Retry interval after failed join [ms]
+#define JOIN_RETRY_MS 10000
+
+/*!
+ * \brief Latency statistics
+ */
+struct Latency
+{
+    unsigned n = 0;
+    double sum = 0;
+    double min = 0;
+    double max = 0;
+
+    void add(double ms)
+    {
+        min = (n == 0 || ms < min) ? ms : min;
+        max = (n == 0 || ms > max) ? ms : max;
+        sum += ms;
+        n++;
+    }
+
+    void print(const char *name) const
+    {
+        if (n == 0)
+        {
+            printf("%-28s -\n", name);
+            return;
+        }
+        printf("%-28s n=%u min=%.0f ms avg=%.0f ms max=%.0f ms\n", name, n, min, sum / n, max);
+    }
+};
+
+static bool parseHex(const char *s, uint8_t *out, size_t len)
+{
+    if (strlen(s) != 2 * len)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++)
+    {
+        unsigned v;
+        if (sscanf(&s[2 * i], "%2x", &v) != 1)
+        {
+            return false;
+        }
+        out[i] = static_cast<uint8_t>(v);
+    }
+    return true;
+}
+
+static double wallMs(void)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: lw_e2e -k <NwkKey> [-e <DevEUI>] [-j <JoinEUI>] [-h <server>] [-p <port>]\n"
+                    "              [-n <uplinks>] [-i <interval [s]>] [-c <confirm every n>]\n"
+                    "              [-T <DeviceTime every n>] [-L <LinkCheck every n>]\n"
+                    "              [-u <loss %%>] [-U <list>] [-d <loss %%>] [-D <list>] [-s <seed>]\n");
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    uint8_t nwkKey[16];
+    bool keySet = false;
+    uint64_t devEui = 0x70B3D57ED0000001ULL;
+    uint64_t joinEui = 0;
+    const char *server = "127.0.0.1";
+    uint16_t port = GWMP_PORT;
+    unsigned nUplinks = 10;
+    unsigned interval = 10;
+    unsigned confirmEvery = 2;
+    unsigned timeEvery = 5;
+    unsigned linkEvery = 3;
+    unsigned upPercent = 0;
+    unsigned downPercent = 0;
+    const char *upList = "";
+    const char *downList = "";
+    uint32_t seed = 1;
+    int arg = 1;
+
+    for (; arg + 1 < argc; arg += 2)
+    {
+        const char *val = argv[arg + 1];
+        if (strcmp(argv[arg], "-k") == 0)
+            keySet = parseHex(val, nwkKey, sizeof(nwkKey));
+        else if (strcmp(argv[arg], "-e") == 0)
+            devEui = strtoull(val, nullptr, 16);
+        else if (strcmp(argv[arg], "-j") == 0)
+            joinEui = strtoull(val, nullptr, 16);
+        else if (strcmp(argv[arg], "-h") == 0)
+            server = val;
+        else if (strcmp(argv[arg], "-p") == 0)
+            port = static_cast<uint16_t>(atoi(val));
+        else if (strcmp(argv[arg], "-n") == 0)
+            nUplinks = static_cast<unsigned>(atoi(val));
+        else if (strcmp(argv[arg], "-i") == 0)
+            interval = static_cast<unsigned>(atoi(val));
+        else if (strcmp(argv[arg], "-c") == 0)
+            confirmEvery = static_cast<unsigned>(atoi(val));
+        else if (strcmp(argv[arg], "-T") == 0)
+            timeEvery = static_cast<unsigned>(atoi(val));
+        else if (strcmp(argv[arg], "-L") == 0)
+            linkEvery = static_cast<unsigned>(atoi(val));
+        else if (strcmp(argv[arg], "-u") == 0)
+            upPercent = static_cast<unsigned>(atoi(val));
+        else if (strcmp(argv[arg], "-U") == 0)
+            upList = val;
+        else if (strcmp(argv[arg], "-d") == 0)
+            downPercent = static_cast<unsigned>(atoi(val));
+        else if (strcmp(argv[arg], "-D") == 0)
+            downList = val;
+        else if (strcmp(argv[arg], "-s") == 0)
+            seed = static_cast<uint32_t>(strtoul(val, nullptr, 10));
+        else
+            break;
+    }
+    if ((arg != argc) || !keySet)
+    {
+        usage();
+    }
+
+    VirtualHal hal;
+    VirtualRadio radio(&hal, server, port);
+    radio.uplinkLoss().setRandom(upPercent, seed);
+    radio.downlinkLoss().setRandom(downPercent, seed * 2654435761UL);
+    if (!radio.uplinkLoss().setList(upList) || !radio.downlinkLoss().setList(downList))
+    {
+        usage();
+    }
+    srand(seed);
+    if (radio.begin() != RADIOLIB_ERR_NONE)
+    {
+        fprintf(stderr, "Opening UDP socket failed\n");
+        return 1;
+    }
+
+    // Same sequence as lwActivate() in growatt2lorawan-v2.ino (without persistence);
+    // LoRaWAN 1.0.x uses a single root key
+    LoRaWANNode node(&radio, &EU868, 0);
+    node.beginOTAA(joinEui, devEui, nwkKey, nwkKey);
+
+    double tJoin = wallMs();
+    unsigned joinAttempts = 0;
+    int16_t state = RADIOLIB_ERR_NETWORK_NOT_JOINED;
+    while (state != RADIOLIB_LORAWAN_NEW_SESSION)
+    {
+        joinAttempts++;
+        double t = wallMs();
+        state = node.activateOTAA();
+        printf("activateOTAA: %d (%.0f ms)\n", state, wallMs() - t);
+        if (state != RADIOLIB_LORAWAN_NEW_SESSION)
+        {
+            hal.delay(JOIN_RETRY_MS);
+        }
+    }
+    double joinMs = wallMs() - tJoin;
+    printf("Joined after %.0f ms, %u attempt(s)\n", joinMs, joinAttempts);
+
+    Latency sendReceiveNoDl;
+    Latency sendReceiveDl;
+    Latency cmdLatency;
+    Latency timeOffset;
+    unsigned nConfirmed = 0;
+    unsigned nAcked = 0;
+    unsigned nLinkCheck = 0;
+    unsigned nLinkCheckAns = 0;
+    unsigned nDeviceTime = 0;
+    unsigned nDeviceTimeAns = 0;
+    unsigned nErrors = 0;
+    uint8_t cmdPending = 0;
+    double cmdTime = 0;
+
+    for (unsigned i = 0; i < nUplinks; i++)
+    {
+        uint8_t uplinkPayload[51];
+        LoraEncoder encoder(uplinkPayload);
+        uint8_t fPort = 1;
+
+        // Response to command received in previous downlink, as sendCfgUplink()
+        if (cmdPending == CMD_GET_DATETIME)
+        {
+            fPort = cmdPending;
+            encodeDateTime(encoder, static_cast<uint32_t>(time(nullptr)), TIME_SOURCE_LORA);
+        }
+        else if (cmdPending == CMD_GET_LW_CONFIG)
+        {
+            fPort = cmdPending;
+            encodeLwConfig(encoder, 300, 900, 0);
+        }
+        else
+        {
+            encoder.writeUint32(i);
+        }
+
+        bool timeReq = timeEvery && (i % timeEvery == 0);
+        bool linkReq = linkEvery && (i % linkEvery == 0);
+        bool confirmed = confirmEvery && (i % confirmEvery == 0);
+        if (timeReq)
+        {
+            node.sendMacCommandReq(RADIOLIB_LORAWAN_MAC_DEVICE_TIME);
+            nDeviceTime++;
+        }
+        if (linkReq)
+        {
+            node.sendMacCommandReq(RADIOLIB_LORAWAN_MAC_LINK_CHECK);
+            nLinkCheck++;
+        }
+        nConfirmed += confirmed ? 1 : 0;
+
+        uint8_t downlinkPayload[256];
+        size_t downlinkSize = 0;
+        LoRaWANEvent_t uplinkDetails;
+        LoRaWANEvent_t downlinkDetails;
+        double t = wallMs();
+        state = node.sendReceive(uplinkPayload, encoder.getLength(), fPort, downlinkPayload, &downlinkSize,
+                                 confirmed, &uplinkDetails, &downlinkDetails);
+        double dt = wallMs() - t;
+        printf("#%u port %u%s%s%s: state %d, %.0f ms, ToA %lu ms", i, fPort, confirmed ? " conf" : "",
+               timeReq ? " DeviceTimeReq" : "", linkReq ? " LinkCheckReq" : "", state, dt,
+               static_cast<unsigned long>(node.getLastToA()));
+
+        if (fPort == cmdPending)
+        {
+            cmdLatency.add(wallMs() - cmdTime);
+            cmdPending = 0;
+        }
+        if (state == RADIOLIB_LORAWAN_NO_DOWNLINK)
+        {
+            sendReceiveNoDl.add(dt);
+        }
+        else if (state == RADIOLIB_ERR_NONE)
+        {
+            sendReceiveDl.add(dt);
+            if (confirmed && downlinkDetails.confirming)
+            {
+                nAcked++;
+                printf(" ACK");
+            }
+            if ((downlinkSize > 0) && (downlinkDetails.fPort > 0))
+            {
+                printf(" downlink port %u:", downlinkDetails.fPort);
+                for (size_t j = 0; j < downlinkSize; j++)
+                {
+                    printf(" %02X", downlinkPayload[j]);
+                }
+                // Commands handled by decodeDownlink() which require a response uplink
+                if (((downlinkDetails.fPort == CMD_GET_DATETIME) || (downlinkDetails.fPort == CMD_GET_LW_CONFIG)) &&
+                    (downlinkSize == 1) && (downlinkPayload[0] == 0x00))
+                {
+                    cmdPending = downlinkDetails.fPort;
+                    cmdTime = wallMs();
+                }
+            }
+        }
+        else
+        {
+            nErrors++;
+        }
+
+        uint32_t networkTime = 0;
+        uint8_t fracSecond = 0;
+        if (node.getMacDeviceTimeAns(&networkTime, &fracSecond, true) == RADIOLIB_ERR_NONE)
+        {
+            // Offset of network time against the host clock, at reception of the answer
+            double offset = networkTime * 1000.0 + fracSecond * 1000.0 / 256 - wallMs();
+            printf(" DeviceTime %u (%+.0f ms)", networkTime, offset);
+            timeOffset.add(offset < 0 ? -offset : offset);
+            nDeviceTimeAns++;
+        }
+        uint8_t margin = 0;
+        uint8_t gwCnt = 0;
+        if (node.getMacLinkCheckAns(&margin, &gwCnt) == RADIOLIB_ERR_NONE)
+        {
+            printf(" LinkCheck margin %u dB, %u gateway(s)", margin, gwCnt);
+            nLinkCheckAns++;
+        }
+        printf("\n");
+        fflush(stdout);
+
+        if (i + 1 < nUplinks)
+        {
+            unsigned long wait = interval * 1000UL;
+            unsigned long dutyCycle = node.timeUntilUplink();
+            hal.delay((dutyCycle > wait) ? dutyCycle : wait);
+        }
+    }
+
+    printf("\n--- Summary ---\n");
+    printf("Join                         %.0f ms, %u attempt(s)\n", joinMs, joinAttempts);
+    printf("Uplinks                      %u (%u errors)\n", nUplinks, nErrors);
+    printf("Confirmed / ACK received     %u / %u\n", nConfirmed, nAcked);
+    printf("LinkCheckReq / Ans           %u / %u\n", nLinkCheck, nLinkCheckAns);
+    printf("DeviceTimeReq / Ans          %u / %u\n", nDeviceTime, nDeviceTimeAns);
+    printf("Downlinks missed (no window) %u\n", radio.getMissedDownlinks());
+    sendReceiveNoDl.print("sendReceive (no downlink)");
+    sendReceiveDl.print("sendReceive (downlink)");
+    cmdLatency.print("Command -> response");
+    timeOffset.print("DeviceTime |offset|");
+    return 0;
+}
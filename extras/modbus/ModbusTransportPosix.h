@@ -0,0 +1,256 @@
+///////////////////////////////////////////////////////////////////////////////
+// ModbusTransportPosix.h
+//
+// Modbus RTU transports for POSIX hosts - serial port / pty and
+// RTU-over-TCP (see src/ModbusRtu.h)
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_MODBUSTRANSPORTPOSIX_H)
+#define _MODBUSTRANSPORTPOSIX_H
+
+#include <cstring>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <termios.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "ModbusRtu.h"
+
+/*!
+ * \brief Receive response frame from file descriptor
+ *
+ * \returns number of bytes received (0: timeout), -1 on error
+ */
+static inline int posixReceiveFrame(int fd, uint8_t *resp, size_t expected, uint32_t timeoutMs)
+{
+    using namespace std::chrono;
+    size_t len = 0;
+    auto deadline = steady_clock::now() + milliseconds(timeoutMs);
+
+    while (!modbusFrameComplete(resp, len, expected))
+    {
+        auto left = duration_cast<milliseconds>(deadline - steady_clock::now()).count();
+        if (left <= 0)
+        {
+            break;
+        }
+        struct pollfd pfd = {fd, POLLIN, 0};
+        int rc = poll(&pfd, 1, static_cast<int>(left));
+        if (rc < 0)
+        {
+            return -1;
+        }
+        if (rc == 0)
+        {
+            break;
+        }
+        ssize_t n = read(fd, resp + len, expected - len);
+        if (n <= 0)
+        {
+            // Peer closed connection / pty hangup
+            return len ? static_cast<int>(len) : -1;
+        }
+        len += n;
+    }
+    return static_cast<int>(len);
+}
+
+/*!
+ * \brief Write complete buffer to file descriptor
+ */
+static inline bool posixWriteAll(int fd, const uint8_t *buf, size_t size)
+{
+    while (size)
+    {
+        ssize_t n = write(fd, buf, size);
+        if (n <= 0)
+        {
+            return false;
+        }
+        buf += n;
+        size -= n;
+    }
+    return true;
+}
+
+/*!
+ * \brief Modbus RTU transport over a POSIX serial port or pty
+ */
+class ModbusTransportPosixSerial : public ModbusTransport
+{
+public:
+    ~ModbusTransportPosixSerial()
+    {
+        if (_fd >= 0)
+        {
+            close(_fd);
+        }
+    }
+
+    /*!
+     * \brief Open serial port (8N1, raw mode)
+     *
+     * \param path device path (e.g. /dev/ttyUSB0 or /dev/pts/N)
+     * \param baud data rate (ignored by ptys)
+     *
+     * \returns true on success
+     */
+    bool begin(const char *path, unsigned baud)
+    {
+        _fd = open(path, O_RDWR | O_NOCTTY);
+        if (_fd < 0)
+        {
+            return false;
+        }
+        struct termios tio;
+        if (tcgetattr(_fd, &tio) < 0)
+        {
+            return false;
+        }
+        cfmakeraw(&tio);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tio.c_cc[VMIN] = 0;
+        tio.c_cc[VTIME] = 0;
+        speed_t speed = (baud == 115200) ? B115200 : (baud == 19200) ? B19200 : B9600;
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+        return tcsetattr(_fd, TCSANOW, &tio) == 0;
+    }
+
+    int transact(const uint8_t *req, size_t reqLen, uint8_t *resp, size_t expected, uint32_t timeoutMs) override
+    {
+        if (_fd < 0)
+        {
+            return -1;
+        }
+        // Discard stale data
+        tcflush(_fd, TCIFLUSH);
+        if (!posixWriteAll(_fd, req, reqLen))
+        {
+            return -1;
+        }
+        tcdrain(_fd);
+        return posixReceiveFrame(_fd, resp, expected, timeoutMs);
+    }
+
+private:
+    int _fd = -1;
+};
+
+/*!
+ * \brief Modbus RTU-over-TCP transport (POSIX sockets)
+ */
+class ModbusTransportPosixTcp : public ModbusTransport
+{
+public:
+    ~ModbusTransportPosixTcp()
+    {
+        if (_fd >= 0)
+        {
+            close(_fd);
+        }
+    }
+
+    /*!
+     * \brief Connect to gateway
+     *
+     * \param host gateway host name or IP address
+     * \param port gateway TCP port
+     *
+     * \returns true on success
+     */
+    bool begin(const char *host, const char *port)
+    {
+        struct addrinfo hints;
+        struct addrinfo *res;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        if (getaddrinfo(host, port, &hints, &res) != 0)
+        {
+            return false;
+        }
+        for (struct addrinfo *ai = res; ai; ai = ai->ai_next)
+        {
+            _fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+            if (_fd < 0)
+            {
+                continue;
+            }
+            if (connect(_fd, ai->ai_addr, ai->ai_addrlen) == 0)
+            {
+                break;
+            }
+            close(_fd);
+            _fd = -1;
+        }
+        freeaddrinfo(res);
+        if (_fd < 0)
+        {
+            return false;
+        }
+        // Requests are small - send immediately
+        int one = 1;
+        setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        return true;
+    }
+
+    int transact(const uint8_t *req, size_t reqLen, uint8_t *resp, size_t expected, uint32_t timeoutMs) override
+    {
+        if (_fd < 0)
+        {
+            return -1;
+        }
+        // Discard stale data (e.g. late response to a timed out request)
+        uint8_t tmp[64];
+        while (recv(_fd, tmp, sizeof(tmp), MSG_DONTWAIT) > 0)
+            ;
+        if (!posixWriteAll(_fd, req, reqLen))
+        {
+            return -1;
+        }
+        return posixReceiveFrame(_fd, resp, expected, timeoutMs);
+    }
+
+private:
+    int _fd = -1;
+};
+#endif // _MODBUSTRANSPORTPOSIX_H
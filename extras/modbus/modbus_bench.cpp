@@ -0,0 +1,388 @@
+///////////////////////////////////////////////////////////////////////////////
+// modbus_bench.cpp
+//
+// Host tool for the Modbus transports - runs the node's acquisition
+// sequence (input registers 0...63 and 64...127, holding registers 0...63,
+// see growattIF) through ModbusRtuMaster (src/ModbusRtu.h) and reports
+// latency and error statistics
+//
+// The transport is selected on the command line:
+//   pty     - built-in inverter emulator on a pseudo terminal, accessed via
+//             the POSIX serial transport (same code path as a real port)
+//   tcp-emu - built-in inverter emulator on a local TCP port, accessed via
+//             the RTU-over-TCP transport
+//   serial  - real serial port (e.g. USB/RS485 adapter)
+//   tcp     - real RTU-over-TCP gateway (transparent mode)
+//
+// With the built-in emulator, every register value is verified.
+//
+// With -r <file>, all transactions are recorded in the node's record format
+// (see src/ModbusRecorder.h) for replay with modbus_replay.
+//
+// Build:
+//   g++ -std=c++11 -O2 -Wall -I../../src -o modbus_bench modbus_bench.cpp -lutil -lpthread
+//
+// Usage:
+//   ./modbus_bench [-n <cycles>] [-r <file>] pty
+//   ./modbus_bench [-n <cycles>] [-r <file>] tcp-emu
+//   ./modbus_bench [-n <cycles>] [-r <file>] serial <device> [<baud>]
+//   ./modbus_bench [-n <cycles>] [-r <file>] tcp <host> <port>
+//
+// Exit code: 0 - no errors / 1 - failure
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//          Added recording (-r)
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <pty.h>
+#include <arpa/inet.h>
+#include <ctime>
+#include "ModbusRtu.h"
+#include "ModbusRecorder.h"
+#include "ModbusTransportPosix.h"
+
+#define SLAVE_ID 1
+
+// Acquisition sequence: function, address, quantity
+static const struct
+{
+    uint8_t function;
+    uint16_t addr;
+    uint16_t qty;
+} sequence[] = {
+    {0x04, 0, 64},
+    {0x04, 64, 64},
+    {0x03, 0, 64},
+};
+
+// Emulated register value
+static uint16_t emuRegister(uint8_t function, uint16_t addr)
+{
+    return static_cast<uint16_t>((function << 12) ^ (addr * 0x9E37u));
+}
+
+/*!
+ * \brief Minimal Modbus RTU slave serving emulated registers on a file descriptor
+ */
+static void emulator(int fd)
+{
+    uint8_t req[8];
+    uint8_t resp[MB_FRAME_MAX];
+
+    for (;;)
+    {
+        // Requests of all supported functions have 8 bytes
+        int len = posixReceiveFrame(fd, req, sizeof(req), 60000);
+        if (len < 0)
+        {
+            return;
+        }
+        if ((len != 8) || (req[0] != SLAVE_ID))
+        {
+            continue;
+        }
+        uint16_t crc = modbusCrc16(req, 6);
+        if ((req[6] != (crc & 0xFF)) || (req[7] != (crc >> 8)))
+        {
+            continue;
+        }
+        uint16_t addr = (req[2] << 8) | req[3];
+        uint16_t val = (req[4] << 8) | req[5];
+        size_t size;
+
+        resp[0] = SLAVE_ID;
+        resp[1] = req[1];
+        if (((req[1] == 0x03) || (req[1] == 0x04)) && (val >= 1) && (val <= MB_REGS_MAX))
+        {
+            resp[2] = static_cast<uint8_t>(2 * val);
+            for (uint16_t i = 0; i < val; i++)
+            {
+                uint16_t r = emuRegister(req[1], addr + i);
+                resp[3 + 2 * i] = r >> 8;
+                resp[4 + 2 * i] = r & 0xFF;
+            }
+            size = 3 + 2 * val;
+        }
+        else if (req[1] == 0x06)
+        {
+            memcpy(resp, req, 6);
+            size = 6;
+        }
+        else
+        {
+            resp[1] |= 0x80;
+            resp[2] = 0x01; // illegal function
+            size = 3;
+        }
+        crc = modbusCrc16(resp, size);
+        resp[size++] = crc & 0xFF;
+        resp[size++] = crc >> 8;
+        if (!posixWriteAll(fd, resp, size))
+        {
+            return;
+        }
+    }
+}
+
+// Record file
+static FILE *recordFile = nullptr;
+
+static void recordSink(const char *line)
+{
+    fprintf(recordFile, "%s\n", line);
+}
+
+static uint32_t recordMillis(void)
+{
+    static auto t0 = std::chrono::steady_clock::now();
+    return static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count());
+}
+
+static uint32_t recordUnixTime(void)
+{
+    return static_cast<uint32_t>(time(nullptr));
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: modbus_bench [-n <cycles>] [-r <file>] pty | tcp-emu | serial <device> [<baud>] | tcp <host> <port>\n");
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    int cycles = 1000;
+    int arg = 1;
+
+    for (; arg + 1 < argc; arg += 2)
+    {
+        if (strcmp(argv[arg], "-n") == 0)
+        {
+            cycles = atoi(argv[arg + 1]);
+        }
+        else if (strcmp(argv[arg], "-r") == 0)
+        {
+            recordFile = fopen(argv[arg + 1], "w");
+            if (!recordFile)
+            {
+                perror(argv[arg + 1]);
+                return 1;
+            }
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (arg >= argc)
+    {
+        usage();
+    }
+    const char *mode = argv[arg];
+
+    ModbusTransportPosixSerial serial;
+    ModbusTransportPosixTcp tcp;
+    ModbusTransport *transport = nullptr;
+    bool emulated = false;
+
+    if (strcmp(mode, "pty") == 0)
+    {
+        int master;
+        int slave;
+        char name[64];
+        if (openpty(&master, &slave, name, nullptr, nullptr) < 0)
+        {
+            perror("openpty");
+            return 1;
+        }
+        // Emulator on the master side, raw mode on the slave side
+        struct termios tio;
+        tcgetattr(master, &tio);
+        cfmakeraw(&tio);
+        tcsetattr(master, TCSANOW, &tio);
+        std::thread(emulator, master).detach();
+        if (!serial.begin(name, 9600))
+        {
+            perror(name);
+            return 1;
+        }
+        close(slave);
+        transport = &serial;
+        emulated = true;
+        printf("Transport: pty (%s)\n", name);
+    }
+    else if (strcmp(mode, "tcp-emu") == 0)
+    {
+        int lfd = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in sa;
+        socklen_t salen = sizeof(sa);
+        memset(&sa, 0, sizeof(sa));
+        sa.sin_family = AF_INET;
+        sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if ((bind(lfd, reinterpret_cast<sockaddr *>(&sa), sizeof(sa)) < 0) || (listen(lfd, 1) < 0) ||
+            (getsockname(lfd, reinterpret_cast<sockaddr *>(&sa), &salen) < 0))
+        {
+            perror("socket");
+            return 1;
+        }
+        std::thread([lfd]() {
+            int fd = accept(lfd, nullptr, nullptr);
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            emulator(fd);
+        }).detach();
+        char port[8];
+        snprintf(port, sizeof(port), "%u", ntohs(sa.sin_port));
+        if (!tcp.begin("127.0.0.1", port))
+        {
+            perror("connect");
+            return 1;
+        }
+        transport = &tcp;
+        emulated = true;
+        printf("Transport: RTU-over-TCP (emulator on 127.0.0.1:%s)\n", port);
+    }
+    else if ((strcmp(mode, "serial") == 0) && (arg + 1 < argc))
+    {
+        unsigned baud = (arg + 2 < argc) ? atoi(argv[arg + 2]) : 9600;
+        if (!serial.begin(argv[arg + 1], baud))
+        {
+            perror(argv[arg + 1]);
+            return 1;
+        }
+        transport = &serial;
+        printf("Transport: serial (%s, %u bps)\n", argv[arg + 1], baud);
+    }
+    else if ((strcmp(mode, "tcp") == 0) && (arg + 2 < argc))
+    {
+        if (!tcp.begin(argv[arg + 1], argv[arg + 2]))
+        {
+            perror("connect");
+            return 1;
+        }
+        transport = &tcp;
+        printf("Transport: RTU-over-TCP (%s:%s)\n", argv[arg + 1], argv[arg + 2]);
+    }
+    else
+    {
+        usage();
+    }
+
+    ModbusRecorder recorder;
+    if (recordFile)
+    {
+        recorder.begin(*transport, recordSink, recordMillis, recordUnixTime);
+        transport = &recorder;
+    }
+
+    ModbusRtuMaster master;
+    master.begin(SLAVE_ID, *transport);
+
+    std::vector<double> latency;
+    unsigned errors[256] = {0};
+    unsigned mismatches = 0;
+    size_t nSeq = sizeof(sequence) / sizeof(sequence[0]);
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (int c = 0; c < cycles; c++)
+    {
+        for (size_t s = 0; s < nSeq; s++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            uint8_t result = (sequence[s].function == 0x04)
+                                 ? master.readInputRegisters(sequence[s].addr, sequence[s].qty)
+                                 : master.readHoldingRegisters(sequence[s].addr, sequence[s].qty);
+            auto end = std::chrono::steady_clock::now();
+            latency.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+            if (result != ModbusRtuMaster::ku8MBSuccess)
+            {
+                errors[result]++;
+                continue;
+            }
+            if (emulated)
+            {
+                for (uint16_t i = 0; i < sequence[s].qty; i++)
+                {
+                    if (master.getResponseBuffer(i) != emuRegister(sequence[s].function, sequence[s].addr + i))
+                    {
+                        mismatches++;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::sort(latency.begin(), latency.end());
+    double sum = 0;
+    for (double l : latency)
+    {
+        sum += l;
+    }
+    size_t n = latency.size();
+    printf("Transactions: %zu in %.3f s (%.0f/s)\n", n, total, n / total);
+    if (n)
+    {
+        printf("Latency [us]: min %.1f  avg %.1f  p50 %.1f  p99 %.1f  max %.1f\n",
+               latency[0], sum / n, latency[n / 2], latency[n * 99 / 100], latency[n - 1]);
+    }
+    unsigned failed = mismatches;
+    for (int i = 0; i < 256; i++)
+    {
+        if (errors[i])
+        {
+            printf("Errors 0x%02X: %u\n", i, errors[i]);
+            failed += errors[i];
+        }
+    }
+    if (emulated)
+    {
+        printf("Data mismatches: %u\n", mismatches);
+    }
+    if (recordFile)
+    {
+        fclose(recordFile);
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,364 @@
+///////////////////////////////////////////////////////////////////////////////
+// modbus_replay.cpp
+//
+// Host-side replay of recorded Modbus RTU traffic (see src/ModbusRecorder.h)
+//
+// The recorded responses are fed through the node's ModbusRtuMaster, input
+// register readouts are decoded with growattDecodeInputRegisters() and encoded
+// with the node's uplink payload layout (ports 1 and 2). The resulting
+// payloads can be written to or compared against a golden file, and the
+// decode/encode path can be benchmarked against the recorded data.
+//
+// Build: g++ -std=c++11 -O2 -Wall -I../../src -o modbus_replay modbus_replay.cpp
+//
+// Usage: modbus_replay [-s <slave>] [-w <golden>] [-g <golden>] [-b <iterations>] <capture>
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "ModbusRtu.h"
+#include "ModbusRecorder.h"
+#include "GrowattDecode.h"
+#include "../host/LoraEncoderHost.h"
+#include "UplinkSchema.h"
+
+// Number of input registers read by the node (2 blocks of 64 registers)
+#define NUM_INPUT_REGISTERS 128
+
+/*!
+ * \brief Transport returning the recorded responses
+ *
+ * The request issued by ModbusRtuMaster is compared against the recorded
+ * request to detect deviations of the frame construction.
+ */
+class ReplayTransport : public ModbusTransport
+{
+public:
+    const ModbusRecord *rec = nullptr;
+    unsigned int mismatches = 0;
+
+    int transact(const uint8_t *req, size_t reqLen, uint8_t *resp, size_t expected, uint32_t timeoutMs) override
+    {
+        (void)expected;
+        (void)timeoutMs;
+        if ((reqLen != rec->reqLen) || (memcmp(req, rec->req, reqLen) != 0))
+        {
+            mismatches++;
+        }
+        if (rec->len > 0)
+        {
+            memcpy(resp, rec->resp, rec->len);
+        }
+        return rec->len;
+    }
+};
+
+// Uplink payload derived from a complete input register readout
+struct Uplink
+{
+    uint32_t unixTime;
+    uint8_t port;
+    std::vector<uint8_t> payload;
+};
+
+static std::string toHex(const std::vector<uint8_t> &buf)
+{
+    std::string s;
+    char h[3];
+    for (uint8_t b : buf)
+    {
+        snprintf(h, sizeof(h), "%02X", b);
+        s += h;
+    }
+    return s;
+}
+
+// Decode register image and encode the payloads of ports 1 and 2
+static void encodeUplinks(const uint16_t *regs, uint32_t unixTime, std::vector<Uplink> &out)
+{
+    growatt_input_registers d;
+    uint8_t buf[64];
+
+    growattDecodeInputRegisters(regs, d);
+    {
+        LoraEncoder encoder(buf);
+        encodeInverterStatus(encoder, d);
+        out.push_back({unixTime, 1, std::vector<uint8_t>(buf, buf + encoder.getLength())});
+    }
+    {
+        LoraEncoder encoder(buf);
+        encodeInverterPv1(encoder, d);
+        out.push_back({unixTime, 2, std::vector<uint8_t>(buf, buf + encoder.getLength())});
+    }
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: modbus_replay [-s <slave>] [-w <golden>] [-g <golden>] [-b <iterations>] <capture>\n");
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    int slave = 1;
+    const char *writeFile = nullptr;
+    const char *goldenFile = nullptr;
+    long iterations = 0;
+    int arg = 1;
+
+    for (; arg + 1 < argc; arg += 2)
+    {
+        if (strcmp(argv[arg], "-s") == 0)
+        {
+            slave = atoi(argv[arg + 1]);
+        }
+        else if (strcmp(argv[arg], "-w") == 0)
+        {
+            writeFile = argv[arg + 1];
+        }
+        else if (strcmp(argv[arg], "-g") == 0)
+        {
+            goldenFile = argv[arg + 1];
+        }
+        else if (strcmp(argv[arg], "-b") == 0)
+        {
+            iterations = atol(argv[arg + 1]);
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (arg != argc - 1)
+    {
+        usage();
+    }
+
+    FILE *f = fopen(argv[arg], "r");
+    if (!f)
+    {
+        perror(argv[arg]);
+        return 1;
+    }
+    std::vector<ModbusRecord> records;
+    char line[2 * MB_RECORD_LINE_MAX];
+    while (fgets(line, sizeof(line), f))
+    {
+        ModbusRecord rec;
+        if (modbusParseRecord(line, rec))
+        {
+            records.push_back(rec);
+        }
+    }
+    fclose(f);
+    printf("Records: %zu\n", records.size());
+
+    // Replay all transactions through the Modbus master
+    ReplayTransport transport;
+    ModbusRtuMaster master;
+    unsigned int histogram[256] = {0};
+    unsigned int unsupported = 0;
+    uint32_t durMin = UINT32_MAX;
+    uint32_t durMax = 0;
+    uint64_t durSum = 0;
+    uint16_t regs[NUM_INPUT_REGISTERS];
+    bool haveBlock0 = false;
+    std::vector<Uplink> uplinks;
+    std::vector<std::vector<uint16_t>> images;
+    std::vector<uint32_t> imageTimes;
+
+    for (const ModbusRecord &rec : records)
+    {
+        if (rec.reqLen != 8)
+        {
+            unsupported++;
+            continue;
+        }
+        uint8_t function = rec.req[1];
+        uint16_t addr = (rec.req[2] << 8) | rec.req[3];
+        uint16_t val = (rec.req[4] << 8) | rec.req[5];
+        uint8_t result;
+
+        transport.rec = &rec;
+        master.begin(rec.req[0], transport);
+        if (function == 0x04)
+        {
+            result = master.readInputRegisters(addr, val);
+        }
+        else if (function == 0x03)
+        {
+            result = master.readHoldingRegisters(addr, val);
+        }
+        else if (function == 0x06)
+        {
+            result = master.writeSingleRegister(addr, val);
+        }
+        else
+        {
+            unsupported++;
+            continue;
+        }
+        histogram[result]++;
+        durMin = (rec.duration < durMin) ? rec.duration : durMin;
+        durMax = (rec.duration > durMax) ? rec.duration : durMax;
+        durSum += rec.duration;
+
+        // Assemble input register readouts as done by growattIF::ReadInputRegisters()
+        if ((function != 0x04) || (rec.req[0] != slave) || (val != 64))
+        {
+            continue;
+        }
+        if (result != ModbusRtuMaster::ku8MBSuccess)
+        {
+            haveBlock0 = false;
+            continue;
+        }
+        if (addr == 0)
+        {
+            for (int i = 0; i < 64; i++)
+            {
+                regs[i] = master.getResponseBuffer(i);
+            }
+            haveBlock0 = true;
+        }
+        else if ((addr == 64) && haveBlock0)
+        {
+            for (int i = 0; i < 64; i++)
+            {
+                regs[64 + i] = master.getResponseBuffer(i);
+            }
+            haveBlock0 = false;
+            encodeUplinks(regs, rec.unixTime, uplinks);
+            images.push_back(std::vector<uint16_t>(regs, regs + NUM_INPUT_REGISTERS));
+            imageTimes.push_back(rec.unixTime);
+        }
+    }
+
+    size_t replayed = records.size() - unsupported;
+    printf("Transactions: %zu replayed, %u unsupported, %u request mismatches\n",
+           replayed, unsupported, transport.mismatches);
+    if (replayed)
+    {
+        printf("Duration [ms]: min %u / avg %.1f / max %u\n",
+               durMin, static_cast<double>(durSum) / replayed, durMax);
+    }
+    for (int r = 0; r < 256; r++)
+    {
+        if (histogram[r])
+        {
+            printf("Result 0x%02X: %u\n", r, histogram[r]);
+        }
+    }
+    printf("Readouts: %zu\n", images.size());
+
+    int ret = (transport.mismatches > 0) ? 1 : 0;
+
+    if (writeFile)
+    {
+        FILE *w = fopen(writeFile, "w");
+        if (!w)
+        {
+            perror(writeFile);
+            return 1;
+        }
+        for (const Uplink &u : uplinks)
+        {
+            fprintf(w, "%u %u %s\n", u.unixTime, u.port, toHex(u.payload).c_str());
+        }
+        fclose(w);
+        printf("Golden file written: %s (%zu uplinks)\n", writeFile, uplinks.size());
+    }
+
+    if (goldenFile)
+    {
+        FILE *g = fopen(goldenFile, "r");
+        if (!g)
+        {
+            perror(goldenFile);
+            return 1;
+        }
+        size_t idx = 0;
+        unsigned int diffs = 0;
+        char hex[512];
+        unsigned int unixTime;
+        unsigned int port;
+        while (fscanf(g, "%u %u %511s", &unixTime, &port, hex) == 3)
+        {
+            if ((idx >= uplinks.size()) || (uplinks[idx].unixTime != unixTime) ||
+                (uplinks[idx].port != port) || (toHex(uplinks[idx].payload) != hex))
+            {
+                if (diffs++ < 10)
+                {
+                    printf("Mismatch in uplink #%zu (port %u): expected %s, got %s\n", idx, port, hex,
+                           (idx < uplinks.size()) ? toHex(uplinks[idx].payload).c_str() : "-");
+                }
+            }
+            idx++;
+        }
+        fclose(g);
+        if (idx != uplinks.size())
+        {
+            printf("Number of uplinks differs: expected %zu, got %zu\n", idx, uplinks.size());
+            diffs++;
+        }
+        printf("Golden comparison: %s\n", diffs ? "FAILED" : "passed");
+        ret |= diffs ? 1 : 0;
+    }
+
+    if ((iterations > 0) && !images.empty())
+    {
+        // Decode and encode throughput - the result is accumulated to keep
+        // the compiler from optimizing the loop away
+        std::vector<Uplink> tmp;
+        uint32_t check = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (long i = 0; i < iterations; i++)
+        {
+            tmp.clear();
+            encodeUplinks(images[i % images.size()].data(), imageTimes[i % images.size()], tmp);
+            check += tmp[0].payload[2] + tmp[1].payload[0];
+        }
+        double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        printf("Decode + encode: %ld readouts in %.3f s (%.0f readouts/s, %.2f us/readout) [%08X]\n",
+               iterations, s, iterations / s, 1e6 * s / iterations, check);
+    }
+    return ret;
+}
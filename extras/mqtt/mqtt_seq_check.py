@@ -0,0 +1,93 @@
+###################################################################################################
+# mqtt_seq_check.py
+#
+# Checks the samples published by the Wi-Fi/MQTT fast path (MQTT_FASTPATH) for
+# gaps, duplicates and out-of-order sequence numbers.
+#
+# Reads the output of mosquitto_sub with topic names (-v) from stdin, e.g.:
+#
+#   mosquitto -v
+#   mosquitto_sub -h localhost -t 'growatt2lorawan/#' -v | python3 mqtt_seq_check.py
+#
+# A summary is printed on end of input (Ctrl-C / Ctrl-D).
+#
+# created: 10/2026
+#
+#
+# MIT License
+#
+# Copyright (c) 2024 Matthias Prinke
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+#
+# History:
+#
+# 20261017 Created
+#
+# ToDo:
+# -
+###################################################################################################
+import json
+import sys
+
+
+def main():
+    seen = set()
+    last = None
+    gaps = 0
+    duplicates = 0
+    reordered = 0
+    messages = 0
+    try:
+        for line in sys.stdin:
+            topic, _, payload = line.strip().partition(' ')
+            if topic.endswith('/data'):
+                data = json.loads(payload)
+                print(f"data:    seq {data['seq']}, {data['outputpower']:.1f} W")
+                continue
+            if not topic.endswith('/samples'):
+                continue
+            messages += 1
+            samples = json.loads(payload)['samples']
+            for rec in samples:
+                seq = rec['seq']
+                if seq in seen:
+                    duplicates += 1
+                    continue
+                seen.add(seq)
+                if last is not None:
+                    diff = (seq - last) & 0xFFFF
+                    if diff > 0x8000:
+                        reordered += 1
+                        continue
+                    if diff > 1:
+                        gaps += 1
+                        print(f"gap:     #{(last + 1) & 0xFFFF}...#{(seq - 1) & 0xFFFF}")
+                last = seq
+            print(f"samples: {len(samples)} (#{samples[0]['seq']}...#{samples[-1]['seq']})" if samples else "samples: 0")
+    except KeyboardInterrupt:
+        pass
+    print(f"messages: {messages}, samples: {len(seen)}, gaps: {gaps}, duplicates: {duplicates}, "
+          f"out of order: {reordered}")
+    return 1 if gaps or reordered else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
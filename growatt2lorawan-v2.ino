@@ -54,6 +54,24 @@
 // 20240814 Initial draft version
 // 20240820 Fixed sleep time calculation
 // 20240828 Renamed Preferences: BWS-LW to GRO2LW
+// 20261017 Added sample-only wake-ups for power curve compression
+//          Added data rate dependent maximum payload size
+//          Skip uplink if no payload is provided (dual-prediction reporting)
+//          Added pending AppLayer uplink requests (backfill)
+//          Register transmitted uplinks with AppLayer (cross-frame parity)
+//          Send oversized payloads fragmented instead of truncating
+//          Replaced confirmed uplink on every 64th frame by link policy
+//          Added margin-driven data rate / TX power optimisation
+//          Added low-latency downlink polling on external power
+//          Added draining of queued downlinks
+//          Added ABP activation mode
+//          Added radio sleep with latched NSS/RESET during deep sleep
+//          Added wake-cycle guard (phase deadlines, cycle budget, incident recovery)
+//          Added health statistics (app status uplink)
+//          Added Wi-Fi/MQTT fast path
+//          Added diagnostic burst (CMD_START_BURST)
+//          Moved sleep interval alignment to SleepSchedule.h
+//          Maximum payload size from the data rate of the next uplink
 //
 //
 // Notes:
@@ -86,6 +104,10 @@
 #include "src/growatt_cfg.h"
 #include "src/growatt2lorawan_cmd.h"
 #include "src/AppLayer.h"
+#include "src/LinkPolicy.h"
+#include "src/WakeGuard.h"
+#include "src/HealthStats.h"
+#include "src/SleepSchedule.h"
 #include "src/LoadSecrets.h"
 
 /// Modbus interface select: 0 - USB / 1 - RS485
@@ -130,6 +152,8 @@ RTC_DATA_ATTR E_TIME_SOURCE rtcTimeSource;
 RTC_DATA_ATTR bool appStatusUplinkPending = false;
 RTC_DATA_ATTR bool lwStatusUplinkPending = false;
 RTC_DATA_ATTR uint8_t LWsession[RADIOLIB_LORAWAN_SESSION_BUF_SIZE];
+RTC_DATA_ATTR uint8_t rtcUplinkDatarate = 0; //!< data rate of last transmitted uplink
+RTC_DATA_ATTR time_t rtcNextUplink = 0;      //!< time of next uplink (power curve sampling)
 
 #else
 // Saved to/restored from Watchdog SCRATCH registers
@@ -152,6 +176,12 @@ bool appStatusUplinkPending __attribute__((section(".uninitialized_data")));
 
 /// LoRaWAN Node status uplink pending
 bool lwStatusUplinkPending __attribute__((section(".uninitialized_data")));
+
+/// Data rate of last uplink
+uint8_t rtcUplinkDatarate __attribute__((section(".uninitialized_data")));
+
+/// Time of next uplink (power curve sampling)
+time_t rtcNextUplink __attribute__((section(".uninitialized_data")));
 #endif
 
 /// Real time clock
@@ -160,6 +190,44 @@ ESP32Time rtc;
 /// Application layer
 AppLayer appLayer(&rtc, &rtcLastClockSync);
 
+/// Link policy (confirmed uplinks / link loss detection)
+LinkPolicy linkPolicy;
+
+/// Radio has been initialized in this wake-up cycle
+bool radioActive = false;
+
+/// Wake-cycle guard (phase deadlines / cycle budget)
+WakeGuard wakeGuard;
+
+/// Node health telemetry (LoRaWAN counters; shared state with AppLayer)
+HealthStats healthStats;
+
+#if defined(ESP32) && RADIO_SLEEP_HOLD
+/*!
+ * \brief Put radio into sleep mode and keep it there during deep sleep
+ *
+ * NSS (inactive) and RESET (inactive) are latched during deep sleep,
+ * otherwise the floating pins might wake up or reset the radio.
+ */
+void radioSleep(void)
+{
+  if (!radioActive)
+  {
+    return;
+  }
+  if (radio.sleep() != RADIOLIB_ERR_NONE)
+  {
+    return;
+  }
+  gpio_hold_en(static_cast<gpio_num_t>(radio.getMod()->getCs()));
+  if (radio.getMod()->getRst() != RADIOLIB_NC)
+  {
+    gpio_hold_en(static_cast<gpio_num_t>(radio.getMod()->getRst()));
+  }
+  gpio_deep_sleep_hold_en();
+}
+#endif
+
 #if defined(ESP32)
 /*!
  * \brief Print wakeup reason (ESP32 only)
@@ -188,6 +256,51 @@ uint16_t getBatteryVoltage()
   return 0;
 }
 
+/*!
+ * \brief Get maximum uplink payload size
+ *
+ * The maximum payload size depends on the data rate of the next uplink.
+ * Region.payloadLenMax[] is the maximum MACPayload size M, which includes
+ * FHDR (7 bytes without FOpts) and FPort (1 byte); additionally, space is
+ * reserved for MAC commands (max. 15 bytes in FOpts).
+ * Example: EU868 DR3 - M = 123, application payload 123 - 8 - 15 = 100 bytes.
+ * The result is at least PAYLOAD_SIZE.
+ *
+ * \param datarate data rate of the next uplink
+ *
+ * \returns maximum payload size in bytes
+ */
+uint8_t getPayloadSizeMax(uint8_t datarate)
+{
+  if (datarate >= sizeof(Region.payloadLenMax))
+  {
+    return PAYLOAD_SIZE;
+  }
+  uint8_t size = Region.payloadLenMax[datarate];
+  size = (size > PAYLOAD_SIZE + 8 + 15) ? size - 8 - 15 : PAYLOAD_SIZE;
+  return min(size, PAYLOAD_SIZE_MAX);
+}
+
+/*!
+ * \brief Update AppLayer's maximum payload size for the next uplink
+ *
+ * With LP_DR_OPTIMISER, the data rate is selected by the link policy.
+ * Otherwise (network ADR), the data rate of the last transmitted uplink
+ * is used - RadioLib does not provide the node's current data rate.
+ *
+ * \returns maximum payload size in bytes
+ */
+uint8_t updatePayloadSizeMax(void)
+{
+#if LP_DR_OPTIMISER
+  uint8_t size = getPayloadSizeMax(linkPolicy.getDatarate());
+#else
+  uint8_t size = getPayloadSizeMax(rtcUplinkDatarate);
+#endif
+  appLayer.setPayloadSizeMax(size);
+  return size;
+}
+
 /*!
  * \brief Compute sleep duration
  *
@@ -224,18 +337,40 @@ uint32_t sleepDuration(uint16_t battery_weak)
     time_t t_now = rtc.getLocalEpoch();
     localtime_r(&t_now, &timeinfo);
 
-    uint32_t diff = (timeinfo.tm_min * 60) % sleep_interval + timeinfo.tm_sec;
-    if (diff > sleep_interval)
-    {
-      diff -= sleep_interval;
-    }
-    sleep_interval = sleep_interval - diff;
+    sleep_interval = alignSleepInterval(sleep_interval, timeinfo);
   }
 
   sleep_interval = max(sleep_interval, static_cast<uint32_t>(SLEEP_INTERVAL_MIN));
   return sleep_interval;
 }
 
+/*!
+ * \brief Save LoRaWAN session to RTC RAM
+ *
+ * Saved after each scheduled uplink, so the frame counter is not reused
+ * if the wake-up cycle is aborted by the wake guard.
+ */
+void saveSession(void)
+{
+  if (!node.isActivated())
+  {
+    return;
+  }
+  uint8_t *persist = node.getBufferSession();
+  memcpy(LWsession, persist, RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
+}
+
+/*!
+ * \brief Wake guard sleep hook - save state before forced sleep
+ *
+ * \returns sleep duration in seconds
+ */
+uint32_t wakeGuardSleepHook(void)
+{
+  saveSession();
+  return sleepDuration(BATTERY_WEAK);
+}
+
 #if defined(ESP32)
 /*!
  * \brief Enter sleep mode (ESP32 variant)
@@ -247,6 +382,12 @@ uint32_t sleepDuration(uint16_t battery_weak)
 void gotoSleep(uint32_t seconds)
 {
   log_i("Sleeping for %lu s", seconds);
+  wakeGuard.enter(E_WAKE_PHASE::E_SLEEP);
+#if RADIO_SLEEP_HOLD
+  radioSleep();
+#endif
+  healthStats.endCycle(millis());
+  wakeGuard.end();
   esp_sleep_enable_timer_wakeup(seconds * 1000UL * 1000UL); // function uses uS
   Serial.flush();
 
@@ -268,6 +409,8 @@ void gotoSleep(uint32_t seconds)
 void gotoSleep(uint32_t seconds)
 {
   log_i("Sleeping for %lu s", seconds);
+  healthStats.endCycle(millis());
+  wakeGuard.end();
   time_t t_now = rtc.getLocalEpoch();
   datetime_t dt;
   epoch_to_datetime(&t_now, &dt);
@@ -346,6 +489,7 @@ int16_t lwActivate(void)
       log_d("Succesfully restored session - now activating");
       state = node.activateOTAA();
       debug((state != RADIOLIB_LORAWAN_SESSION_RESTORED), "Failed to activate restored session", state, true);
+      healthStats.sessionRestored();
 
       // ##### close the store before returning
       store.end();
@@ -362,6 +506,7 @@ int16_t lwActivate(void)
   while (state != RADIOLIB_LORAWAN_NEW_SESSION)
   {
     log_d("Join ('login') to the LoRaWAN Network");
+    healthStats.joinAttempt();
     state = node.activateOTAA();
 
     // ##### save the join counters (nonces) to permanent store
@@ -402,6 +547,166 @@ int16_t lwActivate(void)
   return (state);
 }
 
+#if LW_ABP
+// restoreSessionABP() advances FCntUp in the session buffer; RadioLib 6.6 has no
+// public API for this, so the buffer layout of the pinned version is relied upon
+#if (RADIOLIB_VERSION_MAJOR != 6) || (RADIOLIB_VERSION_MINOR != 6)
+#error "restoreSessionABP() requires the session buffer layout of RadioLib 6.6 - check before updating"
+#endif
+static_assert(RADIOLIB_LORAWAN_SESSION_FCNT_UP + 4 <= RADIOLIB_LORAWAN_SESSION_SIGNATURE,
+              "FCntUp must be covered by the session signature");
+static_assert(RADIOLIB_LORAWAN_SESSION_SIGNATURE + 2 <= RADIOLIB_LORAWAN_SESSION_BUF_SIZE,
+              "Session signature must fit into the session buffer");
+
+/*!
+ * \brief Compute session buffer signature (as done by RadioLib 6.6)
+ */
+static uint16_t sessionSignature(const uint8_t *buffer)
+{
+  uint16_t checkSum = 0;
+  for (size_t i = 0; i < RADIOLIB_LORAWAN_SESSION_SIGNATURE; i += 2)
+  {
+    uint16_t word = buffer[i] << 8;
+    if (i + 1 < RADIOLIB_LORAWAN_SESSION_SIGNATURE)
+    {
+      word |= buffer[i + 1];
+    }
+    checkSum ^= word;
+  }
+  return checkSum;
+}
+
+/*!
+ * \brief Restore ABP session from flash (after power loss)
+ *
+ * The uplink frame counter is advanced by 2 * ABP_FCNT_STEP, because up to
+ * ABP_FCNT_STEP (plus the uplinks of one wake-up cycle) frame counts may have
+ * been used since the session was saved. The advanced session is saved
+ * immediately, so the same frame counts are never used twice.
+ *
+ * \returns RadioLib status code
+ */
+static int16_t restoreSessionABP(void)
+{
+  uint8_t buffer[RADIOLIB_LORAWAN_SESSION_BUF_SIZE];
+
+  if (store.getBytes("abp_session", buffer, RADIOLIB_LORAWAN_SESSION_BUF_SIZE) != RADIOLIB_LORAWAN_SESSION_BUF_SIZE)
+  {
+    return RADIOLIB_ERR_UNKNOWN;
+  }
+
+  // RadioLib stores integers in little endian byte order
+  uint8_t *p = &buffer[RADIOLIB_LORAWAN_SESSION_FCNT_UP];
+  uint32_t fCntUp = p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+  fCntUp += 2 * ABP_FCNT_STEP;
+  p[0] = fCntUp & 0xFF;
+  p[1] = (fCntUp >> 8) & 0xFF;
+  p[2] = (fCntUp >> 16) & 0xFF;
+  p[3] = fCntUp >> 24;
+  uint16_t signature = sessionSignature(buffer);
+  buffer[RADIOLIB_LORAWAN_SESSION_SIGNATURE] = signature & 0xFF;
+  buffer[RADIOLIB_LORAWAN_SESSION_SIGNATURE + 1] = signature >> 8;
+
+  int16_t state = node.setBufferSession(buffer);
+  if (state == RADIOLIB_ERR_NONE)
+  {
+    log_i("Restored ABP session from flash; FCntUp advanced to %u", fCntUp);
+    store.putBytes("abp_session", buffer, RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
+    store.putULong("abp_fcnt", fCntUp);
+  }
+  return state;
+}
+
+/*!
+ * \brief Save ABP session to flash
+ *
+ * To limit flash wear, the session is only saved if the uplink frame counter
+ * has advanced by at least ABP_FCNT_STEP since it was saved last time.
+ */
+void saveSessionABP(void)
+{
+  uint32_t fCntUp = node.getFCntUp();
+
+  store.begin("radiolib");
+  if (!store.isKey("abp_session") || (fCntUp >= store.getULong("abp_fcnt") + ABP_FCNT_STEP))
+  {
+    log_d("Saving ABP session to flash (FCntUp: %u)", fCntUp);
+    store.putBytes("abp_session", node.getBufferSession(), RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
+    store.putULong("abp_fcnt", fCntUp);
+  }
+  store.end();
+}
+
+/*!
+ * \brief Activate node by restoring session or otherwise starting a new ABP session
+ *
+ * The session is restored from RTC RAM or - after a power loss - from flash;
+ * there is no join procedure.
+ *
+ * \return RADIOLIB_LORAWAN_NEW_SESSION or RADIOLIB_LORAWAN_SESSION_RESTORED
+ */
+int16_t lwActivateABP(void)
+{
+  int16_t state = RADIOLIB_ERR_UNKNOWN;
+
+  // setup the ABP session information;
+  // LoRaWAN 1.0.x if FNwkSIntKey/SNwkSIntKey are not set
+  uint8_t check = 0;
+  for (size_t i = 0; i < sizeof(fNwkSIntKey); i++)
+  {
+    check |= fNwkSIntKey[i];
+  }
+  if (check)
+  {
+    node.beginABP(devAddr, fNwkSIntKey, sNwkSIntKey, nwkSEncKey, appSKey);
+  }
+  else
+  {
+    node.beginABP(devAddr, NULL, NULL, nwkSEncKey, appSKey);
+  }
+
+  log_d("Recalling LoRaWAN nonces & session");
+  store.begin("radiolib");
+  if (store.isKey("nonces"))
+  {
+    uint8_t buffer[RADIOLIB_LORAWAN_NONCES_BUF_SIZE];
+    store.getBytes("nonces", buffer, RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
+    state = node.setBufferNonces(buffer);
+    debug(state != RADIOLIB_ERR_NONE, "Restoring nonces buffer failed", state, false);
+
+    // recall session from RTC deep-sleep preserved variable, otherwise from flash
+    state = node.setBufferSession(LWsession);
+    if (state != RADIOLIB_ERR_NONE)
+    {
+      log_d("No session in RTC RAM - trying flash");
+      state = restoreSessionABP();
+    }
+
+    if (state == RADIOLIB_ERR_NONE)
+    {
+      log_d("Succesfully restored session - now activating");
+      state = node.activateABP();
+      debug((state != RADIOLIB_LORAWAN_SESSION_RESTORED), "Failed to activate restored session", state, true);
+      healthStats.sessionRestored();
+
+      store.end();
+      return (state);
+    }
+    log_w("Restoring ABP session failed - starting new session with FCntUp = 0");
+  }
+
+  state = node.activateABP();
+  debug((state != RADIOLIB_LORAWAN_NEW_SESSION), "ABP activation failed", state, true);
+
+  // save the nonces buffer (contains the ABP configuration signature)
+  log_d("Saving nonces to flash");
+  store.putBytes("nonces", node.getBufferNonces(), RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
+  store.remove("abp_session");
+  store.end();
+  return (state);
+}
+#endif
+
 // setup & execute all device functions ...
 void setup()
 {
@@ -460,6 +765,23 @@ void setup()
 #endif
   log_i("Boot count: %u", bootCount);
 
+  // Start wake-cycle guard; evaluates incidents of the previous cycle
+  E_WAKE_PHASE incident = wakeGuard.begin(wakeGuardSleepHook);
+
+#if SDT_SAMPLE_INTERVAL > 0
+  // Sample-only wake-up between uplinks (5 s tolerance for wake-up time);
+  // bootCount is not incremented to keep the uplink schedule
+  if ((bootCount > 1) && (static_cast<time_t>(rtc.getLocalEpoch() + 5) < rtcNextUplink))
+  {
+    appLayer.begin();
+    wakeGuard.enter(E_WAKE_PHASE::E_MODBUS);
+    appLayer.getSample();
+    time_t t_now = rtc.getLocalEpoch();
+    uint32_t remaining = (rtcNextUplink > t_now) ? rtcNextUplink - t_now : SLEEP_INTERVAL_MIN;
+    gotoSleep(min(remaining, static_cast<uint32_t>(SDT_SAMPLE_INTERVAL)));
+  }
+#endif
+
   if (bootCount == 1)
   {
     rtcTimeSource = E_TIME_SOURCE::E_UNSYNCHED;
@@ -468,12 +790,43 @@ void setup()
   }
   bootCount++;
 
+  // Recovery action depends on the phase which failed in the previous cycle
+  bool skipOptional = false;
+  switch (incident)
+  {
+  case E_WAKE_PHASE::E_NONE:
+    break;
+  case E_WAKE_PHASE::E_MODBUS:
+    // Inverter not responding properly - single readout attempt
+    appLayer.setModbusRetries(1);
+    break;
+  case E_WAKE_PHASE::E_RADIO:
+    // The radio is reset and reinitialized in each cycle anyway
+    break;
+  case E_WAKE_PHASE::E_JOIN:
+    // Session restore or join failed - discard session
+    memset(LWsession, 0, RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
+    break;
+  default:
+    // Uplink, downlink or cycle budget - only scheduled uplinks
+    skipOptional = true;
+    break;
+  }
+  if (wakeGuard.reportPending())
+  {
+    lwStatusUplinkPending = true;
+  }
+
   // Set time zone
   setenv("TZ", timeZoneInfo.c_str(), 1);
   printDateTime();
 
   // Try to load LoRaWAN secrets from LittleFS file, if available
+#if LW_ABP
+  loadSecrets(devAddr, fNwkSIntKey, sNwkSIntKey, nwkSEncKey, appSKey);
+#else
   loadSecrets(joinEUI, devEUI, nwkKey, appKey);
+#endif
 
   // Initialize Application Layer
   appLayer.begin();
@@ -487,6 +840,12 @@ void setup()
   log_d("Preferences: lw_stat_interval:      %u cycles", prefs.lw_stat_interval);
   preferences.end();
 
+  if (wakeGuard.getConsecutive() >= WG_INCIDENTS_MAX)
+  {
+    log_w("Repeated wake guard incidents - long sleep");
+    gotoSleep(prefs.sleep_interval_long);
+  }
+
   uint16_t voltage = getBatteryVoltage();
   if (voltage && voltage <= battery_low)
   {
@@ -495,24 +854,58 @@ void setup()
   }
 
   // build payload byte array (+ reserve to prevent overflow with configuration at run-time)
-  uint8_t uplinkPayload[PAYLOAD_SIZE + 8];
+  uint8_t uplinkPayload[PAYLOAD_SIZE_MAX + 8];
 
   LoraEncoder encoder(uplinkPayload);
 
   uint8_t port = 1;
+  wakeGuard.enter(E_WAKE_PHASE::E_MODBUS);
   appLayer.getPayloadStage1(port, encoder);
 
+#if MQTT_FASTPATH
+  // Publish via Wi-Fi/MQTT if available - LoRaWAN is used as fallback
+  // and periodically for keeping the session alive
+  wakeGuard.enter(E_WAKE_PHASE::E_UPLINK, 2 * MQTT_TIMEOUT + WG_DL_MODBUS + WG_DL_UPLINK);
+  if (appLayer.publishMqtt())
+  {
+    uint32_t sleepSeconds = sleepDuration(battery_weak);
+#if SDT_SAMPLE_INTERVAL > 0
+    rtcNextUplink = rtc.getLocalEpoch() + sleepSeconds;
+    sleepSeconds = min(sleepSeconds, static_cast<uint32_t>(SDT_SAMPLE_INTERVAL));
+#endif
+    gotoSleep(sleepSeconds);
+  }
+#endif
+
   int16_t state = 0; // return value for calls to RadioLib
 
   // setup the radio based on the pinmap (connections) in config.h
+  wakeGuard.enter(E_WAKE_PHASE::E_RADIO);
+#if defined(ESP32) && RADIO_SLEEP_HOLD
+  // Release pins latched during deep sleep
+  gpio_deep_sleep_hold_dis();
+  gpio_hold_dis(static_cast<gpio_num_t>(radio.getMod()->getCs()));
+  if (radio.getMod()->getRst() != RADIOLIB_NC)
+  {
+    gpio_hold_dis(static_cast<gpio_num_t>(radio.getMod()->getRst()));
+  }
+#endif
+  // RadioLib's begin() resets and reconfigures the chip in any case
   log_v("Initalise the radio");
   radio.reset();
   state = radio.begin();
   debug(state != RADIOLIB_ERR_NONE, "Initalise radio failed", state, true);
+  radioActive = true;
 
   // activate node by restoring session or otherwise joining the network
+  wakeGuard.enter(E_WAKE_PHASE::E_JOIN);
+#if LW_ABP
+  state = lwActivateABP();
+#else
   state = lwActivate();
+#endif
   // state is one of RADIOLIB_LORAWAN_NEW_SESSION or RADIOLIB_LORAWAN_SESSION_RESTORED
+  wakeGuard.enter(E_WAKE_PHASE::E_UPLINK);
 
   // Set battery fill level -
   // the LoRaWAN network server may periodically request this information
@@ -549,9 +942,19 @@ void setup()
   // Retrieve the last uplink frame counter
   uint32_t fCntUp = node.getFCntUp();
 
-  // Send a confirmed uplink every 64th frame
+  // Send a confirmed uplink as requested by the link policy
   // and also request the LinkCheck command
-  if (fCntUp % 64 == 0)
+  linkPolicy.begin();
+#if LP_DR_OPTIMISER
+  // Data rate and TX power are selected by the link policy instead of network ADR
+  node.setADR(false);
+  state = node.setDatarate(linkPolicy.getDatarate());
+  debug(state != RADIOLIB_ERR_NONE, "Setting data rate failed", state, false);
+  state = node.setTxPower(linkPolicy.getTxPower());
+  debug(state != RADIOLIB_ERR_NONE, "Setting TX power failed", state, false);
+#endif
+  bool confirmUplink = linkPolicy.confirmNext();
+  if (confirmUplink)
   {
     log_i("[LoRaWAN] Requesting LinkCheck");
     node.sendMacCommandReq(RADIOLIB_LORAWAN_MAC_LINK_CHECK);
@@ -573,6 +976,11 @@ void setup()
   /// Uplink request - command received via downlink
   uint8_t uplinkReq = 0;
 
+  /// More downlinks may be queued at the network server
+  bool downlinkPending = false;
+
+  uint8_t payloadSizeMax = updatePayloadSizeMax();
+
   for (int i = 0; i < NUM_PORTS; i++)
   {
     LoraEncoder encoder(uplinkPayload);
@@ -584,54 +992,76 @@ void setup()
     }
     if (i > 0)
     {
-      delay(getUplinkDelayMs(SLEEP_INTERVAL_MIN));
+      uint32_t delayMs = getUplinkDelayMs(SLEEP_INTERVAL_MIN);
+      wakeGuard.enter(E_WAKE_PHASE::E_UPLINK, delayMs / 1000 + WG_DL_UPLINK);
+      delay(delayMs);
     }
     port = UplinkSchedule[i].port;
 
     // get payload immediately before uplink
+    wakeGuard.enter(E_WAKE_PHASE::E_MODBUS);
     appLayer.getPayloadStage2(port, encoder);
+    if (encoder.getLength() == 0)
+    {
+      log_d("No uplink required on port %u", port);
+      continue;
+    }
 
     uint8_t downlinkPayload[MAX_DOWNLINK_SIZE]; // Make sure this fits your plans!
     size_t downlinkSize;                        // To hold the actual payload size rec'd
     LoRaWANEvent_t uplinkDetails;
     LoRaWANEvent_t downlinkDetails;
+    uplinkDetails.datarate = 0xFF; // not filled in if nothing was transmitted
 
     uint8_t payloadSize = encoder.getLength();
 
-    if (payloadSize > PAYLOAD_SIZE)
+    if (payloadSize > payloadSizeMax)
     {
-      log_w("Payload size exceeds maximum of %u bytes - truncating", PAYLOAD_SIZE);
-      payloadSize = PAYLOAD_SIZE;
+      // Send oversized payload as blob (fragmented), if possible
+      if (appLayer.startBlob(BLOB_TYPE_UPLINK | port, uplinkPayload, payloadSize))
+      {
+        log_i("Payload size exceeds maximum of %u bytes - sending fragmented", payloadSizeMax);
+        appLayer.uplinkSent(port);
+        continue;
+      }
+      log_w("Payload size exceeds maximum of %u bytes - truncating", payloadSizeMax);
+      payloadSize = payloadSizeMax;
     }
 
     // ----- and now for the main event -----
     log_i("Sending uplink; port %u, size %u", port, payloadSize);
+    wakeGuard.enter(E_WAKE_PHASE::E_UPLINK);
 
     // perform an uplink & optionally receive downlink
-    if (fCntUp % 64 == 0)
+    state = node.sendReceive(
+        uplinkPayload,
+        payloadSize,
+        port,
+        downlinkPayload,
+        &downlinkSize,
+        confirmUplink,
+        &uplinkDetails,
+        &downlinkDetails);
+    if (uplinkDetails.datarate != 0xFF)
+    {
+      // Data rate actually used - also if no (valid) downlink was received
+      rtcUplinkDatarate = uplinkDetails.datarate;
+    }
+    else if (state == RADIOLIB_ERR_PACKET_TOO_LONG)
     {
-      state = node.sendReceive(
-          uplinkPayload,
-          payloadSize,
-          port,
-          downlinkPayload,
-          &downlinkSize,
-          true,
-          &uplinkDetails,
-          &downlinkDetails);
+      // With ADR, the node's data rate is not known until the next uplink has
+      // been transmitted (e.g. after ADR backoff) - assume the lowest one
+      rtcUplinkDatarate = 0;
     }
-    else
+    // A LinkADRReq received with this uplink may have changed the data rate
+    payloadSizeMax = updatePayloadSizeMax();
+    if ((state == RADIOLIB_LORAWAN_NO_DOWNLINK) || (state == RADIOLIB_ERR_NONE))
     {
-      state = node.sendReceive(
-          uplinkPayload,
-          payloadSize,
-          port,
-          downlinkPayload,
-          &downlinkSize,
-          false,
-          nullptr,
-          &downlinkDetails);
+      appLayer.uplinkSent(port);
+      appLayer.addUplink(port, uplinkPayload, payloadSize);
     }
+    healthStats.uplink((state == RADIOLIB_LORAWAN_NO_DOWNLINK) || (state == RADIOLIB_ERR_NONE), node.getLastToA());
+    saveSession();
     debug((state != RADIOLIB_LORAWAN_NO_DOWNLINK) && (state != RADIOLIB_ERR_NONE), "Error in sendReceive", state, false);
 
     // Check if downlink was received
@@ -692,12 +1122,28 @@ void setup()
 
     uint8_t margin = 0;
     uint8_t gwCnt = 0;
+    bool linkCheck = false;
     if (node.getMacLinkCheckAns(&margin, &gwCnt) == RADIOLIB_ERR_NONE)
     {
       log_d("[LoRaWAN] LinkCheck margin:\t%d", margin);
       log_d("[LoRaWAN] LinkCheck count:\t%u", gwCnt);
+      linkCheck = true;
     }
 
+    // RadioLib 6.6 provides neither the FPending flag nor the raw downlink frame -
+    // a follow-up uplink is only sent after an application downlink (a command
+    // may be followed by further queued commands); MAC-only downlinks
+    // (e.g. DeviceTimeAns, LinkCheckAns) and plain ACKs do not trigger draining
+    if ((state == RADIOLIB_ERR_NONE) && (downlinkSize > 0) && (downlinkDetails.fPort > 0))
+    {
+      downlinkPending = true;
+    }
+
+    // Update link policy; only the first uplink per wake-up cycle is confirmed
+    bool acked = (state == RADIOLIB_ERR_NONE) && downlinkDetails.confirming;
+    linkPolicy.update(confirmUplink, acked, state == RADIOLIB_ERR_NONE, linkCheck, margin, gwCnt);
+    confirmUplink = false;
+
     if (appStatusUplinkPending)
     {
       log_i("App status uplink pending");
@@ -708,6 +1154,8 @@ void setup()
       log_i("LoRaWAN node status uplink pending");
     }
 
+    // Command responses wait for uplinkIntervalSeconds
+    wakeGuard.enter(E_WAKE_PHASE::E_UPLINK, uplinkIntervalSeconds + WG_DL_UPLINK);
     if (uplinkReq)
     {
       sendCfgUplink(uplinkReq, uplinkIntervalSeconds);
@@ -718,20 +1166,79 @@ void setup()
       sendCfgUplink(CMD_GET_LW_STATUS, uplinkIntervalSeconds);
       lwStatusUplinkPending = false;
     }
-    // else if (appStatusUplinkPending)
-    // {
-    //   sendCfgUplink(CMD_GET_SENSORS_STAT, uplinkIntervalSeconds);
-    //   appStatusUplinkPending = false;
-    // }
+    else if (appLayer.getPendingUplinkReq())
+    {
+      sendCfgUplink(appLayer.getPendingUplinkReq(), uplinkIntervalSeconds);
+    }
+    else if (appStatusUplinkPending)
+    {
+      sendCfgUplink(CMD_GET_SENSORS_STAT, uplinkIntervalSeconds);
+      appStatusUplinkPending = false;
+    }
 
     log_d("FcntUp: %u", node.getFCntUp());
   }
-  // now save session to RTC memory
-  uint8_t *persist = node.getBufferSession();
-  memcpy(LWsession, persist, RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
+  // Diagnostic burst requested by downlink - high-rate capture,
+  // the data is sent as blob; afterwards, the normal schedule is resumed
+  if (appLayer.burstPending() && !skipOptional && !linkPolicy.rejoinRequired())
+  {
+    uint32_t duration = appLayer.getBurstDuration();
+    wakeGuard.extendBudget(duration);
+    wakeGuard.enter(E_WAKE_PHASE::E_MODBUS, duration + WG_DL_MODBUS);
+    appLayer.runBurst();
+  }
 
   // wait until next uplink - observing legal & TTN Fair Use Policy constraints
-  gotoSleep(sleepDuration(battery_weak));
+  uint32_t sleepSeconds = sleepDuration(battery_weak);
+#if SDT_SAMPLE_INTERVAL > 0
+  rtcNextUplink = rtc.getLocalEpoch() + sleepSeconds;
+  sleepSeconds = min(sleepSeconds, static_cast<uint32_t>(SDT_SAMPLE_INTERVAL));
+#endif
+
+  if (linkPolicy.rejoinRequired())
+  {
+    // Link lost - discard session; the network is joined again after wake-up
+    log_w("[LoRaWAN] Link lost - rejoin required");
+    memset(LWsession, 0, RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
+    linkPolicy.reset();
+  }
+  else if (skipOptional)
+  {
+    // Recovering from an incident - no optional downlink traffic in this cycle
+    log_i("Skipping downlink draining / blob transfer");
+    saveSession();
+  }
+  else
+  {
+    // Fetch further downlinks queued at the network server
+    if (downlinkPending)
+    {
+      wakeGuard.enter(E_WAKE_PHASE::E_DOWNLINK, DL_DRAIN_MAX * (DL_DRAIN_WAIT_MAX + WG_DL_UPLINK));
+      drainDownlinks();
+    }
+
+    // Send pending blob fragments (paced by duty cycle limits, continued after wake-up)
+    wakeGuard.enter(E_WAKE_PHASE::E_DOWNLINK, BLOB_FRAGS_PER_WAKE * (BLOB_WAIT_MAX + WG_DL_UPLINK));
+    sendBlobFragments();
+
+#if LOW_LATENCY_MODE
+    // On external power, stay responsive to commands until the next wake-up
+    if (battLevel == 0)
+    {
+      wakeGuard.extendBudget(sleepSeconds);
+      wakeGuard.enter(E_WAKE_PHASE::E_DOWNLINK, sleepSeconds + WG_DL_UPLINK);
+      sleepSeconds = pollDownlinks(sleepSeconds);
+    }
+#endif
+
+    // now save session to RTC memory
+    saveSession();
+#if LW_ABP
+    saveSessionABP();
+#endif
+  }
+
+  gotoSleep(sleepSeconds);
 }
 
 // The ESP32 wakes from deep-sleep and starts from the very beginning.
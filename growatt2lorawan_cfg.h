@@ -32,6 +32,25 @@
 // History:
 //
 // 20240814 Created
+// 20261017 Added PV analytics uplink (port 3)
+//          Added power curve uplink (port 4)
+//          Added dual-prediction reporting (port 5)
+//          Moved PAYLOAD_SIZE_MAX from growatt2lorawan-v2.ino
+//          Added cross-frame parity (port 6)
+//          Added blob transfer (port 7)
+//          Added link policy settings
+//          Added data rate / TX power optimiser settings
+//          Added low-latency mode settings
+//          Added downlink drain settings
+//          Added ABP settings
+//          Added radio sleep hold setting
+//          Added wake guard settings
+//          Added health statistics settings
+//          Added Wi-Fi/MQTT fast path settings
+//          Added energy meter settings (port 9)
+//          Added diagnostic burst settings
+//          PV analytics (port 3) disabled by default
+//          App status uplink disabled by default
 //
 // ToDo:
 // - 
@@ -48,11 +67,196 @@
 // Enter your time zone (https://remotemonitoringsystems.ca/time-zone-abbreviations.php)
 #define TZINFO_STR "CET-1CEST-2,M3.5.0/02:00:00,M10.5.0/03:00:00"
 
+// LoRaWAN activation mode (0 = OTAA / 1 = ABP)
+// ABP credentials are defined in secrets.h or secrets.json
+#define LW_ABP 0
+
+// ABP - the session is saved to flash every ABP_FCNT_STEP uplinks;
+// after a power loss, the uplink frame counter is advanced by 2 * ABP_FCNT_STEP
+// (must exceed the number of uplinks per wake-up cycle)
+#define ABP_FCNT_STEP 64
+
+// Radio sleep hold (ESP32 only; 0 = disabled / 1 = enabled)
+// If enabled, the radio is put into sleep mode before deep sleep and NSS and
+// RESET are latched, so floating pins cannot wake up the radio. The radio is
+// still reset and reinitialized after wake-up (RadioLib's begin() always
+// resets the chip).
+#define RADIO_SLEEP_HOLD 1
+
 // RTC to network time sync interval (in minutes)
 #define CLOCK_SYNC_INTERVAL 24 * 60
 
+// Power curve sampling interval (in seconds; 0 = disabled)
+// If enabled, the node wakes up every SDT_SAMPLE_INTERVAL seconds between
+// uplinks to sample outputpower and solarpower without transmitting;
+// the compressed power curve is sent on port 4.
+#define SDT_SAMPLE_INTERVAL 0
+
+// Power curve compression - maximum absolute error (in W)
+#define SDT_MAX_ERROR 20
+
+// Dual-prediction reporting (0 = disabled / 1 = enabled)
+// If enabled, port 5 replaces port 1: the node and the receiving side run
+// the same predictor (see src/DualPredictor.h) for outputpower and energytotal,
+// and a report is only sent if the measurement deviates from the prediction
+// by more than DP_POWER_BOUND or DP_ENERGY_BOUND, or after DP_HEARTBEAT seconds.
+#define DUAL_PREDICTION 0
+
+// Dual-prediction reporting - maximum output power deviation (in W)
+#define DP_POWER_BOUND 50
+
+// Dual-prediction reporting - maximum total energy deviation (in Wh)
+// (energytotal has a resolution of 100 Wh)
+#define DP_ENERGY_BOUND 200
+
+// Dual-prediction reporting - maximum time between reports (in seconds)
+#define DP_HEARTBEAT 3600
+
+// Cross-frame FEC - number of telemetry frames per parity frame (0 = disabled / 2...8)
+// A parity frame is sent on port 6 after every FEC_GROUP_SIZE telemetry frames
+// (ports 1/5), which allows to rebuild any single lost frame of the group.
+#define FEC_GROUP_SIZE 0
+
+// Blob transfer - uplink port for fragments
+#define BLOB_PORT 7
+
+// Blob transfer - number of redundancy fragments per blob
+// (allows to rebuild the blob if up to approx. BLOB_REDUNDANCY fragments are lost)
+#define BLOB_REDUNDANCY 2
+
+// Blob transfer - maximum number of fragments per wake-up cycle
+#define BLOB_FRAGS_PER_WAKE 4
+
+// Diagnostic burst (CMD_START_BURST) - maximum capture duration (in seconds)
+// The node stays awake (light sleep between samples) for this time
+#define BURST_DURATION_MAX 600
+
+// Diagnostic burst - minimum sampling period (in seconds)
+#define BURST_PERIOD_MIN 5
+
+// Blob transfer - maximum waiting time for next fragment (in seconds);
+// otherwise the transfer continues after the next wake-up
+#define BLOB_WAIT_MAX 30
+
+// Link policy - confirmed uplink (with LinkCheck request) interval (in frames)
+// for a normal, strong and weak link, respectively
+#define LP_CONFIRM_INTERVAL 64
+#define LP_CONFIRM_INTERVAL_MAX 128
+#define LP_CONFIRM_INTERVAL_MIN 8
+
+// Link policy - LinkCheck margin thresholds (in dB) for a strong / weak link
+#define LP_MARGIN_GOOD 15
+#define LP_MARGIN_WEAK 5
+
+// Link policy - number of consecutive unacknowledged confirmed uplinks
+// after which the link is considered lost and the network is joined again
+#define LP_REJOIN_FAILURES 3
+
+// Link policy - data rate / TX power optimiser (0 = disabled / 1 = enabled)
+// If enabled, network ADR is disabled and the node selects the fastest data rate
+// and the lowest TX power which keep a LinkCheck margin of LP_SAFETY_MARGIN dB.
+#define LP_DR_OPTIMISER 0
+
+// Link policy - data rate range and initial data rate (EU868: 0 = SF12 ... 5 = SF7)
+#define LP_DR_MIN 0
+#define LP_DR_MAX 5
+#define LP_DR_START 3
+
+// Link policy - TX power range and step size (in dBm; EU868: 16 dBm EIRP max., 2 dB steps)
+#define LP_TX_POWER_MAX 16
+#define LP_TX_POWER_MIN 2
+#define LP_TX_POWER_STEP 2
+
+// Link policy - required LinkCheck margin (in dB)
+#define LP_SAFETY_MARGIN 6
+
+// Link policy - additional margin (in dB) and number of LinkCheck answers
+// required for stepping to a faster data rate / lower TX power
+#define LP_OPT_STEP 3
+#define LP_OPT_SAMPLES 3
+
+// Low-latency downlinks on external power (0 = disabled / 1 = enabled)
+// If enabled and the battery level indicates external power, the node stays
+// awake between scheduled uplinks and polls for downlinks with empty uplinks
+// on LL_POLL_PORT every LL_POLL_INTERVAL seconds (see README.md for fair use).
+// Requires getBatteryVoltage() (growatt2lorawan-v2.ino) to be implemented -
+// external power is reported by a voltage above BATTERY_CHARGE_LIM; the shipped
+// dummy returns 0 ("unable to measure"), i.e. low-latency mode is never active.
+#define LOW_LATENCY_MODE 0
+
+// Low-latency mode - polling interval (in seconds)
+#define LL_POLL_INTERVAL 120
+
+// Low-latency mode / downlink drain - uplink port for empty poll uplinks
+#define LL_POLL_PORT 8
+
+// Downlink drain - maximum number of empty uplinks per wake-up cycle (0 = disabled)
+// After a downlink which indicates that more downlinks may be queued at the
+// network server, empty uplinks are sent until no more downlinks are received.
+#define DL_DRAIN_MAX 8
+
+// Downlink drain - maximum waiting time for next uplink (in seconds)
+#define DL_DRAIN_WAIT_MAX 30
+
+// Wake guard - overall awake time budget per wake-up cycle (in seconds)
+// If the budget is exceeded, the node is put into deep sleep immediately.
+// Must cover the scheduled uplinks including the duty cycle delays between them.
+#define WG_CYCLE_BUDGET 600
+
+// Wake guard - phase deadlines (in seconds)
+// A phase which misses its deadline is aborted by a watchdog reset.
+#define WG_DL_DEFAULT 10 // start-up, preparing sleep
+#define WG_DL_MODBUS 60  // inverter readout (incl. MODBUS_RETRIES)
+#define WG_DL_RADIO 10   // radio initialization
+#define WG_DL_JOIN 60    // session restore / join
+#define WG_DL_UPLINK 30  // uplink incl. receive windows
+
+// Wake guard - consecutive cycles with incident until SLEEP_INTERVAL_LONG is used
+#define WG_INCIDENTS_MAX 3
+
+// App status (health statistics) uplink interval (in frames; 0 = disabled)
+// Default value (disabled; e.g. 96), can be changed with CMD_SET_STATUS_INTERVAL
+#define APP_STATUS_INTERVAL 0
+
+// Health statistics - number of wake-up cycles between flash commits (1...255)
+#define HS_COMMIT_INTERVAL 48
+
+// Wi-Fi/MQTT fast path (0 = disabled / 1 = enabled)
+// If enabled and the Wi-Fi network and MQTT broker are reachable, the inverter
+// data and the sample backlog are published via MQTT and the LoRaWAN uplinks
+// are skipped; otherwise LoRaWAN is used. Credentials are defined in secrets.h.
+#define MQTT_FASTPATH 0
+
+// Wi-Fi/MQTT fast path - broker and topic prefix
+#define MQTT_HOST "192.168.0.2"
+#define MQTT_PORT 1883
+#define MQTT_TOPIC_BASE "growatt2lorawan"
+
+// Wi-Fi/MQTT fast path - timeout for Wi-Fi and broker connection (in seconds)
+#define MQTT_TIMEOUT 10
+
+// Wi-Fi/MQTT fast path - maximum number of samples per message
+#define MQTT_BATCH_SIZE 8
+
+// Wi-Fi/MQTT fast path - LoRaWAN cycle interval while MQTT is available
+// (in wake-up cycles; 0 = LoRaWAN only as fallback)
+// Keeps the LoRaWAN session alive and allows downlink commands and clock sync.
+#define MQTT_LW_INTERVAL 12
+
+// Energy meter on the inverter's RS485 bus (0 = none / 1 = SDM630 / 2 = SDM72 / 3 = SDM120/SDM230)
+// (see src/DeviceProfiles.h)
+// If enabled, the meter is polled after the inverter and the production and
+// consumption data are sent together on port 9.
+#define METER_TYPE 0
+
+// Energy meter - Modbus slave ID (must differ from the inverter's ID)
+#define METER_SLAVE_ID 2
+
+// Energy meter - Modbus data rate
+#define METER_RATE 9600
+
 // Number of uplink ports
-#define NUM_PORTS 2
+#define NUM_PORTS 7
 
 typedef struct
 {
@@ -62,13 +266,21 @@ typedef struct
 
 const Schedule UplinkSchedule[NUM_PORTS] = {
     // {port, mult}
-    {1, 1},
-    {2, 3}
+    {1, DUAL_PREDICTION ? 0 : 1},
+    {2, 3},
+    {3, 0},  // PV analytics (disabled; e.g. 10: every 10th uplink)
+    {4, (SDT_SAMPLE_INTERVAL > 0) ? 1 : 0}, // Power curve
+    {5, DUAL_PREDICTION ? 1 : 0},           // Dual-prediction reporting
+    {6, (FEC_GROUP_SIZE > 0) ? 1 : 0},      // Cross-frame parity
+    {9, (METER_TYPE > 0) ? 1 : 0}           // Inverter and energy meter
 };
 
 // Maximum downlink payload size (bytes)
 const uint8_t MAX_DOWNLINK_SIZE = 51;
 
+// Maximum uplink payload size at high data rates (bytes)
+const uint8_t PAYLOAD_SIZE_MAX = 222;
+
 // Minimum sleep interval (in seconds)
 #define SLEEP_INTERVAL_MIN 60
 
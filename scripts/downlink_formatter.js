@@ -18,6 +18,12 @@
 // port = CMD_GET_DATETIME, {"cmd": "CMD_GET_DATETIME"} / payload = 0x00
 // port = CMD_SET_DATETIME, {"epoch": <epoch>}
 // port = CMD_GET_LW_CONFIG, {"cmd": "CMD_GET_LW_CONFIG"} / payload = 0x00
+// port = CMD_GET_SAMPLES, {"get_samples": [[<first_seq>, <count>], ...]}
+// port = CMD_GET_BLOB, {"get_blob": <blob_type>}
+// port = CMD_START_BURST, {"burst": [<duration_in_seconds>, <period_in_seconds>, <fields>]}
+// port = CMD_GET_STATUS_INTERVAL, {"cmd": "CMD_GET_STATUS_INTERVAL"} / payload = 0x00
+// port = CMD_SET_STATUS_INTERVAL, {"status_interval": <interval_in_uplink_frames>}
+// port = CMD_GET_SENSORS_STAT, {"cmd": "CMD_GET_SENSORS_STAT"} / payload = 0x00
 
 // Responses:
 // -----------
@@ -35,6 +41,10 @@
 // <lw_status_interval> : 0...255
 // <epoch>              : unix epoch time, see https://www.epochconverter.com/ (<integer> / "0x....")
 // <rtc_source>         : 0x00: GPS / 0x01: RTC / 0x02: LORA / 0x03: unsynched / 0x04: set (source unknown)
+// <first_seq>          : sequence number of first missing sample (0...65535)
+// <count>              : number of missing samples (1...255); max. 8 ranges
+// <blob_type>          : 0x01: input register image / 0x02: sample ring
+// <status_interval>    : 0...255 (0: disabled)
 //
 //
 // Based on:
@@ -69,6 +79,10 @@
 //
 // History:
 // 20240818 Copied from BresserWeatherSensorLW and adapted for growatt2lorawan
+// 20261017 Added CMD_GET_SAMPLES
+//          Added CMD_GET_BLOB
+//          Added CMD_GET_STATUS_INTERVAL, CMD_SET_STATUS_INTERVAL, CMD_GET_SENSORS_STAT
+//          Added CMD_START_BURST
 //
 // ToDo:
 // -  
@@ -83,6 +97,12 @@ const CMD_SET_SLEEP_INTERVAL_LONG = 0x33;
 const CMD_SET_LW_STATUS_INTERVAL = 0x35;
 const CMD_GET_LW_CONFIG = 0x36;
 const CMD_GET_LW_STATUS = 0x38;
+const CMD_GET_STATUS_INTERVAL = 0x40;
+const CMD_SET_STATUS_INTERVAL = 0x41;
+const CMD_GET_SENSORS_STAT = 0x42;
+const CMD_GET_SAMPLES = 0x44;
+const CMD_GET_BLOB = 0x45;
+const CMD_START_BURST = 0x46;
 
 
 // Source of Real Time Clock setting
@@ -202,6 +222,22 @@ function encodeDownlink(input) {
                 errors: []
             };
         }
+        else if (input.data.cmd == "CMD_GET_STATUS_INTERVAL") {
+            return {
+                bytes: [0],
+                fPort: CMD_GET_STATUS_INTERVAL,
+                warnings: [],
+                errors: []
+            };
+        }
+        else if (input.data.cmd == "CMD_GET_SENSORS_STAT") {
+            return {
+                bytes: [0],
+                fPort: CMD_GET_SENSORS_STAT,
+                warnings: [],
+                errors: []
+            };
+        }
     }
     if (input.data.hasOwnProperty('sleep_interval')) {
         return {
@@ -225,6 +261,59 @@ function encodeDownlink(input) {
             errors: []
         };
     }
+    else if (input.data.hasOwnProperty('get_samples')) {
+        var ranges = input.data.get_samples;
+        if (!Array.isArray(ranges) || (ranges.length < 1) || (ranges.length > 8)) {
+            return {
+                bytes: [],
+                warnings: [],
+                errors: ["get_samples: 1...8 ranges required"]
+            };
+        }
+        var bytes = [];
+        for (var i = 0; i < ranges.length; i++) {
+            bytes.push((ranges[i][0] >> 8) & 0xFF, ranges[i][0] & 0xFF, Math.min(ranges[i][1], 255));
+        }
+        return {
+            bytes: bytes,
+            fPort: CMD_GET_SAMPLES,
+            warnings: [],
+            errors: []
+        };
+    }
+    else if (input.data.hasOwnProperty('get_blob')) {
+        return {
+            bytes: [input.data.get_blob & 0xFF],
+            fPort: CMD_GET_BLOB,
+            warnings: [],
+            errors: []
+        };
+    }
+    else if (input.data.hasOwnProperty('burst')) {
+        // [duration (s), period (s), fields (bitmap, see src/BurstCapture.h)]
+        var burst = input.data.burst;
+        if (!Array.isArray(burst) || (burst.length !== 3)) {
+            return {
+                bytes: [],
+                warnings: [],
+                errors: ["burst: [duration, period, fields] required"]
+            };
+        }
+        return {
+            bytes: [(burst[0] >> 8) & 0xFF, burst[0] & 0xFF, burst[1] & 0xFF, burst[2] & 0xFF],
+            fPort: CMD_START_BURST,
+            warnings: [],
+            errors: []
+        };
+    }
+    else if (input.data.hasOwnProperty('status_interval')) {
+        return {
+            bytes: [input.data.status_interval],
+            fPort: CMD_SET_STATUS_INTERVAL,
+            warnings: [],
+            errors: []
+        };
+    }
     else if (input.data.hasOwnProperty('lw_status_interval')) {
         return {
             bytes: [input.data.lw_status_interval],
@@ -273,6 +362,8 @@ function decodeDownlink(input) {
         case CMD_GET_DATETIME:
         case CMD_GET_LW_CONFIG:
         case CMD_GET_LW_STATUS:
+        case CMD_GET_STATUS_INTERVAL:
+        case CMD_GET_SENSORS_STAT:
             return {
                 data: [0],
                 warnings: [],
@@ -302,6 +393,34 @@ function decodeDownlink(input) {
                     lw_status_interval: uint8(input.bytes)
                 }
             };
+        case CMD_SET_STATUS_INTERVAL:
+            return {
+                data: {
+                    status_interval: uint8(input.bytes)
+                }
+            };
+        case CMD_GET_BLOB:
+            return {
+                data: {
+                    get_blob: uint8(input.bytes)
+                }
+            };
+        case CMD_START_BURST:
+            return {
+                data: {
+                    burst: [uint16BE(input.bytes.slice(0, 2)), input.bytes[2], input.bytes[3]]
+                }
+            };
+        case CMD_GET_SAMPLES:
+            var ranges = [];
+            for (var i = 0; i + 2 < input.bytes.length; i += 3) {
+                ranges.push([uint16BE(input.bytes.slice(i, i + 2)), input.bytes[i + 2]]);
+            }
+            return {
+                data: {
+                    get_samples: ranges
+                }
+            };
         default:
             return {
                 errors: ["unknown FPort"]
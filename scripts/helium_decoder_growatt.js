@@ -177,6 +177,37 @@ function Decoder(bytes, port, uplink_info) {
     };
     bitmap.BYTES = 1;
 
+    var int8 = function (bytes) {
+        if (bytes.length !== int8.BYTES) {
+            throw new Error('int8 must have exactly 1 byte');
+        }
+        return (bytes[0] & 0x80) ? bytes[0] - 0x100 : bytes[0];
+    };
+    int8.BYTES = 1;
+
+    var uint8fp5 = function (bytes) {
+        if (bytes.length !== uint8fp5.BYTES) {
+            throw new Error('int must have exactly 1 byte');
+        }
+        var res = bytes[0] * 0.5;
+        return res.toFixed(1);
+    };
+    uint8fp5.BYTES = 1;
+
+    var pv_flags = function (byte) {
+        if (byte.length !== pv_flags.BYTES) {
+            throw new Error('Bitmap must have exactly 1 byte');
+        }
+        var i = bytesToInt(byte);
+        var bm = ('00000000' + Number(i).toString(2)).substr(-8).split('').map(Number).map(Boolean);
+        return ['no_data', 'fault', 'string_fail', 'degradation', 'thermal_derate', 'clipping', 'mismatch', 'low_efficiency']
+            .reduce(function (obj, pos, index) {
+                obj[pos] = bm[index];
+                return obj;
+            }, {});
+    };
+    pv_flags.BYTES = 1;
+
     var decode = function (bytes, mask, names) {
 
         var maskLength = mask.reduce(function (prev, cur) {
@@ -210,6 +241,9 @@ function Decoder(bytes, port, uplink_info) {
             latLng: latLng,
             bitmap: bitmap,
             rawfloat: rawfloat,
+            int8: int8,
+            uint8fp5: uint8fp5,
+            pv_flags: pv_flags,
             uint16fp1: uint16fp1,
             modbus: modbus,
             decode: decode
@@ -230,7 +264,7 @@ function Decoder(bytes, port, uplink_info) {
                 'outputpower', 'gridvoltage', 'gridfrequency'
             ]
         );
-    } else {
+    } else if (port === 2) {
         return decode(
             bytes,
             [modbus, rawfloat, rawfloat, rawfloat, temperature, temperature,
@@ -240,6 +274,16 @@ function Decoder(bytes, port, uplink_info) {
                 'pv1energytoday', 'pv1energytotal'
             ]
         );
+    } else if (port === 3) {
+        return decode(
+            bytes,
+            [modbus, uint8, uint8, pv_flags, uint8fp5, uint8, uint8,
+                uint8, int8, int8, int8
+            ],
+            ['modbus', 'pv_samples', 'pv_score', 'pv_flags', 'pv_efficiency', 'pv_mismatch', 'pv_clipping',
+                'pv_derating', 'pv_thermal_corr', 'pv_eff_trend', 'pv_peak_trend'
+            ]
+        );
     }
 
     return decoded;
@@ -19,6 +19,11 @@
 // port = CMD_GET_DATETIME, {"cmd": "CMD_GET_DATETIME"} / payload = 0x00
 // port = CMD_SET_DATETIME, {"epoch": <epoch>}
 // port = CMD_GET_LW_CONFIG, {"cmd": "CMD_GET_LW_CONFIG"} / payload = 0x00
+// port = CMD_GET_SAMPLES, {"get_samples": [[<first_seq>, <count>], ...]}
+// port = CMD_GET_BLOB, {"get_blob": <blob_type>}
+// port = CMD_GET_STATUS_INTERVAL, {"cmd": "CMD_GET_STATUS_INTERVAL"} / payload = 0x00
+// port = CMD_SET_STATUS_INTERVAL, {"status_interval": <interval_in_frames>}
+// port = CMD_GET_SENSORS_STAT, {"cmd": "CMD_GET_SENSORS_STAT"} / payload = 0x00
 //
 // Responses:
 // -----------
@@ -28,6 +33,17 @@
 // 
 // CMD_GET_DATETIME {"epoch": <unix_epoch_time>, "rtc_source": <rtc_source>}
 //
+// CMD_GET_SAMPLES {"samples": [{"seq": <seq>, "timestamp": <epoch>, ...}, ...], "remaining": <remaining>}
+//
+// CMD_GET_STATUS_INTERVAL {"status_interval": <status_interval>}
+//
+// CMD_GET_SENSORS_STAT {"mb_transactions": <count>, "mb_err_*": <count>, ..., "awake_avg": <seconds>}
+//
+// CMD_GET_LW_STATUS {"ubatt_mv": <ubatt_mv>, "long_sleep": <long_sleep>,
+//                    "wg_incidents": <count>, "wg_last_incident": <phase>, "wg_awake_max": <seconds>}
+//                   (format changed with the wake guard: 7 instead of 3 bytes;
+//                    the short format of older firmware is still decoded)
+//
 //
 //
 // <sleep_interval>     : 0...65535
@@ -66,6 +82,16 @@
 // History:
 // 20240818 Copied from growatt2lorawan
 // 20240828 Added decoding of RTC source
+// 20261017 Added decoding of PV analytics (port 3)
+//          Added decoding of compressed power curve (port 4)
+//          Added decoding of dual-prediction reports (port 5) and dpPredict()
+//          Added decoding of sequence numbers and CMD_GET_SAMPLES
+//          Added decoding of parity frames (port 6) and fecRecover()
+//          Added decoding of blob fragment headers (port 7)
+//          Added empty poll uplinks (port 8)
+//          Added wake guard incident report (CMD_GET_LW_STATUS)
+//          Added decoding of inverter and energy meter data (port 9)
+//          Added CMD_GET_STATUS_INTERVAL and CMD_GET_SENSORS_STAT (health statistics)
 //
 // ToDo:
 // -  
@@ -76,6 +102,9 @@ function decoder(bytes, port) {
     const CMD_GET_DATETIME = 0x20;
     const CMD_GET_LW_CONFIG = 0x36;
     const CMD_GET_LW_STATUS = 0x38;
+    const CMD_GET_STATUS_INTERVAL = 0x40;
+    const CMD_GET_SENSORS_STAT = 0x42;
+    const CMD_GET_SAMPLES = 0x44;
 
     const rtc_source_code = {
         0x00: "GPS",
@@ -271,6 +300,59 @@ function decoder(bytes, port) {
     };
     bitmap.BYTES = 1;
 
+    var int8 = function (bytes) {
+        if (bytes.length !== int8.BYTES) {
+            throw new Error('int8 must have exactly 1 byte');
+        }
+        return (bytes[0] & 0x80) ? bytes[0] - 0x100 : bytes[0];
+    };
+    int8.BYTES = 1;
+
+    var int16 = function (bytes) {
+        if (bytes.length !== int16.BYTES) {
+            throw new Error('int16 must have exactly 2 bytes');
+        }
+        var i = bytesToInt(bytes);
+        return (i & 0x8000) ? i - 0x10000 : i;
+    };
+    int16.BYTES = 2;
+
+    var dp_reason = function (byte) {
+        if (byte.length !== dp_reason.BYTES) {
+            throw new Error('Bitmap must have exactly 1 byte');
+        }
+        return {
+            "power": (byte[0] & 0x01) !== 0,
+            "energy": (byte[0] & 0x02) !== 0,
+            "heartbeat": (byte[0] & 0x04) !== 0,
+            "resync": (byte[0] & 0x08) !== 0
+        };
+    };
+    dp_reason.BYTES = 1;
+
+    var uint8fp5 = function (bytes) {
+        if (bytes.length !== uint8fp5.BYTES) {
+            throw new Error('int must have exactly 1 byte');
+        }
+        var res = bytes[0] * 0.5;
+        return res.toFixed(1);
+    };
+    uint8fp5.BYTES = 1;
+
+    var pv_flags = function (byte) {
+        if (byte.length !== pv_flags.BYTES) {
+            throw new Error('Bitmap must have exactly 1 byte');
+        }
+        var i = bytesToInt(byte);
+        var bm = ('00000000' + Number(i).toString(2)).substr(-8).split('').map(Number).map(Boolean);
+        return ['no_data', 'fault', 'string_fail', 'degradation', 'thermal_derate', 'clipping', 'mismatch', 'low_efficiency']
+            .reduce(function (obj, pos, index) {
+                obj[pos] = bm[index];
+                return obj;
+            }, {});
+    };
+    pv_flags.BYTES = 1;
+
     var decode = function (bytes, mask, names) {
 
         var maskLength = mask.reduce(function (prev, cur) {
@@ -306,6 +388,9 @@ function decoder(bytes, port) {
             latLng: latLng,
             bitmap: bitmap,
             rawfloat: rawfloat,
+            int8: int8,
+            uint8fp5: uint8fp5,
+            pv_flags: pv_flags,
             uint16fp1: uint16fp1,
             modbus: modbus,
             decode: decode,
@@ -318,8 +403,16 @@ function decoder(bytes, port) {
     }
 
 
+    // Optional sample sequence number (appended to telemetry payloads)
+    var seq = function (res, offset) {
+        if (bytes.length >= offset + uint16.BYTES) {
+            res.seq = uint16(bytes.slice(offset, offset + uint16.BYTES));
+        }
+        return res;
+    };
+
     if (port === 1) {
-        return decode(
+        return seq(decode(
             bytes,
             [modbus, uint8, uint8, rawfloat, rawfloat, rawfloat,
                 rawfloat, rawfloat, rawfloat
@@ -327,9 +420,9 @@ function decoder(bytes, port) {
             ['modbus', 'status', 'faultcode', 'energytoday', 'energytotal', 'totalworktime',
                 'outputpower', 'gridvoltage', 'gridfrequency'
             ]
-        );
+        ), 27);
     } else if (port === 2) {
-        return decode(
+        return seq(decode(
             bytes,
             [modbus, rawfloat, rawfloat, rawfloat, temperature, temperature,
                 rawfloat, rawfloat
@@ -337,7 +430,146 @@ function decoder(bytes, port) {
             ['modbus', 'pv1voltage', 'pv1current', 'pv1power', 'tempinverter', 'tempipm',
                 'pv1energytoday', 'pv1energytotal'
             ]
+        ), 25);
+    } else if (port === 3) {
+        return decode(
+            bytes,
+            [modbus, uint8, uint8, pv_flags, uint8fp5, uint8, uint8,
+                uint8, int8, int8, int8
+            ],
+            ['modbus', 'pv_samples', 'pv_score', 'pv_flags', 'pv_efficiency', 'pv_mismatch', 'pv_clipping',
+                'pv_derating', 'pv_thermal_corr', 'pv_eff_trend', 'pv_peak_trend'
+            ]
+        );
+    } else if (port === 4) {
+        var res = decode(
+            bytes,
+            [modbus, uint32, uint16, uint8, uint8
+            ],
+            ['modbus', 'base', 'max_error', 'n_output', 'n_solar'
+            ]
+        );
+        // Breakpoints: {dt[15:0], value[15:0]}; linear interpolation between breakpoints
+        var offset = 9;
+        var curve = function (n) {
+            var pts = [];
+            for (var i = 0; i < n; i++) {
+                pts.push({
+                    "t": res.base + uint16(bytes.slice(offset, offset + 2)),
+                    "value": uint16(bytes.slice(offset + 2, offset + 4))
+                });
+                offset += 4;
+            }
+            return pts;
+        };
+        res.outputpower_curve = curve(res.n_output);
+        res.solarpower_curve = curve(res.n_solar);
+        return res;
+    } else if (port === 5) {
+        var res = decode(
+            bytes,
+            [modbus, dp_reason, uint32, uint16, int16, uint32
+            ],
+            ['modbus', 'dp_reason', 'dp_t0', 'outputpower', 'dp_trend', 'dp_energy'
+            ]
+        );
+        if (res.dp_energy !== undefined) {
+            res.energytotal = (res.dp_energy / 1000).toFixed(1);
+        }
+        return seq(res, 14);
+    } else if (port === 6) {
+        // Cross-frame parity: base_seq, k, k x {port, len}, parity
+        var res = decode(bytes, [uint16, uint8], ['fec_base', 'fec_k']);
+        res.fec_frames = [];
+        for (var i = 0; i < res.fec_k; i++) {
+            res.fec_frames.push({
+                "seq": (res.fec_base + i) & 0xFFFF,
+                "port": bytes[3 + 2 * i],
+                "len": bytes[4 + 2 * i]
+            });
+        }
+        res.fec_parity = bytes.slice(3 + 2 * res.fec_k);
+        return res;
+    } else if (port === 7) {
+        // Blob fragment - reassembly see extras/blob/blob_reassemble.cpp
+        var res = decode(
+            bytes,
+            [uint8, uint8, uint8, uint8, uint16
+            ],
+            ['blob_session', 'blob_type', 'blob_index', 'blob_n', 'blob_size'
+            ]
+        );
+        res.blob_redundancy = res.blob_index >= res.blob_n;
+        res.blob_data = bytes.slice(6);
+        return res;
+    } else if (port === 8) {
+        // Low-latency mode - empty poll uplink
+        return {};
+    } else if (port === 9) {
+        // Inverter and energy meters: inverter values, n x {modbus, power, import, export}
+        var res = decode(
+            bytes,
+            [modbus, uint8, rawfloat, rawfloat, rawfloat, uint8
+            ],
+            ['modbus', 'status', 'outputpower', 'energytoday', 'energytotal', 'n_meters'
+            ]
+        );
+        res.meters = [];
+        for (var i = 0; i < res.n_meters; i++) {
+            res.meters.push(decode(
+                bytes.slice(15 + 13 * i, 28 + 13 * i),
+                [modbus, rawfloat, rawfloat, rawfloat
+                ],
+                ['modbus', 'power', 'import', 'export'
+                ]
+            ));
+        }
+        return res;
+    } else if (port === CMD_GET_SAMPLES) {
+        // Backfill: n x 20 bytes sample records, 1 byte remaining
+        var samples = [];
+        for (var offset = 0; offset + 20 < bytes.length; offset += 20) {
+            var rec = decode(
+                bytes.slice(offset, offset + 20),
+                [uint16, uint32, uint8, uint8, uint16, uint16, uint32, uint16, uint16
+                ],
+                ['seq', 'timestamp', 'status', 'faultcode', 'outputpower', 'energytoday', 'energytotal',
+                    'gridvoltage', 'gridfrequency'
+                ]
+            );
+            rec.energytoday = (rec.energytoday * 0.1).toFixed(1);
+            rec.energytotal = (rec.energytotal * 0.1).toFixed(1);
+            rec.gridvoltage = (rec.gridvoltage * 0.1).toFixed(1);
+            rec.gridfrequency = (rec.gridfrequency * 0.01).toFixed(2);
+            samples.push(rec);
+        }
+        return {
+            "samples": samples,
+            "remaining": bytes[bytes.length - 1]
+        };
+    } else if (port === CMD_GET_STATUS_INTERVAL) {
+        return decode(
+            bytes,
+            [uint8
+            ],
+            ['status_interval'
+            ]
         );
+    } else if (port === CMD_GET_SENSORS_STAT) {
+        var stat = decode(
+            bytes,
+            [uint32, uint16, uint16, uint16, uint16, uint16, uint16, uint16, uint16,
+                uint16, uint16, uint16, uint32, uint16, uint32, uint32, uint16
+            ],
+            ['mb_transactions', 'mb_err_illegal_function', 'mb_err_illegal_data_address',
+                'mb_err_illegal_data_value', 'mb_err_slave_device_failure', 'mb_err_invalid_slave_id',
+                'mb_err_invalid_function', 'mb_err_response_timed_out', 'mb_err_invalid_crc',
+                'mb_retries', 'joins', 'restores', 'uplinks', 'uplink_failures', 'airtime',
+                'cycles', 'awake_avg'
+            ]
+        );
+        stat.awake_avg = (stat.awake_avg * 0.1).toFixed(1);
+        return stat;
     } else if (port === CMD_GET_DATETIME) {
         return decode(
             bytes,
@@ -355,11 +587,21 @@ function decoder(bytes, port) {
             ]
         );
     } else if (port === CMD_GET_LW_STATUS) {
+        if (bytes.length < 7) {
+            // Old format - firmware without wake guard report
+            return decode(
+                bytes,
+                [uint16, uint8
+                ],
+                ['ubatt_mv', 'long_sleep'
+                ]
+            );
+        }
         return decode(
             bytes,
-            [uint16, uint8
+            [uint16, uint8, uint8, uint8, uint16
             ],
-            ['ubatt_mv', 'long_sleep'
+            ['ubatt_mv', 'long_sleep', 'wg_incidents', 'wg_last_incident', 'wg_awake_max'
             ]
         );
     }
@@ -375,3 +617,65 @@ function decodeUplink(input) {
         errors: []
     };
 }
+
+// Dual-prediction reporting - shared predictor
+// Must be identical to src/DualPredictor.h
+// state: {"t0": dp_t0, "power": outputpower, "trend": dp_trend, "energy": dp_energy} from port 5
+// t:     unix time
+// returns {"outputpower": [W], "energy": [Wh]} predicted for time t
+var DP_TREND_HORIZON = 30;
+
+function dpPower(state, m) {
+    if (m > DP_TREND_HORIZON) {
+        m = DP_TREND_HORIZON;
+    }
+    var p = state.power + Math.trunc((state.trend * m) / 10);
+    return Math.min(Math.max(p, 0), 65535);
+}
+
+function dpPredict(state, t) {
+    var minutes = (t > state.t0) ? Math.floor((t - state.t0) / 60) : 0;
+    var acc = 0;
+    for (var m = 1; (m <= minutes) && (m <= DP_TREND_HORIZON); m++) {
+        acc += dpPower(state, m);
+    }
+    if (minutes > DP_TREND_HORIZON) {
+        acc += (minutes - DP_TREND_HORIZON) * dpPower(state, DP_TREND_HORIZON);
+    }
+    return {
+        "outputpower": dpPower(state, minutes),
+        "energy": state.energy + Math.floor(acc / 60)
+    };
+}
+
+// Cross-frame FEC - rebuild a single lost frame
+// Must be identical to fecRecover() in src/FrameParity.h
+// parity: raw bytes of parity frame (port 6)
+// frames: raw bytes of the frames of the group in sequence order; null if lost
+// returns {"port": <port>, "bytes": [...]} (decode with decoder(bytes, port)),
+//         null if nothing is missing or more than one frame is missing
+function fecRecover(parity, frames) {
+    var k = parity[2];
+    var hdr = 3 + 2 * k;
+    var out = parity.slice(hdr);
+    var lost = -1;
+    for (var i = 0; i < k; i++) {
+        if (!frames[i]) {
+            if (lost >= 0) {
+                return null;
+            }
+            lost = i;
+            continue;
+        }
+        for (var j = 0; (j < frames[i].length) && (j < out.length); j++) {
+            out[j] ^= frames[i][j];
+        }
+    }
+    if (lost < 0) {
+        return null;
+    }
+    return {
+        "port": parity[3 + 2 * lost],
+        "bytes": out.slice(0, parity[4 + 2 * lost])
+    };
+}
@@ -17,5 +17,38 @@
 #define RADIOLIB_LORAWAN_NWK_KEY   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 #endif
 
+// ABP (only used if LW_ABP is enabled in growatt2lorawan_cfg.h)
+// Device Address & session keys are provided by your network server;
+// for LoRaWAN 1.0.x, NwkSKey is used as NWKSENC_KEY and FNWKSINT_KEY/SNWKSINT_KEY are all zeros
+#ifndef RADIOLIB_LORAWAN_DEV_ADDR
+#define RADIOLIB_LORAWAN_DEV_ADDR   0x00000000
+#endif
+#ifndef RADIOLIB_LORAWAN_FNWKSINT_KEY
+#define RADIOLIB_LORAWAN_FNWKSINT_KEY   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+#endif
+#ifndef RADIOLIB_LORAWAN_SNWKSINT_KEY
+#define RADIOLIB_LORAWAN_SNWKSINT_KEY   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+#endif
+#ifndef RADIOLIB_LORAWAN_NWKSENC_KEY
+#define RADIOLIB_LORAWAN_NWKSENC_KEY    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+#endif
+#ifndef RADIOLIB_LORAWAN_APPS_KEY
+#define RADIOLIB_LORAWAN_APPS_KEY       0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+#endif
+
+// Wi-Fi/MQTT fast path (only used if MQTT_FASTPATH is enabled in growatt2lorawan_cfg.h)
+#ifndef WIFI_SSID
+#define WIFI_SSID       "SSID"
+#endif
+#ifndef WIFI_PASSWORD
+#define WIFI_PASSWORD   "PASSWORD"
+#endif
+#ifndef MQTT_USER
+#define MQTT_USER       ""
+#endif
+#ifndef MQTT_PASS
+#define MQTT_PASS       ""
+#endif
+
 // For the curious, the #ifndef blocks allow for automated testing &/or you can
 // put your EUI & keys in to your platformio.ini - see RadioLib wiki for more tips
@@ -33,6 +33,25 @@
 // History:
 //
 // 20240513 Created
+// 20261017 Added PV analytics (port 3)
+//          Added power curve compression (port 4)
+//          Added dual-prediction reporting (port 5)
+//          Added sequence numbers (ports 1, 2, 5) and backfill (CMD_GET_SAMPLES)
+//          Added cross-frame parity (port 6)
+//          Added blob transfer (CMD_GET_BLOB)
+//          Limited Modbus attempts per readout
+//          Added health statistics (CMD_GET_SENSORS_STAT, CMD_GET/SET_STATUS_INTERVAL)
+//          Added Wi-Fi/MQTT fast path (publishMqtt())
+//          Added Modbus slave proxy update
+//          Added energy meter (port 9)
+//          Added diagnostic burst (CMD_START_BURST)
+//          Moved encoding of ports 1 and 2 to UplinkSchema.h
+//          Moved encoding of port 9 to UplinkSchema.h
+//          Power curve cleared only after successful uplink (uplinkSent())
+//          Moved frame encoding of ports 1, 2, 4 and 5 to UplinkSchema.h
+//          Moved get requests to DownlinkDispatch.h
+//          Only one PV analytics snapshot per wake-up cycle
+//          Backfill ranges released only after successful uplink (uplinkSent())
 //
 //
 // ToDo:
@@ -43,16 +62,123 @@
 #include "AppLayer.h"
 #include "growattInterface.h"
 #include "growatt_cfg.h"
+#include "growatt2lorawan_cfg.h"
+#include "UplinkSchema.h"
 
 growattIF growattInterface(MAX485_RE_NEG, MAX485_DE, MAX485_RX, MAX485_TX);
+
+#define FEC_STORE_MAGIC 0x46454331 // "FEC1"
+
+/*!
+ * \brief Parity group (located in RTC RAM)
+ */
+struct FecStore
+{
+    uint32_t magic; //!< validity marker
+    bool ready;     //!< group complete, parity frame pending
+    FecGroup group; //!< parity group
+};
+
+// Parity group - must retain its contents during deep sleep
+#if defined(ESP32)
+RTC_DATA_ATTR FecStore fecStore;
+#else
+FecStore fecStore __attribute__((section(".uninitialized_data")));
+#endif
 //bool holdingregisters = false;
 
 uint8_t
 AppLayer::decodeDownlink(uint8_t port, uint8_t *payload, size_t size)
 {
+    if ((port == CMD_GET_SAMPLES) && sampleRing.request(payload, size))
+    {
+        log_d("Get samples");
+        return CMD_GET_SAMPLES;
+    }
+    if ((port == CMD_GET_BLOB) && (size == 1))
+    {
+        log_d("Get blob");
+        startBlob(payload[0]);
+        return 0;
+    }
+    if ((port == CMD_START_BURST) && burstCapture.request(payload, size))
+    {
+        log_d("Start burst");
+        return 0;
+    }
+    if ((port == CMD_SET_STATUS_INTERVAL) && (size == 1))
+    {
+        healthStats.setStatusInterval(payload[0]);
+        return 0;
+    }
     return 0;
 }
 
+bool AppLayer::startBlob(uint8_t type)
+{
+    uint8_t buf[BLOB_SIZE_MAX];
+    uint16_t size = 0;
+
+    if (type == BLOB_TYPE_INPUT_REGS)
+    {
+        if (!_inputRegsValid && (readInputRegisters() != growattInterface.Success))
+        {
+            return false;
+        }
+        for (uint8_t i = 0; i < growattInterface.numInputRegisters; i++)
+        {
+            buf[size++] = growattInterface.inputregisters[i] & 0xFF;
+            buf[size++] = growattInterface.inputregisters[i] >> 8;
+        }
+    }
+    else if (type == BLOB_TYPE_SAMPLES)
+    {
+        size = sampleRing.dump(buf, sizeof(buf));
+    }
+    else
+    {
+        log_w("Unknown blob type 0x%02X", type);
+        return false;
+    }
+    return blobTransfer.start(type, buf, size, BLOB_REDUNDANCY);
+}
+
+void AppLayer::addUplink(uint8_t port, const uint8_t *payload, uint8_t size)
+{
+    if ((FEC_GROUP_SIZE == 0) || ((port != 1) && (port != 5)))
+    {
+        return;
+    }
+    if ((size < 3) || (payload[0] != growattInterface.Success))
+    {
+        // Modbus error - no sample, no sequence number
+        return;
+    }
+    if ((fecStore.magic != FEC_STORE_MAGIC) || (fecStore.group.k != FEC_GROUP_SIZE))
+    {
+        memset(&fecStore, 0, sizeof(fecStore));
+        fecStore.magic = FEC_STORE_MAGIC;
+        fecReset(fecStore.group, 0, FEC_GROUP_SIZE);
+    }
+
+    // The sequence number is appended to the telemetry payload
+    uint16_t seq = payload[size - 2] | (payload[size - 1] << 8);
+    fecStore.ready = fecAdd(fecStore.group, seq, port, payload, size);
+    log_d("FEC group #%u: %u/%u frames", fecStore.group.base, fecStore.group.count, fecStore.group.k);
+}
+
+void AppLayer::uplinkSent(uint8_t port)
+{
+    if (port == 4)
+    {
+        powerCurve.clear();
+    }
+    else if (port == CMD_GET_SAMPLES)
+    {
+        sampleRing.sent();
+    }
+}
+
 void AppLayer::genPayload(uint8_t port, LoraEncoder &encoder)
 {
     (void)port;    // suppress warning regarding unused parameter
@@ -65,10 +191,80 @@ void AppLayer::getPayloadStage1(uint8_t port, LoraEncoder &encoder)
     (void)encoder; // suppress warning regarding unused parameter
 }
 
-void AppLayer::getPayloadStage2(uint8_t port, LoraEncoder &encoder)
+bool AppLayer::runBurst(void)
+{
+    if (blobTransfer.pending())
+    {
+        // The captured data could not be sent - try again in the next cycle
+        log_i("Diagnostic burst postponed - blob transfer in progress");
+        return false;
+    }
+
+    uint32_t duration = burstCapture.getDuration() * 1000UL;
+    uint32_t period = burstCapture.getPeriod() * 1000UL;
+    uint8_t retries = _modbusRetries;
+    uint32_t start = _rtc->getLocalEpoch();
+
+    log_i("Diagnostic burst: %lu s, period %lu s", duration / 1000, period / 1000);
+    burstCapture.start(start);
+
+    // Single readout attempt per sample - a failed sample is skipped
+    _modbusRetries = 1;
+    uint32_t t0 = millis();
+    for (uint32_t next = 0; next < duration; next += period)
+    {
+        uint32_t elapsed = millis() - t0;
+        if (next > elapsed)
+        {
+#if defined(ESP32)
+            Serial.flush();
+            esp_sleep_enable_timer_wakeup((next - elapsed) * 1000ULL);
+            esp_light_sleep_start();
+#else
+            delay(next - elapsed);
+#endif
+        }
+        _inputRegsValid = false;
+        if (readInputRegisters() != growattInterface.Success)
+        {
+            continue;
+        }
+        float meterPower = 0;
+        if (growattInterface.numDevices && (growattInterface.ReadDevices() == growattInterface.Success))
+        {
+            meterPower = growattInterface.devices[0].values[DEV_POWER];
+        }
+        if (!burstCapture.addSample(start + (millis() - t0) / 1000, growattInterface.modbusdata, meterPower))
+        {
+            break;
+        }
+    }
+    _modbusRetries = retries;
+
+    return blobTransfer.start(BLOB_TYPE_BURST, burstCapture.getData(), burstCapture.getSize(), BLOB_REDUNDANCY);
+}
+
+void AppLayer::addDevices(void)
+{
+#if METER_TYPE > 0
+    if (!growattInterface.addDevice(METER_TYPE, METER_SLAVE_ID, METER_RATE))
+    {
+        log_e("Invalid METER_TYPE");
+    }
+#endif
+}
+
+uint8_t AppLayer::readInputRegisters(void)
 {
     uint8_t result;
 
+#if MODBUS_SNIFF
+    if (_inputRegsValid)
+    {
+        // Already acquired in this wake-up cycle
+        return growattInterface.Success;
+    }
+#endif
     growattInterface.initGrowatt();
     delay(500);
     /*
@@ -81,20 +277,39 @@ void AppLayer::getPayloadStage2(uint8_t port, LoraEncoder &encoder)
     }
     */
 
+#if MODBUS_SNIFF
+    // Listen to another master's traffic first - no additional bus load
+    result = growattInterface.SniffInputRegisters(SNIFF_WINDOW * 1000UL);
+    healthStats.modbusResult(result);
+    if (result != growattInterface.Success)
+    {
+        log_i("No complete Modbus traffic observed - polling inverter");
+    }
+#else
+    result = ModbusRtuMaster::ku8MBResponseTimedOut;
+#endif
+
     int retries = 0;
-    do
+    while ((result != growattInterface.Success) && (retries < _modbusRetries))
     {
+        if (retries > 0)
+        {
+            healthStats.modbusRetry();
+        }
         result = growattInterface.ReadInputRegisters(NULL);
+        healthStats.modbusResult((result == growattInterface.Continue) ? growattInterface.Success : result);
         log_d("ReadInputRegisters: 0x%02x", result);
         if ((result != growattInterface.Continue) && (result != growattInterface.Success))
         {
             String message = growattInterface.sendModbusError(result);
             log_e("Error: %s", message.c_str());
         }
-        while (result == growattInterface.Continue)
+        // Each Continue reads the next register block - limit in case the transfer never completes
+        for (int blocks = 0; (result == growattInterface.Continue) && (blocks < MODBUS_BLOCKS_MAX); blocks++)
         {
             delay(1000);
             result = growattInterface.ReadInputRegisters(NULL);
+            healthStats.modbusResult((result == growattInterface.Continue) ? growattInterface.Success : result);
             String message = growattInterface.sendModbusError(result);
             if (result != growattInterface.Continue && (result != growattInterface.Success))
             {
@@ -106,39 +321,205 @@ void AppLayer::getPayloadStage2(uint8_t port, LoraEncoder &encoder)
                 log_d("%s", message.c_str());
             }
         }
-    } while ((result != growattInterface.Success) && (++retries < MODBUS_RETRIES));
+        retries++;
+    }
+
+    _inputRegsValid = (result == growattInterface.Success);
+#if MODBUS_PROXY
+    if (_inputRegsValid)
+    {
+        // Local consumers are served from this snapshot
+        modbusProxy.update(growattInterface.inputregisters, growattInterface.numInputRegisters);
+    }
+#endif
+    return result;
+}
+
+uint16_t AppLayer::addSample(time_t timestamp)
+{
+    // Only one sample per wake-up cycle (MQTT and LoRaWAN use the same readout)
+    if (_sampleSeq < 0)
+    {
+        _sampleSeq = sampleRing.add(growattInterface.modbusdata, timestamp);
+    }
+    return static_cast<uint16_t>(_sampleSeq);
+}
+
+void AppLayer::addSnapshot(time_t timestamp)
+{
+    // Only one snapshot per wake-up cycle (MQTT and LoRaWAN use the same readout)
+    if (!_snapshotAdded)
+    {
+        pvAnalytics.addSnapshot(growattInterface.modbusdata, timestamp);
+        _snapshotAdded = true;
+    }
+}
+
+#if MQTT_FASTPATH
+bool AppLayer::publishMqtt(void)
+{
+    mqttFastPath.begin();
+    if (!mqttFastPath.connect())
+    {
+        return false;
+    }
+
+    bool ok = true;
+    if (readInputRegisters() == growattInterface.Success)
+    {
+        time_t t_now = *_rtcLastClockSync ? _rtc->getLocalEpoch() : 0;
+        uint16_t seq = addSample(t_now);
+        ok = mqttFastPath.publishData(growattInterface.modbusdata, seq, t_now);
+        if (ok)
+        {
+            addSnapshot(t_now);
+        }
+    }
+    // Drain backlog (incl. samples acquired while the broker was not reachable)
+    ok = ok && mqttFastPath.drain(sampleRing);
+    mqttFastPath.end();
+
+    return ok && !mqttFastPath.lorawanDue();
+}
+#endif
+
+void AppLayer::getSample(void)
+{
+    if (readInputRegisters() == growattInterface.Success)
+    {
+        powerCurve.addSample(_rtc->getLocalEpoch(),
+                             growattInterface.modbusdata.outputpower,
+                             growattInterface.modbusdata.solarpower);
+    }
+}
+
+void AppLayer::getPayloadStage2(uint8_t port, LoraEncoder &encoder)
+{
+    if (port == 6)
+    {
+        // Parity frame - no Modbus access, only sent when a group is complete
+        if ((fecStore.magic == FEC_STORE_MAGIC) && fecStore.ready)
+        {
+            uint8_t buf[3 + 2 * FEC_GROUP_MAX + FEC_FRAME_MAX];
+            size_t size = fecEncode(fecStore.group, buf);
+            if (size <= _payloadSizeMax)
+            {
+                for (size_t i = 0; i < size; i++)
+                {
+                    encoder.writeUint8(buf[i]);
+                }
+            }
+            else
+            {
+                log_w("Parity frame exceeds maximum payload size");
+            }
+            fecStore.ready = false;
+        }
+        return;
+    }
+
+    uint8_t result = readInputRegisters();
 
-    encoder.writeUint8(result);
-    if (result == growattInterface.Success)
+    if (port == 9)
     {
-        log_v("Port: %d", port);
-        if (port == 1)
+        // Production (inverter) and consumption (energy meters) in one frame;
+        // the inverter values are only valid if result is Success
+        encodeInverterSummary(encoder, result, growattInterface.modbusdata);
+
+        growattInterface.ReadDevices();
+        encoder.writeUint8(growattInterface.numDevices);
+        for (uint8_t i = 0; i < growattInterface.numDevices; i++)
         {
-            encoder.writeUint8(growattInterface.modbusdata.status);
-            encoder.writeUint8(growattInterface.modbusdata.faultcode);
-            encoder.writeRawFloat(growattInterface.modbusdata.energytoday);
-            encoder.writeRawFloat(growattInterface.modbusdata.energytotal);
-            encoder.writeRawFloat(growattInterface.modbusdata.totalworktime);
-            encoder.writeRawFloat(growattInterface.modbusdata.outputpower);
-            encoder.writeRawFloat(growattInterface.modbusdata.gridvoltage);
-            encoder.writeRawFloat(growattInterface.modbusdata.gridfrequency);
+            const growattIF::modbus_device &dev = growattInterface.devices[i];
+            healthStats.modbusResult(dev.result);
+            encodeMeter(encoder, dev.result, dev.values);
         }
-        else
+        return;
+    }
+
+    if ((port == 5) && (result == growattInterface.Success))
+    {
+        // Dual-prediction reporting - skip uplink if measurement matches prediction
+        time_t t_now = *_rtcLastClockSync ? _rtc->getLocalEpoch() : 0;
+        addSnapshot(t_now);
+        if (!dualPrediction.update(t_now,
+                                   growattInterface.modbusdata.outputpower,
+                                   growattInterface.modbusdata.energytotal))
         {
-            encoder.writeRawFloat(growattInterface.modbusdata.pv1voltage);
-            encoder.writeRawFloat(growattInterface.modbusdata.pv1current);
-            encoder.writeRawFloat(growattInterface.modbusdata.pv1power);
-            encoder.writeTemperature(growattInterface.modbusdata.tempinverter);
-            encoder.writeTemperature(growattInterface.modbusdata.tempipm);
-            encoder.writeRawFloat(growattInterface.modbusdata.pv1energytoday);
-            encoder.writeRawFloat(growattInterface.modbusdata.pv1energytotal);
+            return;
         }
     }
+
+    if (result != growattInterface.Success)
+    {
+        encoder.writeUint8(result);
+        return;
+    }
+
+    log_v("Port: %d", port);
+    if (port == 1)
+    {
+        // Add snapshot to PV analytics history
+        time_t t_now = *_rtcLastClockSync ? _rtc->getLocalEpoch() : 0;
+        addSnapshot(t_now);
+
+        // Add sample to ring and append its sequence number
+        encodeStatusUplink(encoder, growattInterface.modbusdata, addSample(t_now));
+    }
+    else if (port == 2)
+    {
+        // Sequence number of latest sample
+        encodePv1Uplink(encoder, growattInterface.modbusdata, sampleRing.getSeq());
+    }
+    else if (port == 3)
+    {
+        PvInsights insights;
+        pvAnalytics.evaluate(insights);
+        encoder.writeUint8(result);
+        encoder.writeUint8(insights.samples);
+        encoder.writeUint8(insights.score);
+        encoder.writeUint8(insights.flags);
+        encoder.writeUint8(insights.efficiency);
+        encoder.writeUint8(insights.mismatch);
+        encoder.writeUint8(insights.clipping);
+        encoder.writeUint8(insights.derating);
+        encoder.writeUint8(static_cast<uint8_t>(insights.thermalCorr));
+        encoder.writeUint8(static_cast<uint8_t>(insights.effTrend));
+        encoder.writeUint8(static_cast<uint8_t>(insights.peakTrend));
+    }
+    else if (port == 4)
+    {
+        powerCurve.addSample(_rtc->getLocalEpoch(),
+                             growattInterface.modbusdata.outputpower,
+                             growattInterface.modbusdata.solarpower);
+        powerCurve.encode(encoder, _payloadSizeMax - encoder.getLength(), SDT_MAX_ERROR);
+    }
+    else if (port == 5)
+    {
+        // Add sample to ring and append its sequence number
+        time_t t_now = *_rtcLastClockSync ? _rtc->getLocalEpoch() : 0;
+        dualPrediction.encode(encoder, addSample(t_now));
+    }
+    else
+    {
+        encoder.writeUint8(result);
+    }
 }
 
 void AppLayer::getConfigPayload(uint8_t cmd, uint8_t &port, LoraEncoder &encoder)
 {
-    (void)cmd;     // suppress warning regarding unused parameter
-    (void)port;    // suppress warning regarding unused parameter
-    (void)encoder; // suppress warning regarding unused parameter
+    (void)port; // suppress warning regarding unused parameter
+
+    if (cmd == CMD_GET_SAMPLES)
+    {
+        sampleRing.encode(encoder, _payloadSizeMax);
+    }
+    else if (cmd == CMD_GET_STATUS_INTERVAL)
+    {
+        encoder.writeUint8(healthStats.getStatusInterval());
+    }
+    else if (cmd == CMD_GET_SENSORS_STAT)
+    {
+        healthStats.encode(encoder);
+    }
 }
@@ -33,6 +33,19 @@
 //
 // 20240513 Created
 // 20240607 Added getAppStatusUplinkInterval() for compatibility
+// 20261017 Added PV analytics
+//          Added power curve compression
+//          Added dual-prediction reporting
+//          Added sequence numbers and backfill (CMD_GET_SAMPLES)
+//          Added cross-frame parity (addUplink())
+//          Added blob transfer
+//          Added setModbusRetries()
+//          Added health statistics (CMD_GET_SENSORS_STAT)
+//          Added Wi-Fi/MQTT fast path
+//          Added Modbus slave proxy
+//          Added energy meter (port 9)
+//          Added diagnostic burst (CMD_START_BURST)
+//          Added uplinkSent()
 //
 // ToDo:
 // -
@@ -46,6 +59,17 @@
 #include <LoraMessage.h> // see https://github.com/thesolarnomad/lora-serialization
 //#include <Preferences.h> // keep this to store data persistently
 #include "growatt2lorawan_cmd.h"
+#include "growatt_cfg.h"
+#include "PvAnalytics.h"
+#include "PowerCurve.h"
+#include "DualPrediction.h"
+#include "SampleRing.h"
+#include "FrameParity.h"
+#include "BlobTransfer.h"
+#include "HealthStats.h"
+#include "MqttFastPath.h"
+#include "ModbusSlaveProxy.h"
+#include "BurstCapture.h"
 //#include "adc/adc.h" // keep this for using ADC functions
 
 
@@ -60,6 +84,85 @@ private:
     ESP32Time *_rtc;
     time_t *_rtcLastClockSync;
 
+    /// PV analytics
+    PvAnalytics pvAnalytics;
+
+    /// Power curve compression
+    PowerCurve powerCurve;
+
+    /// Dual-prediction reporting
+    DualPrediction dualPrediction;
+
+    /// Sequence-numbered samples for backfill
+    SampleRing sampleRing;
+
+    /// Bulk data transfer
+    BlobTransfer blobTransfer;
+
+    /// Node health telemetry
+    HealthStats healthStats;
+
+    /// Wi-Fi/MQTT fast path
+    MqttFastPath mqttFastPath;
+
+    /// Modbus slave proxy (serves cached input registers)
+    ModbusSlaveProxy modbusProxy;
+
+    /// Diagnostic burst
+    BurstCapture burstCapture;
+
+    /// Sequence number of sample added in current wake-up cycle (-1: none)
+    int32_t _sampleSeq = -1;
+
+    /*!
+     * \brief Add current inverter data to sample ring (once per wake-up cycle)
+     *
+     * \param timestamp unix time of acquisition
+     *
+     * \returns sequence number of sample
+     */
+    uint16_t addSample(time_t timestamp);
+
+    /// PV analytics snapshot added in current wake-up cycle
+    bool _snapshotAdded = false;
+
+    /*!
+     * \brief Add current inverter data to PV analytics history (once per wake-up cycle)
+     *
+     * \param timestamp unix time of acquisition
+     */
+    void addSnapshot(time_t timestamp);
+
+    /// Input register image valid (read in current wake-up cycle)
+    bool _inputRegsValid = false;
+
+    /*!
+     * \brief Start blob transfer requested by downlink
+     *
+     * \param type blob type (BLOB_TYPE_*)
+     *
+     * \returns true if transfer has been started
+     */
+    bool startBlob(uint8_t type);
+
+    /// Maximum uplink payload size
+    uint8_t _payloadSizeMax = 51;
+
+    /// Number of Modbus read attempts
+    uint8_t _modbusRetries = MODBUS_RETRIES;
+
+    /*!
+     * \brief Read input registers (with retries)
+     *
+     * \returns Modbus result code
+     */
+    uint8_t readInputRegisters(void);
+
+    /*!
+     * \brief Add configured devices (METER_TYPE) to polling schedule
+     */
+    void addDevices(void);
+
     /// Preferences (stored in flash memory)
     //Preferences appPrefs;
 
@@ -83,8 +186,47 @@ public:
      */
     void begin(void)
     {
+        pvAnalytics.begin();
+        powerCurve.begin();
+        dualPrediction.begin(DP_POWER_BOUND, DP_ENERGY_BOUND, DP_HEARTBEAT);
+        sampleRing.begin();
+        blobTransfer.begin();
+        healthStats.begin();
+        burstCapture.begin();
+#if MODBUS_PROXY
+        Serial1.begin(PROXY_RATE, SERIAL_8N1, PROXY_RX, PROXY_TX);
+        modbusProxy.begin(Serial1, PROXY_SLAVE_ID, PROXY_DE);
+#endif
+        addDevices();
     };
 
+    /*!
+     * \brief Set maximum uplink payload size
+     *
+     * \param size maximum payload size in bytes (depending on data rate)
+     */
+    void setPayloadSizeMax(uint8_t size)
+    {
+        _payloadSizeMax = size;
+    };
+
+    /*!
+     * \brief Set number of Modbus read attempts
+     *
+     * \param retries number of attempts (default: MODBUS_RETRIES)
+     */
+    void setModbusRetries(uint8_t retries)
+    {
+        _modbusRetries = retries;
+    };
+
+    /*!
+     * \brief Acquire power curve sample
+     *
+     * Used in sample-only wake-ups between uplinks.
+     */
+    void getSample(void);
+
     /*!
      * \brief Get sensor status message uplink interval
      *
@@ -92,7 +234,115 @@ public:
      */
     uint8_t getAppStatusUplinkInterval(void)
     {
-        return 0;
+        return healthStats.getStatusInterval();
+    };
+
+    /*!
+     * \brief Check if a diagnostic burst has been requested (CMD_START_BURST)
+     */
+    bool burstPending(void)
+    {
+        return burstCapture.pending();
+    };
+
+    /*!
+     * \brief Get duration of requested diagnostic burst [s]
+     */
+    uint16_t getBurstDuration(void)
+    {
+        return burstCapture.getDuration();
+    };
+
+    /*!
+     * \brief Run diagnostic burst
+     *
+     * Samples the requested fields at the requested period (light sleep
+     * in between) and starts the blob transfer of the captured data.
+     * Takes up to getBurstDuration() seconds. The burst is postponed
+     * while another blob transfer is in progress.
+     *
+     * \returns true if the burst has been executed
+     */
+    bool runBurst(void);
+
+    /*!
+     * \brief Publish inverter data and sample backlog via Wi-Fi/MQTT
+     *
+     * Only available if MQTT_FASTPATH is enabled.
+     *
+     * \returns true if the LoRaWAN uplinks can be skipped in this cycle
+     */
+    bool publishMqtt(void);
+
+    /*!
+     * \brief Register transmitted uplink
+     *
+     * Telemetry frames (ports 1 and 5) are added to the current parity group
+     * if cross-frame FEC is enabled (FEC_GROUP_SIZE > 0). Must only be called
+     * after the uplink has been sent successfully - the parity frame can only
+     * recover frames which have actually been transmitted.
+     *
+     * \param port    uplink port
+     * \param payload uplink payload
+     * \param size    payload size in bytes
+     */
+    void addUplink(uint8_t port, const uint8_t *payload, uint8_t size);
+
+    /*!
+     * \brief Uplink has been sent successfully
+     *
+     * Releases data which is kept until it has been transmitted
+     * (power curve samples, port 4; backfill ranges, CMD_GET_SAMPLES).
+     *
+     * \param port uplink port
+     */
+    void uplinkSent(uint8_t port);
+
+    /*!
+     * \brief Start blob transfer
+     *
+     * \param type blob type (BLOB_TYPE_*)
+     * \param data blob data
+     * \param size blob size in bytes
+     *
+     * \returns false if a transfer is already in progress or the blob is too large
+     */
+    bool startBlob(uint8_t type, const uint8_t *data, uint16_t size)
+    {
+        return blobTransfer.start(type, data, size, BLOB_REDUNDANCY);
+    };
+
+    /*!
+     * \brief Get next blob fragment
+     *
+     * \param buf  buffer of at least PAYLOAD_SIZE bytes
+     * \param size fragment size
+     *
+     * \returns false if no fragment is pending
+     */
+    bool getBlobFragment(uint8_t *buf, uint8_t &size)
+    {
+        return blobTransfer.getFragment(buf, size);
+    };
+
+    /*!
+     * \brief Advance to next blob fragment (after successful transmission)
+     */
+    void blobFragmentSent(void)
+    {
+        blobTransfer.fragmentSent();
+    };
+
+    /*!
+     * \brief Get pending config/status uplink request
+     *
+     * Used for requests which take more than one uplink (e.g. backfill).
+     *
+     * \returns command ID or 0
+     */
+    uint8_t getPendingUplinkReq(void)
+    {
+        return sampleRing.pending() ? CMD_GET_SAMPLES : 0;
     };
 
     /*!
@@ -136,6 +386,9 @@ public:
      * - The sensor preparation has been started in stage1
      * - The data aquistion has to be done immediately before uplink
      *
+     * If no payload is written (dual-prediction reporting), the uplink
+     * is skipped.
+     *
      * \param port LoRaWAN port
      * \param encoder uplink encoder object
      */
@@ -0,0 +1,111 @@
+///////////////////////////////////////////////////////////////////////////////
+// BlobTransfer.cpp
+//
+// Bulk data (blob) transfer - fragmented uplinks which are sent across
+// several wake-up cycles (see FragCodec.h)
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "BlobTransfer.h"
+
+#define BLOB_STORE_MAGIC 0x424C4231 // "BLB1"
+
+// Blob transfer state - must retain its contents during deep sleep
+#if defined(ESP32)
+RTC_DATA_ATTR BlobStore blobStore;
+#else
+BlobStore blobStore __attribute__((section(".uninitialized_data")));
+#endif
+
+void BlobTransfer::begin(void)
+{
+    if (blobStore.magic != BLOB_STORE_MAGIC)
+    {
+        log_d("Initializing blob transfer");
+        memset(&blobStore, 0, sizeof(blobStore));
+        blobStore.magic = BLOB_STORE_MAGIC;
+    }
+}
+
+bool BlobTransfer::start(uint8_t type, const uint8_t *data, uint16_t size, uint8_t redundancy)
+{
+    if (pending())
+    {
+        log_w("Blob transfer in progress");
+        return false;
+    }
+    if ((size == 0) || (size > BLOB_SIZE_MAX))
+    {
+        log_w("Invalid blob size: %u", size);
+        return false;
+    }
+
+    uint8_t n = fragCount(size, BLOB_FRAG_SIZE);
+    memcpy(blobStore.data, data, size);
+    blobStore.session++;
+    blobStore.type = type;
+    blobStore.size = size;
+    blobStore.total = n + min(redundancy, static_cast<uint8_t>(255 - n));
+    blobStore.next = 0;
+    log_i("Blob transfer #%u: type 0x%02X, %u bytes, %u fragments",
+          blobStore.session, type, size, blobStore.total);
+    return true;
+}
+
+bool BlobTransfer::pending(void)
+{
+    return blobStore.next < blobStore.total;
+}
+
+bool BlobTransfer::getFragment(uint8_t *buf, uint8_t &size)
+{
+    if (!pending())
+    {
+        return false;
+    }
+    size = fragEncode(blobStore.data, blobStore.size, blobStore.session, blobStore.type,
+                      blobStore.next, BLOB_FRAG_SIZE, buf);
+    return true;
+}
+
+void BlobTransfer::fragmentSent(void)
+{
+    if (pending())
+    {
+        blobStore.next++;
+        log_d("Blob transfer #%u: %u/%u fragments sent", blobStore.session, blobStore.next, blobStore.total);
+    }
+}
@@ -0,0 +1,121 @@
+///////////////////////////////////////////////////////////////////////////////
+// BlobTransfer.h
+//
+// Bulk data (blob) transfer - fragmented uplinks which are sent across
+// several wake-up cycles (see FragCodec.h)
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_BLOBTRANSFER_H)
+#define _BLOBTRANSFER_H
+
+#include <Arduino.h>
+#include "FragCodec.h"
+
+/// Maximum blob size (kept in RTC RAM)
+#define BLOB_SIZE_MAX 1024
+
+/// Fragment data size - fits into the smallest uplink at any data rate
+#define BLOB_FRAG_SIZE (51 - FRAG_HDR_SIZE)
+
+/// Blob types
+#define BLOB_TYPE_INPUT_REGS 0x01 //!< raw input register image
+#define BLOB_TYPE_SAMPLES    0x02 //!< all samples from the sample ring
+#define BLOB_TYPE_BURST      0x03 //!< diagnostic burst (see BurstCapture.h)
+#define BLOB_TYPE_UPLINK     0x80 //!< oversized uplink payload; bits 6..0: port
+
+/*!
+ * \brief Blob transfer state (located in RTC RAM)
+ */
+struct BlobStore
+{
+    uint32_t magic;              //!< validity marker
+    uint8_t session;             //!< session ID
+    uint8_t type;                //!< blob type
+    uint16_t size;               //!< blob size
+    uint8_t total;               //!< number of data + redundancy fragments
+    uint8_t next;                //!< index of next fragment
+    uint8_t data[BLOB_SIZE_MAX]; //!< blob data
+};
+
+/*!
+ * \brief Blob transfer
+ *
+ * Keeps a blob in RTC RAM and provides its fragments one at a time, so the
+ * transfer can be paced by the duty cycle limits and continued after
+ * deep sleep.
+ */
+class BlobTransfer
+{
+public:
+    /*!
+     * \brief Initialize state (if RTC RAM contents are invalid)
+     */
+    void begin(void);
+
+    /*!
+     * \brief Start transfer of a new blob
+     *
+     * \param type       blob type
+     * \param data       blob data
+     * \param size       blob size (max. BLOB_SIZE_MAX)
+     * \param redundancy number of redundancy fragments
+     *
+     * \returns false if a transfer is already in progress or the blob is too large
+     */
+    bool start(uint8_t type, const uint8_t *data, uint16_t size, uint8_t redundancy);
+
+    /*!
+     * \brief Check if fragments are pending
+     */
+    bool pending(void);
+
+    /*!
+     * \brief Get next fragment
+     *
+     * \param buf  buffer of at least FRAG_HDR_SIZE + BLOB_FRAG_SIZE bytes
+     * \param size fragment size
+     *
+     * \returns false if no fragment is pending
+     */
+    bool getFragment(uint8_t *buf, uint8_t &size);
+
+    /*!
+     * \brief Advance to next fragment (after successful transmission)
+     */
+    void fragmentSent(void);
+};
+#endif // _BLOBTRANSFER_H
@@ -0,0 +1,197 @@
+///////////////////////////////////////////////////////////////////////////////
+// BurstCapture.cpp
+//
+// Downlink-triggered diagnostic burst - high-rate capture of selected
+// inverter values, sent as blob
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "BurstCapture.h"
+#include "growatt2lorawan_cfg.h"
+
+#define BURST_STORE_MAGIC 0x42525331 // "BRS1"
+
+// Burst request - must retain its contents during deep sleep
+#if defined(ESP32)
+RTC_DATA_ATTR BurstStore burstStore;
+#else
+BurstStore burstStore __attribute__((section(".uninitialized_data")));
+#endif
+
+// Convert float to uint16_t with saturation
+static uint16_t toUint16(float val)
+{
+    if (val <= 0)
+    {
+        return 0;
+    }
+    if (val >= 65535.0f)
+    {
+        return 65535;
+    }
+    return static_cast<uint16_t>(val + 0.5f);
+}
+
+// Convert float to int16_t (as uint16_t) with saturation
+static uint16_t toInt16(float val)
+{
+    return static_cast<uint16_t>(static_cast<int16_t>(constrain(lroundf(val), -32768L, 32767L)));
+}
+
+void BurstCapture::begin(void)
+{
+    if (burstStore.magic != BURST_STORE_MAGIC)
+    {
+        memset(&burstStore, 0, sizeof(burstStore));
+        burstStore.magic = BURST_STORE_MAGIC;
+    }
+}
+
+bool BurstCapture::request(const uint8_t *payload, size_t size)
+{
+    if (size != 4)
+    {
+        return false;
+    }
+    uint16_t duration = (payload[0] << 8) | payload[1];
+    uint8_t period = payload[2];
+    uint8_t fields = payload[3];
+
+    if ((duration == 0) || (period < BURST_PERIOD_MIN) || (fields == 0))
+    {
+        log_w("Invalid burst request");
+        return false;
+    }
+    burstStore.duration = min(duration, static_cast<uint16_t>(BURST_DURATION_MAX));
+    burstStore.period = period;
+    burstStore.fields = fields;
+    burstStore.pending = true;
+    log_d("Burst requested: %u s, period %u s, fields 0x%02X", burstStore.duration, period, fields);
+    return true;
+}
+
+bool BurstCapture::pending(void)
+{
+    return burstStore.pending;
+}
+
+uint16_t BurstCapture::getDuration(void)
+{
+    return burstStore.duration;
+}
+
+uint8_t BurstCapture::getPeriod(void)
+{
+    return burstStore.period;
+}
+
+void BurstCapture::start(uint32_t timestamp)
+{
+    burstStore.pending = false;
+    _start = timestamp;
+    _fields = burstStore.fields;
+    _count = 0;
+    _size = BURST_HDR_SIZE;
+
+    _buf[0] = timestamp & 0xFF;
+    _buf[1] = (timestamp >> 8) & 0xFF;
+    _buf[2] = (timestamp >> 16) & 0xFF;
+    _buf[3] = timestamp >> 24;
+    _buf[4] = burstStore.period;
+    _buf[5] = _fields;
+    _buf[6] = 0;
+    _buf[7] = 0;
+}
+
+bool BurstCapture::addSample(uint32_t timestamp, const growattIF::modbus_input_registers &data, float meterPower)
+{
+    uint16_t values[8];
+    uint8_t n = 0;
+
+    for (uint8_t bit = 0; bit < 8; bit++)
+    {
+        if (!(_fields & (1 << bit)))
+        {
+            continue;
+        }
+        switch (1 << bit)
+        {
+        case BURST_F_OUTPUTPOWER:
+            values[n++] = toUint16(data.outputpower);
+            break;
+        case BURST_F_SOLARPOWER:
+            values[n++] = toUint16(data.solarpower);
+            break;
+        case BURST_F_PV1POWER:
+            values[n++] = toUint16(data.pv1power);
+            break;
+        case BURST_F_PV2POWER:
+            values[n++] = toUint16(data.pv2power);
+            break;
+        case BURST_F_GRIDVOLTAGE:
+            values[n++] = toUint16(data.gridvoltage * 10);
+            break;
+        case BURST_F_GRIDFREQUENCY:
+            values[n++] = toUint16(data.gridfrequency * 100);
+            break;
+        case BURST_F_TEMPINVERTER:
+            values[n++] = toInt16(data.tempinverter * 10);
+            break;
+        default:
+            values[n++] = toInt16(meterPower);
+            break;
+        }
+    }
+
+    if (_size + 2 + 2 * n > BLOB_SIZE_MAX)
+    {
+        log_w("Burst buffer full");
+        return false;
+    }
+    uint16_t dt = static_cast<uint16_t>(timestamp - _start);
+    _buf[_size++] = dt & 0xFF;
+    _buf[_size++] = dt >> 8;
+    for (uint8_t i = 0; i < n; i++)
+    {
+        _buf[_size++] = values[i] & 0xFF;
+        _buf[_size++] = values[i] >> 8;
+    }
+    _count++;
+    _buf[6] = _count & 0xFF;
+    _buf[7] = _count >> 8;
+    log_v("Burst sample #%u, dt=%u s", _count, dt);
+    return true;
+}
@@ -0,0 +1,163 @@
+///////////////////////////////////////////////////////////////////////////////
+// BurstCapture.h
+//
+// Downlink-triggered diagnostic burst - high-rate capture of selected
+// inverter values, sent as blob
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_BURSTCAPTURE_H)
+#define _BURSTCAPTURE_H
+
+#include <Arduino.h>
+#include "growattInterface.h"
+#include "BlobTransfer.h"
+
+/// Field set (BurstStore::fields) - each field is encoded as 16 bit value (LE)
+#define BURST_F_OUTPUTPOWER   0x01 //!< outputpower [W]
+#define BURST_F_SOLARPOWER    0x02 //!< solarpower [W]
+#define BURST_F_PV1POWER      0x04 //!< pv1power [W]
+#define BURST_F_PV2POWER      0x08 //!< pv2power [W]
+#define BURST_F_GRIDVOLTAGE   0x10 //!< gridvoltage [0.1 V]
+#define BURST_F_GRIDFREQUENCY 0x20 //!< gridfrequency [0.01 Hz]
+#define BURST_F_TEMPINVERTER  0x40 //!< tempinverter [0.1 degC], signed
+#define BURST_F_METERPOWER    0x80 //!< power of first energy meter [W], signed
+
+/// Blob header: start[31:0], period[7:0], fields[7:0], n[15:0]
+#define BURST_HDR_SIZE 8
+
+/*!
+ * \brief Burst request (located in RTC RAM)
+ */
+struct BurstStore
+{
+    uint32_t magic;    //!< validity marker
+    bool pending;      //!< capture requested
+    uint16_t duration; //!< capture duration [s]
+    uint8_t period;    //!< sampling period [s]
+    uint8_t fields;    //!< field set (BURST_F_*)
+};
+
+/*!
+ * \brief Diagnostic burst capture
+ *
+ * A burst is requested by downlink (CMD_START_BURST) with duration, sampling
+ * period and field set. The application samples at the requested rate
+ * (light sleep in between), collects the records with addSample() and sends
+ * the buffer as blob (BLOB_TYPE_BURST). The request is one-shot, i.e. the
+ * node returns to its normal schedule afterwards.
+ *
+ * Blob format (little endian):
+ *   start[31:0], period[7:0], fields[7:0], n[15:0],
+ *   n x {dt[15:0], <one 16 bit value per bit set in fields, LSB first>}
+ */
+class BurstCapture
+{
+public:
+    /*!
+     * \brief Initialize request (if RTC RAM contents are invalid)
+     */
+    void begin(void);
+
+    /*!
+     * \brief Decode burst request
+     *
+     * Payload: duration[15:8], duration[7:0], period[7:0], fields[7:0]
+     *
+     * \param payload downlink payload
+     * \param size    payload size
+     *
+     * \returns false if the request is invalid
+     */
+    bool request(const uint8_t *payload, size_t size);
+
+    /*!
+     * \brief Check if a burst has been requested
+     */
+    bool pending(void);
+
+    /*!
+     * \brief Get requested duration [s]
+     */
+    uint16_t getDuration(void);
+
+    /*!
+     * \brief Get requested sampling period [s]
+     */
+    uint8_t getPeriod(void);
+
+    /*!
+     * \brief Start capture (clears request)
+     *
+     * \param timestamp unix time of capture start
+     */
+    void start(uint32_t timestamp);
+
+    /*!
+     * \brief Add sample
+     *
+     * \param timestamp  unix time of acquisition
+     * \param data       inverter input register data
+     * \param meterPower power of first energy meter [W]
+     *
+     * \returns false if the buffer is full
+     */
+    bool addSample(uint32_t timestamp, const growattIF::modbus_input_registers &data, float meterPower);
+
+    /*!
+     * \brief Get captured data (blob)
+     */
+    const uint8_t *getData(void)
+    {
+        return _buf;
+    };
+
+    /*!
+     * \brief Get size of captured data
+     */
+    uint16_t getSize(void)
+    {
+        return _size;
+    };
+
+private:
+    uint8_t _buf[BLOB_SIZE_MAX];
+    uint16_t _size = 0;
+    uint16_t _count = 0;
+    uint32_t _start = 0;
+    uint8_t _fields = 0;
+};
+#endif // _BURSTCAPTURE_H
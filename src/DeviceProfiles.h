@@ -0,0 +1,118 @@
+///////////////////////////////////////////////////////////////////////////////
+// DeviceProfiles.h
+//
+// Register profiles of additional Modbus devices (e.g. energy meters)
+// on the same bus as the inverter
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_DEVICEPROFILES_H)
+#define _DEVICEPROFILES_H
+
+#include <stdint.h>
+
+/// Maximum number of additional devices on the Modbus
+#define MODBUS_DEVICES_MAX 2
+
+/// Device types (METER_TYPE)
+#define METER_NONE      0   //!< no additional device
+#define METER_SDM630    1   //!< Eastron SDM630 (3-phase)
+#define METER_SDM72     2   //!< Eastron SDM72D-M (3-phase, totals only)
+#define METER_SDM120    3   //!< Eastron SDM120 / SDM230 (1-phase)
+
+/// Device values (index into modbus_device::values)
+#define DEV_POWER       0   //!< total active power [W]; > 0: import from grid
+#define DEV_IMPORT      1   //!< total imported active energy [kWh]
+#define DEV_EXPORT      2   //!< total exported active energy [kWh]
+#define DEV_NUM_VALUES  3
+
+/// Register data types
+#define DEV_U16         0   //!< unsigned 16 bit
+#define DEV_S16         1   //!< signed 16 bit
+#define DEV_U32         2   //!< unsigned 32 bit, high word first
+#define DEV_FLOAT32     3   //!< IEEE 754 single precision, high word first
+
+/*!
+ * \brief Register mapping
+ */
+struct DeviceRegister
+{
+    uint16_t addr;  //!< register address
+    uint8_t type;   //!< data type (DEV_U16...)
+    float scale;    //!< scale factor
+    uint8_t value;  //!< target value (DEV_POWER...)
+};
+
+/*!
+ * \brief Register profile of a device type
+ *
+ * All registers are read in a single request of `count` registers
+ * starting at `first`.
+ */
+struct DeviceProfile
+{
+    const char *name;            //!< device type name
+    uint8_t function;            //!< read function code (0x03 or 0x04)
+    uint16_t first;              //!< first register of request
+    uint16_t count;              //!< number of registers in request
+    const DeviceRegister *regs;  //!< register mapping
+    uint8_t numRegs;             //!< number of entries in regs
+};
+
+// Eastron SDM630 - input registers
+static const DeviceRegister sdm630Regs[] = {
+    {0x0034, DEV_FLOAT32, 1.0f, DEV_POWER},
+    {0x0048, DEV_FLOAT32, 1.0f, DEV_IMPORT},
+    {0x004A, DEV_FLOAT32, 1.0f, DEV_EXPORT}
+};
+
+// Eastron SDM120 / SDM230 - input registers
+static const DeviceRegister sdm120Regs[] = {
+    {0x000C, DEV_FLOAT32, 1.0f, DEV_POWER},
+    {0x0048, DEV_FLOAT32, 1.0f, DEV_IMPORT},
+    {0x004A, DEV_FLOAT32, 1.0f, DEV_EXPORT}
+};
+
+/*!
+ * \brief Device profiles, indexed by device type (METER_*)
+ */
+static const DeviceProfile deviceProfiles[] = {
+    {"none", 0x04, 0, 0, nullptr, 0},
+    {"SDM630", 0x04, 0x0034, 0x004C - 0x0034, sdm630Regs, 3},
+    {"SDM72", 0x04, 0x0034, 0x004C - 0x0034, sdm630Regs, 3},
+    {"SDM120", 0x04, 0x000C, 0x004C - 0x000C, sdm120Regs, 3}
+};
+#endif // _DEVICEPROFILES_H
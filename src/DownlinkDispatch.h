@@ -0,0 +1,83 @@
+///////////////////////////////////////////////////////////////////////////////
+// DownlinkDispatch.h
+//
+// Dispatch of downlink commands requesting a response without parameters
+//
+// This file has no dependencies on the Arduino framework and is shared with
+// host-side tools.
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_DOWNLINKDISPATCH_H)
+#define _DOWNLINKDISPATCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "growatt2lorawan_cmd.h"
+
+/*!
+ * \brief Get request for a response uplink
+ *
+ * Recognizes the CMD_GET_* commands which consist of a single 0x00 byte
+ * and only request a response (sent by sendCfgUplink()). Commands with
+ * parameters or side effects are handled by decodeDownlink() and
+ * AppLayer::decodeDownlink().
+ *
+ * \param port    downlink message port
+ * \param payload downlink message payload
+ * \param size    downlink message size in bytes
+ *
+ * \returns command ID, if downlink message is a get request, otherwise 0
+ */
+static inline uint8_t getCmdRequest(uint8_t port, const uint8_t *payload, size_t size)
+{
+    if ((size != 1) || (payload[0] != 0x00))
+    {
+        return 0;
+    }
+    switch (port)
+    {
+    case CMD_GET_DATETIME:
+    case CMD_GET_LW_CONFIG:
+    case CMD_GET_LW_STATUS:
+    case CMD_GET_STATUS_INTERVAL:
+    case CMD_GET_SENSORS_STAT:
+        return port;
+    default:
+        return 0;
+    }
+}
+#endif // _DOWNLINKDISPATCH_H
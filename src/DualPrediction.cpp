@@ -0,0 +1,120 @@
+///////////////////////////////////////////////////////////////////////////////
+// DualPrediction.cpp
+//
+// Dual-prediction reporting - decides if a measurement has to be sent
+// or can be replaced by the shared prediction on the receiving side
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//          Moved frame encoding to UplinkSchema.h
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DualPrediction.h"
+#include "UplinkSchema.h"
+
+#define DP_STORE_MAGIC 0x44505331 // "DPS1"
+
+// Predictor state - must retain its contents during deep sleep
+#if defined(ESP32)
+RTC_DATA_ATTR DpStore dpStore;
+#else
+DpStore dpStore __attribute__((section(".uninitialized_data")));
+#endif
+
+void DualPrediction::begin(uint16_t powerBound, uint16_t energyBound, uint32_t heartbeat)
+{
+    _powerBound = powerBound;
+    _energyBound = energyBound;
+    _heartbeat = heartbeat;
+    if (dpStore.magic != DP_STORE_MAGIC)
+    {
+        log_d("Initializing dual-prediction state");
+        memset(&dpStore, 0, sizeof(dpStore));
+        dpStore.magic = DP_STORE_MAGIC;
+    }
+}
+
+bool DualPrediction::update(time_t t, float outputpower, float energytotal)
+{
+    uint32_t now = static_cast<uint32_t>(t);
+    uint16_t power = (outputpower <= 0) ? 0 : ((outputpower >= 65535.0f) ? 65535 : static_cast<uint16_t>(outputpower + 0.5f));
+    uint32_t energy = (energytotal <= 0) ? 0 : static_cast<uint32_t>(static_cast<double>(energytotal) * 1000.0 + 0.5);
+    DpState &state = dpStore.state;
+    uint8_t reason = 0;
+
+    if ((now == 0) || (state.t0 == 0) || (now <= state.t0))
+    {
+        reason = DP_REASON_RESYNC;
+    }
+    else
+    {
+        uint16_t predPower;
+        uint32_t predEnergy;
+        dpPredict(state, now, predPower, predEnergy);
+        log_d("Prediction: %u W / %lu Wh, measurement: %u W / %lu Wh",
+              predPower, predEnergy, power, energy);
+
+        if (abs(static_cast<int32_t>(power) - static_cast<int32_t>(predPower)) > _powerBound)
+        {
+            reason |= DP_REASON_POWER;
+        }
+        if (((energy > predEnergy) ? energy - predEnergy : predEnergy - energy) > _energyBound)
+        {
+            reason |= DP_REASON_ENERGY;
+        }
+        if (now - state.t0 >= _heartbeat)
+        {
+            reason |= DP_REASON_HEARTBEAT;
+        }
+    }
+
+    if (reason == 0)
+    {
+        log_i("Measurement matches prediction - no report");
+        return false;
+    }
+
+    state.trend = dpTrend(state, now, power);
+    state.t0 = now;
+    state.power = power;
+    state.energy = energy;
+    dpStore.reason = reason;
+    log_d("Report (reason 0x%02X): trend %d", reason, state.trend);
+    return true;
+}
+
+void DualPrediction::encode(LoraEncoder &encoder, uint16_t seq)
+{
+    encodePredictionUplink(encoder, dpStore.reason, dpStore.state, seq);
+}
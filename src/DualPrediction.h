@@ -0,0 +1,113 @@
+///////////////////////////////////////////////////////////////////////////////
+// DualPrediction.h
+//
+// Dual-prediction reporting - decides if a measurement has to be sent
+// or can be replaced by the shared prediction on the receiving side
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//          Moved frame encoding to UplinkSchema.h
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_DUALPREDICTION_H)
+#define _DUALPREDICTION_H
+
+#include <Arduino.h>
+#include <LoraMessage.h>
+#include "DualPredictor.h"
+
+/// Report reasons
+#define DP_REASON_POWER     0x01 //!< output power deviates from prediction
+#define DP_REASON_ENERGY    0x02 //!< total energy deviates from prediction
+#define DP_REASON_HEARTBEAT 0x04 //!< maximum time between reports expired
+#define DP_REASON_RESYNC    0x08 //!< no valid state or no valid time
+
+/*!
+ * \brief Dual-prediction state (located in RTC RAM)
+ */
+struct DpStore
+{
+    uint32_t magic; //!< validity marker
+    DpState state;  //!< state of last report
+    uint8_t reason; //!< reason of last report (DP_REASON_*)
+};
+
+/*!
+ * \brief Dual-prediction reporting
+ *
+ * Compares the measured output power and total energy with the
+ * shared prediction (see DualPredictor.h) and requests a report only
+ * if one of the bounds is exceeded or the heartbeat interval has expired.
+ *
+ * Uplink format: see encodePredictionUplink() in UplinkSchema.h
+ */
+class DualPrediction
+{
+private:
+    uint16_t _powerBound = 50;
+    uint16_t _energyBound = 200;
+    uint32_t _heartbeat = 3600;
+
+public:
+    /*!
+     * \brief Initialize state (if RTC RAM contents are invalid) and set bounds
+     *
+     * \param powerBound  maximum output power deviation [W]
+     * \param energyBound maximum total energy deviation [Wh]
+     * \param heartbeat   maximum time between reports [s]
+     */
+    void begin(uint16_t powerBound, uint16_t energyBound, uint32_t heartbeat);
+
+    /*!
+     * \brief Compare measurement with prediction
+     *
+     * If a report is required, the state is updated.
+     *
+     * \param t           time of measurement (unix epoch; 0 if clock is not synchronized)
+     * \param outputpower output power [W]
+     * \param energytotal total energy [kWh]
+     *
+     * \returns true if report is required
+     */
+    bool update(time_t t, float outputpower, float energytotal);
+
+    /*!
+     * \brief Encode report frame (including Modbus result)
+     *
+     * \param encoder uplink encoder object
+     * \param seq     sequence number of sample
+     */
+    void encode(LoraEncoder &encoder, uint16_t seq);
+};
+#endif // _DUALPREDICTION_H
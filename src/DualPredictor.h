@@ -0,0 +1,148 @@
+///////////////////////////////////////////////////////////////////////////////
+// DualPredictor.h
+//
+// Shared forecast model for dual-prediction reporting
+//
+// The node and the receiving side run the same predictor. The node only
+// sends a report if its measurement deviates from the prediction by more
+// than a bound; otherwise the receiver uses the predicted values.
+// Each report carries the complete model state, so a lost report does not
+// lead to diverging predictions - the receiver just lacks the values
+// between the lost report and the next one.
+//
+// Model: local linear trend of the output power, limited to
+// DP_TREND_HORIZON minutes after the report (alpha-beta filter with
+// alpha = 1, beta = 1/2); the total energy is the integral of the
+// predicted power. Only integer arithmetic is used, so the C++ and the
+// JavaScript implementation (scripts/uplink_formatter.js) yield identical
+// results.
+//
+// This file has no dependencies on the Arduino framework and is shared with
+// host-side tools.
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_DUALPREDICTOR_H)
+#define _DUALPREDICTOR_H
+
+#include <stdint.h>
+
+/// Trend horizon in minutes - the power is constant afterwards
+#define DP_TREND_HORIZON 30
+
+/*!
+ * \brief Predictor state (as sent in a report)
+ */
+struct DpState
+{
+    uint32_t t0;     //!< time of report (unix epoch); 0: invalid
+    uint16_t power;  //!< output power at t0 [W]
+    int16_t trend;   //!< output power trend [0.1 W/min]
+    uint32_t energy; //!< total energy at t0 [Wh]
+};
+
+/*!
+ * \brief Predicted output power
+ *
+ * \param s state
+ * \param m minutes since report
+ *
+ * \returns output power [W]
+ */
+static inline uint16_t dpPower(const DpState &s, uint32_t m)
+{
+    if (m > DP_TREND_HORIZON)
+    {
+        m = DP_TREND_HORIZON;
+    }
+    // Division truncates towards zero (Math.trunc() in JavaScript)
+    int32_t p = static_cast<int32_t>(s.power) + (static_cast<int32_t>(s.trend) * static_cast<int32_t>(m)) / 10;
+    return (p < 0) ? 0 : ((p > 65535) ? 65535 : static_cast<uint16_t>(p));
+}
+
+/*!
+ * \brief Predict output power and total energy
+ *
+ * The prediction has a resolution of one minute.
+ *
+ * \param s      state
+ * \param t      time of prediction (unix epoch)
+ * \param power  predicted output power [W]
+ * \param energy predicted total energy [Wh]
+ */
+static inline void dpPredict(const DpState &s, uint32_t t, uint16_t &power, uint32_t &energy)
+{
+    uint32_t minutes = (t > s.t0) ? (t - s.t0) / 60 : 0;
+
+    // Energy in W*min (sum of power at the end of each minute)
+    uint64_t acc = 0;
+    uint32_t m;
+    for (m = 1; (m <= minutes) && (m <= DP_TREND_HORIZON); m++)
+    {
+        acc += dpPower(s, m);
+    }
+    if (minutes > DP_TREND_HORIZON)
+    {
+        acc += static_cast<uint64_t>(minutes - DP_TREND_HORIZON) * dpPower(s, DP_TREND_HORIZON);
+    }
+    power = dpPower(s, minutes);
+    energy = s.energy + static_cast<uint32_t>(acc / 60);
+}
+
+/*!
+ * \brief Update trend after a report
+ *
+ * The new trend is the mean of the previous trend and of the slope
+ * observed since the previous report.
+ *
+ * \param s     state before the report
+ * \param t     time of report (unix epoch)
+ * \param power measured output power [W]
+ *
+ * \returns new trend [0.1 W/min]
+ */
+static inline int16_t dpTrend(const DpState &s, uint32_t t, uint16_t power)
+{
+    uint32_t minutes = (t > s.t0) ? (t - s.t0) / 60 : 0;
+    if ((s.t0 == 0) || (minutes == 0))
+    {
+        return 0;
+    }
+    int32_t slope = (static_cast<int32_t>(power) - s.power) * 10 / static_cast<int32_t>(minutes);
+    int32_t trend = (((minutes < DP_TREND_HORIZON) ? s.trend : 0) + slope) / 2;
+    return (trend < -32768) ? -32768 : ((trend > 32767) ? 32767 : static_cast<int16_t>(trend));
+}
+#endif // _DUALPREDICTOR_H
@@ -0,0 +1,326 @@
+///////////////////////////////////////////////////////////////////////////////
+// FragCodec.h
+//
+// Fragmentation of bulk data (blobs) into LoRaWAN uplinks with optional
+// redundancy fragments, and reassembly on the receiving side
+//
+// Inspired by LoRaWAN TS004 (Fragmented Data Block Transport): the blob is
+// split into n data fragments of equal size; redundancy fragments are the
+// XOR of a pseudo-random subset of the data fragments. The receiver
+// rebuilds the blob from any sufficiently large set of fragments by
+// Gaussian elimination over GF(2).
+//
+// Fragment format:
+//   session, type, index, n, size[15:0] (LE), data[0...frag_size-1]
+//   (index < n: data fragment, index >= n: redundancy fragment)
+//
+// This file has no dependencies on the Arduino framework and is shared with
+// host-side tools.
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_FRAGCODEC_H)
+#define _FRAGCODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/// Fragment header size
+#define FRAG_HDR_SIZE 6
+
+/// Maximum number of data fragments
+#define FRAG_DATA_MAX 64
+
+/// Maximum fragment data size
+#define FRAG_SIZE_MAX 242
+
+/*!
+ * \brief Get data fragments contained in a fragment
+ *
+ * \param idx fragment index
+ * \param n   number of data fragments
+ *
+ * \returns bit mask of data fragments
+ */
+static inline uint64_t fragMask(uint8_t idx, uint8_t n)
+{
+    if (idx < n)
+    {
+        return 1ULL << idx;
+    }
+    if (n == 1)
+    {
+        return 1;
+    }
+
+    // xorshift32, seeded with the redundancy fragment number
+    uint32_t x = (static_cast<uint32_t>(idx - n) + 1) * 0x9E3779B9UL;
+    uint64_t mask = 0;
+    for (uint8_t i = 0; i < n; i++)
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        if (x & 0x80000000UL)
+        {
+            mask |= 1ULL << i;
+        }
+    }
+
+    // At least two data fragments per redundancy fragment
+    uint8_t j = (idx - n) % n;
+    mask |= (1ULL << j) | (1ULL << ((j + 1) % n));
+    return mask;
+}
+
+/*!
+ * \brief Get number of data fragments
+ *
+ * \param size     blob size
+ * \param fragSize fragment data size
+ */
+static inline uint8_t fragCount(uint16_t size, uint8_t fragSize)
+{
+    return static_cast<uint8_t>((size + fragSize - 1) / fragSize);
+}
+
+/*!
+ * \brief Encode fragment
+ *
+ * \param blob     blob data
+ * \param size     blob size (max. FRAG_DATA_MAX * fragSize)
+ * \param session  session ID
+ * \param type     blob type
+ * \param idx      fragment index
+ * \param fragSize fragment data size
+ * \param out      buffer of at least FRAG_HDR_SIZE + fragSize bytes
+ *
+ * \returns fragment size
+ */
+static inline size_t fragEncode(const uint8_t *blob, uint16_t size, uint8_t session, uint8_t type,
+                                uint8_t idx, uint8_t fragSize, uint8_t *out)
+{
+    uint8_t n = fragCount(size, fragSize);
+    uint64_t mask = fragMask(idx, n);
+
+    out[0] = session;
+    out[1] = type;
+    out[2] = idx;
+    out[3] = n;
+    out[4] = size & 0xFF;
+    out[5] = size >> 8;
+
+    uint8_t *data = &out[FRAG_HDR_SIZE];
+    memset(data, 0, fragSize);
+    for (uint8_t i = 0; i < n; i++)
+    {
+        if (mask & (1ULL << i))
+        {
+            size_t offs = static_cast<size_t>(i) * fragSize;
+            size_t len = (offs + fragSize <= size) ? fragSize : size - offs;
+            for (size_t j = 0; j < len; j++)
+            {
+                data[j] ^= blob[offs + j];
+            }
+        }
+    }
+    return FRAG_HDR_SIZE + fragSize;
+}
+
+/*!
+ * \brief Blob reassembly
+ *
+ * Collects the fragments of one session; fragments of another session
+ * restart the reassembly.
+ */
+class FragReassembler
+{
+public:
+    FragReassembler()
+    {
+        reset();
+    }
+
+    /*!
+     * \brief Discard all fragments
+     */
+    void reset(void)
+    {
+        _valid = false;
+        _rank = 0;
+        memset(_mask, 0, sizeof(_mask));
+    }
+
+    /*!
+     * \brief Add fragment
+     *
+     * \param frame fragment (uplink payload)
+     * \param len   fragment size
+     *
+     * \returns true if fragment is valid
+     */
+    bool add(const uint8_t *frame, size_t len)
+    {
+        if ((len <= FRAG_HDR_SIZE) || (len - FRAG_HDR_SIZE > FRAG_SIZE_MAX))
+        {
+            return false;
+        }
+        uint8_t n = frame[3];
+        uint16_t size = frame[4] | (frame[5] << 8);
+        uint8_t fragSize = static_cast<uint8_t>(len - FRAG_HDR_SIZE);
+        if ((n == 0) || (n > FRAG_DATA_MAX) || (fragCount(size, fragSize) != n))
+        {
+            return false;
+        }
+        if (!_valid || (frame[0] != _session) || (frame[1] != _type) ||
+            (n != _n) || (size != _size) || (fragSize != _fragSize))
+        {
+            reset();
+            _valid = true;
+            _session = frame[0];
+            _type = frame[1];
+            _n = n;
+            _size = size;
+            _fragSize = fragSize;
+        }
+        if (complete())
+        {
+            return true;
+        }
+
+        // Reduce by the rows already known (row i has its lowest bit at i)
+        uint64_t mask = fragMask(frame[2], n);
+        uint8_t row[FRAG_SIZE_MAX];
+        memcpy(row, &frame[FRAG_HDR_SIZE], fragSize);
+        for (uint8_t i = 0; i < n; i++)
+        {
+            if ((mask & (1ULL << i)) && _mask[i])
+            {
+                mask ^= _mask[i];
+                xorRow(row, _data[i]);
+            }
+        }
+        if (mask == 0)
+        {
+            // Linearly dependent - no new information
+            return true;
+        }
+        uint8_t pivot = 0;
+        while (!(mask & (1ULL << pivot)))
+        {
+            pivot++;
+        }
+        _mask[pivot] = mask;
+        memcpy(_data[pivot], row, fragSize);
+        _rank++;
+
+        if (complete())
+        {
+            // Back substitution
+            for (int i = n - 1; i >= 0; i--)
+            {
+                for (uint8_t j = i + 1; j < n; j++)
+                {
+                    if (_mask[i] & (1ULL << j))
+                    {
+                        _mask[i] ^= _mask[j];
+                        xorRow(_data[i], _data[j]);
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    /// Check if blob is complete
+    bool complete(void) const
+    {
+        return _valid && (_rank == _n);
+    }
+
+    /// Number of data fragments still missing
+    uint8_t missing(void) const
+    {
+        return _valid ? _n - _rank : 0;
+    }
+
+    /*!
+     * \brief Copy blob data
+     *
+     * \param out buffer of at least size() bytes
+     *
+     * \returns blob size or 0 if not complete
+     */
+    size_t read(uint8_t *out) const
+    {
+        if (!complete())
+        {
+            return 0;
+        }
+        for (uint8_t i = 0; i < _n; i++)
+        {
+            size_t offs = static_cast<size_t>(i) * _fragSize;
+            size_t len = (offs + _fragSize <= _size) ? _fragSize : _size - offs;
+            memcpy(&out[offs], _data[i], len);
+        }
+        return _size;
+    }
+
+    uint8_t session(void) const { return _session; } //!< session ID
+    uint8_t type(void) const { return _type; }       //!< blob type
+    uint16_t size(void) const { return _size; }      //!< blob size
+
+private:
+    void xorRow(uint8_t *dst, const uint8_t *src)
+    {
+        for (uint8_t j = 0; j < _fragSize; j++)
+        {
+            dst[j] ^= src[j];
+        }
+    }
+
+    bool _valid;
+    uint8_t _session;
+    uint8_t _type;
+    uint8_t _n;
+    uint8_t _rank;
+    uint8_t _fragSize;
+    uint16_t _size;
+    uint64_t _mask[FRAG_DATA_MAX];
+    uint8_t _data[FRAG_DATA_MAX][FRAG_SIZE_MAX];
+};
+#endif // _FRAGCODEC_H
@@ -0,0 +1,219 @@
+///////////////////////////////////////////////////////////////////////////////
+// FrameParity.h
+//
+// Cross-frame forward error correction - XOR parity over a group of
+// K telemetry frames
+//
+// The parity frame allows the receiving side to rebuild any single lost
+// frame of the group without a downlink. Frames are identified by their
+// sample sequence number (see SampleRing.h); the frames of a group have
+// consecutive sequence numbers.
+//
+// Parity frame format:
+//   base_seq[15:0] (LE), k, k x {port, len}, parity[0...max_len-1]
+//
+// This file has no dependencies on the Arduino framework and is shared with
+// host-side tools.
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_FRAMEPARITY_H)
+#define _FRAMEPARITY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/// Maximum number of frames per group
+#define FEC_GROUP_MAX 8
+
+/// Maximum size of protected frame
+#define FEC_FRAME_MAX 48
+
+/*!
+ * \brief Parity group
+ */
+struct FecGroup
+{
+    uint16_t base;                 //!< sequence number of first frame
+    uint8_t k;                     //!< group size
+    uint8_t count;                 //!< number of frames added
+    uint8_t maxLen;                //!< size of largest frame
+    uint8_t port[FEC_GROUP_MAX];   //!< frame ports
+    uint8_t len[FEC_GROUP_MAX];    //!< frame sizes
+    uint8_t parity[FEC_FRAME_MAX]; //!< XOR of all frames (zero padded)
+};
+
+/*!
+ * \brief Start new group
+ *
+ * \param g    parity group
+ * \param base sequence number of first frame
+ * \param k    group size (2...FEC_GROUP_MAX)
+ */
+static inline void fecReset(FecGroup &g, uint16_t base, uint8_t k)
+{
+    memset(&g, 0, sizeof(g));
+    g.base = base;
+    g.k = (k > FEC_GROUP_MAX) ? FEC_GROUP_MAX : k;
+}
+
+/*!
+ * \brief Add frame to group
+ *
+ * If the sequence number does not continue the current group (e.g. after
+ * a reset or a frame which could not be protected), a new group is started.
+ *
+ * \param g    parity group
+ * \param seq  sequence number of frame
+ * \param port frame port
+ * \param buf  frame payload
+ * \param len  frame size
+ *
+ * \returns true if group is complete
+ */
+static inline bool fecAdd(FecGroup &g, uint16_t seq, uint8_t port, const uint8_t *buf, uint8_t len)
+{
+    if ((len > FEC_FRAME_MAX) || (g.k == 0))
+    {
+        return false;
+    }
+    if ((g.count >= g.k) || (static_cast<uint16_t>(g.base + g.count) != seq))
+    {
+        fecReset(g, seq, g.k);
+    }
+    for (uint8_t i = 0; i < len; i++)
+    {
+        g.parity[i] ^= buf[i];
+    }
+    g.port[g.count] = port;
+    g.len[g.count] = len;
+    g.count++;
+    if (len > g.maxLen)
+    {
+        g.maxLen = len;
+    }
+    return g.count == g.k;
+}
+
+/*!
+ * \brief Get size of parity frame
+ *
+ * \param g parity group
+ */
+static inline size_t fecSize(const FecGroup &g)
+{
+    return 3 + 2 * static_cast<size_t>(g.count) + g.maxLen;
+}
+
+/*!
+ * \brief Encode parity frame
+ *
+ * \param g   parity group
+ * \param out buffer of at least fecSize(g) bytes
+ *
+ * \returns size of parity frame
+ */
+static inline size_t fecEncode(const FecGroup &g, uint8_t *out)
+{
+    size_t n = 0;
+    out[n++] = g.base & 0xFF;
+    out[n++] = g.base >> 8;
+    out[n++] = g.count;
+    for (uint8_t i = 0; i < g.count; i++)
+    {
+        out[n++] = g.port[i];
+        out[n++] = g.len[i];
+    }
+    memcpy(&out[n], g.parity, g.maxLen);
+    return n + g.maxLen;
+}
+
+/*!
+ * \brief Rebuild lost frame
+ *
+ * \param parity     parity frame
+ * \param parityLen  parity frame size
+ * \param frames     received frames of the group in sequence order; nullptr if lost
+ * \param frameLens  sizes of received frames
+ * \param out        rebuilt frame (at least FEC_FRAME_MAX bytes)
+ * \param port       port of rebuilt frame
+ *
+ * \returns size of rebuilt frame, 0 if nothing is missing,
+ *          or -1 if more than one frame is missing or the input is invalid
+ */
+static inline int fecRecover(const uint8_t *parity, size_t parityLen,
+                             const uint8_t *const *frames, const uint8_t *frameLens,
+                             uint8_t *out, uint8_t &port)
+{
+    if (parityLen < 3)
+    {
+        return -1;
+    }
+    uint8_t k = parity[2];
+    size_t hdr = 3 + 2 * static_cast<size_t>(k);
+    if ((k > FEC_GROUP_MAX) || (parityLen < hdr) || (parityLen - hdr > FEC_FRAME_MAX))
+    {
+        return -1;
+    }
+    size_t maxLen = parityLen - hdr;
+
+    int lost = -1;
+    memcpy(out, &parity[hdr], maxLen);
+    for (uint8_t i = 0; i < k; i++)
+    {
+        if (frames[i] == nullptr)
+        {
+            if (lost >= 0)
+            {
+                return -1;
+            }
+            lost = i;
+            continue;
+        }
+        for (size_t j = 0; (j < frameLens[i]) && (j < maxLen); j++)
+        {
+            out[j] ^= frames[i][j];
+        }
+    }
+    if (lost < 0)
+    {
+        return 0;
+    }
+    port = parity[3 + 2 * lost];
+    return parity[4 + 2 * lost];
+}
+#endif // _FRAMEPARITY_H
@@ -0,0 +1,258 @@
+///////////////////////////////////////////////////////////////////////////////
+// GrowattDecode.h
+//
+// Decoding of the Growatt input and holding registers
+//
+// This file has no dependencies on the Arduino framework and is shared with
+// host-side tools.
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//          Added holding registers
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_GROWATTDECODE_H)
+#define _GROWATTDECODE_H
+
+#include <stdint.h>
+
+/*!
+ * \brief Growatt inverter data (decoded input registers)
+ */
+struct growatt_input_registers
+{
+    int status;
+    float solarpower, pv1voltage, pv1current, pv1power, pv2voltage, pv2current, pv2power, outputpower, gridfrequency, gridvoltage;
+    float energytoday, energytotal, totalworktime, pv1energytoday, pv1energytotal, pv2energytoday, pv2energytotal, opfullpower;
+    float tempinverter, tempipm, tempboost;
+    int ipf, realoppercent, deratingmode, faultcode, faultbitcode, warningbitcode;
+};
+
+/*!
+ * \brief Growatt inverter settings (decoded holding registers)
+ */
+struct growatt_holding_registers
+{
+    int enable, safetyfuncen, maxoutputactivepp, maxoutputreactivepp, modul;
+    float  maxpower, voltnormal, startvoltage, gridvoltlowlimit, gridvolthighlimit, gridfreqlowlimit, gridfreqhighlimit, gridvoltlowconnlimit, gridvolthighconnlimit, gridfreqlowconnlimit, gridfreqhighconnlimit;
+    char firmware[6], controlfirmware[6];
+    char serial[10];
+};
+
+/*!
+ * \brief Decode input registers
+ *
+ * Registers 0...66 and 93...111 are evaluated.
+ *
+ * \param regs input register image (registers 0...127)
+ * \param d    decoded inverter data
+ */
+static inline void growattDecodeInputRegisters(const uint16_t *regs, growatt_input_registers &d)
+{
+    // Status and PV data
+    d.status = regs[0];
+    d.solarpower = ((regs[1] << 16) | regs[2]) * 0.1;
+
+    d.pv1voltage = regs[3] * 0.1;
+    d.pv1current = regs[4] * 0.1;
+    d.pv1power = ((regs[5] << 16) | regs[6]) * 0.1;
+
+    d.pv2voltage = regs[7] * 0.1;
+    d.pv2current = regs[8] * 0.1;
+    d.pv2power = ((regs[9] << 16) | regs[10]) * 0.1;
+
+    // Output
+    d.outputpower = ((regs[35] << 16) | regs[36]) * 0.1;
+    d.gridfrequency = regs[37] * 0.01;
+    d.gridvoltage = regs[38] * 0.1;
+
+    // Energy
+    d.energytoday = ((regs[53] << 16) | regs[54]) * 0.1;
+    d.energytotal = ((regs[55] << 16) | regs[56]) * 0.1;
+    d.totalworktime = ((regs[57] << 16) | regs[58]) * 0.5;
+
+    d.pv1energytoday = ((regs[59] << 16) | regs[60]) * 0.1;
+    d.pv1energytotal = ((regs[61] << 16) | regs[62]) * 0.1;
+
+    d.pv2energytoday = ((regs[63] << 16) | regs[64]) * 0.1;
+    d.pv2energytotal = ((regs[65] << 16) | regs[66]) * 0.1;
+
+    // Temperatures
+    d.tempinverter = regs[93] * 0.1;
+    d.tempipm = regs[94] * 0.1;
+    d.tempboost = regs[95] * 0.1;
+
+    // Diag data
+    d.ipf = regs[100];
+    d.realoppercent = regs[101];
+    d.opfullpower = ((regs[102] << 16) | regs[103]) * 0.1;
+    d.deratingmode = regs[103];
+    //  0:no derate;
+    //  1:PV;
+    //  2:*;
+    //  3:Vac;
+    //  4:Fac;
+    //  5:Tboost;
+    //  6:Tinv;
+    //  7:Control;
+    //  8:*;
+    //  9:*OverBack
+    //  ByTime;
+
+    d.faultcode = regs[105];
+    //  1~23 " Error: 99+x
+    //  24 "Auto Test
+    //  25 "No AC
+    //  26 "PV Isolation Low",
+    //  27 " Residual I
+    //  28 " Output High
+    //  29 " PV Voltage
+    //  30 " AC V Outrange
+    //  31 " AC F Outrange
+    //  32 " Module Hot
+
+
+    d.faultbitcode = ((regs[105] << 16) | regs[106]);
+    //  0x00000001 %
+    //  0x00000002 Communication error
+    //  0x00000004 %
+    //  0x00000008 StrReverse or StrShort fault
+    //  0x00000010 Model Init fault
+    //  0x00000020 Grid Volt Sample diffirent
+    //  0x00000040 ISO Sample diffirent
+    //  0x00000080 GFCI Sample diffirent
+    //  0x00000100 %
+    //  0x00000200 %
+    //  0x00000400 %
+    //  0x00000800 %
+    //  0x00001000 AFCI Fault
+    //  0x00002000 %
+    //  0x00004000 AFCI Module fault
+    //  0x00008000 %
+    //  0x00010000 %
+    //  0x00020000 Relay check fault
+    //  0x00040000 %
+    //  0x00080000 %
+    //  0x00100000 %
+    //  0x00200000 Communication error
+    //  0x00400000 Bus Voltage error
+    //  0x00800000 AutoTest fail
+    //  0x01000000 No Utility
+    //  0x02000000 PV Isolation Low
+    //  0x04000000 Residual I High
+    //  0x08000000 Output High DCI
+    //  0x10000000 PV Voltage high
+    //  0x20000000 AC V Outrange
+    //  0x40000000 AC F Outrange
+    //  0x80000000 TempratureHigh
+
+    d.warningbitcode = ((regs[110] << 16) | regs[111]);
+    //  0x0001 Fan warning
+    //  0x0002 String communication abnormal
+    //  0x0004 StrPIDconfig Warning
+    //  0x0008 %
+    //  0x0010 DSP and COM firmware unmatch
+    //  0x0020 %
+    //  0x0040 SPD abnormal
+    //  0x0080 GND and N connect abnormal
+    //  0x0100 PV1 or PV2 circuit short
+    //  0x0200 PV1 or PV2 boost driver broken
+    //  0x0400 %
+    //  0x0800 %
+    //  0x1000 %
+    //  0x2000 %
+    //  0x4000 %
+    //  0x8000 %
+}
+
+/*!
+ * \brief Decode block of 64 holding registers
+ *
+ * \param block block number (0: registers 0...63, 1: registers 64...127)
+ * \param regs  register values of block
+ * \param s     decoded inverter settings
+ */
+static inline void growattDecodeHoldingRegisters(uint8_t block, const uint16_t *regs, growatt_holding_registers &s)
+{
+    if (block == 0)
+    {
+        s.enable = regs[0];
+        s.safetyfuncen = regs[1]; // Safety Function Enabled
+        //  Bit0: SPI enable
+        //  Bit1: AutoTestStart
+        //  Bit2: LVFRT enable
+        //  Bit3: FreqDerating Enable
+        //  Bit4: Softstart enable
+        //  Bit5: DRMS enable
+        //  Bit6: Power Volt Func Enable
+        //  Bit7: HVFRT enable
+        //  Bit8: ROCOF enable
+        //  Bit9: Recover FreqDerating Mode Enable
+        //  Bit10~15: Reserved
+        s.maxoutputactivepp = regs[3]; // Inverter M ax output active power percent  0-100: %, 255: not limited
+        s.maxoutputreactivepp = regs[4]; // Inverter M ax output reactive power percent  0-100: %, 255: not limited
+        s.maxpower = ((regs[6] << 16) | regs[7]) * 0.1;
+        s.voltnormal = regs[8] * 0.1;
+        for (int i = 0; i < 3; i++)
+        {
+            s.firmware[2 * i] = regs[9 + i] >> 8;
+            s.firmware[2 * i + 1] = regs[9 + i] & 0xff;
+            s.controlfirmware[2 * i] = regs[12 + i] >> 8;
+            s.controlfirmware[2 * i + 1] = regs[12 + i] & 0xff;
+        }
+
+        s.startvoltage = regs[17] * 0.1;
+
+        for (int i = 0; i < 5; i++)
+        {
+            s.serial[2 * i] = regs[23 + i] >> 8;
+            s.serial[2 * i + 1] = regs[23 + i] & 0xff;
+        }
+
+        s.gridvoltlowlimit = regs[52] * 0.1;
+        s.gridvolthighlimit = regs[53] * 0.1;
+        s.gridfreqlowlimit = regs[54] * 0.01;
+        s.gridfreqhighlimit = regs[55] * 0.01;
+    }
+    else if (block == 1)
+    {
+        s.gridvoltlowconnlimit = regs[64 - 64] * 0.1;
+        s.gridvolthighconnlimit = regs[65 - 64] * 0.1;
+        s.gridfreqlowconnlimit = regs[66 - 64] * 0.01;
+        s.gridfreqhighconnlimit = regs[67 - 64] * 0.01;
+
+        s.modul = regs[121 - 64];
+    }
+}
+#endif // _GROWATTDECODE_H
@@ -0,0 +1,186 @@
+///////////////////////////////////////////////////////////////////////////////
+// HealthStats.cpp
+//
+// Node health telemetry - Modbus link statistics and lifetime counters,
+// kept in RTC RAM and committed to flash in batches
+//
+// created: 10/2026
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "HealthStats.h"
+#include "growatt2lorawan_cfg.h"
+#include <Preferences.h>
+
+#define HEALTH_STORE_MAGIC 0x484C5431 // "HLT1"
+
+// Health statistics - must retain its contents during deep sleep
+#if defined(ESP32)
+RTC_DATA_ATTR HealthStore healthStore;
+#else
+HealthStore healthStore __attribute__((section(".uninitialized_data")));
+#endif
+
+// Modbus result codes, in order of HealthCounters::mbErrors
+static const uint8_t mbErrorCodes[HS_MODBUS_ERRORS] = {
+    0x01, // ku8MBIllegalFunction
+    0x02, // ku8MBIllegalDataAddress
+    0x03, // ku8MBIllegalDataValue
+    0x04, // ku8MBSlaveDeviceFailure
+    0xE0, // ku8MBInvalidSlaveID
+    0xE1, // ku8MBInvalidFunction
+    0xE2, // ku8MBResponseTimedOut
+    0xE3  // ku8MBInvalidCRC
+};
+
+// Saturate counter to 16 bits
+static uint16_t sat16(uint32_t val)
+{
+    return (val > 0xFFFF) ? 0xFFFF : static_cast<uint16_t>(val);
+}
+
+void HealthStats::begin(void)
+{
+    if (healthStore.magic == HEALTH_STORE_MAGIC)
+    {
+        return;
+    }
+    log_d("Loading health statistics");
+    memset(&healthStore, 0, sizeof(healthStore));
+    healthStore.magic = HEALTH_STORE_MAGIC;
+
+    Preferences prefs;
+    prefs.begin("GRO2LW_HS", true);
+    if (prefs.getBytes("counters", &healthStore.cnt, sizeof(healthStore.cnt)) != sizeof(healthStore.cnt))
+    {
+        memset(&healthStore.cnt, 0, sizeof(healthStore.cnt));
+    }
+    healthStore.statusInterval = prefs.getUChar("stat_int", APP_STATUS_INTERVAL);
+    prefs.end();
+}
+
+void HealthStats::modbusResult(uint8_t result)
+{
+    healthStore.cnt.mbTransactions++;
+    for (uint8_t i = 0; i < HS_MODBUS_ERRORS; i++)
+    {
+        if (result == mbErrorCodes[i])
+        {
+            healthStore.cnt.mbErrors[i]++;
+            return;
+        }
+    }
+}
+
+void HealthStats::modbusRetry(void)
+{
+    healthStore.cnt.mbRetries++;
+}
+
+void HealthStats::joinAttempt(void)
+{
+    healthStore.cnt.joins++;
+}
+
+void HealthStats::sessionRestored(void)
+{
+    healthStore.cnt.restores++;
+}
+
+void HealthStats::uplink(bool success, uint32_t airtime)
+{
+    healthStore.cnt.uplinks++;
+    if (!success)
+    {
+        healthStore.cnt.uplinkFailures++;
+    }
+    healthStore.cnt.airtime += airtime;
+}
+
+void HealthStats::endCycle(uint32_t awakeMs)
+{
+    healthStore.cnt.cycles++;
+    healthStore.cnt.awake += awakeMs / 100;
+    if (++healthStore.pending >= HS_COMMIT_INTERVAL)
+    {
+        commit();
+    }
+}
+
+void HealthStats::commit(void)
+{
+    log_d("Saving health statistics");
+    Preferences prefs;
+    prefs.begin("GRO2LW_HS", false);
+    prefs.putBytes("counters", &healthStore.cnt, sizeof(healthStore.cnt));
+    prefs.end();
+    healthStore.pending = 0;
+}
+
+uint8_t HealthStats::getStatusInterval(void)
+{
+    return healthStore.statusInterval;
+}
+
+void HealthStats::setStatusInterval(uint8_t interval)
+{
+    log_d("Set app status interval: %u frames", interval);
+    healthStore.statusInterval = interval;
+    Preferences prefs;
+    prefs.begin("GRO2LW_HS", false);
+    prefs.putUChar("stat_int", interval);
+    prefs.end();
+}
+
+void HealthStats::encode(LoraEncoder &encoder)
+{
+    const HealthCounters &cnt = healthStore.cnt;
+
+    encoder.writeUint32(cnt.mbTransactions);
+    for (uint8_t i = 0; i < HS_MODBUS_ERRORS; i++)
+    {
+        encoder.writeUint16(sat16(cnt.mbErrors[i]));
+    }
+    encoder.writeUint16(sat16(cnt.mbRetries));
+    encoder.writeUint16(sat16(cnt.joins));
+    encoder.writeUint16(sat16(cnt.restores));
+    encoder.writeUint32(cnt.uplinks);
+    encoder.writeUint16(sat16(cnt.uplinkFailures));
+    encoder.writeUint32(cnt.airtime / 1000);
+    encoder.writeUint32(cnt.cycles);
+    encoder.writeUint16(cnt.cycles ? sat16(cnt.awake / cnt.cycles) : 0);
+    log_d("Health: Modbus %u transactions, %u joins, %u restores, %u/%u uplinks failed, airtime %u s, %u cycles",
+          cnt.mbTransactions, cnt.joins, cnt.restores, cnt.uplinkFailures, cnt.uplinks,
+          cnt.airtime / 1000, cnt.cycles);
+}
@@ -0,0 +1,170 @@
+///////////////////////////////////////////////////////////////////////////////
+// HealthStats.h
+//
+// Node health telemetry - Modbus link statistics and lifetime counters,
+// kept in RTC RAM and committed to flash in batches
+//
+// created: 10/2026
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_HEALTHSTATS_H)
+#define _HEALTHSTATS_H
+
+#include <Arduino.h>
+#include <LoraMessage.h>
+
+/// Number of Modbus error classes (ku8MB* codes)
+#define HS_MODBUS_ERRORS 8
+
+/*!
+ * \brief Lifetime counters (committed to flash)
+ */
+struct HealthCounters
+{
+    uint32_t mbTransactions;                //!< Modbus transactions
+    uint32_t mbErrors[HS_MODBUS_ERRORS];    //!< Modbus errors per ku8MB* code
+    uint32_t mbRetries;                     //!< Modbus readout retries
+    uint32_t joins;                         //!< join attempts
+    uint32_t restores;                      //!< session restores
+    uint32_t uplinks;                       //!< uplinks
+    uint32_t uplinkFailures;                //!< failed uplinks
+    uint32_t airtime;                       //!< cumulative airtime [ms]
+    uint32_t cycles;                        //!< wake-up cycles
+    uint32_t awake;                         //!< cumulative awake time [100 ms]
+};
+
+/*!
+ * \brief Health statistics state (located in RTC RAM)
+ */
+struct HealthStore
+{
+    uint32_t magic;             //!< validity marker
+    HealthCounters cnt;         //!< lifetime counters
+    uint8_t pending;            //!< cycles since last flash commit
+    uint8_t statusInterval;     //!< app status uplink interval [frames]
+};
+
+/*!
+ * \brief Node health telemetry
+ *
+ * The counters are updated in RTC RAM only - the flash is written every
+ * HS_COMMIT_INTERVAL wake-up cycles (and when the status interval is changed),
+ * so at most HS_COMMIT_INTERVAL cycles are lost after a power failure.
+ * The counters are loaded from flash after a cold boot.
+ *
+ * Uplink format (CMD_GET_SENSORS_STAT):
+ *   mb_transactions[31:0],
+ *   8 x mb_errors[15:0] (illegal function, illegal data address, illegal data value,
+ *                        slave device failure, invalid slave ID, invalid function,
+ *                        response timed out, invalid CRC),
+ *   mb_retries[15:0], joins[15:0], restores[15:0],
+ *   uplinks[31:0], uplink_failures[15:0], airtime[31:0] [s],
+ *   cycles[31:0], awake_avg[15:0] [100 ms]
+ *   (little endian; 16 bit counters saturate at 0xFFFF)
+ */
+class HealthStats
+{
+public:
+    /*!
+     * \brief Initialize state (if RTC RAM contents are invalid, from flash)
+     */
+    void begin(void);
+
+    /*!
+     * \brief Count Modbus transaction
+     *
+     * \param result Modbus result code (ku8MB*)
+     */
+    void modbusResult(uint8_t result);
+
+    /*!
+     * \brief Count Modbus readout retry
+     */
+    void modbusRetry(void);
+
+    /*!
+     * \brief Count join attempt
+     */
+    void joinAttempt(void);
+
+    /*!
+     * \brief Count session restore
+     */
+    void sessionRestored(void);
+
+    /*!
+     * \brief Count uplink
+     *
+     * \param success uplink transmitted successfully
+     * \param airtime time on air [ms]
+     */
+    void uplink(bool success, uint32_t airtime);
+
+    /*!
+     * \brief Complete wake-up cycle (before sleep)
+     *
+     * Commits the counters to flash every HS_COMMIT_INTERVAL cycles.
+     *
+     * \param awakeMs awake time in this cycle [ms]
+     */
+    void endCycle(uint32_t awakeMs);
+
+    /*!
+     * \brief Get app status uplink interval
+     *
+     * \returns interval in frame counts (0: disabled)
+     */
+    uint8_t getStatusInterval(void);
+
+    /*!
+     * \brief Set app status uplink interval (stored in flash)
+     *
+     * \param interval interval in frame counts (0: disabled)
+     */
+    void setStatusInterval(uint8_t interval);
+
+    /*!
+     * \brief Encode status uplink
+     *
+     * \param encoder uplink encoder object
+     */
+    void encode(LoraEncoder &encoder);
+
+    /*!
+     * \brief Write counters to flash
+     */
+    void commit(void);
+};
+#endif // _HEALTHSTATS_H
@@ -0,0 +1,278 @@
+///////////////////////////////////////////////////////////////////////////////
+// LinkPolicy.cpp
+//
+// LoRaWAN link policy - link-quality-adaptive confirmed uplinks,
+// detection of a lost link and margin-driven data rate / TX power optimisation
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//          Added data rate / TX power optimisation
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "LinkPolicy.h"
+#include "growatt2lorawan_cfg.h"
+
+#define LINK_POLICY_MAGIC 0x4C4E4B32 // "LNK2"
+
+// Link policy state - must retain its contents during deep sleep
+#if defined(ESP32)
+RTC_DATA_ATTR LinkPolicyStore linkPolicyStore;
+#else
+LinkPolicyStore linkPolicyStore __attribute__((section(".uninitialized_data")));
+#endif
+
+void LinkPolicy::begin(void)
+{
+    if (linkPolicyStore.magic != LINK_POLICY_MAGIC)
+    {
+        reset();
+    }
+}
+
+void LinkPolicy::reset(void)
+{
+    log_d("Initializing link policy");
+    memset(&linkPolicyStore, 0, sizeof(linkPolicyStore));
+    linkPolicyStore.magic = LINK_POLICY_MAGIC;
+
+    // Confirm first uplink
+    linkPolicyStore.framesSinceConfirm = 0xFFFF;
+    linkPolicyStore.datarate = LP_DR_START;
+    linkPolicyStore.txPower = LP_TX_POWER_MAX;
+}
+
+void LinkPolicy::clearHistory(void)
+{
+    linkPolicyStore.head = 0;
+    linkPolicyStore.count = 0;
+}
+
+E_LINK_QUALITY LinkPolicy::getQuality(void)
+{
+    LinkPolicyStore &s = linkPolicyStore;
+
+    if (s.failures >= LP_REJOIN_FAILURES)
+    {
+        return E_LINK_QUALITY::E_LOST;
+    }
+    if (s.failures > 0)
+    {
+        return E_LINK_QUALITY::E_WEAK;
+    }
+    if (s.count == 0)
+    {
+        return E_LINK_QUALITY::E_UNKNOWN;
+    }
+
+    // Recent margins weigh more than old ones; the minimum is checked as well
+    uint8_t latest = (s.head + LP_HISTORY_SIZE - 1) % LP_HISTORY_SIZE;
+    uint16_t sum = 0;
+    uint8_t minMargin = 0xFF;
+    uint8_t minGw = 0xFF;
+    for (uint8_t i = 0; i < s.count; i++)
+    {
+        uint8_t idx = (s.head + LP_HISTORY_SIZE - 1 - i) % LP_HISTORY_SIZE;
+        sum += s.margin[idx];
+        minMargin = min(minMargin, s.margin[idx]);
+        minGw = min(minGw, s.gwCnt[idx]);
+    }
+    uint8_t avgMargin = (sum + s.margin[latest]) / (s.count + 1);
+
+    // ACK success rate [%]
+    uint8_t ackRate = 100;
+    if (s.ackCount > 0)
+    {
+        uint8_t acks = 0;
+        for (uint8_t i = 0; i < s.ackCount; i++)
+        {
+            acks += (s.ackHistory >> i) & 1;
+        }
+        ackRate = 100U * acks / s.ackCount;
+    }
+
+    if ((s.margin[latest] < LP_MARGIN_WEAK) || (avgMargin < LP_MARGIN_WEAK) || (ackRate < 75))
+    {
+        return E_LINK_QUALITY::E_WEAK;
+    }
+    if ((minMargin >= LP_MARGIN_GOOD) && (minGw >= 2) && (ackRate >= 90))
+    {
+        return E_LINK_QUALITY::E_STRONG;
+    }
+    return E_LINK_QUALITY::E_NORMAL;
+}
+
+uint16_t LinkPolicy::confirmInterval(E_LINK_QUALITY quality)
+{
+    switch (quality)
+    {
+    case E_LINK_QUALITY::E_STRONG:
+        return LP_CONFIRM_INTERVAL_MAX;
+    case E_LINK_QUALITY::E_WEAK:
+        // Probe quickly after a missing ACK
+        return (linkPolicyStore.failures > 0) ? 1 : LP_CONFIRM_INTERVAL_MIN;
+    case E_LINK_QUALITY::E_LOST:
+        return 1;
+    case E_LINK_QUALITY::E_UNKNOWN:
+        return LP_CONFIRM_INTERVAL_MIN;
+    default:
+        return LP_CONFIRM_INTERVAL;
+    }
+}
+
+bool LinkPolicy::confirmNext(void)
+{
+    E_LINK_QUALITY quality = getQuality();
+    uint16_t interval = confirmInterval(quality);
+    bool confirm = linkPolicyStore.framesSinceConfirm >= interval;
+
+    log_d("Link quality: %u, confirm interval: %u, frames since confirmed: %u -> %s",
+          static_cast<uint8_t>(quality), interval, linkPolicyStore.framesSinceConfirm,
+          confirm ? "confirmed" : "unconfirmed");
+    return confirm;
+}
+
+void LinkPolicy::update(bool confirmed, bool acked, bool downlink, bool linkCheck, uint8_t margin, uint8_t gwCnt)
+{
+    LinkPolicyStore &s = linkPolicyStore;
+
+    if (linkCheck)
+    {
+        s.margin[s.head] = margin;
+        s.gwCnt[s.head] = gwCnt;
+        s.head = (s.head + 1) % LP_HISTORY_SIZE;
+        if (s.count < LP_HISTORY_SIZE)
+        {
+            s.count++;
+        }
+    }
+
+    if (confirmed)
+    {
+        s.framesSinceConfirm = 0;
+        s.ackHistory = (s.ackHistory << 1) | (acked ? 1 : 0);
+        if (s.ackCount < 16)
+        {
+            s.ackCount++;
+        }
+        if (!acked && !downlink)
+        {
+            s.failures++;
+            log_w("No ACK for confirmed uplink (%u consecutive)", s.failures);
+        }
+    }
+    else if (s.framesSinceConfirm < 0xFFFF)
+    {
+        s.framesSinceConfirm++;
+    }
+
+    if (acked || downlink)
+    {
+        s.failures = 0;
+    }
+
+#if LP_DR_OPTIMISER
+    if (linkCheck || (confirmed && (s.failures > 0)))
+    {
+        optimise(s.failures > 0);
+    }
+#endif
+}
+
+void LinkPolicy::optimise(bool failure)
+{
+    LinkPolicyStore &s = linkPolicyStore;
+    uint8_t dr = s.datarate;
+    int8_t txPower = s.txPower;
+
+    uint8_t minMargin = 0xFF;
+    for (uint8_t i = 0; i < s.count; i++)
+    {
+        minMargin = min(minMargin, s.margin[i]);
+    }
+
+    if (failure)
+    {
+        // Back off quickly - maximum TX power and two data rate steps slower
+        txPower = LP_TX_POWER_MAX;
+        dr = (dr >= LP_DR_MIN + 2) ? dr - 2 : LP_DR_MIN;
+    }
+    else if (s.count && (minMargin < LP_SAFETY_MARGIN))
+    {
+        // Undo last step - TX power first, then data rate
+        if (txPower < LP_TX_POWER_MAX)
+        {
+            txPower = min(txPower + 2 * LP_TX_POWER_STEP, LP_TX_POWER_MAX);
+        }
+        else if (dr > LP_DR_MIN)
+        {
+            dr--;
+        }
+    }
+    else if ((s.count >= LP_OPT_SAMPLES) && (minMargin >= LP_SAFETY_MARGIN + LP_OPT_STEP))
+    {
+        // Sufficient headroom - faster data rate first, then lower TX power
+        if (dr < LP_DR_MAX)
+        {
+            dr++;
+        }
+        else if (txPower > LP_TX_POWER_MIN)
+        {
+            txPower = max(txPower - LP_TX_POWER_STEP, LP_TX_POWER_MIN);
+        }
+    }
+
+    if ((dr != s.datarate) || (txPower != s.txPower))
+    {
+        log_i("Link optimiser: DR%u -> DR%u, %d dBm -> %d dBm (min. margin %u dB)",
+              s.datarate, dr, s.txPower, txPower, minMargin);
+        s.datarate = dr;
+        s.txPower = txPower;
+        clearHistory();
+    }
+}
+
+uint8_t LinkPolicy::getDatarate(void)
+{
+    return linkPolicyStore.datarate;
+}
+
+int8_t LinkPolicy::getTxPower(void)
+{
+    return linkPolicyStore.txPower;
+}
+
+bool LinkPolicy::rejoinRequired(void)
+{
+    return linkPolicyStore.failures >= LP_REJOIN_FAILURES;
+}
@@ -0,0 +1,148 @@
+///////////////////////////////////////////////////////////////////////////////
+// LinkPolicy.h
+//
+// LoRaWAN link policy - link-quality-adaptive confirmed uplinks,
+// detection of a lost link and margin-driven data rate / TX power optimisation
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//          Added data rate / TX power optimisation
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_LINKPOLICY_H)
+#define _LINKPOLICY_H
+
+#include <Arduino.h>
+
+/// Number of LinkCheck answers kept in history
+#define LP_HISTORY_SIZE 8
+
+/// Link quality classes
+enum class E_LINK_QUALITY : uint8_t
+{
+    E_UNKNOWN = 0, //!< no LinkCheck answer yet
+    E_STRONG = 1,  //!< high margin, several gateways, ACKs received
+    E_NORMAL = 2,  //!< default
+    E_WEAK = 3,    //!< low margin or ACKs missing
+    E_LOST = 4     //!< consecutive confirmed uplinks without ACK
+};
+
+/*!
+ * \brief Link policy state (located in RTC RAM)
+ */
+struct LinkPolicyStore
+{
+    uint32_t magic;                    //!< validity marker
+    uint8_t margin[LP_HISTORY_SIZE];   //!< LinkCheck margins [dB]
+    uint8_t gwCnt[LP_HISTORY_SIZE];    //!< LinkCheck gateway counts
+    uint8_t head;                      //!< index of next history entry
+    uint8_t count;                     //!< number of valid history entries
+    uint16_t ackHistory;               //!< results of last confirmed uplinks (bit 0: latest; 1: ACK)
+    uint8_t ackCount;                  //!< number of valid ackHistory bits
+    uint8_t failures;                  //!< consecutive confirmed uplinks without ACK
+    uint16_t framesSinceConfirm;       //!< uplinks since last confirmed uplink
+    uint8_t datarate;                  //!< optimised uplink data rate
+    int8_t txPower;                    //!< optimised TX power [dBm]
+};
+
+/*!
+ * \brief Link policy
+ *
+ * Decides when to send a confirmed uplink with LinkCheck request, based on
+ * the history of LinkCheck margins, gateway counts and ACK success:
+ * strong links are checked rarely, weak links often. A link is considered
+ * lost after LP_REJOIN_FAILURES consecutive confirmed uplinks without ACK.
+ *
+ * The optimiser steps towards the fastest data rate and the lowest TX power
+ * which keep LP_SAFETY_MARGIN over LP_OPT_SAMPLES LinkCheck answers, and
+ * backs off immediately if the margin falls below LP_SAFETY_MARGIN or an
+ * ACK is missing. The margin history is cleared after each change, because
+ * it refers to the previous settings.
+ */
+class LinkPolicy
+{
+public:
+    /*!
+     * \brief Initialize state (if RTC RAM contents are invalid)
+     */
+    void begin(void);
+
+    /*!
+     * \brief Clear state (e.g. after rejoin)
+     */
+    void reset(void);
+
+    /*!
+     * \brief Check if the next uplink shall be confirmed (with LinkCheck request)
+     */
+    bool confirmNext(void);
+
+    /*!
+     * \brief Update state after uplink
+     *
+     * \param confirmed  uplink was confirmed
+     * \param acked      ACK received
+     * \param downlink   any downlink received (link alive)
+     * \param linkCheck  LinkCheck answer received
+     * \param margin     LinkCheck demodulation margin [dB]
+     * \param gwCnt      LinkCheck gateway count
+     */
+    void update(bool confirmed, bool acked, bool downlink, bool linkCheck, uint8_t margin, uint8_t gwCnt);
+
+    /*!
+     * \brief Get current link quality
+     */
+    E_LINK_QUALITY getQuality(void);
+
+    /*!
+     * \brief Check if the link is lost and a rejoin is required
+     */
+    bool rejoinRequired(void);
+
+    /*!
+     * \brief Get optimised uplink data rate
+     */
+    uint8_t getDatarate(void);
+
+    /*!
+     * \brief Get optimised TX power [dBm]
+     */
+    int8_t getTxPower(void);
+
+private:
+    uint16_t confirmInterval(E_LINK_QUALITY quality);
+    void optimise(bool failure);
+    void clearHistory(void);
+};
+#endif // _LINKPOLICY_H
@@ -32,6 +32,8 @@
 // History:
 //
 // 20240815 Copied from BresserWeatherSensorLW
+// 20261017 Added loading of ABP credentials
+//          Moved parsing of EUIs and keys to SecretsParser.h
 //
 // ToDo:
 // -
@@ -39,6 +41,25 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "LoadSecrets.h"
+#include "SecretsParser.h"
+
+// Print key (debug output)
+static void printKey(const uint8_t *key)
+{
+#if CORE_DEBUG_LEVEL >= ARDUHAL_LOG_LEVEL_INFO
+  for (size_t i = 0; i < 16; i++)
+  {
+    printf("0x%02X", key[i]);
+    if (i < 15)
+    {
+      printf(", ");
+    }
+  }
+  printf("\n");
+#else
+  (void)key; // suppress warning regarding unused parameter
+#endif
+}
 
 // Load LoRaWAN secrets from file 'secrets.json' on LittleFS, if available
 void loadSecrets(uint64_t &joinEUI, uint64_t &devEUI, uint8_t *nwkKey, uint8_t *appKey)
@@ -74,41 +95,23 @@ void loadSecrets(uint64_t &joinEUI, uint64_t &devEUI, uint8_t *nwkKey, uint8_t *
       }
       else
       {
-        const char *joinEUIStr = doc["joinEUI"];
-        if (joinEUIStr == nullptr)
+        uint64_t _joinEUI = 0;
+        if (!parseEui(doc["joinEUI"], _joinEUI))
         {
           log_e("Missing joinEUI.");
           file.close();
           return;
         }
-        uint64_t _joinEUI = 0;
-        for (int i = 2; i < 18; i += 2)
-        {
-          char tmpStr[3] = "";
-          unsigned int tmpByte;
-          strncpy(tmpStr, &joinEUIStr[i], 2);
-          sscanf(tmpStr, "%x", &tmpByte);
-          _joinEUI = (_joinEUI << 8) | tmpByte;
-        }
         // printf() cannot print 64-bit hex numbers (sic!), so we split it in two 32-bit numbers...
         log_d("joinEUI: 0x%08X%08X", static_cast<uint32_t>(_joinEUI >> 32), static_cast<uint32_t>(_joinEUI & 0xFFFFFFFF));
 
-        const char *devEUIStr = doc["devEUI"];
-        if (devEUIStr == nullptr)
+        uint64_t _devEUI = 0;
+        if (!parseEui(doc["devEUI"], _devEUI))
         {
           log_e("Missing devEUI.");
           file.close();
           return;
         }
-        uint64_t _devEUI = 0;
-        for (int i = 2; i < 18; i += 2)
-        {
-          char tmpStr[3] = "";
-          unsigned int tmpByte;
-          strncpy(tmpStr, &devEUIStr[i], 2);
-          sscanf(tmpStr, "%x", &tmpByte);
-          _devEUI = (_devEUI << 8) | tmpByte;
-        }
         if (_devEUI == 0)
         {
           log_e("devEUI is zero.");
@@ -118,73 +121,25 @@ void loadSecrets(uint64_t &joinEUI, uint64_t &devEUI, uint8_t *nwkKey, uint8_t *
         // printf() cannot print 64-bit hex numbers (sic!), so we split it in two 32-bit numbers...
         log_d("devEUI: 0x%08X%08X", static_cast<uint32_t>(_devEUI >> 32), static_cast<uint32_t>(_devEUI & 0xFFFFFFFF));
 
-        uint8_t check = 0;
-        bool fail = false;
-
-        log_d("nwkKey:");
         uint8_t _nwkKey[16];
-        for (size_t i = 0; i < 16; i++)
-        {
-          const char *buf = doc["nwkKey"][i];
-          if (buf == nullptr)
-          {
-            fail = true;
-            break;
-          }
-          unsigned int tmp;
-          sscanf(buf, "%x", &tmp);
-          _nwkKey[i] = static_cast<uint8_t>(tmp);
-          check |= _nwkKey[i];
-#if CORE_DEBUG_LEVEL >= ARDUHAL_LOG_LEVEL_INFO
-          printf("0x%02X", _nwkKey[i]);
-          if (i < 15)
-          {
-            printf(", ");
-          }
-#endif
-        } // for all nwk_key bytes
-#if CORE_DEBUG_LEVEL >= ARDUHAL_LOG_LEVEL_INFO
-        printf("\n");
-#endif
-        if (fail || (check == 0))
+        if (!parseKey(doc["nwkKey"], _nwkKey))
         {
           log_e("nwkKey parse error");
           file.close();
           return;
         }
+        log_d("nwkKey:");
+        printKey(_nwkKey);
 
-        check = 0;
-        log_i("appKey:");
         uint8_t _appKey[16];
-        for (size_t i = 0; i < 16; i++)
-        {
-          const char *buf = doc["appKey"][i];
-          if (buf == nullptr)
-          {
-            fail = true;
-            break;
-          }
-          unsigned int tmp;
-          sscanf(buf, "%x", &tmp);
-          _appKey[i] = static_cast<uint8_t>(tmp);
-          check |= _appKey[i];
-#if CORE_DEBUG_LEVEL >= ARDUHAL_LOG_LEVEL_INFO
-          printf("0x%02X", _appKey[i]);
-          if (i < 15)
-          {
-            printf(", ");
-          }
-#endif
-        } // for all app_key bytes
-#if CORE_DEBUG_LEVEL >= ARDUHAL_LOG_LEVEL_INFO
-        printf("\n");
-#endif
-        if (fail || (check == 0))
+        if (!parseKey(doc["appKey"], _appKey))
         {
           log_e("appKey parse error");
           file.close();
           return;
         }
+        log_i("appKey:");
+        printKey(_appKey);
 
         // Every check passed, copy intermediate values as result
         joinEUI = _joinEUI;
@@ -196,3 +151,82 @@ void loadSecrets(uint64_t &joinEUI, uint64_t &devEUI, uint8_t *nwkKey, uint8_t *
     file.close();
   } // LittleFS o.k.
 }
+
+// Load LoRaWAN ABP secrets from file 'secrets.json' on LittleFS, if available
+void loadSecrets(uint32_t &devAddr, uint8_t *fNwkSIntKey, uint8_t *sNwkSIntKey, uint8_t *nwkSEncKey, uint8_t *appSKey)
+{
+  if (!LittleFS.begin(
+#if defined(ESP32)
+          // Format the LittleFS partition on error; parameter only available for ESP32
+          true
+#endif
+          ))
+  {
+    log_d("Could not initialize LittleFS.");
+    return;
+  }
+
+  File file = LittleFS.open("/secrets.json", "r");
+  if (!file)
+  {
+    log_i("File 'secrets.json' not found.");
+    return;
+  }
+
+  log_d("Reading 'secrets.json' (ABP)");
+  JsonDocument doc;
+  DeserializationError error = deserializeJson(doc, file);
+  file.close();
+  if (error)
+  {
+    log_d("Failed to read JSON file, using defaults.");
+    return;
+  }
+
+  const char *devAddrStr = doc["devAddr"];
+  if (devAddrStr == nullptr)
+  {
+    log_e("Missing devAddr.");
+    return;
+  }
+  unsigned int _devAddr = 0;
+  sscanf(devAddrStr, "%x", &_devAddr);
+  if (_devAddr == 0)
+  {
+    log_e("devAddr is zero.");
+    return;
+  }
+  log_d("devAddr: 0x%08X", _devAddr);
+
+  uint8_t _nwkSEncKey[16];
+  uint8_t _appSKey[16];
+  if (!parseKey(doc["nwkSEncKey"], _nwkSEncKey))
+  {
+    log_e("nwkSEncKey parse error");
+    return;
+  }
+  if (!parseKey(doc["appSKey"], _appSKey))
+  {
+    log_e("appSKey parse error");
+    return;
+  }
+
+  // LoRaWAN 1.1 only
+  uint8_t _fNwkSIntKey[16] = {0};
+  uint8_t _sNwkSIntKey[16] = {0};
+  if (!doc["fNwkSIntKey"].isNull() || !doc["sNwkSIntKey"].isNull())
+  {
+    if (!parseKey(doc["fNwkSIntKey"], _fNwkSIntKey) || !parseKey(doc["sNwkSIntKey"], _sNwkSIntKey))
+    {
+      log_e("fNwkSIntKey/sNwkSIntKey parse error");
+      return;
+    }
+  }
+
+  // Every check passed, copy intermediate values as result
+  devAddr = _devAddr;
+  memcpy(fNwkSIntKey, _fNwkSIntKey, 16);
+  memcpy(sNwkSIntKey, _sNwkSIntKey, 16);
+  memcpy(nwkSEncKey, _nwkSEncKey, 16);
+  memcpy(appSKey, _appSKey, 16);
+}
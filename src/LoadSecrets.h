@@ -32,6 +32,7 @@
 // History:
 //
 // 20240815 Copied from BresserWeatherSensorLW
+// 20261017 Added loading of ABP credentials
 //
 // ToDo:
 // -
@@ -56,4 +57,19 @@
  * \param nwkKey
  * \param appKey
  */
-void loadSecrets(uint64_t &joinEUI, uint64_t &devEUI, uint8_t *nwkKey, uint8_t *appKey);
\ No newline at end of file
+void loadSecrets(uint64_t &joinEUI, uint64_t &devEUI, uint8_t *nwkKey, uint8_t *appKey);
+
+/*!
+ * \brief Load LoRaWAN ABP secrets from file 'secrets.json' on LittleFS, if available
+ *
+ * Returns all values by reference/pointer; the values are only modified
+ * if all required entries ("devAddr", "nwkSEncKey", "appSKey") are valid.
+ * "fNwkSIntKey" and "sNwkSIntKey" are only required for LoRaWAN 1.1.
+ *
+ * \param devAddr
+ * \param fNwkSIntKey
+ * \param sNwkSIntKey
+ * \param nwkSEncKey
+ * \param appSKey
+ */
+void loadSecrets(uint32_t &devAddr, uint8_t *fNwkSIntKey, uint8_t *sNwkSIntKey, uint8_t *nwkSEncKey, uint8_t *appSKey);
@@ -0,0 +1,222 @@
+///////////////////////////////////////////////////////////////////////////////
+// ModbusRecorder.h
+//
+// Recording of raw Modbus RTU traffic (request/response frames with timestamps)
+//
+// This file has no dependencies on the Arduino framework and is shared with
+// host-side tools.
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_MODBUSRECORDER_H)
+#define _MODBUSRECORDER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include "ModbusRtu.h"
+
+/// Maximum size of a request frame
+#define MB_REQUEST_MAX 8
+
+/// Maximum length of a record line (incl. terminating zero)
+#define MB_RECORD_LINE_MAX (48 + 2 * MB_REQUEST_MAX + 2 * MB_FRAME_MAX)
+
+/*!
+ * \brief Recorded Modbus transaction
+ */
+struct ModbusRecord
+{
+    uint32_t unixTime;            //!< unix time of request (0: unknown)
+    uint32_t ms;                  //!< time of request [ms since start-up]
+    uint32_t duration;            //!< transaction duration [ms]
+    int len;                      //!< number of bytes received (0: timeout, -1: transport error)
+    size_t reqLen;                //!< request size
+    uint8_t req[MB_REQUEST_MAX];  //!< request frame
+    uint8_t resp[MB_FRAME_MAX];   //!< response bytes as received
+};
+
+/*!
+ * \brief Format record line
+ *
+ * Format: MB <unix_time> <ms> <duration> <len> <request (hex)> <response (hex) or '-'>
+ *
+ * \param buf buffer of MB_RECORD_LINE_MAX bytes
+ * \param rec record
+ */
+static inline void modbusFormatRecord(char *buf, const ModbusRecord &rec)
+{
+    int n = snprintf(buf, MB_RECORD_LINE_MAX, "MB %lu %lu %lu %d ",
+                     static_cast<unsigned long>(rec.unixTime), static_cast<unsigned long>(rec.ms),
+                     static_cast<unsigned long>(rec.duration), rec.len);
+    for (size_t i = 0; i < rec.reqLen; i++)
+    {
+        n += snprintf(buf + n, MB_RECORD_LINE_MAX - n, "%02X", rec.req[i]);
+    }
+    if (rec.len <= 0)
+    {
+        snprintf(buf + n, MB_RECORD_LINE_MAX - n, " -");
+        return;
+    }
+    buf[n++] = ' ';
+    for (int i = 0; i < rec.len; i++)
+    {
+        n += snprintf(buf + n, MB_RECORD_LINE_MAX - n, "%02X", rec.resp[i]);
+    }
+}
+
+// Convert hex string to bytes; returns number of bytes or -1 on error
+static inline int modbusParseHex(const char *hex, uint8_t *buf, size_t size)
+{
+    size_t n = 0;
+    while (isxdigit(static_cast<unsigned char>(hex[0])) && isxdigit(static_cast<unsigned char>(hex[1])))
+    {
+        if (n >= size)
+        {
+            return -1;
+        }
+        unsigned int b;
+        sscanf(hex, "%2x", &b);
+        buf[n++] = static_cast<uint8_t>(b);
+        hex += 2;
+    }
+    return static_cast<int>(n);
+}
+
+/*!
+ * \brief Parse record line
+ *
+ * The record may be preceded by other text (e.g. a serial monitor timestamp).
+ *
+ * \param line text line
+ * \param rec  record
+ *
+ * \returns true if the line contains a valid record
+ */
+static inline bool modbusParseRecord(const char *line, ModbusRecord &rec)
+{
+    const char *p = strstr(line, "MB ");
+    if (p == nullptr)
+    {
+        return false;
+    }
+    unsigned long unixTime, ms, duration;
+    int len;
+    char req[2 * MB_REQUEST_MAX + 2];
+    char resp[2 * MB_FRAME_MAX + 2];
+    if (sscanf(p, "MB %lu %lu %lu %d %17s %511s", &unixTime, &ms, &duration, &len, req, resp) != 6)
+    {
+        return false;
+    }
+    rec.unixTime = unixTime;
+    rec.ms = ms;
+    rec.duration = duration;
+    rec.len = len;
+    int reqLen = modbusParseHex(req, rec.req, sizeof(rec.req));
+    if (reqLen < 1)
+    {
+        return false;
+    }
+    rec.reqLen = reqLen;
+    if (len <= 0)
+    {
+        return true;
+    }
+    return modbusParseHex(resp, rec.resp, sizeof(rec.resp)) == len;
+}
+
+/*!
+ * \brief Recording transport
+ *
+ * Passes all transactions to the underlying transport and writes a record
+ * line (see modbusFormatRecord()) for each of them to a sink - e.g. the debug
+ * UART or a file. The records can be replayed on the host with
+ * extras/modbus/modbus_replay.cpp.
+ */
+class ModbusRecorder : public ModbusTransport
+{
+public:
+    /// Record sink
+    typedef void (*Sink)(const char *line);
+
+    /// Clock [ms] / unix time [s]
+    typedef uint32_t (*Clock)(void);
+
+    /*!
+     * \brief Initialize recorder
+     *
+     * \param inner    underlying transport
+     * \param sink     record sink
+     * \param clockMs  millisecond clock
+     * \param unixTime unix time (may be nullptr)
+     */
+    void begin(ModbusTransport &inner, Sink sink, Clock clockMs, Clock unixTime)
+    {
+        _inner = &inner;
+        _sink = sink;
+        _clockMs = clockMs;
+        _unixTime = unixTime;
+    }
+
+    int transact(const uint8_t *req, size_t reqLen, uint8_t *resp, size_t expected, uint32_t timeoutMs) override
+    {
+        ModbusRecord rec;
+        rec.unixTime = _unixTime ? _unixTime() : 0;
+        rec.ms = _clockMs();
+        rec.len = _inner->transact(req, reqLen, resp, expected, timeoutMs);
+        rec.duration = _clockMs() - rec.ms;
+        rec.reqLen = (reqLen < MB_REQUEST_MAX) ? reqLen : MB_REQUEST_MAX;
+        memcpy(rec.req, req, rec.reqLen);
+        if (rec.len > 0)
+        {
+            memcpy(rec.resp, resp, rec.len);
+        }
+
+        char line[MB_RECORD_LINE_MAX];
+        modbusFormatRecord(line, rec);
+        _sink(line);
+        return rec.len;
+    }
+
+private:
+    ModbusTransport *_inner = nullptr;
+    Sink _sink = nullptr;
+    Clock _clockMs = nullptr;
+    Clock _unixTime = nullptr;
+};
+#endif // _MODBUSRECORDER_H
@@ -0,0 +1,309 @@
+///////////////////////////////////////////////////////////////////////////////
+// ModbusRtu.h
+//
+// Modbus RTU master on top of a pluggable, frame-level transport
+//
+// The transport receives the response frame directly into the master's frame
+// buffer; register values are decoded from this buffer on access (no copy).
+//
+// This file has no dependencies on the Arduino framework and is shared with
+// host-side tools (see extras/modbus).
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_MODBUSRTU_H)
+#define _MODBUSRTU_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/// Maximum number of registers per request
+#define MB_REGS_MAX 125
+
+/// Maximum RTU frame size (slave ID, function, byte count, data, CRC)
+#define MB_FRAME_MAX (3 + 2 * MB_REGS_MAX + 2)
+
+/// Default response timeout [ms]
+#define MB_RESPONSE_TIMEOUT 2000
+
+/*!
+ * \brief Compute Modbus CRC16
+ *
+ * \param buf  data
+ * \param size data size in bytes
+ *
+ * \returns CRC (transmitted LSB first)
+ */
+static inline uint16_t modbusCrc16(const uint8_t *buf, size_t size)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < size; i++)
+    {
+        crc ^= buf[i];
+        for (int b = 0; b < 8; b++)
+        {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+        }
+    }
+    return crc;
+}
+
+/*!
+ * \brief Check if a (partially) received response frame is complete
+ *
+ * \param frame    received bytes
+ * \param len      number of received bytes
+ * \param expected expected size of a regular response
+ *
+ * \returns true if the regular response or an exception response is complete
+ */
+static inline bool modbusFrameComplete(const uint8_t *frame, size_t len, size_t expected)
+{
+    if (len >= expected)
+    {
+        return true;
+    }
+    // Exception response: slave ID, function | 0x80, exception code, CRC
+    return (len >= 5) && (frame[1] & 0x80);
+}
+
+/*!
+ * \brief Frame-level Modbus RTU transport
+ *
+ * Transports carry complete RTU frames (including CRC) - e.g. over a UART
+ * with RS485 transceiver, a host serial port / pty or a TCP connection to
+ * a serial-to-Ethernet gateway (RTU-over-TCP).
+ */
+class ModbusTransport
+{
+public:
+    virtual ~ModbusTransport() {}
+
+    /*!
+     * \brief Send request and receive response
+     *
+     * Reception ends when modbusFrameComplete() is true or the timeout expires.
+     *
+     * \param req       request frame
+     * \param reqLen    request size in bytes
+     * \param resp      response buffer
+     * \param expected  expected size of a regular response (<= buffer size)
+     * \param timeoutMs response timeout [ms]
+     *
+     * \returns number of bytes received (0: timeout), -1 on transport error
+     */
+    virtual int transact(const uint8_t *req, size_t reqLen, uint8_t *resp, size_t expected, uint32_t timeoutMs) = 0;
+};
+
+/*!
+ * \brief Modbus RTU master
+ *
+ * Drop-in replacement for the subset of ModbusMaster used by growattIF;
+ * the result codes are identical.
+ */
+class ModbusRtuMaster
+{
+public:
+    // Result codes (identical to ModbusMaster)
+    static const uint8_t ku8MBSuccess = 0x00;
+    static const uint8_t ku8MBIllegalFunction = 0x01;
+    static const uint8_t ku8MBIllegalDataAddress = 0x02;
+    static const uint8_t ku8MBIllegalDataValue = 0x03;
+    static const uint8_t ku8MBSlaveDeviceFailure = 0x04;
+    static const uint8_t ku8MBInvalidSlaveID = 0xE0;
+    static const uint8_t ku8MBInvalidFunction = 0xE1;
+    static const uint8_t ku8MBResponseTimedOut = 0xE2;
+    static const uint8_t ku8MBInvalidCRC = 0xE3;
+
+    /*!
+     * \brief Initialize master
+     *
+     * \param slave     slave ID
+     * \param transport transport
+     */
+    void begin(uint8_t slave, ModbusTransport &transport)
+    {
+        _slave = slave;
+        _transport = &transport;
+        _regs = 0;
+    }
+
+    /*!
+     * \brief Set response timeout
+     *
+     * \param timeoutMs timeout [ms]
+     */
+    void setTimeout(uint32_t timeoutMs)
+    {
+        _timeout = timeoutMs;
+    }
+
+    /*!
+     * \brief Read input registers (function 0x04)
+     *
+     * \param addr first register address
+     * \param qty  number of registers (1...MB_REGS_MAX)
+     *
+     * \returns result code
+     */
+    uint8_t readInputRegisters(uint16_t addr, uint16_t qty)
+    {
+        return readRegisters(0x04, addr, qty);
+    }
+
+    /*!
+     * \brief Read holding registers (function 0x03)
+     *
+     * \param addr first register address
+     * \param qty  number of registers (1...MB_REGS_MAX)
+     *
+     * \returns result code
+     */
+    uint8_t readHoldingRegisters(uint16_t addr, uint16_t qty)
+    {
+        return readRegisters(0x03, addr, qty);
+    }
+
+    /*!
+     * \brief Write single register (function 0x06)
+     *
+     * \param addr  register address
+     * \param value register value
+     *
+     * \returns result code
+     */
+    uint8_t writeSingleRegister(uint16_t addr, uint16_t value)
+    {
+        _regs = 0;
+        // Regular response is an echo of the request
+        return transaction(0x06, addr, value, 8);
+    }
+
+    /*!
+     * \brief Get register value from last read response
+     *
+     * \param idx register index (relative to first requested register)
+     *
+     * \returns register value or 0xFFFF if idx is out of range
+     */
+    uint16_t getResponseBuffer(uint8_t idx) const
+    {
+        if (idx >= _regs)
+        {
+            return 0xFFFF;
+        }
+        return (_frame[3 + 2 * idx] << 8) | _frame[4 + 2 * idx];
+    }
+
+    /*!
+     * \brief Get number of registers in last read response
+     */
+    uint8_t getResponseSize(void) const
+    {
+        return _regs;
+    }
+
+private:
+    ModbusTransport *_transport = nullptr;
+    uint8_t _slave = 1;
+    uint32_t _timeout = MB_RESPONSE_TIMEOUT;
+    uint8_t _regs = 0;
+    uint8_t _frame[MB_FRAME_MAX];
+
+    uint8_t readRegisters(uint8_t function, uint16_t addr, uint16_t qty)
+    {
+        _regs = 0;
+        if ((qty == 0) || (qty > MB_REGS_MAX))
+        {
+            return ku8MBIllegalDataValue;
+        }
+        uint8_t result = transaction(function, addr, qty, 5 + 2 * qty);
+        if ((result == ku8MBSuccess) && (_frame[2] != 2 * qty))
+        {
+            return ku8MBInvalidFunction;
+        }
+        if (result == ku8MBSuccess)
+        {
+            _regs = static_cast<uint8_t>(qty);
+        }
+        return result;
+    }
+
+    uint8_t transaction(uint8_t function, uint16_t addr, uint16_t val, size_t expected)
+    {
+        uint8_t req[8] = {
+            _slave, function,
+            static_cast<uint8_t>(addr >> 8), static_cast<uint8_t>(addr & 0xFF),
+            static_cast<uint8_t>(val >> 8), static_cast<uint8_t>(val & 0xFF)};
+        uint16_t crc = modbusCrc16(req, 6);
+        req[6] = crc & 0xFF;
+        req[7] = crc >> 8;
+
+        if (_transport == nullptr)
+        {
+            return ku8MBResponseTimedOut;
+        }
+        int len = _transport->transact(req, sizeof(req), _frame, expected, _timeout);
+        if (len < 5)
+        {
+            return ku8MBResponseTimedOut;
+        }
+        if (_frame[0] != _slave)
+        {
+            return ku8MBInvalidSlaveID;
+        }
+        if ((_frame[1] & 0x7F) != function)
+        {
+            return ku8MBInvalidFunction;
+        }
+        size_t size = (_frame[1] & 0x80) ? 5 : expected;
+        if (static_cast<size_t>(len) < size)
+        {
+            return ku8MBResponseTimedOut;
+        }
+        crc = modbusCrc16(_frame, size - 2);
+        if ((_frame[size - 2] != (crc & 0xFF)) || (_frame[size - 1] != (crc >> 8)))
+        {
+            return ku8MBInvalidCRC;
+        }
+        if (_frame[1] & 0x80)
+        {
+            return _frame[2];
+        }
+        return ku8MBSuccess;
+    }
+};
+#endif // _MODBUSRTU_H
@@ -0,0 +1,196 @@
+///////////////////////////////////////////////////////////////////////////////
+// ModbusSlaveProxy.cpp
+//
+// Modbus RTU slave proxy - serves the cached inverter register image on a
+// second UART, so local consumers do not poll the inverter themselves
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//          Moved register image to RTC RAM
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ModbusSlaveProxy.h"
+
+#define PROXY_IMAGE_MAGIC 0x50525831 // "PRX1"
+
+// Register image - must retain its contents during deep sleep
+#if defined(ESP32)
+RTC_DATA_ATTR ProxyImage proxyImage;
+#else
+ProxyImage proxyImage __attribute__((section(".uninitialized_data")));
+#endif
+
+void ModbusSlaveProxy::begin(HardwareSerial &serial, uint8_t slaveId, int dePin)
+{
+    if (proxyImage.magic != PROXY_IMAGE_MAGIC)
+    {
+        memset(&proxyImage, 0, sizeof(proxyImage));
+        proxyImage.magic = PROXY_IMAGE_MAGIC;
+    }
+    _serial = &serial;
+    _slaveId = slaveId;
+    _dePin = dePin;
+    if (_dePin >= 0)
+    {
+        pinMode(_dePin, OUTPUT);
+        digitalWrite(_dePin, 0);
+    }
+#if defined(ESP32)
+    // Process requests as soon as the UART detects the end of a burst
+    static ModbusSlaveProxy *obj = this;
+    _serial->setRxTimeout(1);
+    _serial->onReceive([]() { obj->poll(); });
+    log_i("Modbus proxy: slave ID %u", _slaveId);
+#else
+    log_w("Modbus proxy not supported on this platform");
+#endif
+}
+
+void ModbusSlaveProxy::update(const uint16_t *regs, uint8_t count)
+{
+    uint32_t seq = __atomic_load_n(&proxyImage.seq, __ATOMIC_RELAXED);
+    uint16_t *back = proxyImage.regs[(seq + 1) & 1];
+
+    // The back buffer must not be modified before the previous snapshot is visible
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    memcpy(back, regs, min(count, static_cast<uint8_t>(PROXY_REGS)) * sizeof(uint16_t));
+
+    // Publish - the buffer contents must be visible before the new sequence number
+    __atomic_store_n(&proxyImage.seq, seq + 1, __ATOMIC_RELEASE);
+    log_d("Modbus proxy: snapshot #%u", seq + 1);
+}
+
+bool ModbusSlaveProxy::read(uint16_t addr, uint16_t qty, uint8_t *dst)
+{
+    for (;;)
+    {
+        uint32_t seq = __atomic_load_n(&proxyImage.seq, __ATOMIC_ACQUIRE);
+        if (seq == 0)
+        {
+            return false;
+        }
+        const uint16_t *img = proxyImage.regs[seq & 1];
+        for (uint16_t i = 0; i < qty; i++)
+        {
+            dst[2 * i] = img[addr + i] >> 8;
+            dst[2 * i + 1] = img[addr + i] & 0xFF;
+        }
+        // The buffer is only reused by the writer after the next publication
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&proxyImage.seq, __ATOMIC_RELAXED) == seq)
+        {
+            return true;
+        }
+    }
+}
+
+void ModbusSlaveProxy::respond(uint8_t *frame, size_t size)
+{
+    uint16_t crc = modbusCrc16(frame, size);
+    frame[size++] = crc & 0xFF;
+    frame[size++] = crc >> 8;
+
+    if (_dePin >= 0)
+    {
+        digitalWrite(_dePin, 1);
+    }
+    _serial->write(frame, size);
+    _serial->flush();
+    if (_dePin >= 0)
+    {
+        digitalWrite(_dePin, 0);
+    }
+    _served++;
+}
+
+void ModbusSlaveProxy::exception(uint8_t function, uint8_t code)
+{
+    uint8_t frame[5] = {_slaveId, static_cast<uint8_t>(function | 0x80), code};
+    respond(frame, 3);
+}
+
+void ModbusSlaveProxy::poll(void)
+{
+    while (_serial->available())
+    {
+        // Silence between frames - start of new request
+        uint32_t now = millis();
+        if (now - _lastRx > 5)
+        {
+            _reqLen = 0;
+        }
+        _lastRx = now;
+
+        _req[_reqLen++] = static_cast<uint8_t>(_serial->read());
+        if (_reqLen < sizeof(_req))
+        {
+            continue;
+        }
+        _reqLen = 0;
+
+        // All supported requests have 8 bytes
+        uint16_t crc = modbusCrc16(_req, 6);
+        if ((_req[0] != _slaveId) || (_req[6] != (crc & 0xFF)) || (_req[7] != (crc >> 8)))
+        {
+            continue;
+        }
+        uint8_t function = _req[1];
+        uint16_t addr = (_req[2] << 8) | _req[3];
+        uint16_t qty = (_req[4] << 8) | _req[5];
+
+        if (function != 0x04)
+        {
+            exception(function, 0x01);
+        }
+        else if ((qty == 0) || (qty > MB_REGS_MAX) || (addr + qty > PROXY_REGS))
+        {
+            exception(function, 0x02);
+        }
+        else
+        {
+            uint8_t frame[MB_FRAME_MAX];
+            frame[0] = _slaveId;
+            frame[1] = function;
+            frame[2] = static_cast<uint8_t>(2 * qty);
+            if (read(addr, qty, &frame[3]))
+            {
+                respond(frame, 3 + 2 * qty);
+            }
+            else
+            {
+                exception(function, 0x06);
+            }
+        }
+    }
+}
@@ -0,0 +1,132 @@
+///////////////////////////////////////////////////////////////////////////////
+// ModbusSlaveProxy.h
+//
+// Modbus RTU slave proxy - serves the cached inverter register image on a
+// second UART, so local consumers do not poll the inverter themselves
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//          Moved register image to RTC RAM
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_MODBUSSLAVEPROXY_H)
+#define _MODBUSSLAVEPROXY_H
+
+#include <Arduino.h>
+#include "ModbusRtu.h"
+
+/// Number of input registers served (0...PROXY_REGS-1)
+#define PROXY_REGS 128
+
+/*!
+ * \brief Register image (located in RTC RAM)
+ */
+struct ProxyImage
+{
+    uint32_t magic;               //!< validity marker
+    uint32_t seq;                 //!< sequence number, incremented with each published snapshot (0: none)
+    uint16_t regs[2][PROXY_REGS]; //!< double buffer; published buffer: seq & 1
+};
+
+/*!
+ * \brief Modbus RTU slave proxy
+ *
+ * The register image is double-buffered and protected by a sequence
+ * lock: update() writes into the buffer which is currently not published
+ * and then increments the sequence number, which publishes it. A reader
+ * copies the requested registers from the published buffer and retries
+ * only if a new snapshot has been published in the meantime - the writer
+ * never blocks and never modifies the buffer being served.
+ *
+ * Supported functions:
+ *   0x04 (read input registers 0...PROXY_REGS-1)
+ * Exceptions:
+ *   0x01 - other function codes (the proxy is read-only)
+ *   0x02 - register range outside of image
+ *   0x06 - no snapshot available yet
+ *
+ * Requests are processed in the UART receive event task (ESP32 only).
+ * The proxy is only reachable while the node is awake - requests received
+ * during deep sleep are lost. The image is kept in RTC RAM, so after
+ * wake-up the snapshot of the previous cycle is served until the next
+ * readout has been completed.
+ */
+class ModbusSlaveProxy
+{
+public:
+    /*!
+     * \brief Start serving requests
+     *
+     * \param serial  serial port (already initialized)
+     * \param slaveId slave ID
+     * \param dePin   RS485 driver enable pin (-1: not used)
+     */
+    void begin(HardwareSerial &serial, uint8_t slaveId, int dePin);
+
+    /*!
+     * \brief Publish new register image (writer)
+     *
+     * \param regs  registers
+     * \param count number of registers (max. PROXY_REGS)
+     */
+    void update(const uint16_t *regs, uint8_t count);
+
+    /*!
+     * \brief Process received request data
+     */
+    void poll(void);
+
+    /*!
+     * \brief Get number of requests served
+     */
+    uint32_t getServed(void)
+    {
+        return _served;
+    };
+
+private:
+    HardwareSerial *_serial = nullptr;
+    uint8_t _slaveId = 1;
+    int _dePin = -1;
+
+    uint8_t _req[8];
+    uint8_t _reqLen = 0;
+    uint32_t _lastRx = 0;
+    uint32_t _served = 0;
+
+    bool read(uint16_t addr, uint16_t qty, uint8_t *dst);
+    void respond(uint8_t *frame, size_t size);
+    void exception(uint8_t function, uint8_t code);
+};
+#endif // _MODBUSSLAVEPROXY_H
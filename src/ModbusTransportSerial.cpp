@@ -0,0 +1,140 @@
+///////////////////////////////////////////////////////////////////////////////
+// ModbusTransportSerial.cpp
+//
+// Modbus RTU transports for the Arduino framework -
+// HardwareSerial (RS485/USB) and RTU-over-TCP (any Arduino Client)
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ModbusTransportSerial.h"
+
+// Receive response frame; returns number of bytes received
+static int receiveFrame(Stream &stream, uint8_t *resp, size_t expected, uint32_t timeoutMs)
+{
+    size_t len = 0;
+    uint32_t start = millis();
+
+    while (!modbusFrameComplete(resp, len, expected))
+    {
+        if (stream.available())
+        {
+            resp[len++] = static_cast<uint8_t>(stream.read());
+        }
+        else if (millis() - start >= timeoutMs)
+        {
+            break;
+        }
+        else
+        {
+            yield();
+        }
+    }
+    return static_cast<int>(len);
+}
+
+void ModbusTransportSerial::begin(HardwareSerial &serial, void (*preTransmission)(void), void (*postTransmission)(void))
+{
+    _serial = &serial;
+    _preTransmission = preTransmission;
+    _postTransmission = postTransmission;
+}
+
+int ModbusTransportSerial::transact(const uint8_t *req, size_t reqLen, uint8_t *resp, size_t expected, uint32_t timeoutMs)
+{
+    if (_serial == nullptr)
+    {
+        return -1;
+    }
+
+    // Discard stale data
+    while (_serial->available())
+    {
+        _serial->read();
+    }
+
+    if (_preTransmission)
+    {
+        _preTransmission();
+    }
+    _serial->write(req, reqLen);
+    _serial->flush();
+    if (_postTransmission)
+    {
+        _postTransmission();
+    }
+
+    return receiveFrame(*_serial, resp, expected, timeoutMs);
+}
+
+void ModbusTransportTcp::begin(Client &client, const char *host, uint16_t port)
+{
+    _client = &client;
+    _host = host;
+    _port = port;
+}
+
+int ModbusTransportTcp::transact(const uint8_t *req, size_t reqLen, uint8_t *resp, size_t expected, uint32_t timeoutMs)
+{
+    if (_client == nullptr)
+    {
+        return -1;
+    }
+    if (!_client->connected() && !_client->connect(_host, _port))
+    {
+        log_w("Modbus gateway %s:%u not reachable", _host, _port);
+        return -1;
+    }
+
+    // Discard stale data (e.g. late response to a timed out request)
+    while (_client->available())
+    {
+        _client->read();
+    }
+
+    if (_client->write(req, reqLen) != reqLen)
+    {
+        _client->stop();
+        return -1;
+    }
+
+    int len = receiveFrame(*_client, resp, expected, timeoutMs);
+    if (len == 0)
+    {
+        // Connection may be stale - reconnect with next request
+        _client->stop();
+    }
+    return len;
+}
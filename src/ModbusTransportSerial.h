@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////////
+// ModbusTransportSerial.h
+//
+// Modbus RTU transports for the Arduino framework -
+// HardwareSerial (RS485/USB) and RTU-over-TCP (any Arduino Client)
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_MODBUSTRANSPORTSERIAL_H)
+#define _MODBUSTRANSPORTSERIAL_H
+
+#include <Arduino.h>
+#include <Client.h>
+#include "ModbusRtu.h"
+
+/*!
+ * \brief Modbus RTU transport over HardwareSerial
+ *
+ * The optional callbacks switch an RS485 transceiver between transmit
+ * and receive mode.
+ */
+class ModbusTransportSerial : public ModbusTransport
+{
+public:
+    /*!
+     * \brief Initialize transport
+     *
+     * \param serial           serial port (already initialized)
+     * \param preTransmission  called before transmission (optional)
+     * \param postTransmission called after transmission (optional)
+     */
+    void begin(HardwareSerial &serial, void (*preTransmission)(void) = nullptr, void (*postTransmission)(void) = nullptr);
+
+    int transact(const uint8_t *req, size_t reqLen, uint8_t *resp, size_t expected, uint32_t timeoutMs) override;
+
+private:
+    HardwareSerial *_serial = nullptr;
+    void (*_preTransmission)(void) = nullptr;
+    void (*_postTransmission)(void) = nullptr;
+};
+
+/*!
+ * \brief Modbus RTU-over-TCP transport
+ *
+ * Raw RTU frames (including CRC) over a TCP connection, as supported by
+ * serial-to-Ethernet gateways in transparent mode. The connection is
+ * established on demand and kept open.
+ */
+class ModbusTransportTcp : public ModbusTransport
+{
+public:
+    /*!
+     * \brief Initialize transport
+     *
+     * \param client network client (e.g. WiFiClient)
+     * \param host   gateway host name or IP address
+     * \param port   gateway TCP port
+     */
+    void begin(Client &client, const char *host, uint16_t port);
+
+    int transact(const uint8_t *req, size_t reqLen, uint8_t *resp, size_t expected, uint32_t timeoutMs) override;
+
+private:
+    Client *_client = nullptr;
+    const char *_host = nullptr;
+    uint16_t _port = 0;
+};
+#endif // _MODBUSTRANSPORTSERIAL_H
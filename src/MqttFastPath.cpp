@@ -0,0 +1,246 @@
+///////////////////////////////////////////////////////////////////////////////
+// MqttFastPath.cpp
+//
+// Wi-Fi/MQTT fast path - publishes telemetry and drains the sample backlog
+// via MQTT if a Wi-Fi network and the broker are reachable
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MqttFastPath.h"
+#include "growatt2lorawan_cfg.h"
+
+#if MQTT_FASTPATH
+#include <WiFi.h>
+#include <MQTT.h> // https://github.com/256dpi/arduino-mqtt
+#include <ArduinoJson.h>
+#include "../secrets.h"
+
+#define MQTT_STORE_MAGIC 0x4D515431 // "MQT1"
+
+// MQTT message buffer size
+#define MQTT_PAYLOAD_SIZE 1536
+
+// Fast path state - must retain its contents during deep sleep
+#if defined(ESP32)
+RTC_DATA_ATTR MqttStore mqttStore;
+#else
+MqttStore mqttStore __attribute__((section(".uninitialized_data")));
+#endif
+
+static WiFiClient net;
+static MQTTClient client(MQTT_PAYLOAD_SIZE);
+
+void MqttFastPath::begin(void)
+{
+    if (mqttStore.magic != MQTT_STORE_MAGIC)
+    {
+        log_d("Initializing MQTT fast path state");
+        memset(&mqttStore, 0, sizeof(mqttStore));
+        mqttStore.magic = MQTT_STORE_MAGIC;
+    }
+}
+
+bool MqttFastPath::connect(void)
+{
+    if (mqttStore.skip)
+    {
+        log_d("MQTT: skipping connection attempt (%u)", mqttStore.skip);
+        mqttStore.skip--;
+        return false;
+    }
+
+    uint32_t start = millis();
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+    while ((WiFi.status() != WL_CONNECTED) && (millis() - start < MQTT_TIMEOUT * 1000UL))
+    {
+        delay(50);
+    }
+
+    bool connected = false;
+    if (WiFi.status() == WL_CONNECTED)
+    {
+        log_d("Wi-Fi connected after %lu ms, IP: %s", millis() - start, WiFi.localIP().toString().c_str());
+        client.begin(MQTT_HOST, MQTT_PORT, net);
+        client.setTimeout(MQTT_TIMEOUT * 1000);
+        client.setWill(MQTT_TOPIC_BASE "/status", "offline", true, 1);
+        connected = client.connect(WiFi.getHostname(), MQTT_USER, MQTT_PASS);
+    }
+
+    if (!connected)
+    {
+        log_w("MQTT: connection failed - using LoRaWAN");
+        mqttStore.failures = min(mqttStore.failures + 1, 4);
+        mqttStore.skip = (1 << mqttStore.failures) - 1;
+        end();
+        return false;
+    }
+    log_i("MQTT: connected after %lu ms", millis() - start);
+    mqttStore.failures = 0;
+    publish("status", "online", true);
+    return true;
+}
+
+bool MqttFastPath::publish(const char *subtopic, const char *payload, bool retained)
+{
+    String topic = String(MQTT_TOPIC_BASE "/") + subtopic;
+    if (!client.publish(topic, payload, retained, 1))
+    {
+        log_w("MQTT: publishing to %s failed (%d)", topic.c_str(), client.lastError());
+        return false;
+    }
+    log_v("MQTT: %s %s", topic.c_str(), payload);
+    return true;
+}
+
+bool MqttFastPath::publishData(const growattIF::modbus_input_registers &data, uint16_t seq, uint32_t timestamp)
+{
+    JsonDocument doc;
+    char payload[MQTT_PAYLOAD_SIZE];
+
+    doc["seq"] = seq;
+    doc["timestamp"] = timestamp;
+    doc["status"] = data.status;
+    doc["faultcode"] = data.faultcode;
+    doc["solarpower"] = data.solarpower;
+    doc["pv1voltage"] = data.pv1voltage;
+    doc["pv1current"] = data.pv1current;
+    doc["pv1power"] = data.pv1power;
+    doc["pv2voltage"] = data.pv2voltage;
+    doc["pv2current"] = data.pv2current;
+    doc["pv2power"] = data.pv2power;
+    doc["outputpower"] = data.outputpower;
+    doc["gridvoltage"] = data.gridvoltage;
+    doc["gridfrequency"] = data.gridfrequency;
+    doc["energytoday"] = data.energytoday;
+    doc["energytotal"] = data.energytotal;
+    doc["totalworktime"] = data.totalworktime;
+    doc["pv1energytoday"] = data.pv1energytoday;
+    doc["pv1energytotal"] = data.pv1energytotal;
+    doc["pv2energytoday"] = data.pv2energytoday;
+    doc["pv2energytotal"] = data.pv2energytotal;
+    doc["tempinverter"] = data.tempinverter;
+    doc["tempipm"] = data.tempipm;
+    doc["tempboost"] = data.tempboost;
+    doc["deratingmode"] = data.deratingmode;
+    serializeJson(doc, payload, sizeof(payload));
+
+    return publish("data", payload, true);
+}
+
+bool MqttFastPath::drain(SampleRing &ring)
+{
+    uint8_t count = ring.getCount();
+    uint8_t idx = 0;
+    uint16_t published = 0;
+
+    // Skip samples already published
+    if (mqttStore.cursorValid)
+    {
+        while ((idx < count) && (static_cast<int16_t>(ring.getSample(idx)->seq - mqttStore.lastSeq) <= 0))
+        {
+            idx++;
+        }
+    }
+
+    while (idx < count)
+    {
+        JsonDocument doc;
+        char payload[MQTT_PAYLOAD_SIZE];
+        JsonArray samples = doc["samples"].to<JsonArray>();
+        uint16_t last = 0;
+
+        for (uint8_t n = 0; (n < MQTT_BATCH_SIZE) && (idx < count); n++, idx++)
+        {
+            const Sample *s = ring.getSample(idx);
+            JsonObject rec = samples.add<JsonObject>();
+            rec["seq"] = s->seq;
+            rec["timestamp"] = s->timestamp;
+            rec["status"] = s->status;
+            rec["faultcode"] = s->faultcode;
+            rec["outputpower"] = s->outputpower;
+            rec["energytoday"] = s->energytoday / 10.0;
+            rec["energytotal"] = s->energytotal / 10.0;
+            rec["gridvoltage"] = s->gridvoltage / 10.0;
+            rec["gridfrequency"] = s->gridfrequency / 100.0;
+            last = s->seq;
+        }
+        serializeJson(doc, payload, sizeof(payload));
+
+        if (!publish("samples", payload, false))
+        {
+            return false;
+        }
+        // Advance cursor after each acknowledged message
+        mqttStore.lastSeq = last;
+        mqttStore.cursorValid = true;
+        published += samples.size();
+    }
+    log_i("MQTT: %u samples published", published);
+
+    // All samples in the ring have been delivered via MQTT
+    if (ring.pending())
+    {
+        log_d("MQTT: backfill request cancelled");
+        ring.cancel();
+    }
+    return true;
+}
+
+void MqttFastPath::end(void)
+{
+    if (client.connected())
+    {
+        client.disconnect();
+    }
+    WiFi.disconnect(true);
+    WiFi.mode(WIFI_OFF);
+}
+
+bool MqttFastPath::lorawanDue(void)
+{
+    if (MQTT_LW_INTERVAL == 0)
+    {
+        return false;
+    }
+    if (++mqttStore.lwCycles >= MQTT_LW_INTERVAL)
+    {
+        mqttStore.lwCycles = 0;
+        return true;
+    }
+    return false;
+}
+#endif // MQTT_FASTPATH
@@ -0,0 +1,131 @@
+///////////////////////////////////////////////////////////////////////////////
+// MqttFastPath.h
+//
+// Wi-Fi/MQTT fast path - publishes telemetry and drains the sample backlog
+// via MQTT if a Wi-Fi network and the broker are reachable
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_MQTTFASTPATH_H)
+#define _MQTTFASTPATH_H
+
+#include <Arduino.h>
+#include "growattInterface.h"
+#include "SampleRing.h"
+
+/*!
+ * \brief Fast path state (located in RTC RAM)
+ */
+struct MqttStore
+{
+    uint32_t magic;     //!< validity marker
+    bool cursorValid;   //!< lastSeq is valid
+    uint16_t lastSeq;   //!< sequence number of last sample published
+    uint8_t lwCycles;   //!< MQTT cycles since last LoRaWAN cycle
+    uint8_t failures;   //!< consecutive connection failures
+    uint8_t skip;       //!< cycles to skip before next connection attempt
+};
+
+/*!
+ * \brief Wi-Fi/MQTT fast path
+ *
+ * Publishes the current inverter data and all samples of the sample ring
+ * which have not been published yet (at least once, QoS 1). The position
+ * in the sequence is kept in RTC RAM, so samples acquired while the broker
+ * was not reachable are published with the next successful connection.
+ *
+ * After a connection failure, further attempts are skipped for 1, 3, 7 or
+ * 15 wake-up cycles to save power.
+ *
+ * Topics (MQTT_TOPIC_BASE):
+ *   <base>/data    - inverter data of current cycle (JSON, retained)
+ *   <base>/samples - {"samples": [{"seq": ..., ...}, ...]} (JSON)
+ *   <base>/status  - "online" / "offline" (retained, last will)
+ */
+class MqttFastPath
+{
+public:
+    /*!
+     * \brief Initialize state (if RTC RAM contents are invalid)
+     */
+    void begin(void);
+
+    /*!
+     * \brief Connect to Wi-Fi and MQTT broker
+     *
+     * \returns true if connected
+     */
+    bool connect(void);
+
+    /*!
+     * \brief Publish inverter data
+     *
+     * \param data      inverter input register data
+     * \param seq       sequence number of sample
+     * \param timestamp unix time of acquisition (0: clock not synchronized)
+     *
+     * \returns true on success
+     */
+    bool publishData(const growattIF::modbus_input_registers &data, uint16_t seq, uint32_t timestamp);
+
+    /*!
+     * \brief Publish samples not yet published
+     *
+     * \param ring sample ring
+     *
+     * \returns true if all samples have been published
+     */
+    bool drain(SampleRing &ring);
+
+    /*!
+     * \brief Disconnect and switch off Wi-Fi
+     */
+    void end(void);
+
+    /*!
+     * \brief Check if a LoRaWAN cycle is due while MQTT is available
+     *
+     * Keeps the LoRaWAN session alive (downlinks, ADR, clock sync)
+     * every MQTT_LW_INTERVAL cycles.
+     *
+     * \returns true if LoRaWAN uplinks shall be sent in this cycle
+     */
+    bool lorawanDue(void);
+
+private:
+    bool publish(const char *subtopic, const char *payload, bool retained);
+};
+#endif // _MQTTFASTPATH_H
@@ -0,0 +1,123 @@
+///////////////////////////////////////////////////////////////////////////////
+// PowerCurve.cpp
+//
+// High-rate power curve samples (kept in RTC RAM between uplinks) and
+// their compressed uplink encoding
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//          Sample buffer is cleared by clear() after successful uplink
+//          Moved frame encoding to UplinkSchema.h
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "PowerCurve.h"
+#include "UplinkSchema.h"
+
+#define POWER_CURVE_MAGIC 0x50574331 // "PWC1"
+
+// Sample buffer - must retain its contents during deep sleep
+#if defined(ESP32)
+RTC_DATA_ATTR PowerCurveBuf powerCurveBuf;
+#else
+PowerCurveBuf powerCurveBuf __attribute__((section(".uninitialized_data")));
+#endif
+
+// Convert float to uint16_t with saturation
+static uint16_t toUint16(float val)
+{
+    if (val <= 0)
+    {
+        return 0;
+    }
+    if (val >= 65535.0f)
+    {
+        return 65535;
+    }
+    return static_cast<uint16_t>(val + 0.5f);
+}
+
+void PowerCurve::begin(void)
+{
+    if (powerCurveBuf.magic != POWER_CURVE_MAGIC)
+    {
+        log_d("Initializing power curve buffer");
+        memset(&powerCurveBuf, 0, sizeof(powerCurveBuf));
+        powerCurveBuf.magic = POWER_CURVE_MAGIC;
+    }
+}
+
+uint8_t PowerCurve::getCount(void)
+{
+    return powerCurveBuf.count;
+}
+
+void PowerCurve::addSample(time_t timestamp, float outputpower, float solarpower)
+{
+    uint8_t n = powerCurveBuf.count;
+    uint32_t t = static_cast<uint32_t>(timestamp);
+
+    if (n == 0)
+    {
+        powerCurveBuf.base = t;
+    }
+    else if ((t <= powerCurveBuf.base + powerCurveBuf.dt[n - 1]) || (t - powerCurveBuf.base > 0xFFFF))
+    {
+        // Time offset must be strictly increasing and fit into 16 bits
+        log_w("Power curve sample discarded");
+        return;
+    }
+    if (n >= SDT_BUFFER_SIZE)
+    {
+        log_w("Power curve buffer full");
+        return;
+    }
+
+    powerCurveBuf.dt[n] = static_cast<uint16_t>(t - powerCurveBuf.base);
+    powerCurveBuf.output[n] = toUint16(outputpower);
+    powerCurveBuf.solar[n] = toUint16(solarpower);
+    powerCurveBuf.count++;
+    log_d("Power curve sample #%u: %u W / %u W", powerCurveBuf.count, powerCurveBuf.output[n], powerCurveBuf.solar[n]);
+}
+
+void PowerCurve::encode(LoraEncoder &encoder, uint8_t size, uint16_t maxError)
+{
+    uint16_t err = encodePowerCurveUplink(encoder, powerCurveBuf.base, powerCurveBuf.dt, powerCurveBuf.output,
+                                          powerCurveBuf.solar, powerCurveBuf.count, size, maxError);
+    log_d("Power curve: %u samples, max. error %u W", powerCurveBuf.count, err);
+}
+
+void PowerCurve::clear(void)
+{
+    powerCurveBuf.count = 0;
+}
@@ -0,0 +1,115 @@
+///////////////////////////////////////////////////////////////////////////////
+// PowerCurve.h
+//
+// High-rate power curve samples (kept in RTC RAM between uplinks) and
+// their compressed uplink encoding
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//          Sample buffer is cleared by clear() after successful uplink
+//          Moved frame encoding to UplinkSchema.h
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_POWERCURVE_H)
+#define _POWERCURVE_H
+
+#include <Arduino.h>
+#include <LoraMessage.h>
+#include "SwingingDoor.h"
+
+/// Number of samples kept in RTC RAM
+#define SDT_BUFFER_SIZE 64
+
+/*!
+ * \brief Power curve sample buffer (located in RTC RAM)
+ */
+struct PowerCurveBuf
+{
+    uint32_t magic;                     //!< validity marker
+    uint32_t base;                      //!< time of first sample
+    uint8_t count;                      //!< number of samples
+    uint16_t dt[SDT_BUFFER_SIZE];       //!< time offset from base [s]
+    uint16_t output[SDT_BUFFER_SIZE];   //!< output power [W]
+    uint16_t solar[SDT_BUFFER_SIZE];    //!< solar (DC input) power [W]
+};
+
+/*!
+ * \brief Power curve compression
+ *
+ * Collects outputpower and solarpower samples between uplinks and encodes
+ * the breakpoints of their swinging door trending representation.
+ *
+ * Uplink format: see encodePowerCurveUplink() in UplinkSchema.h
+ */
+class PowerCurve
+{
+public:
+    /*!
+     * \brief Initialize sample buffer (if RTC RAM contents are invalid)
+     */
+    void begin(void);
+
+    /*!
+     * \brief Add sample
+     *
+     * \param timestamp   time of acquisition
+     * \param outputpower AC output power [W]
+     * \param solarpower  DC input power [W]
+     */
+    void addSample(time_t timestamp, float outputpower, float solarpower);
+
+    /*!
+     * \brief Encode compressed power curve frame (including Modbus result)
+     *
+     * The maximum error is doubled until the breakpoints fit into the frame.
+     * The sample buffer is kept until clear() is called after the uplink
+     * has been sent successfully.
+     *
+     * \param encoder uplink encoder object
+     * \param size    number of bytes available for the frame
+     * \param maxError maximum absolute error [W]
+     */
+    void encode(LoraEncoder &encoder, uint8_t size, uint16_t maxError);
+
+    /*!
+     * \brief Clear sample buffer (after successful uplink)
+     */
+    void clear(void);
+
+    /*!
+     * \brief Get number of samples in buffer
+     */
+    uint8_t getCount(void);
+};
+#endif // _POWERCURVE_H
@@ -0,0 +1,323 @@
+///////////////////////////////////////////////////////////////////////////////
+// PvAnalytics.cpp
+//
+// On-device PV analytics - derives compact insights from a short history
+// of inverter snapshots kept in RTC RAM
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "PvAnalytics.h"
+#include "growatt_cfg.h"
+
+#define PV_HISTORY_MAGIC 0x50564831 // "PVH1"
+
+// Snapshot history - must retain its contents during deep sleep
+#if defined(ESP32)
+RTC_DATA_ATTR PvHistory pvHistory;
+#else
+PvHistory pvHistory __attribute__((section(".uninitialized_data")));
+#endif
+
+// Convert float to uint16_t with saturation
+static uint16_t toUint16(float val)
+{
+    if (val <= 0)
+    {
+        return 0;
+    }
+    if (val >= 65535.0f)
+    {
+        return 65535;
+    }
+    return static_cast<uint16_t>(val + 0.5f);
+}
+
+// Clamp integer to int8_t range
+static int8_t toInt8(int32_t val)
+{
+    return static_cast<int8_t>(constrain(val, -128, 127));
+}
+
+void PvAnalytics::begin(void)
+{
+    if (pvHistory.magic != PV_HISTORY_MAGIC)
+    {
+        log_d("Initializing PV history");
+        memset(&pvHistory, 0, sizeof(pvHistory));
+        pvHistory.magic = PV_HISTORY_MAGIC;
+    }
+}
+
+uint8_t PvAnalytics::getCount(void)
+{
+    return pvHistory.count;
+}
+
+const PvSnapshot *PvAnalytics::getSnapshot(uint8_t idx)
+{
+    if (idx >= pvHistory.count)
+    {
+        return nullptr;
+    }
+    uint8_t pos = (pvHistory.head + PV_HISTORY_SIZE - pvHistory.count + idx) % PV_HISTORY_SIZE;
+    return &pvHistory.entry[pos];
+}
+
+void PvAnalytics::addSnapshot(const growattIF::modbus_input_registers &data, time_t timestamp)
+{
+    PvSnapshot &snap = pvHistory.entry[pvHistory.head];
+
+    snap.timestamp = static_cast<uint32_t>(timestamp);
+    snap.solarpower = toUint16(data.solarpower);
+    snap.pv1power = toUint16(data.pv1power);
+    snap.pv2power = toUint16(data.pv2power);
+    snap.outputpower = toUint16(data.outputpower);
+    snap.pv1voltage = toUint16(data.pv1voltage * 10);
+    snap.pv2voltage = toUint16(data.pv2voltage * 10);
+    snap.tempinverter = static_cast<int16_t>(data.tempinverter * 10);
+    snap.deratingmode = static_cast<uint8_t>(data.deratingmode);
+    snap.faultcode = static_cast<uint8_t>(data.faultcode);
+
+    pvHistory.head = (pvHistory.head + 1) % PV_HISTORY_SIZE;
+    if (pvHistory.count < PV_HISTORY_SIZE)
+    {
+        pvHistory.count++;
+    }
+    if (data.opfullpower > 0)
+    {
+        pvHistory.opfullpower = toUint16(data.opfullpower);
+    }
+    updateDailyPeak(snap);
+    log_v("PV history: %u entries", pvHistory.count);
+}
+
+void PvAnalytics::updateDailyPeak(const PvSnapshot &snap)
+{
+    // Daily peaks are only meaningful with a valid clock
+    if (snap.timestamp == 0)
+    {
+        return;
+    }
+
+    struct tm timeinfo;
+    time_t t = snap.timestamp;
+    localtime_r(&t, &timeinfo);
+    uint8_t day = static_cast<uint8_t>(timeinfo.tm_yday & 0xFF);
+
+    if ((day != pvHistory.day) && (pvHistory.dayPeak > 0))
+    {
+        // Day change - compare last day's peak with the long-term average
+        if (pvHistory.peakAvg == 0)
+        {
+            pvHistory.peakAvg = pvHistory.dayPeak;
+        }
+        else
+        {
+            int32_t diff = static_cast<int32_t>(pvHistory.dayPeak) - pvHistory.peakAvg;
+            pvHistory.peakTrend = toInt8(diff * 200 / pvHistory.peakAvg);
+            pvHistory.peakAvg = (static_cast<uint32_t>(pvHistory.peakAvg) * 7 + pvHistory.dayPeak) / 8;
+        }
+        log_d("Daily peak: %u W, average: %u W", pvHistory.dayPeak, pvHistory.peakAvg);
+        pvHistory.dayPeak = 0;
+    }
+    pvHistory.day = day;
+    pvHistory.dayPeak = max(pvHistory.dayPeak, snap.outputpower);
+}
+
+void PvAnalytics::evaluate(PvInsights &res)
+{
+    memset(&res, 0, sizeof(res));
+
+    // First pass: check which strings have been in use at all
+    bool pv1Seen = false;
+    bool pv2Seen = false;
+    for (uint8_t i = 0; i < pvHistory.count; i++)
+    {
+        const PvSnapshot *s = getSnapshot(i);
+        pv1Seen |= (s->pv1power >= PV_MIN_POWER);
+        pv2Seen |= (s->pv2power >= PV_MIN_POWER);
+    }
+
+    uint8_t n = 0;
+    uint32_t sumDc = 0;
+    uint32_t sumAc = 0;
+    uint32_t mismatchSum = 0;
+    uint8_t mismatchCnt = 0;
+    uint8_t clipped = 0;
+    uint8_t derated = 0;
+    bool stringFail = false;
+    bool fault = false;
+
+    // Sums for correlation (temperature vs. derating) and trend (time vs. efficiency)
+    float sx = 0, sy = 0, sxx = 0, syy = 0, sxy = 0;
+    float st = 0, se = 0, stt = 0, ste = 0;
+    uint32_t t0 = pvHistory.count ? getSnapshot(0)->timestamp : 0;
+
+    for (uint8_t i = 0; i < pvHistory.count; i++)
+    {
+        const PvSnapshot *s = getSnapshot(i);
+
+        fault |= (s->faultcode != 0);
+
+        if (s->solarpower < PV_MIN_POWER)
+        {
+            continue;
+        }
+        n++;
+        sumDc += s->solarpower;
+        sumAc += s->outputpower;
+
+        // String mismatch - only if both strings are connected
+        if ((s->pv1voltage >= PV_MIN_VOLTAGE) && (s->pv2voltage >= PV_MIN_VOLTAGE))
+        {
+            uint16_t pmax = max(s->pv1power, s->pv2power);
+            if (pmax > 0)
+            {
+                uint16_t pdiff = (s->pv1power > s->pv2power) ? s->pv1power - s->pv2power : s->pv2power - s->pv1power;
+                mismatchSum += 100UL * pdiff / pmax;
+                mismatchCnt++;
+            }
+        }
+
+        // String failure - a string which produced before is dead now
+        if ((pv1Seen && pv2Seen) &&
+            (((s->pv1power < PV_MIN_POWER / 10) && (s->pv2power >= PV_MIN_POWER)) ||
+             ((s->pv2power < PV_MIN_POWER / 10) && (s->pv1power >= PV_MIN_POWER))))
+        {
+            stringFail = true;
+        }
+
+        // MPPT clipping - output power saturated at nominal power
+        if (pvHistory.opfullpower &&
+            (100UL * s->outputpower >= static_cast<uint32_t>(PV_CLIP_RATIO) * pvHistory.opfullpower))
+        {
+            clipped++;
+        }
+
+        // Thermal derating: 5 - Tboost / 6 - Tinv
+        float d = 0;
+        if ((s->deratingmode == 5) || (s->deratingmode == 6))
+        {
+            derated++;
+            d = 1;
+        }
+        float temp = s->tempinverter * 0.1f;
+        sx += temp;
+        sy += d;
+        sxx += temp * temp;
+        syy += d * d;
+        sxy += temp * d;
+
+        float eff = 100.0f * s->outputpower / s->solarpower;
+        float t = (s->timestamp - t0) / 3600.0f;
+        st += t;
+        se += eff;
+        stt += t * t;
+        ste += t * eff;
+    }
+
+    res.samples = n;
+    res.peakTrend = pvHistory.peakTrend;
+    res.mismatch = mismatchCnt ? static_cast<uint8_t>(mismatchSum / mismatchCnt) : 0xFF;
+
+    if (n < 3)
+    {
+        res.flags = PV_FLAG_NO_DATA | (fault ? PV_FLAG_FAULT : 0);
+        return;
+    }
+
+    res.efficiency = static_cast<uint8_t>(min(200UL, (200UL * sumAc + sumDc / 2) / sumDc));
+    res.clipping = static_cast<uint8_t>(100U * clipped / n);
+    res.derating = static_cast<uint8_t>(100U * derated / n);
+
+    float varX = n * sxx - sx * sx;
+    float varY = n * syy - sy * sy;
+    if ((varX > 0) && (varY > 0))
+    {
+        res.thermalCorr = toInt8(lroundf(100.0f * (n * sxy - sx * sy) / sqrtf(varX * varY)));
+    }
+
+    float varT = n * stt - st * st;
+    if (varT > 0)
+    {
+        // Least squares slope in %/h, scaled to 0.1 %/h
+        res.effTrend = toInt8(lroundf(10.0f * (n * ste - st * se) / varT));
+    }
+
+    uint8_t flags = 0;
+    uint8_t penalty = 0;
+    if (res.efficiency < 2 * PV_EFFICIENCY_MIN)
+    {
+        flags |= PV_FLAG_LOW_EFFICIENCY;
+        penalty += 20;
+    }
+    if ((res.mismatch != 0xFF) && (res.mismatch > PV_MISMATCH_MAX))
+    {
+        flags |= PV_FLAG_MISMATCH;
+        penalty += 15;
+    }
+    if (stringFail)
+    {
+        flags |= PV_FLAG_STRING_FAIL;
+        penalty += 30;
+    }
+    if (fault)
+    {
+        flags |= PV_FLAG_FAULT;
+        penalty += 30;
+    }
+    if (res.clipping > 0)
+    {
+        flags |= PV_FLAG_CLIPPING;
+        penalty += 5;
+    }
+    if (res.derating && (res.thermalCorr > 50))
+    {
+        flags |= PV_FLAG_THERMAL_DERATE;
+        penalty += 10;
+    }
+    if (res.peakTrend < -2 * PV_DEGRADATION_MAX)
+    {
+        flags |= PV_FLAG_DEGRADATION;
+        penalty += 10;
+    }
+    res.flags = flags;
+    res.score = (penalty < 100) ? 100 - penalty : 0;
+
+    log_d("PV insights: n=%u score=%u flags=0x%02X eff=%u mism=%u clip=%u derate=%u corr=%d trend=%d peak=%d",
+          res.samples, res.score, res.flags, res.efficiency, res.mismatch, res.clipping,
+          res.derating, res.thermalCorr, res.effTrend, res.peakTrend);
+}
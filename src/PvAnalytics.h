@@ -0,0 +1,161 @@
+///////////////////////////////////////////////////////////////////////////////
+// PvAnalytics.h
+//
+// On-device PV analytics - derives compact insights from a short history
+// of inverter snapshots kept in RTC RAM
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//          Fixed description of thermalCorr
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_PVANALYTICS_H)
+#define _PVANALYTICS_H
+
+#include <Arduino.h>
+#include "growattInterface.h"
+
+/// Number of snapshots kept in RTC RAM
+#define PV_HISTORY_SIZE 32
+
+/// Anomaly flags (PvInsights::flags)
+#define PV_FLAG_LOW_EFFICIENCY  0x01 //!< conversion efficiency below PV_EFFICIENCY_MIN
+#define PV_FLAG_MISMATCH        0x02 //!< PV1/PV2 mismatch above PV_MISMATCH_MAX
+#define PV_FLAG_CLIPPING        0x04 //!< output clipped at nominal power
+#define PV_FLAG_THERMAL_DERATE  0x08 //!< derating correlated with inverter temperature
+#define PV_FLAG_DEGRADATION     0x10 //!< daily peak power below long-term average
+#define PV_FLAG_STRING_FAIL     0x20 //!< one string dead while the other one produces
+#define PV_FLAG_FAULT           0x40 //!< inverter fault code reported in window
+#define PV_FLAG_NO_DATA         0x80 //!< not enough productive samples for evaluation
+
+/*!
+ * \brief Compact inverter snapshot
+ *
+ * Only the values required for analytics are kept, in integer units.
+ */
+struct PvSnapshot
+{
+    uint32_t timestamp;   //!< unix time of acquisition
+    uint16_t solarpower;  //!< DC input power [W]
+    uint16_t pv1power;    //!< PV1 power [W]
+    uint16_t pv2power;    //!< PV2 power [W]
+    uint16_t outputpower; //!< AC output power [W]
+    uint16_t pv1voltage;  //!< PV1 voltage [0.1 V]
+    uint16_t pv2voltage;  //!< PV2 voltage [0.1 V]
+    int16_t tempinverter; //!< inverter temperature [0.1 degC]
+    uint8_t deratingmode; //!< derating mode (see growattIF)
+    uint8_t faultcode;    //!< fault code (see growattIF)
+};
+
+/*!
+ * \brief Snapshot history (located in RTC RAM)
+ */
+struct PvHistory
+{
+    uint32_t magic;                         //!< validity marker
+    uint8_t head;                           //!< index of next entry
+    uint8_t count;                          //!< number of valid entries
+    uint16_t opfullpower;                   //!< nominal output power [W]
+    uint16_t dayPeak;                       //!< peak output power of current day [W]
+    uint16_t peakAvg;                       //!< long-term average of daily peak power [W]
+    int8_t peakTrend;                       //!< last day's peak vs. average [0.5 %]
+    uint8_t day;                            //!< day of year of dayPeak
+    PvSnapshot entry[PV_HISTORY_SIZE];      //!< ring buffer
+};
+
+/*!
+ * \brief Analytics results
+ */
+struct PvInsights
+{
+    uint8_t samples;     //!< number of productive samples evaluated
+    uint8_t score;       //!< health score [%]
+    uint8_t flags;       //!< anomaly flags (PV_FLAG_*)
+    uint8_t efficiency;  //!< AC/DC conversion efficiency [0.5 %]
+    uint8_t mismatch;    //!< PV1/PV2 mismatch [%]; 0xFF: single string
+    uint8_t clipping;    //!< share of samples clipped at nominal power [%]
+    uint8_t derating;    //!< share of samples with thermal derating [%]
+    int8_t thermalCorr;  //!< correlation of inverter temperature vs. thermal derating [0.01]
+    int8_t effTrend;     //!< efficiency trend [0.1 %/h]
+    int8_t peakTrend;    //!< daily peak power vs. long-term average [0.5 %]
+};
+
+/*!
+ * \brief On-device PV analytics
+ *
+ * Collects snapshots of the inverter data in RTC RAM and evaluates
+ * conversion efficiency, string mismatch, MPPT clipping, thermal derating
+ * and degradation trends over the history.
+ */
+class PvAnalytics
+{
+public:
+    /*!
+     * \brief Initialize history (if RTC RAM contents are invalid)
+     */
+    void begin(void);
+
+    /*!
+     * \brief Add snapshot to history
+     *
+     * \param data inverter input register data
+     * \param timestamp unix time of acquisition
+     */
+    void addSnapshot(const growattIF::modbus_input_registers &data, time_t timestamp);
+
+    /*!
+     * \brief Evaluate history
+     *
+     * \param res analytics results
+     */
+    void evaluate(PvInsights &res);
+
+    /*!
+     * \brief Get number of snapshots in history
+     */
+    uint8_t getCount(void);
+
+    /*!
+     * \brief Get snapshot from history
+     *
+     * \param idx index; 0 is the oldest entry
+     *
+     * \returns pointer to snapshot or nullptr if idx is out of range
+     */
+    const PvSnapshot *getSnapshot(uint8_t idx);
+
+private:
+    void updateDailyPeak(const PvSnapshot &snap);
+};
+#endif // _PVANALYTICS_H
@@ -0,0 +1,250 @@
+///////////////////////////////////////////////////////////////////////////////
+// SampleRing.cpp
+//
+// Sequence-numbered telemetry samples kept in RTC RAM and
+// NACK-driven backfill of samples missed by the network server
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//          Added getSample() and cancel() (MQTT fast path)
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SampleRing.h"
+
+#define SAMPLE_STORE_MAGIC 0x53505231 // "SPR1"
+
+// Sample ring - must retain its contents during deep sleep
+#if defined(ESP32)
+RTC_DATA_ATTR SampleStore sampleStore;
+#else
+SampleStore sampleStore __attribute__((section(".uninitialized_data")));
+#endif
+
+// Convert float to unsigned integer with scaling and saturation
+static uint32_t toFixed(float val, float scale, uint32_t maxVal)
+{
+    float res = val * scale + 0.5f;
+    if (res <= 0)
+    {
+        return 0;
+    }
+    if (res >= static_cast<float>(maxVal))
+    {
+        return maxVal;
+    }
+    return static_cast<uint32_t>(res);
+}
+
+void SampleRing::begin(void)
+{
+    if (sampleStore.magic != SAMPLE_STORE_MAGIC)
+    {
+        log_d("Initializing sample ring");
+        memset(&sampleStore, 0, sizeof(sampleStore));
+        sampleStore.magic = SAMPLE_STORE_MAGIC;
+    }
+}
+
+uint16_t SampleRing::add(const growattIF::modbus_input_registers &data, time_t timestamp)
+{
+    Sample &s = sampleStore.entry[sampleStore.head];
+
+    s.seq = sampleStore.seq++;
+    s.timestamp = static_cast<uint32_t>(timestamp);
+    s.status = static_cast<uint8_t>(data.status);
+    s.faultcode = static_cast<uint8_t>(data.faultcode);
+    s.outputpower = toFixed(data.outputpower, 1, 0xFFFF);
+    s.energytoday = toFixed(data.energytoday, 10, 0xFFFF);
+    s.energytotal = toFixed(data.energytotal, 10, 0xFFFFFFFF);
+    s.gridvoltage = toFixed(data.gridvoltage, 10, 0xFFFF);
+    s.gridfrequency = toFixed(data.gridfrequency, 100, 0xFFFF);
+
+    sampleStore.head = (sampleStore.head + 1) % SAMPLE_RING_SIZE;
+    if (sampleStore.count < SAMPLE_RING_SIZE)
+    {
+        sampleStore.count++;
+    }
+    log_d("Sample #%u", s.seq);
+    return s.seq;
+}
+
+uint16_t SampleRing::getSeq(void)
+{
+    return sampleStore.seq - 1;
+}
+
+const Sample *SampleRing::find(uint16_t seq)
+{
+    for (uint8_t i = 0; i < sampleStore.count; i++)
+    {
+        if (sampleStore.entry[i].seq == seq)
+        {
+            return &sampleStore.entry[i];
+        }
+    }
+    return nullptr;
+}
+
+void SampleRing::write(LoraEncoder &encoder, const Sample &s)
+{
+    encoder.writeUint16(s.seq);
+    encoder.writeUint32(s.timestamp);
+    encoder.writeUint8(s.status);
+    encoder.writeUint8(s.faultcode);
+    encoder.writeUint16(s.outputpower);
+    encoder.writeUint16(s.energytoday);
+    encoder.writeUint32(s.energytotal);
+    encoder.writeUint16(s.gridvoltage);
+    encoder.writeUint16(s.gridfrequency);
+}
+
+size_t SampleRing::dump(uint8_t *buf, size_t size)
+{
+    LoraEncoder encoder(buf);
+    for (uint8_t i = 0; i < sampleStore.count; i++)
+    {
+        if (static_cast<size_t>(encoder.getLength()) + SAMPLE_RECORD_SIZE > size)
+        {
+            break;
+        }
+        write(encoder, *getSample(i));
+    }
+    return encoder.getLength();
+}
+
+bool SampleRing::request(const uint8_t *payload, size_t size)
+{
+    if ((size == 0) || (size % 3 != 0) || (size / 3 > BACKFILL_RANGES_MAX))
+    {
+        return false;
+    }
+
+    // A new request replaces any pending one
+    sampleStore.numRanges = 0;
+    _encoded = false;
+    for (size_t i = 0; i < size; i += 3)
+    {
+        SeqRange &r = sampleStore.range[sampleStore.numRanges];
+        r.first = (payload[i] << 8) | payload[i + 1];
+        r.count = payload[i + 2];
+        if (r.count > 0)
+        {
+            log_d("Backfill request: #%u...#%u", r.first, static_cast<uint16_t>(r.first + r.count - 1));
+            sampleStore.numRanges++;
+        }
+    }
+    return sampleStore.numRanges > 0;
+}
+
+bool SampleRing::pending(void)
+{
+    return sampleStore.numRanges > 0;
+}
+
+void SampleRing::cancel(void)
+{
+    sampleStore.numRanges = 0;
+    _encoded = false;
+}
+
+uint8_t SampleRing::getCount(void)
+{
+    return sampleStore.count;
+}
+
+const Sample *SampleRing::getSample(uint8_t idx)
+{
+    if (idx >= sampleStore.count)
+    {
+        return nullptr;
+    }
+    uint8_t pos = (sampleStore.head + SAMPLE_RING_SIZE - sampleStore.count + idx) % SAMPLE_RING_SIZE;
+    return &sampleStore.entry[pos];
+}
+
+void SampleRing::encode(LoraEncoder &encoder, uint8_t size)
+{
+    // Work on a copy - the ranges are released by sent()
+    _nextNum = sampleStore.numRanges;
+    memcpy(_next, sampleStore.range, _nextNum * sizeof(SeqRange));
+
+    uint8_t sent = 0;
+    while (_nextNum > 0)
+    {
+        SeqRange &r = _next[0];
+        const Sample *s = find(r.first);
+        if (s)
+        {
+            // Keep one byte for the trailer
+            if (encoder.getLength() + SAMPLE_RECORD_SIZE + 1 > size)
+            {
+                break;
+            }
+            write(encoder, *s);
+            sent++;
+        }
+        else
+        {
+            log_d("Sample #%u not available", r.first);
+        }
+
+        // Advance to next sequence number
+        r.first++;
+        if (--r.count == 0)
+        {
+            memmove(&_next[0], &_next[1], (--_nextNum) * sizeof(SeqRange));
+        }
+    }
+    _encoded = true;
+
+    // Trailer: number of requested samples still pending
+    uint16_t remaining = 0;
+    for (uint8_t i = 0; i < _nextNum; i++)
+    {
+        remaining += _next[i].count;
+    }
+    encoder.writeUint8((remaining > 255) ? 255 : remaining);
+    log_d("Backfill: %u samples encoded, %u remaining", sent, remaining);
+}
+
+void SampleRing::sent(void)
+{
+    if (!_encoded)
+    {
+        return;
+    }
+    sampleStore.numRanges = _nextNum;
+    memcpy(sampleStore.range, _next, _nextNum * sizeof(SeqRange));
+    _encoded = false;
+}
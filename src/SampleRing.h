@@ -0,0 +1,209 @@
+///////////////////////////////////////////////////////////////////////////////
+// SampleRing.h
+//
+// Sequence-numbered telemetry samples kept in RTC RAM and
+// NACK-driven backfill of samples missed by the network server
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//          Added getSample() and cancel() (MQTT fast path)
+//          Requested ranges are released only after successful uplink (sent())
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_SAMPLERING_H)
+#define _SAMPLERING_H
+
+#include <Arduino.h>
+#include <LoraMessage.h>
+#include "growattInterface.h"
+
+/// Number of samples kept in RTC RAM
+#define SAMPLE_RING_SIZE 48
+
+/// Maximum number of requested sequence ranges
+#define BACKFILL_RANGES_MAX 8
+
+/// Size of encoded sample in bytes
+#define SAMPLE_RECORD_SIZE 20
+
+/*!
+ * \brief Compact telemetry sample
+ */
+struct Sample
+{
+    uint16_t seq;           //!< sequence number
+    uint32_t timestamp;     //!< unix time of acquisition (0: clock not synchronized)
+    uint8_t status;         //!< inverter status
+    uint8_t faultcode;      //!< fault code
+    uint16_t outputpower;   //!< output power [W]
+    uint16_t energytoday;   //!< energy today [0.1 kWh]
+    uint32_t energytotal;   //!< total energy [0.1 kWh]
+    uint16_t gridvoltage;   //!< grid voltage [0.1 V]
+    uint16_t gridfrequency; //!< grid frequency [0.01 Hz]
+};
+
+/*!
+ * \brief Requested sequence range
+ */
+struct SeqRange
+{
+    uint16_t first; //!< first sequence number
+    uint8_t count;  //!< number of samples
+};
+
+/*!
+ * \brief Sample ring and backfill requests (located in RTC RAM)
+ */
+struct SampleStore
+{
+    uint32_t magic;                           //!< validity marker
+    uint16_t seq;                             //!< next sequence number
+    uint8_t head;                             //!< index of next entry
+    uint8_t count;                            //!< number of valid entries
+    Sample entry[SAMPLE_RING_SIZE];           //!< ring buffer
+    uint8_t numRanges;                        //!< number of pending ranges
+    SeqRange range[BACKFILL_RANGES_MAX];      //!< pending backfill ranges
+};
+
+/*!
+ * \brief Sequence-numbered sample ring with backfill
+ *
+ * Every telemetry sample gets a monotonic (16 bit, wrapping) sequence number
+ * and is kept in a ring buffer. The network server detects gaps in the
+ * sequence and requests the missing ranges with the command CMD_GET_SAMPLES;
+ * the samples are then resent in batched frames.
+ *
+ * Backfill frame format:
+ *   n x {seq[15:0], timestamp[31:0], status, faultcode,
+ *   outputpower[15:0], energytoday[15:0], energytotal[31:0],
+ *   gridvoltage[15:0], gridfrequency[15:0]} (all LE), remaining
+ */
+class SampleRing
+{
+public:
+    /*!
+     * \brief Initialize ring (if RTC RAM contents are invalid)
+     */
+    void begin(void);
+
+    /*!
+     * \brief Add sample
+     *
+     * \param data      inverter input register data
+     * \param timestamp unix time of acquisition
+     *
+     * \returns sequence number of sample
+     */
+    uint16_t add(const growattIF::modbus_input_registers &data, time_t timestamp);
+
+    /*!
+     * \brief Get sequence number of latest sample
+     */
+    uint16_t getSeq(void);
+
+    /*!
+     * \brief Queue backfill request
+     *
+     * \param payload n x {first[15:8], first[7:0], count}
+     * \param size    payload size in bytes
+     *
+     * \returns true if request is valid
+     */
+    bool request(const uint8_t *payload, size_t size);
+
+    /*!
+     * \brief Check if backfill is pending
+     */
+    bool pending(void);
+
+    /*!
+     * \brief Cancel pending backfill request
+     */
+    void cancel(void);
+
+    /*!
+     * \brief Get number of samples in ring
+     */
+    uint8_t getCount(void);
+
+    /*!
+     * \brief Get sample from ring
+     *
+     * \param idx index; 0 is the oldest entry
+     *
+     * \returns pointer to sample or nullptr if idx is out of range
+     */
+    const Sample *getSample(uint8_t idx);
+
+    /*!
+     * \brief Encode requested samples
+     *
+     * Encodes as many of the requested samples as fit into the frame;
+     * the remaining ones are sent in the following frames. Samples which
+     * are no longer available are skipped. The pending ranges are not
+     * modified until sent() is called.
+     *
+     * \param encoder uplink encoder object
+     * \param size    maximum payload size in bytes
+     */
+    void encode(LoraEncoder &encoder, uint8_t size);
+
+    /*!
+     * \brief Frame from last encode() has been sent successfully
+     *
+     * Removes the encoded samples from the pending ranges.
+     */
+    void sent(void);
+
+    /*!
+     * \brief Copy all samples (oldest first) in backfill record format
+     *
+     * \param buf  destination buffer
+     * \param size buffer size in bytes
+     *
+     * \returns number of bytes written
+     */
+    size_t dump(uint8_t *buf, size_t size);
+
+private:
+    /// Pending ranges after the frame from last encode() has been sent
+    SeqRange _next[BACKFILL_RANGES_MAX];
+    uint8_t _nextNum = 0;
+    bool _encoded = false;
+
+    void write(LoraEncoder &encoder, const Sample &s);
+
+    const Sample *find(uint16_t seq);
+};
+#endif // _SAMPLERING_H
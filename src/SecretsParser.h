@@ -0,0 +1,106 @@
+///////////////////////////////////////////////////////////////////////////////
+// SecretsParser.h
+//
+// Parsing of the LoRaWAN secrets' text representation in 'secrets.json'
+//
+// This file has no dependencies on the Arduino framework and is shared with
+// host-side tools.
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_SECRETSPARSER_H)
+#define _SECRETSPARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+/*!
+ * \brief Parse EUI given as hex string ("0x" followed by 16 hex digits)
+ *
+ * \param str EUI string (may be nullptr)
+ * \param eui EUI
+ *
+ * \returns false if the string is missing or too short
+ */
+static inline bool parseEui(const char *str, uint64_t &eui)
+{
+    if ((str == nullptr) || (strlen(str) < 18))
+    {
+        return false;
+    }
+    uint64_t val = 0;
+    for (int i = 2; i < 18; i += 2)
+    {
+        char tmpStr[3] = "";
+        unsigned int tmpByte = 0;
+        memcpy(tmpStr, &str[i], 2);
+        sscanf(tmpStr, "%x", &tmpByte);
+        val = (val << 8) | tmpByte;
+    }
+    eui = val;
+    return true;
+}
+
+/*!
+ * \brief Parse key given as array of 16 hex strings
+ *
+ * \param arr array of strings - JSON array (e.g. doc["appKey"]) or const char *[16]
+ * \param key key (16 bytes)
+ *
+ * \returns false if an entry is missing or if the key is all zeros
+ */
+template <class Array>
+static inline bool parseKey(Array &&arr, uint8_t *key)
+{
+    uint8_t check = 0;
+
+    for (size_t i = 0; i < 16; i++)
+    {
+        const char *buf = arr[i];
+        if (buf == nullptr)
+        {
+            return false;
+        }
+        unsigned int tmp = 0;
+        sscanf(buf, "%x", &tmp);
+        key[i] = static_cast<uint8_t>(tmp);
+        check |= key[i];
+    }
+    return check != 0;
+}
+#endif // _SECRETSPARSER_H
@@ -0,0 +1,70 @@
+///////////////////////////////////////////////////////////////////////////////
+// SleepSchedule.h
+//
+// Alignment of the sleep interval to the wall clock
+//
+// This file has no dependencies on the Arduino framework and is shared with
+// host-side tools.
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_SLEEPSCHEDULE_H)
+#define _SLEEPSCHEDULE_H
+
+#include <stdint.h>
+#include <time.h>
+
+/*!
+ * \brief Align sleep interval to the wall clock
+ *
+ * The sleep interval is reduced so that the wake-up time is the next
+ * integer multiple of the interval past the full hour.
+ *
+ * \param interval sleep interval [s]
+ * \param timeinfo current local time
+ *
+ * \returns aligned sleep interval [s] (may be 0)
+ */
+static inline uint32_t alignSleepInterval(uint32_t interval, const struct tm &timeinfo)
+{
+    uint32_t diff = (timeinfo.tm_min * 60) % interval + timeinfo.tm_sec;
+    if (diff > interval)
+    {
+        diff -= interval;
+    }
+    return interval - diff;
+}
+#endif // _SLEEPSCHEDULE_H
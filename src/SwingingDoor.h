@@ -0,0 +1,181 @@
+///////////////////////////////////////////////////////////////////////////////
+// SwingingDoor.h
+//
+// Error-bounded swinging door trending (SDT) compression of a time series
+//
+// The compressor selects breakpoints such that linear interpolation between
+// consecutive breakpoints reproduces every input sample within the given
+// absolute error (plus 0.5 due to rounding of the breakpoint values).
+// Breakpoint values are taken from the swinging door corridor, i.e. they are
+// not necessarily identical to the input samples.
+//
+// This file has no dependencies on the Arduino framework and is shared with
+// host-side decoders.
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_SWINGINGDOOR_H)
+#define _SWINGINGDOOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*!
+ * \brief Breakpoint of compressed time series
+ */
+struct SdtPoint
+{
+    uint16_t dt;    //!< time offset from start of series [s]
+    uint16_t value; //!< value at breakpoint
+};
+
+/*!
+ * \brief Compress time series with swinging door trending
+ *
+ * The first and the last sample are always kept.
+ *
+ * \param dt        sample time offsets [s], strictly increasing
+ * \param val       sample values
+ * \param n         number of samples
+ * \param maxError  maximum absolute reconstruction error
+ * \param out       breakpoints
+ * \param maxPoints capacity of out
+ *
+ * \returns number of breakpoints, or -1 if more than maxPoints are required
+ */
+static inline int sdtCompress(const uint16_t *dt, const uint16_t *val, size_t n, uint16_t maxError,
+                              SdtPoint *out, size_t maxPoints)
+{
+    if (n == 0)
+    {
+        return 0;
+    }
+    if (maxPoints == 0)
+    {
+        return -1;
+    }
+
+    size_t cnt = 0;
+    out[cnt++] = {dt[0], val[0]};
+
+    // Current pivot (last breakpoint)
+    float pt = dt[0];
+    float pv = val[0];
+
+    // Corridor of slopes which keep all samples since the pivot within maxError
+    float lo = -1e30f;
+    float hi = 1e30f;
+
+    for (size_t i = 1; i < n; i++)
+    {
+        float d = dt[i] - pt;
+        float sLo = (val[i] - maxError - pv) / d;
+        float sHi = (val[i] + maxError - pv) / d;
+        float newLo = (sLo > lo) ? sLo : lo;
+        float newHi = (sHi < hi) ? sHi : hi;
+
+        if (newLo > newHi)
+        {
+            // Door closed - emit breakpoint at previous sample on corridor centerline
+            float s = (lo + hi) / 2;
+            float v = pv + s * (dt[i - 1] - pt);
+            if (cnt >= maxPoints)
+            {
+                return -1;
+            }
+            uint16_t q = (v <= 0) ? 0 : ((v >= 65535.0f) ? 65535 : static_cast<uint16_t>(v + 0.5f));
+            out[cnt++] = {dt[i - 1], q};
+
+            // Restart from new pivot - the quantized value is used
+            // so that the decoder's interpolation is reproduced exactly
+            pt = dt[i - 1];
+            pv = q;
+            d = dt[i] - pt;
+            lo = (val[i] - maxError - pv) / d;
+            hi = (val[i] + maxError - pv) / d;
+        }
+        else
+        {
+            lo = newLo;
+            hi = newHi;
+        }
+    }
+
+    if (n > 1)
+    {
+        if (cnt >= maxPoints)
+        {
+            return -1;
+        }
+        // Last sample on corridor centerline
+        float s = (lo + hi) / 2;
+        float v = pv + s * (dt[n - 1] - pt);
+        uint16_t q = (v <= 0) ? 0 : ((v >= 65535.0f) ? 65535 : static_cast<uint16_t>(v + 0.5f));
+        out[cnt++] = {dt[n - 1], q};
+    }
+    return static_cast<int>(cnt);
+}
+
+/*!
+ * \brief Reconstruct value from breakpoints by linear interpolation
+ *
+ * \param pts breakpoints
+ * \param n   number of breakpoints
+ * \param dt  time offset [s]
+ *
+ * \returns interpolated value
+ */
+static inline float sdtInterpolate(const SdtPoint *pts, size_t n, uint16_t dt)
+{
+    if (n == 0)
+    {
+        return 0;
+    }
+    if (dt <= pts[0].dt)
+    {
+        return pts[0].value;
+    }
+    for (size_t i = 1; i < n; i++)
+    {
+        if (dt <= pts[i].dt)
+        {
+            float f = static_cast<float>(dt - pts[i - 1].dt) / (pts[i].dt - pts[i - 1].dt);
+            return pts[i - 1].value + f * (static_cast<float>(pts[i].value) - pts[i - 1].value);
+        }
+    }
+    return pts[n - 1].value;
+}
+#endif // _SWINGINGDOOR_H
@@ -0,0 +1,475 @@
+///////////////////////////////////////////////////////////////////////////////
+// UplinkSchema.h
+//
+// Uplink payload layout of the inverter data and configuration frames
+//
+// This file has no dependencies on the Arduino framework and is shared with
+// host-side tools (the encoder class is a template parameter). The decoders
+// are the counterparts of the encoders and are used by the host-side
+// uplink decoder (extras/decoder).
+//
+// created: 10/2026
+//
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+// History:
+//
+// 20261017 Created
+//          Added port 9 and configuration uplinks
+//          Added complete frames of ports 1, 2, 4 and 5
+//          Added decoders
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_UPLINKSCHEMA_H)
+#define _UPLINKSCHEMA_H
+
+#include <string.h>
+#include "GrowattDecode.h"
+#include "DeviceProfiles.h"
+#include "SwingingDoor.h"
+#include "DualPredictor.h"
+
+/// Modbus result 'success' (first byte of ports 1..5, see growattIF::Success)
+#define UPLINK_RESULT_SUCCESS 0x00
+
+/// Maximum number of breakpoints per series in a power curve frame
+#define UPLINK_SDT_POINTS_MAX 64
+
+/*!
+ * \brief Encode inverter status (port 1, without sequence number)
+ *
+ * Format: status[7:0], faultcode[7:0], energytoday, energytotal, totalworktime,
+ *         outputpower, gridvoltage, gridfrequency (float, LE)
+ *
+ * \param encoder uplink encoder object (LoraEncoder or compatible)
+ * \param d       inverter data
+ */
+template <class Encoder>
+static inline void encodeInverterStatus(Encoder &encoder, const growatt_input_registers &d)
+{
+    encoder.writeUint8(d.status);
+    encoder.writeUint8(d.faultcode);
+    encoder.writeRawFloat(d.energytoday);
+    encoder.writeRawFloat(d.energytotal);
+    encoder.writeRawFloat(d.totalworktime);
+    encoder.writeRawFloat(d.outputpower);
+    encoder.writeRawFloat(d.gridvoltage);
+    encoder.writeRawFloat(d.gridfrequency);
+}
+
+/*!
+ * \brief Encode PV1 data (port 2, without sequence number)
+ *
+ * Format: pv1voltage, pv1current, pv1power (float, LE),
+ *         tempinverter, tempipm (temperature, BE),
+ *         pv1energytoday, pv1energytotal (float, LE)
+ *
+ * \param encoder uplink encoder object (LoraEncoder or compatible)
+ * \param d       inverter data
+ */
+template <class Encoder>
+static inline void encodeInverterPv1(Encoder &encoder, const growatt_input_registers &d)
+{
+    encoder.writeRawFloat(d.pv1voltage);
+    encoder.writeRawFloat(d.pv1current);
+    encoder.writeRawFloat(d.pv1power);
+    encoder.writeTemperature(d.tempinverter);
+    encoder.writeTemperature(d.tempipm);
+    encoder.writeRawFloat(d.pv1energytoday);
+    encoder.writeRawFloat(d.pv1energytotal);
+}
+
+/*!
+ * \brief Encode inverter status frame (port 1)
+ *
+ * Format: result[7:0], inverter status, seq[15:0] (LE)
+ *
+ * \param encoder uplink encoder object (LoraEncoder or compatible)
+ * \param d       inverter data
+ * \param seq     sequence number of sample
+ */
+template <class Encoder>
+static inline void encodeStatusUplink(Encoder &encoder, const growatt_input_registers &d, uint16_t seq)
+{
+    encoder.writeUint8(UPLINK_RESULT_SUCCESS);
+    encodeInverterStatus(encoder, d);
+    encoder.writeUint16(seq);
+}
+
+/*!
+ * \brief Encode PV1 data frame (port 2)
+ *
+ * Format: result[7:0], PV1 data, seq[15:0] (LE)
+ *
+ * \param encoder uplink encoder object (LoraEncoder or compatible)
+ * \param d       inverter data
+ * \param seq     sequence number of latest sample
+ */
+template <class Encoder>
+static inline void encodePv1Uplink(Encoder &encoder, const growatt_input_registers &d, uint16_t seq)
+{
+    encoder.writeUint8(UPLINK_RESULT_SUCCESS);
+    encodeInverterPv1(encoder, d);
+    encoder.writeUint16(seq);
+}
+
+/*!
+ * \brief Encode compressed power curve frame (port 4)
+ *
+ * The maximum error is doubled until the breakpoints of both series fit
+ * into the frame.
+ *
+ * Format: result[7:0], base[31:0] (LE), max_error[15:0] (LE), n_output, n_solar,
+ *         n_output x {dt[15:0] (LE), value[15:0] (LE)},
+ *         n_solar  x {dt[15:0] (LE), value[15:0] (LE)}
+ *
+ * \param encoder  uplink encoder object (LoraEncoder or compatible)
+ * \param base     time of first sample
+ * \param dt       sample time offsets from base [s]
+ * \param output   output power samples [W]
+ * \param solar    solar (DC input) power samples [W]
+ * \param count    number of samples
+ * \param size     number of bytes available for the frame
+ * \param maxError maximum absolute error [W]
+ *
+ * \returns maximum absolute error used [W]
+ */
+template <class Encoder>
+static inline uint16_t encodePowerCurveUplink(Encoder &encoder, uint32_t base, const uint16_t *dt,
+                                              const uint16_t *output, const uint16_t *solar, uint8_t count,
+                                              uint8_t size, uint16_t maxError)
+{
+    // Frame header: result (1), base (4), max_error (2), n_output (1), n_solar (1)
+    const size_t hdrSize = 9;
+    SdtPoint outPts[UPLINK_SDT_POINTS_MAX];
+    SdtPoint solPts[UPLINK_SDT_POINTS_MAX];
+    size_t budget = (size > hdrSize) ? (size - hdrSize) / 4 : 0;
+    uint32_t err = maxError;
+    int nOut;
+    int nSol;
+
+    if (budget > UPLINK_SDT_POINTS_MAX)
+    {
+        budget = UPLINK_SDT_POINTS_MAX;
+    }
+
+    // Increase the error bound until both series fit into the frame;
+    // two breakpoints per series always fit in a frame of minimum size
+    for (;;)
+    {
+        nOut = sdtCompress(dt, output, count, static_cast<uint16_t>(err), outPts, budget);
+        nSol = (nOut < 0) ? -1 : sdtCompress(dt, solar, count, static_cast<uint16_t>(err), solPts, budget - nOut);
+        if (((nOut >= 0) && (nSol >= 0)) || (err >= 0xFFFF))
+        {
+            break;
+        }
+        err = (err * 2 + 1 < 0xFFFF) ? err * 2 + 1 : 0xFFFF;
+    }
+    if ((nOut < 0) || (nSol < 0))
+    {
+        nOut = 0;
+        nSol = 0;
+    }
+
+    encoder.writeUint8(UPLINK_RESULT_SUCCESS);
+    encoder.writeUint32(base);
+    encoder.writeUint16(static_cast<uint16_t>(err));
+    encoder.writeUint8(static_cast<uint8_t>(nOut));
+    encoder.writeUint8(static_cast<uint8_t>(nSol));
+    for (int i = 0; i < nOut; i++)
+    {
+        encoder.writeUint16(outPts[i].dt);
+        encoder.writeUint16(outPts[i].value);
+    }
+    for (int i = 0; i < nSol; i++)
+    {
+        encoder.writeUint16(solPts[i].dt);
+        encoder.writeUint16(solPts[i].value);
+    }
+    return static_cast<uint16_t>(err);
+}
+
+/*!
+ * \brief Encode dual-prediction report frame (port 5)
+ *
+ * Format: result[7:0], reason, t0[31:0] (LE), power[15:0] (LE),
+ *         trend[15:0] (LE, signed), energy[31:0] (LE), seq[15:0] (LE)
+ *
+ * \param encoder uplink encoder object (LoraEncoder or compatible)
+ * \param reason  reason of report (DP_REASON_*)
+ * \param s       predictor state
+ * \param seq     sequence number of sample
+ */
+template <class Encoder>
+static inline void encodePredictionUplink(Encoder &encoder, uint8_t reason, const DpState &s, uint16_t seq)
+{
+    encoder.writeUint8(UPLINK_RESULT_SUCCESS);
+    encoder.writeUint8(reason);
+    encoder.writeUint32(s.t0);
+    encoder.writeUint16(s.power);
+    encoder.writeUint16(static_cast<uint16_t>(s.trend));
+    encoder.writeUint32(s.energy);
+    encoder.writeUint16(seq);
+}
+
+/*!
+ * \brief Encode inverter summary (port 9, inverter part)
+ *
+ * Format: result[7:0], status[7:0], outputpower, energytoday, energytotal (float, LE)
+ *
+ * \param encoder uplink encoder object (LoraEncoder or compatible)
+ * \param result  Modbus result of inverter readout
+ * \param d       inverter data (only valid if result is 0)
+ */
+template <class Encoder>
+static inline void encodeInverterSummary(Encoder &encoder, uint8_t result, const growatt_input_registers &d)
+{
+    encoder.writeUint8(result);
+    encoder.writeUint8(d.status);
+    encoder.writeRawFloat(d.outputpower);
+    encoder.writeRawFloat(d.energytoday);
+    encoder.writeRawFloat(d.energytotal);
+}
+
+/*!
+ * \brief Encode energy meter (port 9, one entry per meter)
+ *
+ * Format: result[7:0], power, import, export (float, LE)
+ *
+ * \param encoder uplink encoder object (LoraEncoder or compatible)
+ * \param result  Modbus result of meter readout
+ * \param values  meter values (DEV_NUM_VALUES)
+ */
+template <class Encoder>
+static inline void encodeMeter(Encoder &encoder, uint8_t result, const float *values)
+{
+    encoder.writeUint8(result);
+    encoder.writeRawFloat(values[DEV_POWER]);
+    encoder.writeRawFloat(values[DEV_IMPORT]);
+    encoder.writeRawFloat(values[DEV_EXPORT]);
+}
+
+/*!
+ * \brief Encode date/time (response to CMD_GET_DATETIME)
+ *
+ * Format: unix time[31:0] (BE), time source[7:0]
+ *
+ * \param encoder uplink encoder object (LoraEncoder or compatible)
+ * \param t       unix time
+ * \param source  time source
+ */
+template <class Encoder>
+static inline void encodeDateTime(Encoder &encoder, uint32_t t, uint8_t source)
+{
+    encoder.writeUint8((t >> 24) & 0xff);
+    encoder.writeUint8((t >> 16) & 0xff);
+    encoder.writeUint8((t >> 8) & 0xff);
+    encoder.writeUint8(t & 0xff);
+    encoder.writeUint8(source);
+}
+
+/*!
+ * \brief Encode LoRaWAN configuration (response to CMD_GET_LW_CONFIG)
+ *
+ * Format: sleep_interval[15:0] (BE), sleep_interval_long[15:0] (BE), lw_stat_interval[7:0]
+ *
+ * \param encoder             uplink encoder object (LoraEncoder or compatible)
+ * \param sleep_interval      sleep interval [s]
+ * \param sleep_interval_long sleep interval with weak battery [s]
+ * \param lw_stat_interval    LoRaWAN status uplink interval [frames]
+ */
+template <class Encoder>
+static inline void encodeLwConfig(Encoder &encoder, uint16_t sleep_interval, uint16_t sleep_interval_long,
+                                  uint8_t lw_stat_interval)
+{
+    encoder.writeUint8(sleep_interval >> 8);
+    encoder.writeUint8(sleep_interval & 0xFF);
+    encoder.writeUint8(sleep_interval_long >> 8);
+    encoder.writeUint8(sleep_interval_long & 0xFF);
+    encoder.writeUint8(lw_stat_interval);
+}
+
+// -----------------------------------------------------------------------------
+// Decoders
+// -----------------------------------------------------------------------------
+
+/// Size of inverter status (port 1, without result and sequence number)
+#define UPLINK_STATUS_SIZE 26
+
+/// Size of PV1 data (port 2, without result and sequence number)
+#define UPLINK_PV1_SIZE 24
+
+/// Size of date/time response
+#define UPLINK_DATETIME_SIZE 5
+
+/// Size of LoRaWAN configuration response
+#define UPLINK_LWCONFIG_SIZE 5
+
+/*!
+ * \brief Inverter status as transmitted (port 1)
+ */
+struct UplinkStatus
+{
+    uint8_t status;      //!< inverter status
+    uint8_t faultcode;   //!< fault code
+    float energytoday;   //!< [kWh]
+    float energytotal;   //!< [kWh]
+    float totalworktime; //!< [h]
+    float outputpower;   //!< [W]
+    float gridvoltage;   //!< [V]
+    float gridfrequency; //!< [Hz]
+};
+
+/*!
+ * \brief PV1 data as transmitted (port 2)
+ *
+ * The temperatures are kept in their transmitted resolution.
+ */
+struct UplinkPv1
+{
+    float pv1voltage;     //!< [V]
+    float pv1current;     //!< [A]
+    float pv1power;       //!< [W]
+    int16_t tempinverter; //!< [0.01 degC]
+    int16_t tempipm;      //!< [0.01 degC]
+    float pv1energytoday; //!< [kWh]
+    float pv1energytotal; //!< [kWh]
+};
+
+// Read float (LE)
+static inline float uplinkRawFloat(const uint8_t *buf)
+{
+    uint32_t u = buf[0] | (buf[1] << 8) | (buf[2] << 16) | (static_cast<uint32_t>(buf[3]) << 24);
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+// Read temperature (BE, 0.01 degC)
+static inline int16_t uplinkTemperature(const uint8_t *buf)
+{
+    return static_cast<int16_t>((buf[0] << 8) | buf[1]);
+}
+
+/*!
+ * \brief Decode inverter status - counterpart of encodeInverterStatus()
+ *
+ * \param buf payload (after result)
+ * \param len size of buf
+ * \param s   decoded data
+ *
+ * \returns true if buf is large enough
+ */
+static inline bool decodeInverterStatus(const uint8_t *buf, size_t len, UplinkStatus &s)
+{
+    if (len < UPLINK_STATUS_SIZE)
+    {
+        return false;
+    }
+    s.status = buf[0];
+    s.faultcode = buf[1];
+    s.energytoday = uplinkRawFloat(&buf[2]);
+    s.energytotal = uplinkRawFloat(&buf[6]);
+    s.totalworktime = uplinkRawFloat(&buf[10]);
+    s.outputpower = uplinkRawFloat(&buf[14]);
+    s.gridvoltage = uplinkRawFloat(&buf[18]);
+    s.gridfrequency = uplinkRawFloat(&buf[22]);
+    return true;
+}
+
+/*!
+ * \brief Decode PV1 data - counterpart of encodeInverterPv1()
+ *
+ * \param buf payload (after result)
+ * \param len size of buf
+ * \param s   decoded data
+ *
+ * \returns true if buf is large enough
+ */
+static inline bool decodeInverterPv1(const uint8_t *buf, size_t len, UplinkPv1 &s)
+{
+    if (len < UPLINK_PV1_SIZE)
+    {
+        return false;
+    }
+    s.pv1voltage = uplinkRawFloat(&buf[0]);
+    s.pv1current = uplinkRawFloat(&buf[4]);
+    s.pv1power = uplinkRawFloat(&buf[8]);
+    s.tempinverter = uplinkTemperature(&buf[12]);
+    s.tempipm = uplinkTemperature(&buf[14]);
+    s.pv1energytoday = uplinkRawFloat(&buf[16]);
+    s.pv1energytotal = uplinkRawFloat(&buf[20]);
+    return true;
+}
+
+/*!
+ * \brief Decode date/time - counterpart of encodeDateTime()
+ *
+ * \param buf    payload
+ * \param len    size of buf
+ * \param t      unix time
+ * \param source time source
+ *
+ * \returns true if buf is large enough
+ */
+static inline bool decodeDateTime(const uint8_t *buf, size_t len, uint32_t &t, uint8_t &source)
+{
+    if (len < UPLINK_DATETIME_SIZE)
+    {
+        return false;
+    }
+    t = (static_cast<uint32_t>(buf[0]) << 24) | (buf[1] << 16) | (buf[2] << 8) | buf[3];
+    source = buf[4];
+    return true;
+}
+
+/*!
+ * \brief Decode LoRaWAN configuration - counterpart of encodeLwConfig()
+ *
+ * \param buf                 payload
+ * \param len                 size of buf
+ * \param sleep_interval      sleep interval [s]
+ * \param sleep_interval_long sleep interval with weak battery [s]
+ * \param lw_stat_interval    LoRaWAN status uplink interval [frames]
+ *
+ * \returns true if buf is large enough
+ */
+static inline bool decodeLwConfig(const uint8_t *buf, size_t len, uint16_t &sleep_interval,
+                                  uint16_t &sleep_interval_long, uint8_t &lw_stat_interval)
+{
+    if (len < UPLINK_LWCONFIG_SIZE)
+    {
+        return false;
+    }
+    sleep_interval = static_cast<uint16_t>((buf[0] << 8) | buf[1]);
+    sleep_interval_long = static_cast<uint16_t>((buf[2] << 8) | buf[3]);
+    lw_stat_interval = buf[4];
+    return true;
+}
+#endif // _UPLINKSCHEMA_H
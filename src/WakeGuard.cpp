@@ -0,0 +1,338 @@
+///////////////////////////////////////////////////////////////////////////////
+// WakeGuard.cpp
+//
+// Wake-cycle guard - per-phase deadlines enforced by a watchdog, overall
+// awake time budget and incident records for the status uplink
+//
+// created: 10/2026
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//
+// History:
+//
+// 20261017 Created
+//          Cycle budget checked in main task (check())
+//          Counters cleared only after successful report uplink (reportSent())
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "WakeGuard.h"
+#include "growatt2lorawan_cfg.h"
+
+#if defined(ESP32)
+#include <esp_idf_version.h>
+#include <esp_system.h>
+#include <esp_task_wdt.h>
+#include <esp_timer.h>
+#else
+#include <pico/time.h>
+#include <hardware/watchdog.h>
+#endif
+
+#define WAKE_GUARD_MAGIC 0x57474431 // "WGD1"
+
+// Guard state - must retain its contents during deep sleep and watchdog reset
+#if defined(ESP32)
+RTC_DATA_ATTR WakeGuardStore wakeGuardStore;
+#else
+WakeGuardStore wakeGuardStore __attribute__((section(".uninitialized_data")));
+#endif
+
+// Sleep hook, set in begin()
+static WakeGuard::SleepHook sleepHook = nullptr;
+
+// Cycle budget expired - set by timer callback, evaluated by check()
+static volatile bool budgetFlag = false;
+
+#if defined(ESP32)
+static esp_timer_handle_t budgetTimer = nullptr;
+#else
+static alarm_id_t phaseAlarm = 0;
+static alarm_id_t budgetAlarmId = 0;
+
+// Phase deadline missed - reset MCU; the phase is evaluated after restart
+static int64_t phaseExpired(alarm_id_t id, void *arg)
+{
+    (void)id;
+    (void)arg;
+    watchdog_reboot(0, 0, 0);
+    return 0;
+}
+
+// Cycle budget exceeded
+static int64_t budgetAlarm(alarm_id_t id, void *arg)
+{
+    (void)id;
+    WakeGuard::budgetExpired(arg);
+    return 0;
+}
+#endif
+
+// Cycle start [ms]
+static uint32_t cycleStart;
+
+// Cycle budget [s]
+static uint32_t cycleBudget;
+
+E_WAKE_PHASE WakeGuard::begin(SleepHook hook)
+{
+    sleepHook = hook;
+    budgetFlag = false;
+    cycleStart = millis();
+    cycleBudget = WG_CYCLE_BUDGET;
+
+    if (wakeGuardStore.magic != WAKE_GUARD_MAGIC)
+    {
+        log_d("Initializing wake guard");
+        memset(&wakeGuardStore, 0, sizeof(wakeGuardStore));
+        wakeGuardStore.magic = WAKE_GUARD_MAGIC;
+    }
+    else if (wakeGuardStore.phase != E_WAKE_PHASE::E_NONE)
+    {
+        // Previous cycle did not complete - watchdog reset, forced sleep or fatal error
+        _incident = (wakeGuardStore.phase == E_WAKE_PHASE::E_FAILURE) ? wakeGuardStore.failed : wakeGuardStore.phase;
+        wakeGuardStore.last = _incident;
+        if (wakeGuardStore.incidents < 255)
+        {
+            wakeGuardStore.incidents++;
+        }
+        if (wakeGuardStore.consecutive < 255)
+        {
+            wakeGuardStore.consecutive++;
+        }
+#if defined(ESP32)
+        log_w("Wake guard incident: phase %u, reset reason %d, %u consecutive",
+              static_cast<uint8_t>(wakeGuardStore.phase), esp_reset_reason(), wakeGuardStore.consecutive);
+#else
+        log_w("Wake guard incident: phase %u, %u consecutive",
+              static_cast<uint8_t>(wakeGuardStore.phase), wakeGuardStore.consecutive);
+#endif
+    }
+
+#if defined(ESP32)
+    if (budgetTimer == nullptr)
+    {
+        esp_timer_create_args_t args = {};
+        args.callback = budgetExpired;
+        args.arg = this;
+        args.name = "wake_budget";
+        esp_timer_create(&args, &budgetTimer);
+    }
+    esp_timer_start_once(budgetTimer, static_cast<uint64_t>(cycleBudget) * 1000000ULL);
+#else
+    budgetAlarmId = add_alarm_in_ms(cycleBudget * 1000UL, budgetAlarm, this, true);
+#endif
+    enter(E_WAKE_PHASE::E_STARTUP);
+    return _incident;
+}
+
+uint32_t WakeGuard::deadline(E_WAKE_PHASE phase)
+{
+    switch (phase)
+    {
+    case E_WAKE_PHASE::E_MODBUS:
+        return WG_DL_MODBUS;
+    case E_WAKE_PHASE::E_RADIO:
+        return WG_DL_RADIO;
+    case E_WAKE_PHASE::E_JOIN:
+        return WG_DL_JOIN;
+    case E_WAKE_PHASE::E_UPLINK:
+    case E_WAKE_PHASE::E_DOWNLINK:
+        return WG_DL_UPLINK;
+    default:
+        return WG_DL_DEFAULT;
+    }
+}
+
+void WakeGuard::enter(E_WAKE_PHASE phase)
+{
+    enter(phase, deadline(phase));
+}
+
+void WakeGuard::enter(E_WAKE_PHASE phase, uint32_t seconds)
+{
+    if (phase != E_WAKE_PHASE::E_SLEEP)
+    {
+        check();
+    }
+    log_v("Wake guard: phase %u, deadline %u s", static_cast<uint8_t>(phase), seconds);
+    wakeGuardStore.phase = phase;
+    armWatchdog(seconds);
+}
+
+void WakeGuard::check(void)
+{
+    if (budgetFlag)
+    {
+        forceSleep(E_WAKE_PHASE::E_BUDGET);
+    }
+}
+
+void WakeGuard::armWatchdog(uint32_t seconds)
+{
+#if defined(ESP32)
+    // Arduino-ESP32 initializes the task watchdog at start-up;
+    // subscribing the current task again is rejected and harmless
+#if ESP_IDF_VERSION_MAJOR >= 5
+    esp_task_wdt_config_t cfg = {};
+    cfg.timeout_ms = seconds * 1000UL;
+    cfg.idle_core_mask = 0;
+    cfg.trigger_panic = true;
+    esp_task_wdt_reconfigure(&cfg);
+#else
+    esp_task_wdt_init(seconds, true);
+#endif
+    esp_task_wdt_add(NULL);
+    esp_task_wdt_reset();
+#else
+    if (phaseAlarm > 0)
+    {
+        cancel_alarm(phaseAlarm);
+    }
+    phaseAlarm = add_alarm_in_ms(seconds * 1000UL, phaseExpired, nullptr, true);
+#endif
+}
+
+void WakeGuard::disarm(void)
+{
+#if defined(ESP32)
+    esp_task_wdt_delete(NULL);
+    if (budgetTimer != nullptr)
+    {
+        esp_timer_stop(budgetTimer);
+    }
+#else
+    if (phaseAlarm > 0)
+    {
+        cancel_alarm(phaseAlarm);
+        phaseAlarm = 0;
+    }
+    if (budgetAlarmId > 0)
+    {
+        cancel_alarm(budgetAlarmId);
+        budgetAlarmId = 0;
+    }
+#endif
+}
+
+void WakeGuard::extendBudget(uint32_t seconds)
+{
+    uint32_t elapsed = (millis() - cycleStart) / 1000;
+    cycleBudget += seconds;
+    log_d("Wake guard: cycle budget extended to %u s", cycleBudget);
+#if defined(ESP32)
+    esp_timer_stop(budgetTimer);
+    esp_timer_start_once(budgetTimer, static_cast<uint64_t>(cycleBudget - elapsed) * 1000000ULL);
+#else
+    cancel_alarm(budgetAlarmId);
+    budgetAlarmId = add_alarm_in_ms((cycleBudget - elapsed) * 1000UL, budgetAlarm, this, true);
+#endif
+}
+
+void WakeGuard::budgetExpired(void *arg)
+{
+    // The main task may be inside a radio operation - no sleep from here
+    (void)arg;
+    budgetFlag = true;
+}
+
+void WakeGuard::fail(void)
+{
+    wakeGuardStore.failed = wakeGuardStore.phase;
+    forceSleep(E_WAKE_PHASE::E_FAILURE);
+}
+
+// Called by the main task only (check(), fail())
+void WakeGuard::forceSleep(E_WAKE_PHASE phase)
+{
+    // The phase is kept - the next cycle evaluates it as incident
+    wakeGuardStore.phase = phase;
+#if defined(ESP32)
+    esp_task_wdt_delete(NULL);
+    uint32_t seconds = sleepHook ? sleepHook() : SLEEP_INTERVAL_MIN;
+    log_w("Wake guard: forced sleep for %u s (phase %u)", seconds, static_cast<uint8_t>(phase));
+    esp_sleep_enable_timer_wakeup(seconds * 1000UL * 1000UL);
+    Serial.flush();
+    esp_deep_sleep_start();
+#else
+    // Restart; the next cycle evaluates the incident
+    if (sleepHook)
+    {
+        sleepHook();
+    }
+    watchdog_reboot(0, 0, 0);
+    for (;;)
+        ;
+#endif
+}
+
+void WakeGuard::end(void)
+{
+    disarm();
+
+    uint32_t awake = (millis() - cycleStart) / 1000;
+    uint16_t awake16 = static_cast<uint16_t>(min(awake, static_cast<uint32_t>(0xFFFF)));
+    wakeGuardStore.awakeMax = max(wakeGuardStore.awakeMax, awake16);
+    if (_incident == E_WAKE_PHASE::E_NONE)
+    {
+        wakeGuardStore.consecutive = 0;
+    }
+    wakeGuardStore.phase = E_WAKE_PHASE::E_NONE;
+    log_d("Wake guard: awake for %u s", awake);
+}
+
+E_WAKE_PHASE WakeGuard::getIncident(void)
+{
+    return _incident;
+}
+
+uint8_t WakeGuard::getConsecutive(void)
+{
+    return wakeGuardStore.consecutive;
+}
+
+bool WakeGuard::reportPending(void)
+{
+    return wakeGuardStore.incidents > 0;
+}
+
+void WakeGuard::encodeReport(LoraEncoder &encoder)
+{
+    encoder.writeUint8(wakeGuardStore.incidents);
+    encoder.writeUint8(static_cast<uint8_t>(wakeGuardStore.last));
+    encoder.writeUint16(wakeGuardStore.awakeMax);
+    _reported = wakeGuardStore.incidents;
+}
+
+void WakeGuard::reportSent(void)
+{
+    // Incidents which occurred after encoding are kept for the next report
+    wakeGuardStore.incidents -= min(_reported, wakeGuardStore.incidents);
+    wakeGuardStore.awakeMax = 0;
+    _reported = 0;
+}
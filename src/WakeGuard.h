@@ -0,0 +1,221 @@
+///////////////////////////////////////////////////////////////////////////////
+// WakeGuard.h
+//
+// Wake-cycle guard - per-phase deadlines enforced by a watchdog, overall
+// awake time budget and incident records for the status uplink
+//
+// created: 10/2026
+//
+// MIT License
+//
+// Copyright (c) 2024 Matthias Prinke
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//
+// History:
+//
+// 20261017 Created
+//          Cycle budget checked in main task (check())
+//          Counters cleared only after successful report uplink (reportSent())
+//
+// ToDo:
+// -
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_WAKEGUARD_H)
+#define _WAKEGUARD_H
+
+#include <Arduino.h>
+#include <LoraMessage.h>
+
+/// Wake-cycle phases (also used as incident classes)
+enum class E_WAKE_PHASE : uint8_t
+{
+    E_NONE = 0,     //!< not awake / cycle completed
+    E_STARTUP = 1,  //!< start-up, preferences, secrets
+    E_MODBUS = 2,   //!< inverter readout
+    E_RADIO = 3,    //!< radio initialization
+    E_JOIN = 4,     //!< session restore / join
+    E_UPLINK = 5,   //!< scheduled uplinks and command responses
+    E_DOWNLINK = 6, //!< downlink draining, blob fragments, downlink polling
+    E_SLEEP = 7,    //!< preparing deep sleep
+    E_BUDGET = 8,   //!< overall cycle budget exceeded
+    E_FAILURE = 9   //!< fatal error reported by debug()
+};
+
+/*!
+ * \brief Wake-cycle guard state (located in RTC RAM)
+ */
+struct WakeGuardStore
+{
+    uint32_t magic;         //!< validity marker
+    E_WAKE_PHASE phase;     //!< current phase; E_NONE if last cycle completed
+    E_WAKE_PHASE failed;    //!< phase which was active when debug() failed
+    E_WAKE_PHASE last;      //!< class of last incident
+    uint8_t incidents;      //!< incidents since last report
+    uint8_t consecutive;    //!< consecutive cycles with incident
+    uint16_t awakeMax;      //!< maximum awake time since last report [s]
+};
+
+/*!
+ * \brief Wake-cycle guard
+ *
+ * Each phase of the wake-up cycle gets a deadline which is enforced by the
+ * task watchdog (ESP32) or a hardware alarm (RP2040); a phase which misses
+ * its deadline (e.g. a stuck Modbus transaction or radio operation) resets
+ * the MCU. The overall awake time is limited to WG_CYCLE_BUDGET seconds -
+ * if it is exceeded, the node is put into deep sleep at the next phase
+ * boundary. The budget timer callback only sets a flag; the forced sleep
+ * (including the sleep hook) is executed by the main task in enter() or
+ * check(), so the radio and the session buffer are never accessed
+ * concurrently.
+ *
+ * The phase is kept in RTC RAM, so after a reset or a forced sleep, the
+ * next wake-up cycle knows which phase failed (the incident class) and can
+ * take a recovery action. Incidents are reported in the LoRaWAN node status
+ * uplink (CMD_GET_LW_STATUS).
+ *
+ * Worst-case awake time per cycle: WG_CYCLE_BUDGET plus the deadline of the
+ * phase active when the budget expires (plus the time explicitly granted
+ * with extendBudget() for downlink polling on external power).
+ */
+class WakeGuard
+{
+public:
+    /*!
+     * \brief Sleep hook - called before forced deep sleep
+     *
+     * Called by the main task at a phase boundary. Must save all state
+     * required in the next cycle and return the sleep duration in seconds
+     * (ESP32). On RP2040, the MCU is restarted instead.
+     */
+    typedef uint32_t (*SleepHook)(void);
+
+    /*!
+     * \brief Start wake-up cycle
+     *
+     * Detects incidents of the previous cycle, arms the watchdog
+     * (phase E_STARTUP) and the cycle budget timer.
+     *
+     * \param hook sleep hook
+     *
+     * \returns incident class of previous cycle or E_WAKE_PHASE::E_NONE
+     */
+    E_WAKE_PHASE begin(SleepHook hook);
+
+    /*!
+     * \brief Enter phase with default deadline (see WG_DL_*)
+     *
+     * Enters forced sleep instead if the cycle budget has expired.
+     *
+     * \param phase wake-cycle phase
+     */
+    void enter(E_WAKE_PHASE phase);
+
+    /*!
+     * \brief Enter phase with specific deadline
+     *
+     * \param phase   wake-cycle phase
+     * \param seconds deadline [s]
+     */
+    void enter(E_WAKE_PHASE phase, uint32_t seconds);
+
+    /*!
+     * \brief Check cycle budget
+     *
+     * Enters forced sleep if the cycle budget has expired.
+     * Must be called from the main task between radio operations
+     * (e.g. in loops which send several uplinks).
+     */
+    void check(void);
+
+    /*!
+     * \brief Extend overall cycle budget
+     *
+     * \param seconds additional awake time [s]
+     */
+    void extendBudget(uint32_t seconds);
+
+    /*!
+     * \brief Handle fatal error - record incident and enter forced deep sleep
+     */
+    void fail(void);
+
+    /*!
+     * \brief Complete wake-up cycle (immediately before deep sleep)
+     */
+    void end(void);
+
+    /*!
+     * \brief Get incident class of previous cycle
+     */
+    E_WAKE_PHASE getIncident(void);
+
+    /*!
+     * \brief Get number of consecutive cycles with incident
+     */
+    uint8_t getConsecutive(void);
+
+    /*!
+     * \brief Check if incidents are waiting to be reported
+     */
+    bool reportPending(void);
+
+    /*!
+     * \brief Encode incident report
+     *
+     * The counters are cleared by reportSent().
+     *
+     * Uplink format:
+     *   incidents, last_incident, awake_max[15:0] (LE)
+     *
+     * \param encoder uplink encoder object
+     */
+    void encodeReport(LoraEncoder &encoder);
+
+    /*!
+     * \brief Incident report has been sent successfully - clear counters
+     */
+    void reportSent(void);
+
+    /*!
+     * \brief Cycle budget timer callback
+     *
+     * Runs on the timer task (ESP32) or in interrupt context (RP2040) and
+     * only sets a flag which is evaluated by check().
+     *
+     * \param arg pointer to WakeGuard object
+     */
+    static void budgetExpired(void *arg);
+
+private:
+    E_WAKE_PHASE _incident = E_WAKE_PHASE::E_NONE;
+
+    /// Number of incidents in last encoded report
+    uint8_t _reported = 0;
+
+    void forceSleep(E_WAKE_PHASE phase);
+    static uint32_t deadline(E_WAKE_PHASE phase);
+    static void armWatchdog(uint32_t seconds);
+    static void disarm(void);
+};
+#endif // _WAKEGUARD_H
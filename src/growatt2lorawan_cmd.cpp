@@ -40,17 +40,35 @@
 // 20240818 Replaced delay() with light sleep for ESP32
 // 20240828 Renamed Preferences: BWS-LW to GRO2LW
 //          Added implementation of CMD_SET_LW_STATUS_INTERVAL
+// 20261017 Increased uplink buffer size to PAYLOAD_SIZE_MAX (backfill)
+//          Added sendBlobFragments()
+//          Added pollDownlinks()
+//          Added drainDownlinks()
+//          Added wake guard incident report to CMD_GET_LW_STATUS
+//          Added wake guard budget checks in uplink loops
+//          Drain only after application downlinks
+//          Added health statistics
+//          Moved encoding of configuration uplinks to UplinkSchema.h
+//          Moved get requests to DownlinkDispatch.h
+//          Save session after each uplink
+//          Notify AppLayer of successful configuration uplink (backfill)
+//          Clear wake guard incident counters after successful report
 //
 // ToDo:
 // -
 //
 ///////////////////////////////////////////////////////////////////////////////
 
+#include <Arduino.h>
 #include "growatt2lorawan_cmd.h"
 #include <Preferences.h>
 #include <RadioLib.h>
 #include <ESP32Time.h>
 #include "src/AppLayer.h"
+#include "src/WakeGuard.h"
+#include "src/HealthStats.h"
+#include "src/UplinkSchema.h"
+#include "src/DownlinkDispatch.h"
 
 /*
  * From config.h
@@ -63,6 +81,7 @@ extern const uint16_t uplinkIntervalSeconds;
  * From growatt2lorawan-v2.ino
  */
 extern uint16_t getBatteryVoltage();
+extern void saveSession(void);
 
 /*
  * External variables (declared in BresserWeatherSensorLW.ino)
@@ -83,6 +102,12 @@ extern ESP32Time rtc;
 /// Application layer
 extern AppLayer appLayer;
 
+/// Wake-cycle guard
+extern WakeGuard wakeGuard;
+
+/// Node health telemetry
+extern HealthStats healthStats;
+
 extern bool longSleep;
 extern time_t rtcLastClockSync;
 extern E_TIME_SOURCE rtcTimeSource;
@@ -101,10 +126,11 @@ uint8_t decodeDownlink(uint8_t port, uint8_t *payload, size_t size)
 {
   log_v("Port: %d", port);
 
-  if ((port == CMD_GET_DATETIME) && (payload[0] == 0x00) && (size == 1))
+  uint8_t uplinkReq = getCmdRequest(port, payload, size);
+  if (uplinkReq)
   {
-    log_d("Get date/time");
-    return CMD_GET_DATETIME;
+    log_d("Get request 0x%02X", uplinkReq);
+    return uplinkReq;
   }
 
   if ((port == CMD_SET_DATETIME) && (size == 4))
@@ -155,18 +181,6 @@ uint8_t decodeDownlink(uint8_t port, uint8_t *payload, size_t size)
     return 0;
   }
 
-  if ((port == CMD_GET_LW_CONFIG) && (payload[0] == 0x00) && (size == 1))
-  {
-    log_d("Get config");
-    return CMD_GET_LW_CONFIG;
-  }
-
-  if ((port == CMD_GET_LW_STATUS) && (payload[0] == 0x00) && (size == 1))
-  {
-    log_d("Get device status");
-    return CMD_GET_LW_STATUS;
-  }
-
   log_d("appLayer.decodeDownlink(port=%d, payload[0]=0x%02X, size=%d)", port, payload[0], size);
   return appLayer.decodeDownlink(port, payload, size);
 }
@@ -176,7 +190,7 @@ void sendCfgUplink(uint8_t uplinkReq, uint32_t uplinkInterval)
 {
   log_d("--- Uplink Configuration/Status ---");
 
-  uint8_t uplinkPayload[48];
+  uint8_t uplinkPayload[PAYLOAD_SIZE_MAX];
   uint8_t port = uplinkReq;
 
   //
@@ -188,21 +202,12 @@ void sendCfgUplink(uint8_t uplinkReq, uint32_t uplinkInterval)
   {
     log_d("Date/Time");
     time_t t_now = rtc.getLocalEpoch();
-    encoder.writeUint8((t_now >> 24) & 0xff);
-    encoder.writeUint8((t_now >> 16) & 0xff);
-    encoder.writeUint8((t_now >> 8) & 0xff);
-    encoder.writeUint8(t_now & 0xff);
-
-    encoder.writeUint8(static_cast<uint8_t>(rtcTimeSource));
+    encodeDateTime(encoder, static_cast<uint32_t>(t_now), static_cast<uint8_t>(rtcTimeSource));
   }
   else if (uplinkReq == CMD_GET_LW_CONFIG)
   {
     log_d("LoRaWAN Config");
-    encoder.writeUint8(prefs.sleep_interval >> 8);
-    encoder.writeUint8(prefs.sleep_interval & 0xFF);
-    encoder.writeUint8(prefs.sleep_interval_long >> 8);
-    encoder.writeUint8(prefs.sleep_interval_long & 0xFF);
-    encoder.writeUint8(prefs.lw_stat_interval);
+    encodeLwConfig(encoder, prefs.sleep_interval, prefs.sleep_interval_long, prefs.lw_stat_interval);
   }
   else if (uplinkReq == CMD_GET_LW_STATUS)
   {
@@ -210,6 +215,7 @@ void sendCfgUplink(uint8_t uplinkReq, uint32_t uplinkInterval)
     log_d("Device Status: U_batt=%u mV, longSleep=%u", getBatteryVoltage(), status);
     encoder.writeUint16(getBatteryVoltage());
     encoder.writeUint8(status);
+    wakeGuard.encodeReport(encoder);
 #if defined(ARDUINO_ESP32S3_POWERFEATHER)
     Result res;
     uint16_t voltage;
@@ -325,5 +331,157 @@ void sendCfgUplink(uint8_t uplinkReq, uint32_t uplinkInterval)
 #endif
   log_d("Sending configuration uplink now.");
   int16_t state = node.sendReceive(uplinkPayload, encoder.getLength(), port);
+  healthStats.uplink((state == RADIOLIB_LORAWAN_NO_DOWNLINK) || (state == RADIOLIB_ERR_NONE), node.getLastToA());
+  saveSession();
+  debug((state != RADIOLIB_LORAWAN_NO_DOWNLINK) && (state != RADIOLIB_ERR_NONE), "Error in sendReceive", state, false);
+  if ((state != RADIOLIB_LORAWAN_NO_DOWNLINK) && (state != RADIOLIB_ERR_NONE))
+  {
+    return;
+  }
+  if (uplinkReq == CMD_GET_LW_STATUS)
+  {
+    wakeGuard.reportSent();
+  }
+  appLayer.uplinkSent(port);
+}
+
+// Send pending blob fragments
+void sendBlobFragments(void)
+{
+  uint8_t fragment[PAYLOAD_SIZE_MAX];
+  uint8_t size;
+
+  for (int i = 0; i < BLOB_FRAGS_PER_WAKE; i++)
+  {
+    if (!appLayer.getBlobFragment(fragment, size))
+    {
+      return;
+    }
+
+    // Pace transmission by duty cycle / fair use limits
+    uint32_t delayMs = node.timeUntilUplink();
+    if (delayMs > BLOB_WAIT_MAX * 1000UL)
+    {
+      log_d("Blob transfer continues after next wake-up (%u s)", delayMs / 1000);
+      return;
+    }
+    if (delayMs > 0)
+    {
+#if defined(ESP32)
+      esp_sleep_enable_timer_wakeup(delayMs * 1000);
+      esp_light_sleep_start();
+#else
+      delay(delayMs);
+#endif
+    }
+
+    wakeGuard.check();
+    log_d("Sending blob fragment; size %u", size);
+    int16_t state = node.sendReceive(fragment, size, BLOB_PORT);
+    healthStats.uplink((state == RADIOLIB_LORAWAN_NO_DOWNLINK) || (state == RADIOLIB_ERR_NONE), node.getLastToA());
+    saveSession();
+    debug((state != RADIOLIB_LORAWAN_NO_DOWNLINK) && (state != RADIOLIB_ERR_NONE), "Error in sendReceive", state, false);
+    if ((state != RADIOLIB_LORAWAN_NO_DOWNLINK) && (state != RADIOLIB_ERR_NONE))
+    {
+      return;
+    }
+    appLayer.blobFragmentSent();
+  }
+}
+
+// Send empty uplink and handle received command, if any;
+// returns true if an application downlink has been received
+static bool sendPollUplink(void)
+{
+  uint8_t uplinkPayload[1];
+  uint8_t downlinkPayload[MAX_DOWNLINK_SIZE];
+  size_t downlinkSize = 0;
+  LoRaWANEvent_t uplinkDetails;
+  LoRaWANEvent_t downlinkDetails;
+
+  log_d("Sending empty uplink");
+  int16_t state = node.sendReceive(
+      uplinkPayload,
+      0,
+      LL_POLL_PORT,
+      downlinkPayload,
+      &downlinkSize,
+      false,
+      &uplinkDetails,
+      &downlinkDetails);
+  healthStats.uplink((state == RADIOLIB_LORAWAN_NO_DOWNLINK) || (state == RADIOLIB_ERR_NONE), node.getLastToA());
+  saveSession();
   debug((state != RADIOLIB_LORAWAN_NO_DOWNLINK) && (state != RADIOLIB_ERR_NONE), "Error in sendReceive", state, false);
-}
\ No newline at end of file
+
+  // Only application downlinks count (see drainDownlinks())
+  if ((state != RADIOLIB_ERR_NONE) || (downlinkSize == 0) || (downlinkDetails.fPort == 0))
+  {
+    return false;
+  }
+  log_i("Downlink port %u, size %u", downlinkDetails.fPort, downlinkSize);
+  uint8_t uplinkReq = decodeDownlink(downlinkDetails.fPort, downlinkPayload, downlinkSize);
+  if (uplinkReq)
+  {
+    sendCfgUplink(uplinkReq, 0);
+  }
+  return true;
+}
+
+// Poll for downlinks
+uint32_t pollDownlinks(uint32_t seconds)
+{
+  uint32_t startMs = millis();
+  uint32_t windowMs = seconds * 1000UL;
+
+  log_i("Low-latency mode - polling for downlinks for %u s", seconds);
+  for (;;)
+  {
+    uint32_t elapsedMs = millis() - startMs;
+    uint32_t delayMs = getUplinkDelayMs(LL_POLL_INTERVAL);
+    if (elapsedMs + delayMs >= windowMs)
+    {
+      break;
+    }
+#if defined(ESP32)
+    esp_sleep_enable_timer_wakeup(delayMs * 1000);
+    esp_light_sleep_start();
+#else
+    delay(delayMs);
+#endif
+    wakeGuard.check();
+    sendPollUplink();
+  }
+
+  uint32_t elapsedMs = millis() - startMs;
+  return (elapsedMs < windowMs) ? max((windowMs - elapsedMs) / 1000UL, 1UL) : 1;
+}
+
+// Drain queued downlinks
+void drainDownlinks(void)
+{
+  for (int i = 0; i < DL_DRAIN_MAX; i++)
+  {
+    // Pace transmission by duty cycle / fair use limits
+    uint32_t delayMs = node.timeUntilUplink();
+    if (delayMs > DL_DRAIN_WAIT_MAX * 1000UL)
+    {
+      log_d("Downlink drain continues after next wake-up (%u s)", delayMs / 1000);
+      return;
+    }
+    if (delayMs > 0)
+    {
+#if defined(ESP32)
+      esp_sleep_enable_timer_wakeup(delayMs * 1000);
+      esp_light_sleep_start();
+#else
+      delay(delayMs);
+#endif
+    }
+    wakeGuard.check();
+    if (!sendPollUplink())
+    {
+      log_d("Downlink queue empty");
+      return;
+    }
+  }
+}
@@ -36,6 +36,14 @@
 //
 // 20240721 Copied from BresserWeatherSensorLW project
 // 20240815 Added getUplinkDelayMs()
+// 20261017 Added CMD_GET_SAMPLES
+//          Added CMD_GET_BLOB, sendBlobFragments()
+//          Added pollDownlinks()
+//          Added drainDownlinks()
+//          Added wake guard incident report to CMD_GET_LW_STATUS
+//          Added CMD_GET_SENSORS_STAT (health statistics)
+//          Added CMD_START_BURST
+//          Removed dependency on Arduino.h (shared with host-side tools)
 //
 // ToDo:
 // -
@@ -45,7 +53,8 @@
 #if !defined(_LWCMD_H)
 #define _LWCMD_H
 
-#include <Arduino.h>
+#include <stdint.h>
+#include <stddef.h>
 #include "growatt2lorawan_cfg.h"
 
 // ===========================
@@ -144,9 +153,13 @@
 // byte0: 0x00
 
 // Uplink (response):
-// byte0: u_batt[15:8]
-// byte1: u_batt[ 7:0]
+// byte0: u_batt[ 7:0]
+// byte1: u_batt[15:8]
 // byte2: flags[ 7:0]
+// byte3: wake guard incidents since last report
+// byte4: wake guard last incident class (E_WAKE_PHASE)
+// byte5: wake guard max. awake time since last report [s] [ 7:0]
+// byte6: wake guard max. awake time since last report [s] [15:8]
 
 // -----------------------
 // -- Application layer --
@@ -175,6 +188,61 @@
 
 // Uplink: n.a.
 
+// CMD_GET_SENSORS_STAT
+// ---------------------
+// Note: Get node health statistics (lifetime counters)
+// Port: CMD_GET_SENSORS_STAT
+#define CMD_GET_SENSORS_STAT 0x42
+
+// Downlink (command):
+// byte0: 0x00
+
+// Uplink (response; little endian, see HealthStats.h):
+// mb_transactions[31:0], 8 x mb_errors[15:0],
+// mb_retries[15:0], joins[15:0], restores[15:0],
+// uplinks[31:0], uplink_failures[15:0], airtime[31:0],
+// cycles[31:0], awake_avg[15:0]
+
+// CMD_GET_SAMPLES
+// ----------------
+// Note: Request retransmission of telemetry samples (backfill) by sequence number
+// Port: CMD_GET_SAMPLES
+#define CMD_GET_SAMPLES 0x44
+
+// Downlink (command):
+// n x {first_seq[15:8], first_seq[7:0], count[7:0]} (n = 1...8)
+
+// Uplink (response; repeated until all requested samples have been sent):
+// m x {seq[15:0], timestamp[31:0], status[7:0], faultcode[7:0],
+//      outputpower[15:0], energytoday[15:0], energytotal[31:0],
+//      gridvoltage[15:0], gridfrequency[15:0]} (little endian)
+// remaining[7:0]
+
+// CMD_GET_BLOB
+// -------------
+// Note: Request bulk data transfer (fragmented uplinks on BLOB_PORT, see src/FragCodec.h)
+// Port: CMD_GET_BLOB
+#define CMD_GET_BLOB 0x45
+
+// Downlink (command):
+// byte0: blob_type[7:0] (0x01: input register image / 0x02: sample ring)
+
+// Uplink (response): fragments on BLOB_PORT
+// session[7:0], blob_type[7:0], index[7:0], n[7:0], size[15:0] (LE), data
+
+// CMD_START_BURST
+// ----------------
+// Note: Start diagnostic burst - high-rate capture of selected values (see src/BurstCapture.h),
+//       executed once at the end of the current wake-up cycle
+// Port: CMD_START_BURST
+#define CMD_START_BURST 0x46
+
+// Downlink (command):
+// duration[15:8], duration[7:0] (s; max. BURST_DURATION_MAX), period[7:0] (s; min. BURST_PERIOD_MIN),
+// fields[7:0] (BURST_F_*)
+
+// Uplink (response): blob of type 0x03 (BLOB_TYPE_BURST)
+
 // ===========================
 
 /*!
@@ -195,6 +263,38 @@ uint8_t decodeDownlink(uint8_t port, uint8_t *payload, size_t size);
  */
 void sendCfgUplink(uint8_t uplinkReq, uint32_t uplinkInterval);
 
+/*!
+ * \brief Send pending blob fragments
+ *
+ * Fragments are sent as long as node.timeUntilUplink() allows without
+ * waiting more than BLOB_WAIT_MAX seconds, up to BLOB_FRAGS_PER_WAKE
+ * fragments per wake-up cycle. The transfer continues after the next wake-up.
+ */
+void sendBlobFragments(void);
+
+/*!
+ * \brief Poll for downlinks (low-latency mode)
+ *
+ * Sends empty uplinks on LL_POLL_PORT every LL_POLL_INTERVAL seconds
+ * (or as permitted by node.timeUntilUplink()) and handles received
+ * commands via decodeDownlink().
+ *
+ * \param seconds polling window in seconds
+ *
+ * \returns remaining time until end of polling window in seconds (min. 1)
+ */
+uint32_t pollDownlinks(uint32_t seconds);
+
+/*!
+ * \brief Drain downlinks queued at the network server
+ *
+ * Sends empty uplinks on LL_POLL_PORT as long as each uplink is answered
+ * by an application downlink (MAC-only downlinks end draining), up to
+ * DL_DRAIN_MAX uplinks without waiting more than DL_DRAIN_WAIT_MAX seconds
+ * for the duty cycle.
+ */
+void drainDownlinks(void);
+
 /*!
  * \brief Get uplink delay in milliseconds
  *
@@ -7,11 +7,50 @@
 //                      The code was originally executed on ESP8266 in a timer interrupt handler;
 //                      will now be run on ESP32 in main execution loop.
 // 20230408 matthias-bs Added Modbus serial interface selection
+// 20261017 matthias-bs Added raw input register image
+//                      Modbus transport is now pluggable (serial or RTU-over-TCP)
+//                      Added passive acquisition by sniffing another master's traffic
+//                      Added additional devices with own register profile, slave ID and data rate
+//                      Moved input register decoding to GrowattDecode.h (shared with host tools)
+//                      Added recording of raw Modbus traffic to debug UART or flash
+//                      Moved holding register decoding to GrowattDecode.h
 
 #include "growattInterface.h"
+#include "growatt_cfg.h"
+#if MODBUS_RECORD == 2
+#include <LittleFS.h>
+#endif
 
 extern bool modbusRS485;
 
+#if MODBUS_RECORD
+// Record sink - debug UART (only if Modbus is not on the same port) or file
+static void recordSink(const char *line) {
+#if MODBUS_RECORD == 1
+  if (modbusRS485) {
+    Serial.println(line);
+  }
+#else
+  File file = LittleFS.open(MODBUS_RECORD_FILE, "a");
+  if (file) {
+    if (file.size() < MODBUS_RECORD_MAX) {
+      file.write(reinterpret_cast<const uint8_t *>(line), strlen(line));
+      file.write(reinterpret_cast<const uint8_t *>("\n"), 1);
+    }
+    file.close();
+  }
+#endif
+}
+
+static uint32_t recordMillis() {
+  return millis();
+}
+
+static uint32_t recordUnixTime() {
+  return static_cast<uint32_t>(time(nullptr));
+}
+#endif
+
 growattIF::growattIF(int _PinMAX485_RE_NEG, int _PinMAX485_DE, int _PinMAX485_RX, int _PinMAX485_TX) {
   PinMAX485_RE_NEG = _PinMAX485_RE_NEG;
   PinMAX485_DE = _PinMAX485_DE;
@@ -26,24 +65,42 @@ growattIF::growattIF(int _PinMAX485_RE_NEG, int _PinMAX485_DE, int _PinMAX485_RX
 }
 
 void growattIF::initGrowatt() {
-  if (modbusRS485) {
-    Serial2.begin(MODBUS_RATE_RS485, SERIAL_8N1, PinMAX485_RX, PinMAX485_TX);
-    growattInterface.begin(SLAVE_ID, Serial2);
+  if (transport) {
+    // Alternative transport provided by application
+    serial = nullptr;
+    activeTransport = transport;
   } else {
-    Serial.begin(MODBUS_RATE_USB, SERIAL_8N1);
-    growattInterface.begin(SLAVE_ID, Serial);
+    initSerial();
+    activeTransport = &serialTransport;
   }
-  
+
+#if MODBUS_RECORD
+  // All transactions are passed through the recorder
+#if MODBUS_RECORD == 2
+  LittleFS.begin();
+#endif
+  recorder.begin(*activeTransport, recordSink, recordMillis, recordUnixTime);
+  activeTransport = &recorder;
+#endif
+  growattInterface.begin(SLAVE_ID, *activeTransport);
+}
+
+void growattIF::initSerial() {
   static growattIF* obj = this;                              //pointer to the object
   // Callbacks allow us to configure the RS485 transceiver correctly
-  growattInterface.preTransmission ([]() {                   //Set function pointer via anonymous Lambda function
-    obj->preTransmission();
-  });
-
-  growattInterface.postTransmission([]() {                   //Set function pointer via anonymous Lambda function
-    obj->postTransmission();
-  });
+  auto pre  = []() { obj->preTransmission(); };
+  auto post = []() { obj->postTransmission(); };
 
+  if (modbusRS485) {
+    Serial2.begin(MODBUS_RATE_RS485, SERIAL_8N1, PinMAX485_RX, PinMAX485_TX);
+    serial = &Serial2;
+    baudrate = MODBUS_RATE_RS485;
+  } else {
+    Serial.begin(MODBUS_RATE_USB, SERIAL_8N1);
+    serial = &Serial;
+    baudrate = MODBUS_RATE_USB;
+  }
+  serialTransport.begin(*serial, pre, post);
 }
 
 uint8_t growattIF::writeRegister(uint16_t reg, uint16_t message) {
@@ -73,128 +130,18 @@ uint8_t growattIF::ReadInputRegisters(char* json) {
   //ESP.wdtEnable(1);
 
   if (result == growattInterface.ku8MBSuccess)   {
+    for (int i = 0; i < 64; i++) {
+      inputregisters[setcounter * 64 + i] = growattInterface.getResponseBuffer(i);
+    }
+
     if (setcounter == 0) {    //register 0-63
-      // Status and PV data
-      modbusdata.status = growattInterface.getResponseBuffer(0);
-      modbusdata.solarpower = ((growattInterface.getResponseBuffer(1) << 16) | growattInterface.getResponseBuffer(2)) * 0.1;
-
-      modbusdata.pv1voltage = growattInterface.getResponseBuffer(3) * 0.1;
-      modbusdata.pv1current = growattInterface.getResponseBuffer(4) * 0.1;
-      modbusdata.pv1power = ((growattInterface.getResponseBuffer(5) << 16) | growattInterface.getResponseBuffer(6)) * 0.1;
-
-      modbusdata.pv2voltage = growattInterface.getResponseBuffer(7) * 0.1;
-      modbusdata.pv2current = growattInterface.getResponseBuffer(8) * 0.1;
-      modbusdata.pv2power = ((growattInterface.getResponseBuffer(9) << 16) | growattInterface.getResponseBuffer(10)) * 0.1;
-
-      // Output
-      modbusdata.outputpower = ((growattInterface.getResponseBuffer(35) << 16) | growattInterface.getResponseBuffer(36)) * 0.1;
-      modbusdata.gridfrequency = growattInterface.getResponseBuffer(37) * 0.01;
-      modbusdata.gridvoltage = growattInterface.getResponseBuffer(38) * 0.1;
-
-      // Energy
-      modbusdata.energytoday = ((growattInterface.getResponseBuffer(53) << 16) | growattInterface.getResponseBuffer(54)) * 0.1;
-      modbusdata.energytotal = ((growattInterface.getResponseBuffer(55) << 16) | growattInterface.getResponseBuffer(56)) * 0.1;
-      modbusdata.totalworktime = ((growattInterface.getResponseBuffer(57) << 16) | growattInterface.getResponseBuffer(58)) * 0.5;
-
-      modbusdata.pv1energytoday = ((growattInterface.getResponseBuffer(59) << 16) | growattInterface.getResponseBuffer(60)) * 0.1;
-      modbusdata.pv1energytotal = ((growattInterface.getResponseBuffer(61) << 16) | growattInterface.getResponseBuffer(62)) * 0.1;
-      overflow = growattInterface.getResponseBuffer(63);
       setcounter ++;
       return Continue;
     }
 
-    if (setcounter == 1) {    //register 64 -127
-      modbusdata.pv2energytoday = ((overflow << 16) | growattInterface.getResponseBuffer(64 - 64)) * 0.1;
-      modbusdata.pv2energytotal = ((growattInterface.getResponseBuffer(65 - 64) << 16) | growattInterface.getResponseBuffer(66 - 64)) * 0.1;
-
-      // Temperatures
-      modbusdata.tempinverter = growattInterface.getResponseBuffer(93 - 64) * 0.1;
-      modbusdata.tempipm = growattInterface.getResponseBuffer(94 - 64) * 0.1;
-      modbusdata.tempboost = growattInterface.getResponseBuffer(95 - 64) * 0.1;
-
-      // Diag data
-      modbusdata.ipf = growattInterface.getResponseBuffer(100 - 64);
-      modbusdata.realoppercent = growattInterface.getResponseBuffer(101 - 64);
-      modbusdata.opfullpower = ((growattInterface.getResponseBuffer(102 - 64) << 16) | growattInterface.getResponseBuffer(103 - 64)) * 0.1;
-      modbusdata.deratingmode = growattInterface.getResponseBuffer(103 - 64);
-      //  0:no derate;
-      //  1:PV;
-      //  2:*;
-      //  3:Vac;
-      //  4:Fac;
-      //  5:Tboost;
-      //  6:Tinv;
-      //  7:Control;
-      //  8:*;
-      //  9:*OverBack
-      //  ByTime;
-
-      modbusdata.faultcode = growattInterface.getResponseBuffer(105 - 64);
-      //  1~23 " Error: 99+x
-      //  24 "Auto Test
-      //  25 "No AC
-      //  26 "PV Isolation Low",
-      //  27 " Residual I
-      //  28 " Output High
-      //  29 " PV Voltage
-      //  30 " AC V Outrange
-      //  31 " AC F Outrange
-      //  32 " Module Hot
-
-
-      modbusdata.faultbitcode = ((growattInterface.getResponseBuffer(105 - 64) << 16) | growattInterface.getResponseBuffer(106 - 64));
-      //  0x00000001 %
-      //  0x00000002 Communication error
-      //  0x00000004 %
-      //  0x00000008 StrReverse or StrShort fault
-      //  0x00000010 Model Init fault
-      //  0x00000020 Grid Volt Sample diffirent
-      //  0x00000040 ISO Sample diffirent
-      //  0x00000080 GFCI Sample diffirent
-      //  0x00000100 %
-      //  0x00000200 %
-      //  0x00000400 %
-      //  0x00000800 %
-      //  0x00001000 AFCI Fault
-      //  0x00002000 %
-      //  0x00004000 AFCI Module fault
-      //  0x00008000 %
-      //  0x00010000 %
-      //  0x00020000 Relay check fault
-      //  0x00040000 %
-      //  0x00080000 %
-      //  0x00100000 %
-      //  0x00200000 Communication error
-      //  0x00400000 Bus Voltage error
-      //  0x00800000 AutoTest fail
-      //  0x01000000 No Utility
-      //  0x02000000 PV Isolation Low
-      //  0x04000000 Residual I High
-      //  0x08000000 Output High DCI
-      //  0x10000000 PV Voltage high
-      //  0x20000000 AC V Outrange
-      //  0x40000000 AC F Outrange
-      //  0x80000000 TempratureHigh
-
-      modbusdata.warningbitcode = ((growattInterface.getResponseBuffer(110 - 64) << 16) | growattInterface.getResponseBuffer(111 - 64));
-      //  0x0001 Fan warning
-      //  0x0002 String communication abnormal
-      //  0x0004 StrPIDconfig Warning
-      //  0x0008 %
-      //  0x0010 DSP and COM firmware unmatch
-      //  0x0020 %
-      //  0x0040 SPD abnormal
-      //  0x0080 GND and N connect abnormal
-      //  0x0100 PV1 or PV2 circuit short
-      //  0x0200 PV1 or PV2 boost driver broken
-      //  0x0400 %
-      //  0x0800 %
-      //  0x1000 %
-      //  0x2000 %
-      //  0x4000 %
-      //  0x8000 %
-      setcounter = 0;
-    }
+    //register 64 -127
+    setcounter = 0;
+    decodeInputRegisters();
   } else {
     return result;
   }
@@ -238,6 +185,102 @@ uint8_t growattIF::ReadInputRegisters(char* json) {
   return result;
 }
 
+void growattIF::decodeInputRegisters() {
+  growattDecodeInputRegisters(inputregisters, modbusdata);
+}
+
+// Registers required by decodeInputRegisters()
+static bool sniffRequired(uint8_t reg) {
+  return (reg <= 66) || ((reg >= 93) && (reg <= 111));
+}
+
+uint8_t growattIF::SniffInputRegisters(uint32_t windowMs) {
+  if (!serial) {
+    return growattInterface.ku8MBResponseTimedOut;
+  }
+
+  uint8_t frame[MB_FRAME_MAX];
+  size_t len = 0;
+  uint8_t covered[numInputRegisters / 8] = {0};
+  uint8_t reqFunction = 0;
+  uint16_t reqAddr = 0;
+  uint16_t reqQty = 0;
+  uint32_t frames = 0;
+
+  // Frames are delimited by a silence of 3.5 characters (11 bits each), min. 1.75 ms
+  uint32_t gapUs = max(1750UL, 38500000UL / baudrate);
+  uint32_t start = millis();
+  uint32_t lastRx = micros();
+
+  while (millis() - start < windowMs) {
+    if (serial->available()) {
+      uint8_t b = serial->read();
+      if (len < sizeof(frame)) {
+        frame[len++] = b;
+      } else {
+        // Not a valid frame - resynchronize
+        len = 0;
+      }
+      lastRx = micros();
+      continue;
+    }
+
+    uint32_t silence = micros() - lastRx;
+    if ((len == 0) || (silence < gapUs)) {
+      yield();
+      continue;
+    }
+
+    uint16_t crc = (len >= 4) ? modbusCrc16(frame, len - 2) : 0;
+    if ((len < 4) || (frame[len - 2] != (crc & 0xFF)) || (frame[len - 1] != (crc >> 8))) {
+      // The UART may deliver a frame in several chunks - wait for the remainder
+      if (silence > SNIFF_RESYNC_US) {
+        len = 0;
+      }
+      continue;
+    }
+    frames++;
+
+    if (frame[0] == SLAVE_ID) {
+      if ((len == 8) && ((frame[1] == 0x03) || (frame[1] == 0x04))) {
+        // Request (responses to read requests have an odd length)
+        reqFunction = frame[1];
+        reqAddr = (frame[2] << 8) | frame[3];
+        reqQty = (frame[4] << 8) | frame[5];
+      } else if ((frame[1] == 0x04) && (reqFunction == 0x04) && (frame[2] == 2 * reqQty) && (len == 5U + 2U * reqQty)) {
+        // Response to preceding request
+        for (uint16_t i = 0; i < reqQty; i++) {
+          uint16_t reg = reqAddr + i;
+          if (reg < numInputRegisters) {
+            inputregisters[reg] = (frame[3 + 2 * i] << 8) | frame[4 + 2 * i];
+            covered[reg / 8] |= 1 << (reg % 8);
+          }
+        }
+        reqFunction = 0;
+      } else {
+        // Other function, exception or unmatched response
+        reqFunction = 0;
+      }
+    }
+    len = 0;
+
+    bool complete = true;
+    for (uint8_t reg = 0; reg < numInputRegisters; reg++) {
+      if (sniffRequired(reg) && !(covered[reg / 8] & (1 << (reg % 8)))) {
+        complete = false;
+        break;
+      }
+    }
+    if (complete) {
+      decodeInputRegisters();
+      log_d("Sniffing: complete after %lu ms, %u frames", millis() - start, frames);
+      return growattInterface.ku8MBSuccess;
+    }
+  }
+  log_d("Sniffing: %u valid frames, register image incomplete", frames);
+  return growattInterface.ku8MBResponseTimedOut;
+}
+
 uint8_t growattIF::ReadHoldingRegisters(char* json) {
   uint8_t result;
   //ESP.wdtDisable();
@@ -245,75 +288,19 @@ uint8_t growattIF::ReadHoldingRegisters(char* json) {
   //ESP.wdtEnable(1);
 
   if (result == growattInterface.ku8MBSuccess)   {
-    if (setcounter == 0) {      //register 0-63
-      modbussettings.enable = growattInterface.getResponseBuffer(0);
-      modbussettings.safetyfuncen = growattInterface.getResponseBuffer(1); // Safety Function Enabled
-      //  Bit0: SPI enable
-      //  Bit1: AutoTestStart
-      //  Bit2: LVFRT enable
-      //  Bit3: FreqDerating Enable
-      //  Bit4: Softstart enable
-      //  Bit5: DRMS enable
-      //  Bit6: Power Volt Func Enable
-      //  Bit7: HVFRT enable
-      //  Bit8: ROCOF enable
-      //  Bit9: Recover FreqDerating Mode Enable
-      //  Bit10~15: Reserved
-      modbussettings.maxoutputactivepp = growattInterface.getResponseBuffer(3); // Inverter M ax output active power percent  0-100: %, 255: not limited
-      modbussettings.maxoutputreactivepp = growattInterface.getResponseBuffer(4); // Inverter M ax output reactive power percent  0-100: %, 255: not limited
-      modbussettings.maxpower = ((growattInterface.getResponseBuffer(6) << 16) | growattInterface.getResponseBuffer(7)) * 0.1;
-      modbussettings.voltnormal = growattInterface.getResponseBuffer(8) * 0.1;
-      //strncpy(modbussettings.firmware, "      ", 6);
-      modbussettings.firmware[0] = growattInterface.getResponseBuffer(9) >> 8;
-      modbussettings.firmware[1] = growattInterface.getResponseBuffer(9) & 0xff;
-      modbussettings.firmware[2] = growattInterface.getResponseBuffer(10) >> 8;
-      modbussettings.firmware[3] = growattInterface.getResponseBuffer(10) & 0xff;
-      modbussettings.firmware[4] = growattInterface.getResponseBuffer(11) >> 8;
-      modbussettings.firmware[5] = growattInterface.getResponseBuffer(11) & 0xff;
-
-      //strncpy(modbussettings.controlfirmware, "      ", 6);
-      modbussettings.controlfirmware[0] = growattInterface.getResponseBuffer(12) >> 8;
-      modbussettings.controlfirmware[1] = growattInterface.getResponseBuffer(12) & 0xff;
-      modbussettings.controlfirmware[2] = growattInterface.getResponseBuffer(13) >> 8;
-      modbussettings.controlfirmware[3] = growattInterface.getResponseBuffer(13) & 0xff;
-      modbussettings.controlfirmware[4] = growattInterface.getResponseBuffer(14) >> 8;
-      modbussettings.controlfirmware[5] = growattInterface.getResponseBuffer(14) & 0xff;
-
-      modbussettings.startvoltage = growattInterface.getResponseBuffer(17) * 0.1;
-
-      //strncpy(modbussettings.serial, "          ", 10);
-      modbussettings.serial[0] = growattInterface.getResponseBuffer(23) >> 8;
-      modbussettings.serial[1] = growattInterface.getResponseBuffer(23) & 0xff;
-      modbussettings.serial[2] = growattInterface.getResponseBuffer(24) >> 8;
-      modbussettings.serial[3] = growattInterface.getResponseBuffer(24) & 0xff;
-      modbussettings.serial[4] = growattInterface.getResponseBuffer(25) >> 8;
-      modbussettings.serial[5] = growattInterface.getResponseBuffer(25) & 0xff;
-      modbussettings.serial[6] = growattInterface.getResponseBuffer(26) >> 8;
-      modbussettings.serial[7] = growattInterface.getResponseBuffer(26) & 0xff;
-      modbussettings.serial[8] = growattInterface.getResponseBuffer(27) >> 8;
-      modbussettings.serial[9] = growattInterface.getResponseBuffer(27) & 0xff;
-
-      modbussettings.gridvoltlowlimit = growattInterface.getResponseBuffer(52) * 0.1;
-      modbussettings.gridvolthighlimit = growattInterface.getResponseBuffer(53) * 0.1;
-      modbussettings.gridfreqlowlimit = growattInterface.getResponseBuffer(54) * 0.01;
-      modbussettings.gridfreqhighlimit = growattInterface.getResponseBuffer(55) * 0.01;
-      setcounter ++;
-      return Continue;
+    uint16_t regs[64];
+    for (int i = 0; i < 64; i++) {
+      regs[i] = growattInterface.getResponseBuffer(i);
     }
-    if (setcounter == 1) {      //register 64 -127
-      modbussettings.gridvoltlowconnlimit = growattInterface.getResponseBuffer(64 - 64) * 0.1;
-      modbussettings.gridvolthighconnlimit = growattInterface.getResponseBuffer(65 - 64) * 0.1;
-      modbussettings.gridfreqlowconnlimit = growattInterface.getResponseBuffer(66 - 64) * 0.01;
-      modbussettings.gridfreqhighconnlimit = growattInterface.getResponseBuffer(67 - 64) * 0.01;
+    growattDecodeHoldingRegisters(setcounter, regs, modbussettings);
 
-      modbussettings.modul = growattInterface.getResponseBuffer(121 - 64);
+    if (setcounter < 2) {       //register 0-63, 64-127
       setcounter ++;
       return Continue;
     }
-    if (setcounter == 2) {      //register 128-191
-      //          //          modbussettings.modul = growattInterface.getResponseBuffer(130 - 128);
-      setcounter = 0;
-    }
+    //register 128-191
+    //          //          modbussettings.modul = growattInterface.getResponseBuffer(130 - 128);
+    setcounter = 0;
   } else {
     return result;
   }
@@ -346,6 +333,81 @@ uint8_t growattIF::ReadHoldingRegisters(char* json) {
   return result;
 }
 
+bool growattIF::addDevice(uint8_t type, uint8_t slaveId, uint32_t rate) {
+  if ((type == METER_NONE) || (type >= sizeof(deviceProfiles) / sizeof(deviceProfiles[0])) ||
+      (numDevices >= MODBUS_DEVICES_MAX)) {
+    return false;
+  }
+  modbus_device &dev = devices[numDevices++];
+  dev.profile = &deviceProfiles[type];
+  dev.slaveId = slaveId;
+  dev.rate = rate;
+  dev.result = growattInterface.ku8MBResponseTimedOut;
+  memset(dev.values, 0, sizeof(dev.values));
+  return true;
+}
+
+uint8_t growattIF::readDeviceRegisters(uint8_t slaveId, uint32_t rate, uint8_t function, uint16_t addr, uint16_t qty, uint16_t *dst) {
+  ModbusTransport *t = activeTransport;
+  bool rateChange = serial && (rate != baudrate);
+
+  // Devices on the same bus may use different data rates
+  if (rateChange) {
+    serial->flush();
+    serial->updateBaudRate(rate);
+  }
+  growattInterface.begin(slaveId, *t);
+  uint8_t result = (function == 0x03) ? growattInterface.readHoldingRegisters(addr, qty)
+                                      : growattInterface.readInputRegisters(addr, qty);
+  if (result == growattInterface.ku8MBSuccess) {
+    for (uint16_t i = 0; i < qty; i++) {
+      dst[i] = growattInterface.getResponseBuffer(i);
+    }
+  }
+
+  // Back to Growatt
+  growattInterface.begin(SLAVE_ID, *t);
+  if (rateChange) {
+    serial->updateBaudRate(baudrate);
+  }
+  return result;
+}
+
+uint8_t growattIF::ReadDevices() {
+  uint8_t res = Success;
+  uint16_t regs[MB_REGS_MAX];
+
+  for (uint8_t i = 0; i < numDevices; i++) {
+    modbus_device &dev = devices[i];
+    const DeviceProfile *p = dev.profile;
+
+    dev.result = readDeviceRegisters(dev.slaveId, dev.rate, p->function, p->first, p->count, regs);
+    log_d("%s (ID %u): 0x%02x", p->name, dev.slaveId, dev.result);
+    if (dev.result != growattInterface.ku8MBSuccess) {
+      if (res == Success) {
+        res = dev.result;
+      }
+      continue;
+    }
+
+    for (uint8_t j = 0; j < p->numRegs; j++) {
+      const DeviceRegister &r = p->regs[j];
+      uint16_t idx = r.addr - p->first;
+      uint32_t raw = (r.type == DEV_U16 || r.type == DEV_S16) ? regs[idx] : ((uint32_t)regs[idx] << 16) | regs[idx + 1];
+      float val;
+      if (r.type == DEV_FLOAT32) {
+        memcpy(&val, &raw, sizeof(val));
+      } else if (r.type == DEV_S16) {
+        val = (int16_t)raw;
+      } else {
+        val = raw;
+      }
+      dev.values[r.value] = val * r.scale;
+    }
+  }
+  return res;
+}
+
 String growattIF::sendModbusError(uint8_t result) {
   String message = "";
   if (result == growattInterface.ku8MBIllegalFunction) {
@@ -4,19 +4,35 @@
 //
 // 20230313 matthias-bs Replaced SoftwareSerial by HardwareSerial
 // 20230408 Added different Modbus data rates for RS485 and USB
+// 20261017 Added raw input register image
+//          Replaced ModbusMaster by frame-level ModbusRtuMaster with pluggable transport
+//          Added passive acquisition (SniffInputRegisters())
+//          Added additional devices on the same bus (addDevice(), ReadDevices())
+//          Moved input register decoding to GrowattDecode.h
+//          Added Modbus traffic recording (MODBUS_RECORD)
+//          Moved holding register decoding to GrowattDecode.h
 #ifndef GROWATTINTERFACE_H
 #define GROWATTINTERFACE_H
 
 #include "Arduino.h"
-#include <ModbusMaster.h>            // Modbus master library for ESP8266 by Doc Walker (https://github.com/4-20ma/ModbusMaster)
+#include "ModbusRtu.h"               // Modbus RTU master with pluggable transport
+#include "ModbusTransportSerial.h"   // HardwareSerial and RTU-over-TCP transports
+#include "DeviceProfiles.h"          // Register profiles of additional devices (e.g. energy meters)
+#include "GrowattDecode.h"           // Input register decoding (shared with host tools)
+#include "ModbusRecorder.h"          // Modbus traffic recording
 #define SLAVE_ID                 1   // Default slave ID of Growatt
 #define MODBUS_RATE_RS485     9600   // Growatt Modbus data rate over RS485
 #define MODBUS_RATE_USB     115200   // Growatt Modbus data rate over USB 
+#define SNIFF_RESYNC_US      20000   // Sniffing: discard incomplete frame after this silence [us]
 
 class growattIF {
 
   private:
-    ModbusMaster growattInterface;
+    ModbusRtuMaster growattInterface;
+    ModbusTransportSerial serialTransport;
+    ModbusTransport *transport = nullptr;
+    ModbusTransport *activeTransport = nullptr;
+    ModbusRecorder recorder;
     //SoftwareSerial *serial;
     HardwareSerial *serial;
     void preTransmission();
@@ -26,35 +42,86 @@ class growattIF {
     int PinMAX485_RX;
     int PinMAX485_TX;
     int setcounter = 0;
-    int overflow;
+    uint32_t baudrate = 0;
+    void decodeInputRegisters();
+    void initSerial();
+    uint8_t readDeviceRegisters(uint8_t slaveId, uint32_t rate, uint8_t function, uint16_t addr, uint16_t qty, uint16_t *dst);
 
   public:
-    struct modbus_input_registers
-    {
-      int status;
-      float solarpower, pv1voltage, pv1current, pv1power, pv2voltage, pv2current, pv2power, outputpower, gridfrequency, gridvoltage;
-      float energytoday, energytotal, totalworktime, pv1energytoday, pv1energytotal, pv2energytoday, pv2energytotal, opfullpower;
-      float tempinverter, tempipm, tempboost;
-      int ipf, realoppercent, deratingmode, faultcode, faultbitcode, warningbitcode;
-    };
-    struct modbus_input_registers modbusdata;
+    typedef growatt_input_registers modbus_input_registers;
+    modbus_input_registers modbusdata;
+
+    // Raw input register image (registers 0...127)
+    static const uint8_t numInputRegisters = 128;
+    uint16_t inputregisters[numInputRegisters];
 
-    struct modbus_holding_registers
+    typedef growatt_holding_registers modbus_holding_registers;
+    modbus_holding_registers modbussettings;
+
+    // Additional devices on the same bus (e.g. energy meters)
+    struct modbus_device
     {
-      int enable, safetyfuncen, maxoutputactivepp, maxoutputreactivepp, modul;
-      float  maxpower, voltnormal, startvoltage, gridvoltlowlimit, gridvolthighlimit, gridfreqlowlimit, gridfreqhighlimit, gridvoltlowconnlimit, gridvolthighconnlimit, gridfreqlowconnlimit, gridfreqhighconnlimit;
-      char firmware[6], controlfirmware[6];
-      char serial[10];
+      const DeviceProfile *profile;
+      uint8_t slaveId;
+      uint32_t rate;
+      uint8_t result;
+      float values[DEV_NUM_VALUES];
     };
-
-    struct modbus_holding_registers modbussettings;
+    struct modbus_device devices[MODBUS_DEVICES_MAX];
+    uint8_t numDevices = 0;
 
     growattIF(int _PinMAX485_RE_NEG, int _PinMAX485_DE, int _PinMAX485_RX, int _PinMAX485_TX);
     void initGrowatt();
+
+    /*!
+     * \brief Use alternative Modbus transport (e.g. ModbusTransportTcp)
+     *
+     * Must be called before initGrowatt(); by default, the serial port
+     * selected by modbusRS485 is used.
+     *
+     * \param t transport
+     */
+    void setTransport(ModbusTransport *t) { transport = t; }
     uint8_t writeRegister(uint16_t reg, uint16_t message);
     uint16_t readRegister(uint16_t reg);
     uint8_t ReadInputRegisters(char* json);
+
+    /*!
+     * \brief Acquire input registers passively (listen-only)
+     *
+     * Decodes the request/response pairs of another Modbus master on the
+     * bus (function 0x04, CRC validated, responses matched to the preceding
+     * request) without transmitting. Only available with the serial transport.
+     *
+     * \param windowMs listening time [ms]
+     *
+     * \returns Success if all decoded registers have been seen in the window,
+     *          otherwise ku8MBResponseTimedOut (0xE2)
+     */
+    uint8_t SniffInputRegisters(uint32_t windowMs);
     uint8_t ReadHoldingRegisters(char* json);
+
+    /*!
+     * \brief Add device to polling schedule
+     *
+     * The device is polled with its own slave ID and data rate by ReadDevices().
+     *
+     * \param type    device type (METER_*, see DeviceProfiles.h)
+     * \param slaveId slave ID
+     * \param rate    data rate (ignored with RTU-over-TCP)
+     *
+     * \returns false if the type is invalid or MODBUS_DEVICES_MAX is exceeded
+     */
+    bool addDevice(uint8_t type, uint8_t slaveId, uint32_t rate);
+
+    /*!
+     * \brief Read all additional devices
+     *
+     * Must be called after initGrowatt(). The results are stored in devices[].
+     *
+     * \returns Success or result code of first failed device
+     */
+    uint8_t ReadDevices();
     String sendModbusError(uint8_t result);
 
     // Error codes
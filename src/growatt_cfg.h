@@ -34,6 +34,11 @@
 // History:
 //
 // 20240813 Copied from growatt2lorawan (settings.h)
+// 20261017 Added PV analytics settings
+//          Added MODBUS_BLOCKS_MAX
+//          Added Modbus slave proxy settings
+//          Added passive bus-sniffing settings
+//          Added Modbus recording settings
 //
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -49,6 +54,35 @@
 
 #define UPDATE_MODBUS   2         // Modbus device is read every <n> seconds
 #define MODBUS_RETRIES  5         // no. of modbus retries
+#define MODBUS_BLOCKS_MAX 4       // max. no. of register blocks per readout attempt
+
+// Passive acquisition - if another Modbus master (e.g. a datalogger) polls the inverter,
+// its traffic is decoded instead of polling (0 = disabled / 1 = enabled; serial transport only)
+#define MODBUS_SNIFF        0
+#define SNIFF_WINDOW        10    // Listening time [s] before falling back to active polling
+
+// Recording of raw Modbus traffic for replay on the host (see extras/modbus/modbus_replay.cpp)
+// (0 = disabled / 1 = debug UART (RS485 interface only) / 2 = file on LittleFS)
+#define MODBUS_RECORD       0
+#define MODBUS_RECORD_FILE  "/mbrec.txt"  // Record file
+#define MODBUS_RECORD_MAX   262144        // Recording stops at this file size [bytes]
+
+// Modbus slave proxy (see ModbusSlaveProxy.h) - serves the last input register image
+// on Serial1 during wake-up cycles only, not during deep sleep (0 = disabled / 1 = enabled; ESP32 only)
+#define MODBUS_PROXY        0
+#define PROXY_SLAVE_ID      1     // Slave ID of the proxy
+#define PROXY_RATE          9600  // Data rate of the proxy
+#define PROXY_RX            25    // Serial1 RX pin (RO pin of second RS485 transceiver)
+#define PROXY_TX            26    // Serial1 TX pin (DI pin of second RS485 transceiver)
+#define PROXY_DE            -1    // DE/RE pin of second RS485 transceiver (-1: not used)
+
+// PV analytics (see PvAnalytics.h)
+#define PV_MIN_POWER        50    // Minimum DC power [W] for a sample to be evaluated
+#define PV_MIN_VOLTAGE      500   // Minimum string voltage [0.1 V] for a string to be considered connected
+#define PV_EFFICIENCY_MIN   90    // Conversion efficiency [%] below this value is flagged
+#define PV_MISMATCH_MAX     20    // PV1/PV2 mismatch [%] above this value is flagged
+#define PV_CLIP_RATIO       97    // Output power >= PV_CLIP_RATIO [%] of nominal power counts as clipped
+#define PV_DEGRADATION_MAX  10    // Daily peak power more than PV_DEGRADATION_MAX [%] below average is flagged
 
 #define STATUS_LED    LED_BUILTIN     // Status LED
 